@@ -220,6 +220,22 @@
 #endif
 #define DEFAULT_CHECK_FIRMWARE_BEFORE_LOADING false
 
+/* Disk space (in MB) used to keep content extracted
+ * from archives for cores which need a full path, so
+ * that loading it again does not decompress it again.
+ * 0 extracts to a temporary file every time */
+#if defined(PSP) || defined(GEKKO) || defined(_3DS) || defined(VITA)
+#define DEFAULT_CONTENT_EXTRACTION_CACHE_SIZE 0
+#else
+#define DEFAULT_CONTENT_EXTRACTION_CACHE_SIZE 1024
+#endif
+
+/* Block size (in KB) in which files opened read-only
+ * are read ahead, so that the many small reads and
+ * seeks of the database scanner and archive parsers
+ * do not each reach the OS. 0 leaves it to stdio */
+#define DEFAULT_VFS_READ_AHEAD_SIZE 64
+
 /* Specifies whether to 'reload' (fork and quit)
  * RetroArch when launching content with the
  * currently loaded core
@@ -1151,6 +1167,19 @@ static const unsigned menu_left_thumbnails_default = 0;
 
 static const unsigned gfx_thumbnail_upscale_threshold = 0;
 
+/* Memory (in MB) reserved for decoded thumbnail
+ * images, so that recently viewed thumbnails do not
+ * have to be loaded again. 0 disables the cache */
+#if defined(PSP) || defined(GEKKO) || defined(_3DS)
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 4
+#else
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 32
+#endif
+
+/* Keep copies of thumbnail images on disk that are
+ * pre-scaled to the size at which the menu draws them */
+#define DEFAULT_GFX_THUMBNAIL_DERIVATIVE_CACHE false
+
 #ifdef HAVE_MENU
 #define DEFAULT_MENU_TIMEDATE_STYLE          MENU_TIMEDATE_STYLE_DDMM_HM
 #define DEFAULT_MENU_TIMEDATE_DATE_SEPARATOR MENU_TIMEDATE_DATE_SEPARATOR_HYPHEN
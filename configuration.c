@@ -1652,6 +1652,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("xmb_shadows_enable",            &settings->bools.menu_xmb_shadows_enable, true, DEFAULT_XMB_SHADOWS_ENABLE, false);
    SETTING_BOOL("xmb_vertical_thumbnails",       &settings->bools.menu_xmb_vertical_thumbnails, true, xmb_vertical_thumbnails, false);
 #endif
+   SETTING_BOOL("menu_thumbnail_derivative_cache", &settings->bools.gfx_thumbnail_derivative_cache, true, DEFAULT_GFX_THUMBNAIL_DERIVATIVE_CACHE, false);
 #endif
 #ifdef HAVE_CHEEVOS
    SETTING_BOOL("cheevos_enable",               &settings->bools.cheevos_enable, true, DEFAULT_CHEEVOS_ENABLE, false);
@@ -1877,6 +1878,7 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("menu_thumbnails",              &settings->uints.gfx_thumbnails, true, gfx_thumbnails_default, false);
    SETTING_UINT("menu_left_thumbnails",         &settings->uints.menu_left_thumbnails, true, menu_left_thumbnails_default, false);
    SETTING_UINT("menu_thumbnail_upscale_threshold", &settings->uints.gfx_thumbnail_upscale_threshold, true, gfx_thumbnail_upscale_threshold, false);
+   SETTING_UINT("menu_thumbnail_cache_size", &settings->uints.gfx_thumbnail_cache_size, true, DEFAULT_GFX_THUMBNAIL_CACHE_SIZE, false);
    SETTING_UINT("menu_timedate_style",          &settings->uints.menu_timedate_style, true, DEFAULT_MENU_TIMEDATE_STYLE, false);
    SETTING_UINT("menu_timedate_date_separator", &settings->uints.menu_timedate_date_separator, true, DEFAULT_MENU_TIMEDATE_DATE_SEPARATOR, false);
    SETTING_UINT("menu_ticker_type",             &settings->uints.menu_ticker_type, true, DEFAULT_MENU_TICKER_TYPE, false);
@@ -1930,6 +1932,8 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("custom_viewport_x",            (unsigned*)&settings->video_viewport_custom.x, false, 0 /* TODO */, false);
    SETTING_UINT("custom_viewport_y",            (unsigned*)&settings->video_viewport_custom.y, false, 0 /* TODO */, false);
    SETTING_UINT("content_history_size",         &settings->uints.content_history_size,   true, default_content_history_size, false);
+   SETTING_UINT("content_extraction_cache_size", &settings->uints.content_extraction_cache_size, true, DEFAULT_CONTENT_EXTRACTION_CACHE_SIZE, false);
+   SETTING_UINT("vfs_read_ahead_size",          &settings->uints.vfs_read_ahead_size, true, DEFAULT_VFS_READ_AHEAD_SIZE, false);
    SETTING_UINT("video_hard_sync_frames",       &settings->uints.video_hard_sync_frames, true, DEFAULT_HARD_SYNC_FRAMES, false);
    SETTING_UINT("video_frame_delay",            &settings->uints.video_frame_delay,      true, DEFAULT_FRAME_DELAY, false);
    SETTING_UINT("video_max_swapchain_images",   &settings->uints.video_max_swapchain_images, true, DEFAULT_MAX_SWAPCHAIN_IMAGES, false);
@@ -3368,6 +3372,8 @@ static bool config_load_file(global_t *global,
 
    frontend_driver_set_sustained_performance_mode(settings->bools.sustained_performance_mode);
    recording_driver_update_streaming_url();
+   retro_vfs_file_set_read_ahead_size(
+         (uint64_t)settings->uints.vfs_read_ahead_size << 10);
 
    if (!config_entry_exists(conf, "user_language"))
       msg_hash_set_uint(MSG_HASH_USER_LANGUAGE, frontend_driver_get_user_language());
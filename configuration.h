@@ -197,6 +197,9 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned gfx_thumbnail_cache_size;
+      unsigned content_extraction_cache_size;
+      unsigned vfs_read_ahead_size;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -571,6 +574,7 @@ typedef struct settings
       bool menu_rgui_switch_icons;
       bool menu_xmb_shadows_enable;
       bool menu_xmb_vertical_thumbnails;
+      bool gfx_thumbnail_derivative_cache;
       bool menu_content_show_settings;
       bool menu_content_show_favorites;
       bool menu_content_show_images;
@@ -72,6 +72,11 @@ void content_unset_does_not_need_content(void);
 
 uint32_t content_get_crc(void);
 
+/* Like content_get_crc(), but first waits for the background
+ * task computing the CRC32 of freshly loaded content.
+ * Must only be called from the main thread. */
+uint32_t content_wait_for_crc(void);
+
 void content_deinit(void);
 
 /* Initializes and loads a content file for the currently
@@ -32,8 +32,8 @@
 #define GL_CORE_RASTER_FONT_EMIT(c, vx, vy) \
    font_vertex[     2 * (6 * i + c) + 0] = (x + (delta_x + off_x + vx * width) * scale) * inv_win_width; \
    font_vertex[     2 * (6 * i + c) + 1] = (y + (delta_y - off_y - vy * height) * scale) * inv_win_height; \
-   font_tex_coords[ 2 * (6 * i + c) + 0] = (tex_x + vx * width) * inv_tex_size_x; \
-   font_tex_coords[ 2 * (6 * i + c) + 1] = (tex_y + vy * height) * inv_tex_size_y; \
+   font_tex_coords[ 2 * (6 * i + c) + 0] = tex_x + vx * width; \
+   font_tex_coords[ 2 * (6 * i + c) + 1] = tex_y + vy * height; \
    font_color[      4 * (6 * i + c) + 0] = color[0]; \
    font_color[      4 * (6 * i + c) + 1] = color[1]; \
    font_color[      4 * (6 * i + c) + 2] = color[2]; \
@@ -45,6 +45,10 @@ typedef struct
 {
    gl_core_t *gl;
    GLuint tex;
+   unsigned tex_width, tex_height;
+   /* Atlas size the texture coordinates batched in the
+    * block were normalised to */
+   unsigned coord_width, coord_height;
 
    const font_renderer_driver_t *font_driver;
    void *font_data;
@@ -86,6 +90,8 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, font->atlas->width, font->atlas->height);
+   font->tex_width  = font->atlas->width;
+   font->tex_height = font->atlas->height;
    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
                    font->atlas->width, font->atlas->height, GL_RED, GL_UNSIGNED_BYTE, font->atlas->buffer);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -97,6 +103,65 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    return true;
 }
 
+/* Once get_glyph() has grown the atlas, scales the texture
+ * coordinates already batched in the block to its new size. */
+static void gl_core_raster_font_fit_atlas(gl_core_raster_t *font)
+{
+   unsigned i;
+   float scale_x, scale_y;
+   const struct font_atlas *atlas = font->atlas;
+
+   if (     atlas->width  == font->coord_width
+         && atlas->height == font->coord_height)
+      return;
+
+   if (font->block)
+   {
+      scale_x = (float)font->coord_width  / atlas->width;
+      scale_y = (float)font->coord_height / atlas->height;
+
+      for (i = 0; i < font->block->carr.coords.vertices; i++)
+      {
+         font->block->carr.coords.tex_coord[2 * i + 0] *= scale_x;
+         font->block->carr.coords.tex_coord[2 * i + 1] *= scale_y;
+      }
+   }
+
+   font->coord_width  = atlas->width;
+   font->coord_height = atlas->height;
+}
+
+/* Uploads what changed since the last upload. The texture
+ * has immutable storage, so it is only re-created when the
+ * atlas changed size. */
+static void gl_core_raster_font_update_atlas(gl_core_raster_t *font)
+{
+   const struct font_atlas *atlas = font->atlas;
+
+   gl_core_raster_font_fit_atlas(font);
+
+   if (     atlas->width  != font->tex_width
+         || atlas->height != font->tex_height
+         || !atlas->dirty_width
+         || !atlas->dirty_height)
+   {
+      gl_core_raster_font_upload_atlas(font);
+      return;
+   }
+
+   glBindTexture(GL_TEXTURE_2D, font->tex);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas->width);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0,
+         atlas->dirty_x, atlas->dirty_y,
+         atlas->dirty_width, atlas->dirty_height,
+         GL_RED, GL_UNSIGNED_BYTE,
+         atlas->buffer + atlas->dirty_y * atlas->width + atlas->dirty_x);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 static void *gl_core_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -129,7 +194,10 @@ static void *gl_core_raster_font_init_font(void *data,
    if (!gl_core_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font->coord_width     = font->atlas->width;
+   font->coord_height    = font->atlas->height;
+   font->atlas->dirty    = false;
+   font->atlas->growable = true;
    return font;
 
 error:
@@ -167,12 +235,24 @@ static int gl_core_get_message_width(void *data, const char *msg,
    return delta_x * scale;
 }
 
+static void gl_core_raster_font_normalize_tex_coords(GLfloat *tex_coords,
+      unsigned vertices, float inv_tex_size_x, float inv_tex_size_y)
+{
+   unsigned i;
+
+   for (i = 0; i < vertices; i++)
+   {
+      tex_coords[2 * i + 0] *= inv_tex_size_x;
+      tex_coords[2 * i + 1] *= inv_tex_size_y;
+   }
+}
+
 static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
       const video_coords_t *coords)
 {
    if (font->atlas->dirty)
    {
-      gl_core_raster_font_upload_atlas(font);
+      gl_core_raster_font_update_atlas(font);
       font->atlas->dirty   = false;
    }
 
@@ -221,8 +301,6 @@ static void gl_core_raster_font_render_line(
    int y                = roundf(pos_y * gl->vp.height);
    int delta_x          = 0;
    int delta_y          = 0;
-   float inv_tex_size_x = 1.0f / font->atlas->width;
-   float inv_tex_size_y = 1.0f / font->atlas->height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
@@ -273,6 +351,13 @@ static void gl_core_raster_font_render_line(
          delta_y -= glyph->advance_y;
       }
 
+      /* Only normalise the texture coordinates once every
+       * glyph of the chunk is in, as looking one up may have
+       * grown the atlas */
+      gl_core_raster_font_fit_atlas(font);
+      gl_core_raster_font_normalize_tex_coords(font_tex_coords, i * 6,
+            1.0f / font->coord_width, 1.0f / font->coord_height);
+
       coords.tex_coord     = font_tex_coords;
       coords.vertex        = font_vertex;
       coords.color         = font_color;
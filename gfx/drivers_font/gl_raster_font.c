@@ -31,8 +31,8 @@
 #define GL_RASTER_FONT_EMIT(c, vx, vy) \
    font_vertex[     2 * (6 * i + c) + 0] = (x + (delta_x + off_x + vx * width) * scale) * inv_win_width; \
    font_vertex[     2 * (6 * i + c) + 1] = (y + (delta_y - off_y - vy * height) * scale) * inv_win_height; \
-   font_tex_coords[ 2 * (6 * i + c) + 0] = (tex_x + vx * width) * inv_tex_size_x; \
-   font_tex_coords[ 2 * (6 * i + c) + 1] = (tex_y + vy * height) * inv_tex_size_y; \
+   font_tex_coords[ 2 * (6 * i + c) + 0] = tex_x + vx * width; \
+   font_tex_coords[ 2 * (6 * i + c) + 1] = tex_y + vy * height; \
    font_color[      4 * (6 * i + c) + 0] = color[0]; \
    font_color[      4 * (6 * i + c) + 1] = color[1]; \
    font_color[      4 * (6 * i + c) + 2] = color[2]; \
@@ -47,6 +47,9 @@ typedef struct
    gl_t *gl;
    GLuint tex;
    unsigned tex_width, tex_height;
+   /* Set when the texture must be re-created at tex_width x
+    * tex_height on the next draw */
+   bool tex_resized;
 
    const font_renderer_driver_t *font_driver;
    void *font_data;
@@ -118,13 +121,9 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
-static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+static size_t gl_raster_font_get_format(gl_raster_t *font,
+      GLint *gl_internal, GLenum *gl_format)
 {
-   unsigned i, j;
-   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
-   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
-   size_t ncomponents                   = 2;
-   uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
    struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
 
@@ -135,39 +134,63 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
       GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
       glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 
-      gl_internal = GL_R8;
-      gl_format   = GL_RED;
-      ncomponents = 1;
+      *gl_internal = GL_R8;
+      *gl_format   = GL_RED;
+      return 1;
    }
 #endif
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+   *gl_internal = GL_LUMINANCE_ALPHA;
+   *gl_format   = GL_LUMINANCE_ALPHA;
+   return 2;
+}
 
-   switch (ncomponents)
-   {
-      case 1:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+/* Converts a region of the atlas into 'dst', which is
+ * 'width' texels wide. Texels past the right edge of the
+ * atlas are left untouched. */
+static void gl_raster_font_copy_atlas(const struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height,
+      uint8_t *dst, size_t ncomponents)
+{
+   unsigned i, j;
+   unsigned copy_width = (x + width > atlas->width)
+      ? atlas->width - x : width;
 
-            memcpy(dst, src, font->atlas->width);
-         }
-         break;
-      case 2:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+   for (i = 0; i < height; ++i)
+   {
+      const uint8_t *src = &atlas->buffer[(y + i) * atlas->width + x];
+      uint8_t       *out = &dst[i * width * ncomponents];
 
-            for (j = 0; j < font->atlas->width; ++j)
+      switch (ncomponents)
+      {
+         case 1:
+            memcpy(out, src, copy_width);
+            break;
+         case 2:
+            for (j = 0; j < copy_width; ++j)
             {
-               *dst++ = 0xff;
-               *dst++ = *src++;
+               *out++ = 0xff;
+               *out++ = *src++;
             }
-         }
-         break;
+            break;
+      }
    }
+}
+
+static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+{
+   GLint  gl_internal;
+   GLenum gl_format;
+   size_t ncomponents = gl_raster_font_get_format(font,
+         &gl_internal, &gl_format);
+   uint8_t       *tmp = (uint8_t*)calloc(font->tex_height,
+         font->tex_width * ncomponents);
+
+   if (!tmp)
+      return false;
+
+   gl_raster_font_copy_atlas(font->atlas, 0, 0,
+         font->tex_width, font->atlas->height, tmp, ncomponents);
 
    glTexImage2D(GL_TEXTURE_2D, 0, gl_internal,
          font->tex_width, font->tex_height,
@@ -178,6 +201,86 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Grows the texture size once get_glyph() has grown the
+ * atlas past it. Texture coordinates already batched in the
+ * block were normalised to the old size, so they are scaled
+ * to the new one. */
+static void gl_raster_font_fit_atlas(gl_raster_t *font)
+{
+   unsigned i;
+   float scale_x, scale_y;
+   unsigned tex_width  = font->tex_width;
+   unsigned tex_height = font->tex_height;
+
+   if (     font->atlas->width  <= tex_width
+         && font->atlas->height <= tex_height)
+      return;
+
+   font->tex_width   = MAX(tex_width,  next_pow2(font->atlas->width));
+   font->tex_height  = MAX(tex_height, next_pow2(font->atlas->height));
+   font->tex_resized = true;
+
+   if (!font->block)
+      return;
+
+   scale_x = (float)tex_width  / font->tex_width;
+   scale_y = (float)tex_height / font->tex_height;
+
+   for (i = 0; i < font->block->carr.coords.vertices; i++)
+   {
+      font->block->carr.coords.tex_coord[2 * i + 0] *= scale_x;
+      font->block->carr.coords.tex_coord[2 * i + 1] *= scale_y;
+   }
+}
+
+/* Uploads what changed since the last upload. The whole
+ * texture is only re-created when the atlas outgrew it. */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   GLint  gl_internal;
+   GLenum gl_format;
+   size_t ncomponents;
+   unsigned x0, x1;
+   uint8_t *tmp                    = NULL;
+   const struct font_atlas *atlas  = font->atlas;
+
+   gl_raster_font_fit_atlas(font);
+
+   if (font->tex_resized)
+   {
+      font->tex_resized = false;
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   if (!atlas->dirty_width || !atlas->dirty_height)
+   {
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   /* Whole groups of four texels keep every row of the
+    * upload aligned to the default GL_UNPACK_ALIGNMENT */
+   x0          = atlas->dirty_x & ~3u;
+   x1          = MIN((atlas->dirty_x + atlas->dirty_width + 3) & ~3u,
+         font->tex_width);
+   ncomponents = gl_raster_font_get_format(font, &gl_internal, &gl_format);
+   tmp         = (uint8_t*)calloc(atlas->dirty_height,
+         (x1 - x0) * ncomponents);
+
+   if (!tmp)
+      return;
+
+   gl_raster_font_copy_atlas(atlas, x0, atlas->dirty_y,
+         x1 - x0, atlas->dirty_height, tmp, ncomponents);
+
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x0, atlas->dirty_y,
+         x1 - x0, atlas->dirty_height,
+         gl_format, GL_UNSIGNED_BYTE, tmp);
+
+   free(tmp);
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -216,7 +319,8 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font->atlas->dirty    = false;
+   font->atlas->growable = true;
 
    if (font->gl)
       glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
@@ -260,12 +364,24 @@ static int gl_get_message_width(void *data, const char *msg,
    return delta_x * scale;
 }
 
+static void gl_raster_font_normalize_tex_coords(GLfloat *tex_coords,
+      unsigned vertices, float inv_tex_size_x, float inv_tex_size_y)
+{
+   unsigned i;
+
+   for (i = 0; i < vertices; i++)
+   {
+      tex_coords[2 * i + 0] *= inv_tex_size_x;
+      tex_coords[2 * i + 1] *= inv_tex_size_y;
+   }
+}
+
 static void gl_raster_font_draw_vertices(gl_raster_t *font,
       const video_coords_t *coords)
 {
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
+      gl_raster_font_update_atlas(font);
       font->atlas->dirty   = false;
    }
 
@@ -296,8 +412,6 @@ static void gl_raster_font_render_line(
    int y                = roundf(pos_y * gl->vp.height);
    int delta_x          = 0;
    int delta_y          = 0;
-   float inv_tex_size_x = 1.0f / font->tex_width;
-   float inv_tex_size_y = 1.0f / font->tex_height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
@@ -348,6 +462,13 @@ static void gl_raster_font_render_line(
          delta_y -= glyph->advance_y;
       }
 
+      /* Only normalise the texture coordinates once every
+       * glyph of the chunk is in, as looking one up may have
+       * grown the atlas */
+      gl_raster_font_fit_atlas(font);
+      gl_raster_font_normalize_tex_coords(font_tex_coords, i * 6,
+            1.0f / font->tex_width, 1.0f / font->tex_height);
+
       coords.tex_coord     = font_tex_coords;
       coords.vertex        = font_vertex;
       coords.color         = font_color;
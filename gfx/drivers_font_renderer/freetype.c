@@ -24,6 +24,7 @@
 
 #include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <string/stdstring.h>
 
@@ -36,23 +37,42 @@
 
 #define FT_ATLAS_ROWS 16
 #define FT_ATLAS_COLS 16
+/* Glyph slots per page, see font_renderer_ft_add_page() */
 #define FT_ATLAS_SIZE (FT_ATLAS_ROWS * FT_ATLAS_COLS)
+#define FT_ATLAS_MAX_PAGES 8
+#define FT_ATLAS_MAX_HEIGHT 4096
 
 typedef struct freetype_atlas_slot
 {
-   struct freetype_atlas_slot* next;   /* ptr alignment */
-   struct font_glyph glyph;            /* unsigned alignment */
+   struct freetype_atlas_slot* next;     /* ptr alignment */
+   struct freetype_atlas_slot* lru_prev; /* ptr alignment */
+   struct freetype_atlas_slot* lru_next; /* ptr alignment */
+   struct font_glyph glyph;              /* unsigned alignment */
    unsigned charcode;
    unsigned last_used;
+   bool in_use;
 }freetype_atlas_slot_t;
 
+/* The atlas is a column of pages, each holding a 16x16 grid
+ * of glyph cells. Slots are kept on a list ordered by last
+ * use, so the eviction candidate is always the tail, and are
+ * looked up through a hash map sized to the slot count. When
+ * the video driver allows it, a page is added instead of
+ * evicting a glyph that is still part of the working set
+ * (e.g. a screen full of CJK text). */
 typedef struct freetype_renderer
 {
    FT_Library lib;                                   /* ptr alignment   */
    FT_Face face;                                     /* ptr alignment   */
    struct font_atlas atlas;                          /* ptr alignment   */
-   freetype_atlas_slot_t atlas_slots[FT_ATLAS_SIZE]; /* ptr alignment   */
-   freetype_atlas_slot_t* uc_map[0x100];             /* ptr alignment   */
+   freetype_atlas_slot_t* pages[FT_ATLAS_MAX_PAGES]; /* ptr alignment   */
+   freetype_atlas_slot_t** uc_map;                   /* ptr alignment   */
+   freetype_atlas_slot_t* lru_head;                  /* ptr alignment   */
+   freetype_atlas_slot_t* lru_tail;                  /* ptr alignment   */
+   unsigned num_pages;
+   unsigned uc_map_bits;
+   unsigned cell_width;
+   unsigned cell_height;
    unsigned usage_counter;
    struct font_line_metrics line_metrics;            /* float alignment */
 } ft_font_renderer_t;
@@ -67,12 +87,17 @@ static struct font_atlas *font_renderer_ft_get_atlas(void *data)
 
 static void font_renderer_ft_free(void *data)
 {
+   unsigned i;
    ft_font_renderer_t *handle = (ft_font_renderer_t*)data;
    if (!handle)
       return;
 
    free(handle->atlas.buffer);
 
+   for (i = 0; i < handle->num_pages; i++)
+      free(handle->pages[i]);
+   free(handle->uc_map);
+
    if (handle->face)
       FT_Done_Face(handle->face);
    if (handle->lib)
@@ -80,29 +105,225 @@ static void font_renderer_ft_free(void *data)
    free(handle);
 }
 
+static INLINE unsigned font_renderer_ft_hash(
+      const ft_font_renderer_t *handle, uint32_t charcode)
+{
+   return (uint32_t)(charcode * 0x9E3779B1u) >> (32 - handle->uc_map_bits);
+}
+
+static void font_renderer_ft_lru_unlink(ft_font_renderer_t *handle,
+      freetype_atlas_slot_t *slot)
+{
+   if (slot->lru_prev)
+      slot->lru_prev->lru_next = slot->lru_next;
+   else
+      handle->lru_head         = slot->lru_next;
+
+   if (slot->lru_next)
+      slot->lru_next->lru_prev = slot->lru_prev;
+   else
+      handle->lru_tail         = slot->lru_prev;
+
+   slot->lru_prev = NULL;
+   slot->lru_next = NULL;
+}
+
+static void font_renderer_ft_lru_push_front(ft_font_renderer_t *handle,
+      freetype_atlas_slot_t *slot)
+{
+   slot->lru_prev = NULL;
+   slot->lru_next = handle->lru_head;
+   if (handle->lru_head)
+      handle->lru_head->lru_prev = slot;
+   else
+      handle->lru_tail           = slot;
+   handle->lru_head = slot;
+}
+
+static void font_renderer_ft_lru_push_back(ft_font_renderer_t *handle,
+      freetype_atlas_slot_t *slot)
+{
+   slot->lru_next = NULL;
+   slot->lru_prev = handle->lru_tail;
+   if (handle->lru_tail)
+      handle->lru_tail->lru_next = slot;
+   else
+      handle->lru_head           = slot;
+   handle->lru_tail = slot;
+}
+
+static void font_renderer_ft_map_remove(ft_font_renderer_t *handle,
+      freetype_atlas_slot_t *slot)
+{
+   freetype_atlas_slot_t **ptr = &handle->uc_map[
+      font_renderer_ft_hash(handle, slot->charcode)];
+
+   while (*ptr && *ptr != slot)
+      ptr = &(*ptr)->next;
+   if (*ptr)
+      *ptr = slot->next;
+   slot->next = NULL;
+}
+
+/* Resizes the hash map to one bucket per slot. On failure
+ * the current map is kept, which stays correct but gets
+ * longer chains. */
+static void font_renderer_ft_map_rehash(ft_font_renderer_t *handle)
+{
+   unsigned i, j;
+   freetype_atlas_slot_t **uc_map = NULL;
+   unsigned bits                  = 1;
+
+   while ((1u << bits) < handle->num_pages * FT_ATLAS_SIZE)
+      bits++;
+
+   if (handle->uc_map && bits == handle->uc_map_bits)
+      return;
+
+   uc_map = (freetype_atlas_slot_t**)calloc(1u << bits, sizeof(*uc_map));
+   if (!uc_map)
+      return;
+
+   free(handle->uc_map);
+   handle->uc_map      = uc_map;
+   handle->uc_map_bits = bits;
+
+   for (i = 0; i < handle->num_pages; i++)
+   {
+      for (j = 0; j < FT_ATLAS_SIZE; j++)
+      {
+         freetype_atlas_slot_t *slot = &handle->pages[i][j];
+         unsigned map_id;
+
+         if (!slot->in_use)
+            continue;
+
+         map_id         = font_renderer_ft_hash(handle, slot->charcode);
+         slot->next     = uc_map[map_id];
+         uc_map[map_id] = slot;
+      }
+   }
+}
+
+static void font_renderer_ft_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   if (!width || !height)
+      return;
+
+   if (!atlas->dirty)
+   {
+      atlas->dirty_x      = x;
+      atlas->dirty_y      = y;
+      atlas->dirty_width  = width;
+      atlas->dirty_height = height;
+      atlas->dirty        = true;
+   }
+   /* An empty region while dirty already means 'everything' */
+   else if (atlas->dirty_width && atlas->dirty_height)
+   {
+      unsigned x1         = MAX(atlas->dirty_x + atlas->dirty_width,  x + width);
+      unsigned y1         = MAX(atlas->dirty_y + atlas->dirty_height, y + height);
+      atlas->dirty_x      = MIN(atlas->dirty_x, x);
+      atlas->dirty_y      = MIN(atlas->dirty_y, y);
+      atlas->dirty_width  = x1 - atlas->dirty_x;
+      atlas->dirty_height = y1 - atlas->dirty_y;
+   }
+}
+
+/* Appends a page of empty slots below the current atlas.
+ * The new slots go to the tail of the LRU list, so they
+ * are handed out before anything is evicted. */
+static bool font_renderer_ft_add_page(ft_font_renderer_t *handle)
+{
+   unsigned x, y;
+   uint8_t *buffer             = NULL;
+   freetype_atlas_slot_t *slot = NULL;
+   freetype_atlas_slot_t *page = NULL;
+   unsigned page_height        = handle->cell_height * FT_ATLAS_ROWS;
+   unsigned height             = handle->atlas.height + page_height;
+
+   if (     handle->num_pages >= FT_ATLAS_MAX_PAGES
+         || (handle->num_pages && height > FT_ATLAS_MAX_HEIGHT))
+      return false;
+
+   page = (freetype_atlas_slot_t*)calloc(FT_ATLAS_SIZE, sizeof(*page));
+   if (!page)
+      return false;
+
+   buffer = (uint8_t*)realloc(handle->atlas.buffer,
+         (size_t)handle->atlas.width * height);
+   if (!buffer)
+   {
+      free(page);
+      return false;
+   }
+
+   memset(buffer + (size_t)handle->atlas.width * handle->atlas.height,
+         0, (size_t)handle->atlas.width * page_height);
+
+   slot = page;
+   for (y = 0; y < FT_ATLAS_ROWS; y++)
+   {
+      for (x = 0; x < FT_ATLAS_COLS; x++)
+      {
+         slot->glyph.atlas_offset_x = x * handle->cell_width;
+         slot->glyph.atlas_offset_y = handle->atlas.height
+            + y * handle->cell_height;
+         font_renderer_ft_lru_push_back(handle, slot);
+         slot++;
+      }
+   }
+
+   handle->pages[handle->num_pages++] = page;
+   handle->atlas.buffer               = buffer;
+   handle->atlas.height               = height;
+
+   font_renderer_ft_map_rehash(handle);
+
+   /* Drivers re-create their texture when the size changes */
+   handle->atlas.dirty        = true;
+   handle->atlas.dirty_width  = 0;
+   handle->atlas.dirty_height = 0;
+
+   return handle->uc_map != NULL;
+}
+
 static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
 {
-   int i, map_id;
-   unsigned oldest = 0;
-
-   for (i = 1; i < FT_ATLAS_SIZE; i++)
-      if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
-
-   /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if (handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
-   else if (handle->uc_map[map_id])
+   freetype_atlas_slot_t *slot = handle->lru_tail;
+
+   /* Even the least recently used glyph was needed within
+    * the last two passes over the atlas, so the text being
+    * drawn does not fit: grow rather than thrash. */
+   if (     slot->in_use
+         && handle->atlas.growable
+         && (handle->usage_counter - slot->last_used)
+            < 2 * handle->num_pages * FT_ATLAS_SIZE
+         && font_renderer_ft_add_page(handle))
+      slot = handle->lru_tail;
+
+   if (slot->in_use)
    {
-      freetype_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while (ptr->next && ptr->next != &handle->atlas_slots[oldest])
-         ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
+      unsigned r;
+      uint8_t *dst = handle->atlas.buffer + slot->glyph.atlas_offset_x
+         + slot->glyph.atlas_offset_y * handle->atlas.width;
+
+      font_renderer_ft_map_remove(handle, slot);
+
+      /* Clear the old glyph, so that filtering never picks
+       * up its edges around a smaller replacement */
+      for (r = 0; r < slot->glyph.height; r++, dst += handle->atlas.width)
+         memset(dst, 0, slot->glyph.width);
+
+      font_renderer_ft_mark_dirty(&handle->atlas,
+            slot->glyph.atlas_offset_x, slot->glyph.atlas_offset_y,
+            slot->glyph.width, slot->glyph.height);
+
+      slot->in_use = false;
    }
 
-   return &handle->atlas_slots[oldest];
+   return slot;
 }
 
 static const struct font_glyph *font_renderer_ft_get_glyph(
@@ -117,13 +338,18 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
    if (!handle)
       return NULL;
 
-   map_id     = charcode & 0xFF;
+   map_id     = font_renderer_ft_hash(handle, charcode);
    atlas_slot = handle->uc_map[map_id];
 
    while (atlas_slot)
    {
       if (atlas_slot->charcode == charcode)
       {
+         if (atlas_slot != handle->lru_head)
+         {
+            font_renderer_ft_lru_unlink(handle, atlas_slot);
+            font_renderer_ft_lru_push_front(handle, atlas_slot);
+         }
          atlas_slot->last_used = handle->usage_counter++;
          return &atlas_slot->glyph;
       }
@@ -137,13 +363,20 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
    slot = handle->face->glyph;
 
    atlas_slot             = font_renderer_get_slot(handle);
+
+   /* The map may have been resized by a new page */
+   map_id                 = font_renderer_ft_hash(handle, charcode);
    atlas_slot->charcode   = charcode;
+   atlas_slot->in_use     = true;
    atlas_slot->next       = handle->uc_map[map_id];
    handle->uc_map[map_id] = atlas_slot;
 
+   font_renderer_ft_lru_unlink(handle, atlas_slot);
+   font_renderer_ft_lru_push_front(handle, atlas_slot);
+
    /* Some glyphs can be blank. */
-   atlas_slot->glyph.width         = slot->bitmap.width;
-   atlas_slot->glyph.height        = slot->bitmap.rows;
+   atlas_slot->glyph.width         = MIN(slot->bitmap.width, handle->cell_width);
+   atlas_slot->glyph.height        = MIN(slot->bitmap.rows, handle->cell_height);
    atlas_slot->glyph.advance_x     = slot->advance.x >> 6;
    atlas_slot->glyph.advance_y     = slot->advance.y >> 6;
    atlas_slot->glyph.draw_offset_x = slot->bitmap_left;
@@ -161,46 +394,29 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
             r++, dst += handle->atlas.width, src += slot->bitmap.pitch)
          for (c = 0; c < atlas_slot->glyph.width; c++)
             dst[c] = src[c];
+
+      font_renderer_ft_mark_dirty(&handle->atlas,
+            atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+            atlas_slot->glyph.width, atlas_slot->glyph.height);
    }
 
-   handle->atlas.dirty = true;
    atlas_slot->last_used = handle->usage_counter++;
    return &atlas_slot->glyph;
 }
 
 static bool font_renderer_create_atlas(ft_font_renderer_t *handle, float font_size)
 {
-   unsigned i, x, y;
-   freetype_atlas_slot_t* slot = NULL;
-
-   unsigned max_width = round((handle->face->bbox.xMax - handle->face->bbox.xMin) * font_size / handle->face->units_per_EM);
-   unsigned max_height = round((handle->face->bbox.yMax - handle->face->bbox.yMin) * font_size / handle->face->units_per_EM);
+   unsigned i;
 
-   unsigned atlas_width        = max_width  * FT_ATLAS_COLS;
+   handle->cell_width   = round((handle->face->bbox.xMax - handle->face->bbox.xMin) * font_size / handle->face->units_per_EM);
+   handle->cell_height  = round((handle->face->bbox.yMax - handle->face->bbox.yMin) * font_size / handle->face->units_per_EM);
 
-   unsigned atlas_height       = max_height * FT_ATLAS_ROWS;
+   handle->atlas.width  = handle->cell_width * FT_ATLAS_COLS;
+   handle->atlas.height = 0;
 
-   uint8_t *atlas_buffer       = (uint8_t*)
-      calloc(atlas_width * atlas_height, 1);
-
-   if (!atlas_buffer)
+   if (!font_renderer_ft_add_page(handle))
       return false;
 
-   handle->atlas.buffer        = atlas_buffer;
-   handle->atlas.width         = atlas_width;
-   handle->atlas.height        = atlas_height;
-   slot                        = handle->atlas_slots;
-
-   for (y = 0; y < FT_ATLAS_ROWS; y++)
-   {
-      for (x = 0; x < FT_ATLAS_COLS; x++)
-      {
-         slot->glyph.atlas_offset_x = x * max_width;
-         slot->glyph.atlas_offset_y = y * max_height;
-         slot++;
-      }
-   }
-
    for (i = 0; i < 256; i++)
       font_renderer_ft_get_glyph(handle, i);
 
@@ -208,6 +424,10 @@ static bool font_renderer_create_atlas(ft_font_renderer_t *handle, float font_si
       if (isalnum(i))
          font_renderer_ft_get_glyph(handle, i);
 
+   /* Age the preloaded glyphs, so that replacing them does
+    * not look like thrashing to font_renderer_get_slot() */
+   handle->usage_counter += 2 * FT_ATLAS_SIZE;
+
    return true;
 }
 
@@ -20,6 +20,7 @@
 #ifdef HAVE_BUILTINGLSLANG
 #include "../../deps/glslang/glslang/glslang/Public/ShaderLang.h"
 #include "../../deps/glslang/glslang/SPIRV/GlslangToSpv.h"
+#include "../../deps/glslang/glslang/OGLCompilersDLL/InitializeDll.h"
 #elif HAVE_GLSLANG
 #include <glslang/Public/ShaderLang.h>
 #include <glslang/SPIRV/GlslangToSpv.h>
@@ -28,6 +29,7 @@
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
 #include <mutex>
 
 #include "../../verbosity.h"
@@ -45,23 +47,43 @@ struct SlangProcess
       TBuiltInResource Resources;
 };
 
-/* We don't use glslang from multiple threads, but to be sure.
+/* Outside of concurrent batches we don't use glslang from
+ * multiple threads, but to be sure.
  * Initializing TLS and freeing it for glslang works around 
  * a really bizarre issue where the TLS key is suddenly 
  * corrupted *somehow*.
+ *
+ * begin_concurrent_compile() holds the lock for the whole
+ * batch, so compiles from outside of it wait for it to end.
  */
 static std::mutex glslang_global_lock;
 
 struct SlangProcessHolder
 {
-   SlangProcessHolder()
+   bool concurrent;
+
+   SlangProcessHolder(bool is_concurrent) : concurrent(is_concurrent)
    {
+      /* Within a batch the process state is already set up,
+       * and initializing it again from a worker would reset
+       * glslang's global mutex while others may hold it */
+      if (concurrent)
+      {
+#ifdef HAVE_BUILTINGLSLANG
+         InitThread();
+#endif
+         return;
+      }
+
       glslang_global_lock.lock();
       InitializeProcess();
    }
 
    ~SlangProcessHolder()
    {
+      if (concurrent)
+         return;
+
       FinalizeProcess();
       glslang_global_lock.unlock();
    }
@@ -389,11 +411,11 @@ SlangProcess::SlangProcess()
 }
 
 bool glslang::compile_spirv(const string &source, Stage stage,
-      std::vector<uint32_t> *spirv)
+      std::vector<uint32_t> *spirv, bool concurrent)
 {
    string msg;
    static SlangProcess process;
-   SlangProcessHolder process_holder;
+   SlangProcessHolder process_holder(concurrent);
    TProgram program;
    EShLanguage language;
 
@@ -457,3 +479,25 @@ bool glslang::compile_spirv(const string &source, Stage stage,
    GlslangToSpv(*program.getIntermediate(language), *spirv);
    return true;
 }
+
+std::string glslang::compiler_version()
+{
+   char buf[32];
+   std::string version = GetGlslVersionString();
+
+   snprintf(buf, sizeof(buf), " spirv-gen %d", GetSpirvGeneratorVersion());
+   version += buf;
+   return version;
+}
+
+void glslang::begin_concurrent_compile()
+{
+   glslang_global_lock.lock();
+   InitializeProcess();
+}
+
+void glslang::end_concurrent_compile()
+{
+   FinalizeProcess();
+   glslang_global_lock.unlock();
+}
@@ -17,7 +17,22 @@ namespace glslang
         StageCompute
     };
 
-    bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+    /* concurrent must only be set between begin_concurrent_compile()
+     * and end_concurrent_compile(), see below. */
+    bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv,
+          bool concurrent = false);
+
+    /* Identifies the compiler build, changes whenever
+     * compile_spirv() could produce different output. */
+    std::string compiler_version();
+
+    /* compile_spirv() may be called with concurrent set from
+     * several threads between these two calls, which must be made
+     * from the thread coordinating the batch. They set up and tear
+     * down glslang's process state once for the whole batch and
+     * keep other, non-concurrent compiles out until it is done. */
+    void begin_concurrent_compile();
+    void end_concurrent_compile();
 }
 
 #endif
@@ -19,6 +19,9 @@
 #include <algorithm>
 
 #include <retro_miscellaneous.h>
+#include <rhash.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
 #include <file/file_path.h>
 #include <file/config_file.h>
 #include <streams/file_stream.h>
@@ -28,6 +31,18 @@
 #include "config.h"
 #endif
 
+#if defined(_WIN32)
+#include <process.h>
+#define glslang_getpid() _getpid()
+#else
+#include <unistd.h>
+#define glslang_getpid() getpid()
+#endif
+
+#ifdef RARCH_INTERNAL
+#include "../../configuration.h"
+#endif
+
 #include "glslang_util.h"
 #include "glslang_util_cxx.h"
 #if defined(HAVE_GLSLANG)
@@ -217,36 +232,173 @@ bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta)
    return true;
 }
 
-bool glslang_compile_shader(const char *shader_path, glslang_output *output)
+#if defined(HAVE_GLSLANG)
+/* Compiled SPIR-V is cached on disk, keyed by a hash of the
+ * fully preprocessed stage sources and the compiler version,
+ * so reloading a preset doesn't have to go through glslang.
+ *
+ * File layout (native endian uint32_t):
+ * magic, version, vertex word count, fragment word count,
+ * followed by the vertex and fragment SPIR-V words. */
+#define SLANG_CACHE_MAGIC   0x43534152 /* 'RASC' */
+#define SLANG_CACHE_VERSION 1
+
+static bool glslang_cache_path(char *s, size_t len,
+      const std::string &vertex_source,
+      const std::string &fragment_source)
+{
+   char hash[65];
+   char version[16];
+   char cache_dir[PATH_MAX_LENGTH];
+   std::string key;
+   const char *dir_cache = NULL;
+#ifdef RARCH_INTERNAL
+   settings_t *settings  = config_get_ptr();
+
+   if (settings)
+      dir_cache          = settings->paths.directory_cache;
+#endif
+
+   if (string_is_empty(dir_cache))
+      return false;
+
+   snprintf(version, sizeof(version), "%u ", SLANG_CACHE_VERSION);
+   key  = version;
+   key += glslang::compiler_version();
+   key += '\0';
+   key += vertex_source;
+   key += '\0';
+   key += fragment_source;
+
+   sha256_hash(hash, (const uint8_t*)key.data(), key.size());
+
+   fill_pathname_join(cache_dir, dir_cache, "slang", sizeof(cache_dir));
+
+   if (!path_is_directory(cache_dir) && !path_mkdir(cache_dir))
+      return false;
+
+   fill_pathname_join(s, cache_dir, hash, len);
+   strlcat(s, ".spv", len);
+   return true;
+}
+
+static bool glslang_cache_load(const char *path, glslang_output *output)
+{
+   void *buf            = NULL;
+   int64_t len          = 0;
+   const uint32_t *data = NULL;
+   size_t words         = 0;
+   bool ret             = false;
+
+   if (!path_is_valid(path))
+      return false;
+
+   if (!filestream_read_file(path, &buf, &len) || !buf)
+      return false;
+
+   data  = (const uint32_t*)buf;
+   words = (size_t)len / sizeof(uint32_t);
+
+   if (     words >= 4
+         && data[0] == SLANG_CACHE_MAGIC
+         && data[1] == SLANG_CACHE_VERSION
+         && (uint64_t)data[2] + data[3] == words - 4)
+   {
+      output->vertex.assign(data + 4, data + 4 + data[2]);
+      output->fragment.assign(data + 4 + data[2], data + words);
+      ret = !output->vertex.empty() && !output->fragment.empty();
+   }
+
+   free(buf);
+   return ret;
+}
+
+static void glslang_cache_store(const char *path,
+      const glslang_output *output)
+{
+   char suffix[48];
+   char tmp_path[PATH_MAX_LENGTH];
+   std::vector<uint32_t> data;
+
+   data.reserve(4 + output->vertex.size() + output->fragment.size());
+   data.push_back(SLANG_CACHE_MAGIC);
+   data.push_back(SLANG_CACHE_VERSION);
+   data.push_back((uint32_t)output->vertex.size());
+   data.push_back((uint32_t)output->fragment.size());
+   data.insert(data.end(), output->vertex.begin(), output->vertex.end());
+   data.insert(data.end(), output->fragment.begin(), output->fragment.end());
+
+   /* Write to a temporary file first, so that a concurrent or
+    * interrupted writer never leaves a truncated entry behind.
+    * The same pass may be compiled by several threads or by
+    * several instances at once, so the temporary name must be
+    * unique to both this process and this call. */
+   snprintf(suffix, sizeof(suffix), ".%ld.%lx.tmp",
+         (long)glslang_getpid(), (unsigned long)(uintptr_t)output);
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, suffix, sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, data.data(),
+            data.size() * sizeof(uint32_t)))
+      return;
+
+   filestream_delete(path);
+   if (filestream_rename(tmp_path, path) != 0)
+      filestream_delete(tmp_path);
+}
+#endif
+
+static bool glslang_compile_shader_internal(const char *shader_path,
+      glslang_output *output, bool concurrent)
 {
 #if defined(HAVE_GLSLANG)
+   char cache_path[PATH_MAX_LENGTH];
+   std::string vertex_source;
+   std::string fragment_source;
+   bool use_cache            = false;
    struct string_list *lines = string_list_new();
 
    if (!lines)
       return false;
 
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
-
    if (!glslang_read_shader_file(shader_path, lines, true))
       goto error;
    output->meta = glslang_meta{};
    if (!glslang_parse_meta(lines, &output->meta))
       goto error;
 
-   if (!glslang::compile_spirv(build_stage_source(lines, "vertex"),
-            glslang::StageVertex, &output->vertex))
+   vertex_source   = build_stage_source(lines, "vertex");
+   fragment_source = build_stage_source(lines, "fragment");
+   use_cache       = glslang_cache_path(cache_path, sizeof(cache_path),
+         vertex_source, fragment_source);
+
+   if (use_cache && glslang_cache_load(cache_path, output))
+   {
+      RARCH_LOG("[slang]: Using cached SPIR-V for shader \"%s\".\n",
+            shader_path);
+      string_list_free(lines);
+      return true;
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
+   if (!glslang::compile_spirv(vertex_source,
+            glslang::StageVertex, &output->vertex, concurrent))
    {
       RARCH_ERR("Failed to compile vertex shader stage.\n");
       goto error;
    }
 
-   if (!glslang::compile_spirv(build_stage_source(lines, "fragment"),
-            glslang::StageFragment, &output->fragment))
+   if (!glslang::compile_spirv(fragment_source,
+            glslang::StageFragment, &output->fragment, concurrent))
    {
       RARCH_ERR("Failed to compile fragment shader stage.\n");
       goto error;
    }
 
+   if (use_cache)
+      glslang_cache_store(cache_path, output);
+
    string_list_free(lines);
 
    return true;
@@ -257,3 +409,116 @@ error:
 
    return false;
 }
+
+bool glslang_compile_shader(const char *shader_path, glslang_output *output)
+{
+   return glslang_compile_shader_internal(shader_path, output, false);
+}
+
+#if defined(HAVE_GLSLANG) && defined(HAVE_THREADS)
+struct glslang_compile_batch
+{
+   const char **shader_paths;
+   glslang_output *outputs;
+   bool *results;
+   slock_t *lock;
+   unsigned count;
+   unsigned next;
+};
+
+static void glslang_compile_worker(void *data)
+{
+   glslang_compile_batch *batch = (glslang_compile_batch*)data;
+
+   for (;;)
+   {
+      unsigned i;
+
+      slock_lock(batch->lock);
+      i = batch->next++;
+      slock_unlock(batch->lock);
+
+      if (i >= batch->count)
+         break;
+
+      batch->results[i] = glslang_compile_shader_internal(
+            batch->shader_paths[i], &batch->outputs[i], true);
+   }
+}
+#endif
+
+bool glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned count, unsigned *failed_index)
+{
+   unsigned i;
+#if defined(HAVE_GLSLANG) && defined(HAVE_THREADS)
+   glslang_compile_batch batch;
+   std::vector<sthread_t*> threads;
+   unsigned num_threads = cpu_features_get_core_amount();
+
+   if (num_threads > count)
+      num_threads = count;
+
+   if (num_threads > 1 && (batch.lock = slock_new()))
+   {
+      batch.shader_paths = shader_paths;
+      batch.outputs      = outputs;
+      batch.results      = (bool*)calloc(count, sizeof(bool));
+      batch.count        = count;
+      batch.next         = 0;
+
+      if (batch.results)
+      {
+         glslang::begin_concurrent_compile();
+
+         /* The calling thread takes part in the batch as well */
+         for (i = 1; i < num_threads; i++)
+         {
+            sthread_t *thread = sthread_create(
+                  glslang_compile_worker, &batch);
+            if (thread)
+               threads.push_back(thread);
+         }
+
+         glslang_compile_worker(&batch);
+
+         for (i = 0; i < threads.size(); i++)
+            sthread_join(threads[i]);
+
+         glslang::end_concurrent_compile();
+
+         for (i = 0; i < count; i++)
+         {
+            if (!batch.results[i])
+               break;
+         }
+
+         free(batch.results);
+         slock_free(batch.lock);
+
+         if (i < count)
+         {
+            if (failed_index)
+               *failed_index = i;
+            return false;
+         }
+
+         return true;
+      }
+
+      slock_free(batch.lock);
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+   {
+      if (!glslang_compile_shader(shader_paths[i], &outputs[i]))
+      {
+         if (failed_index)
+            *failed_index = i;
+         return false;
+      }
+   }
+
+   return true;
+}
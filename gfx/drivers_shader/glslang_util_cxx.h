@@ -55,6 +55,12 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Compiles @count shaders into @outputs, spreading the work
+ * over all available cores. On failure, @failed_index is set
+ * to the first shader that did not compile. */
+bool glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned count, unsigned *failed_index);
+
 /* Helpers for internal use. */
 bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta);
 
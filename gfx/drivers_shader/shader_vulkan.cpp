@@ -2555,8 +2555,11 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       const char *path, glslang_filter_chain_filter filter)
 {
    unsigned i;
+   unsigned failed_pass           = 0;
    config_file_t *conf            = NULL;
    unique_ptr<video_shader> shader{ new video_shader() };
+   vector<glslang_output> outputs;
+   vector<const char*> pass_paths;
    if (!shader)
       return nullptr;
 
@@ -2582,9 +2585,23 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   /* Passes are independent until pipeline creation,
+    * so compile all of them up front, concurrently. */
+   outputs.resize(shader->passes);
+   for (i = 0; i < shader->passes; i++)
+      pass_paths.push_back(shader->pass[i].source.path);
+
+   if (!glslang_compile_shaders(pass_paths.data(), outputs.data(),
+            shader->passes, &failed_pass))
+   {
+      RARCH_ERR("Failed to compile shader: \"%s\".\n",
+            shader->pass[failed_pass].source.path);
+      goto error;
+   }
+
    for (i = 0; i < shader->passes; i++)
    {
-      glslang_output output;
+      glslang_output &output = outputs[i];
       struct vulkan_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2600,13 +2617,6 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         goto error;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
@@ -15,12 +15,20 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "font_driver.h"
 #include "video_thread_wrapper.h"
 
@@ -1037,6 +1045,176 @@ end:
 }
 #endif
 
+
+/* Layout cache
+ *
+ * Menu drivers measure and draw the same labels every
+ * frame. Each font remembers the width and (with
+ * HAVE_LANGEXTRA) the reshaped text of recently used
+ * strings, keyed by the string and the scale it was used
+ * at. Glyph advances do not change for the lifetime of a
+ * font, so entries are replaced but never invalidated. */
+
+#define FONT_LAYOUT_CACHE_SETS    256
+#define FONT_LAYOUT_CACHE_WAYS    2
+#define FONT_LAYOUT_CACHE_MAX_LEN 512
+
+typedef struct font_layout_entry
+{
+   char *msg;          /* NULL if the entry is unused */
+#ifdef HAVE_LANGEXTRA
+   char *shaped;       /* NULL if identical to 'msg' */
+   bool shaped_valid;
+#endif
+   uint32_t hash;
+   uint32_t last_used;
+   unsigned len;
+   int width;          /* -1 until the string is measured */
+   float scale;
+} font_layout_entry_t;
+
+struct font_layout_cache
+{
+   font_layout_entry_t entries[
+      FONT_LAYOUT_CACHE_SETS * FONT_LAYOUT_CACHE_WAYS];
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   uint32_t counter;
+};
+
+static void font_layout_entry_clear(font_layout_entry_t *entry)
+{
+   if (entry->msg)
+      free(entry->msg);
+#ifdef HAVE_LANGEXTRA
+   if (entry->shaped)
+      free(entry->shaped);
+#endif
+   memset(entry, 0, sizeof(*entry));
+}
+
+static font_layout_cache_t *font_layout_cache_new(void)
+{
+   font_layout_cache_t *cache = (font_layout_cache_t*)
+      calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+#ifdef HAVE_THREADS
+   /* The OSD font is used from both the main and the
+    * video thread */
+   if (!(cache->lock = slock_new()))
+   {
+      free(cache);
+      return NULL;
+   }
+#endif
+
+   return cache;
+}
+
+static void font_layout_cache_free(font_layout_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < ARRAY_SIZE(cache->entries); i++)
+      font_layout_entry_clear(&cache->entries[i]);
+
+#ifdef HAVE_THREADS
+   slock_free(cache->lock);
+#endif
+   free(cache);
+}
+
+static INLINE void font_layout_cache_lock(font_layout_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_lock(cache->lock);
+#endif
+}
+
+static INLINE void font_layout_cache_unlock(font_layout_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(cache->lock);
+#endif
+}
+
+/* Returns the entry for the first 'len' bytes of 'msg' at
+ * 'scale', replacing the least recently used entry of its
+ * set on a miss. Returns NULL for strings too long to be
+ * worth keeping. Must be called with the cache locked. */
+static font_layout_entry_t *font_layout_cache_get(
+      font_layout_cache_t *cache,
+      const char *msg, unsigned len, float scale)
+{
+   unsigned i;
+   uint32_t scale_bits;
+   char *copy                 = NULL;
+   font_layout_entry_t *set   = NULL;
+   font_layout_entry_t *entry = NULL;
+   uint32_t hash              = 0x811c9dc5; /* FNV-1a */
+
+   if (len > FONT_LAYOUT_CACHE_MAX_LEN)
+      return NULL;
+
+   for (i = 0; i < len; i++)
+      hash = (hash ^ (uint8_t)msg[i]) * 0x01000193;
+   memcpy(&scale_bits, &scale, sizeof(scale_bits));
+   hash   = (hash ^ scale_bits) * 0x01000193;
+
+   set    = &cache->entries[
+      (hash & (FONT_LAYOUT_CACHE_SETS - 1)) * FONT_LAYOUT_CACHE_WAYS];
+   entry  = set;
+
+   for (i = 0; i < FONT_LAYOUT_CACHE_WAYS; i++)
+   {
+      font_layout_entry_t *way = &set[i];
+
+      if (!way->msg)
+      {
+         if (entry->msg)
+            entry = way;
+         continue;
+      }
+
+      if (     way->hash  == hash
+            && way->len   == len
+            && way->scale == scale
+            && !memcmp(way->msg, msg, len))
+      {
+         way->last_used = ++cache->counter;
+         return way;
+      }
+
+      if (     entry->msg
+            && (cache->counter - way->last_used)
+             > (cache->counter - entry->last_used))
+         entry = way;
+   }
+
+   if (!(copy = (char*)malloc(len + 1)))
+      return NULL;
+
+   memcpy(copy, msg, len);
+   copy[len] = '\0';
+
+   font_layout_entry_clear(entry);
+   entry->msg       = copy;
+   entry->hash      = hash;
+   entry->len       = len;
+   entry->scale     = scale;
+   entry->width     = -1;
+   entry->last_used = ++cache->counter;
+
+   return entry;
+}
+
 void font_driver_render_msg(
       void *data,
       const char *msg,
@@ -1051,14 +1229,51 @@ void font_driver_render_msg(
    {
 #ifdef HAVE_LANGEXTRA
       unsigned char tmp_buffer[64];
-      char *new_msg = font_driver_reshape_msg(msg, tmp_buffer, sizeof(tmp_buffer));
+      char *new_msg              = NULL;
+      font_layout_entry_t *entry = NULL;
+
+      if (font->layout_cache)
+      {
+         font_layout_cache_lock(font->layout_cache);
+
+         entry = font_layout_cache_get(font->layout_cache,
+               msg, (unsigned)strlen(msg), params ? params->scale : 1.0f);
+
+         if (entry)
+         {
+            if (!entry->shaped_valid)
+            {
+               char *shaped = font_driver_reshape_msg(msg, NULL, 0);
+
+               if (shaped && !string_is_equal(shaped, msg))
+                  entry->shaped = shaped;
+               else if (shaped)
+                  free(shaped);
+               entry->shaped_valid = true;
+            }
+
+            /* The entry may be replaced by another thread
+             * once the cache is unlocked */
+            if (!entry->shaped)
+               new_msg = (char*)msg;
+            else if (strlen(entry->shaped) < sizeof(tmp_buffer))
+               new_msg = strcpy((char*)tmp_buffer, entry->shaped);
+            else
+               new_msg = strdup(entry->shaped);
+         }
+
+         font_layout_cache_unlock(font->layout_cache);
+      }
+
+      if (!new_msg)
+         new_msg = font_driver_reshape_msg(msg, tmp_buffer, sizeof(tmp_buffer));
 #else
       char *new_msg = (char*)msg;
 #endif
       font->renderer->render_msg(data,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
-      if (new_msg != (char*)tmp_buffer)
+      if (new_msg != msg && new_msg != (char*)tmp_buffer)
          free(new_msg);
 #endif
    }
@@ -1082,12 +1297,32 @@ void font_driver_flush(unsigned width, unsigned height, void *font_data)
 int font_driver_get_message_width(void *font_data,
       const char *msg, unsigned len, float scale)
 {
+   int width;
+   font_layout_entry_t *entry = NULL;
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
    if (len == 0 && msg)
       len = (unsigned)strlen(msg);
-   if (font && font->renderer && font->renderer->get_message_width)
+   if (!font || !font->renderer || !font->renderer->get_message_width)
+      return -1;
+   if (!msg || !font->layout_cache)
       return font->renderer->get_message_width(font->renderer_data, msg, len, scale);
-   return -1;
+
+   font_layout_cache_lock(font->layout_cache);
+   entry = font_layout_cache_get(font->layout_cache, msg, len, scale);
+   width = entry ? entry->width : -1;
+   font_layout_cache_unlock(font->layout_cache);
+
+   if (width >= 0)
+      return width;
+
+   width = font->renderer->get_message_width(font->renderer_data, msg, len, scale);
+
+   font_layout_cache_lock(font->layout_cache);
+   if ((entry = font_layout_cache_get(font->layout_cache, msg, len, scale)))
+      entry->width = width;
+   font_layout_cache_unlock(font->layout_cache);
+
+   return width;
 }
 
 int font_driver_get_line_height(void *font_data, float scale)
@@ -1173,6 +1408,7 @@ void font_driver_free(void *font_data)
       font->renderer      = NULL;
       font->renderer_data = NULL;
 
+      font_layout_cache_free(font->layout_cache);
       free(font);
    }
 }
@@ -1204,6 +1440,8 @@ font_data_t *font_driver_init_first(
       font->renderer      = (const font_renderer_t*)font_driver;
       font->renderer_data = font_handle;
       font->size          = font_size;
+      /* Optional, fonts work without it */
+      font->layout_cache  = font_layout_cache_new();
       return font;
    }
 
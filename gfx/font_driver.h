@@ -60,7 +60,19 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   /* Region written since the atlas was last uploaded,
+    * only meaningful while 'dirty' is set. Renderers which
+    * do not track it leave it empty, meaning 'everything'. */
+   unsigned dirty_x;
+   unsigned dirty_y;
+   unsigned dirty_width;
+   unsigned dirty_height;
    bool dirty;
+   /* Set by video drivers which cope with 'height' (and
+    * 'buffer') changing between uploads. Renderers may
+    * then grow the atlas instead of evicting glyphs which
+    * are still in use. */
+   bool growable;
 };
 
 struct font_params
@@ -128,10 +140,13 @@ typedef struct font_renderer_driver
    bool (*get_line_metrics)(void* data, struct font_line_metrics **metrics);
 } font_renderer_driver_t;
 
+typedef struct font_layout_cache font_layout_cache_t;
+
 typedef struct
 {
    const font_renderer_t *renderer;
    void *renderer_data;
+   font_layout_cache_t *layout_cache;
    float size;
 } font_data_t;
 
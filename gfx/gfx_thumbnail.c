@@ -20,12 +20,15 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
+#include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 #include <file/file_path.h>
+#include <formats/image.h>
 #include <string/stdstring.h>
 
 #include "gfx_display.h"
@@ -33,19 +36,90 @@
 
 #include "gfx_thumbnail.h"
 
+#include "../configuration.h"
 #include "../tasks/tasks_internal.h"
 
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
 #define DEFAULT_GFX_THUMBNAIL_FADE_DURATION 166.66667f
 
+/* Number of entries beyond the visible ones whose
+ * thumbnails are prefetched when the list is not
+ * moving, and the upper limit when scrolling fast */
+#define GFX_THUMBNAIL_PREFETCH_MIN          4
+#define GFX_THUMBNAIL_PREFETCH_MAX          32
+/* Time in ms covered by the prefetch window, at the
+ * current scroll speed */
+#define GFX_THUMBNAIL_PREFETCH_LOOKAHEAD    500.0f
+/* Time constant in ms of the scroll speed average */
+#define GFX_THUMBNAIL_PREFETCH_SMOOTHING    200.0f
+/* Prefetch loads in flight at any time
+ * > Kept low, so that loads requested for entries
+ *   that are actually on screen are not stuck behind
+ *   a long queue of speculative ones */
+#define GFX_THUMBNAIL_PREFETCH_IN_FLIGHT    2
+#define GFX_THUMBNAIL_PREFETCH_CANCEL_MAX   16
+
+/* Sub directory of the cache directory holding
+ * pre-scaled copies of thumbnail images */
+#define GFX_THUMBNAIL_DERIVATIVE_DIR        "thumbnails"
+/* Derivative sizes are rounded up to a multiple
+ * of this value */
+#define GFX_THUMBNAIL_DERIVATIVE_ALIGN      64
+
 /* Utility structure, sent as userdata when pushing
  * an image load */
 typedef struct
 {
    uint64_t list_id;
    gfx_thumbnail_t *thumbnail;
+   char *path;
+   unsigned upscale_threshold;
+   unsigned scaled_width;
+   unsigned scaled_height;
+   bool supports_rgba;
 } gfx_thumbnail_tag_t;
 
+/* Decoded image held by the thumbnail cache. Images
+ * are only valid for the exact file state they were
+ * decoded from, and the load options that affect the
+ * decoded pixels (including the size the image was
+ * scaled down to - 0 for the original image). */
+struct gfx_thumbnail_cache_entry
+{
+   struct texture_image image;
+   struct gfx_thumbnail_cache_entry *prev;
+   struct gfx_thumbnail_cache_entry *next;
+   char *path;
+   int64_t mtime;
+   size_t size;
+   uint32_t hash;
+   unsigned upscale_threshold;
+   unsigned scaled_width;
+   unsigned scaled_height;
+   bool supports_rgba;
+};
+
+typedef struct gfx_thumbnail_cache_entry gfx_thumbnail_cache_entry_t;
+
+/* Userdata of prefetch image loads */
+typedef struct
+{
+   uint64_t id;
+   char *path;
+   unsigned upscale_threshold;
+   unsigned scaled_width;
+   unsigned scaled_height;
+   bool supports_rgba;
+} gfx_thumbnail_prefetch_tag_t;
+
+/* Prefetch loads found by gfx_thumbnail_prefetch_finder() */
+typedef struct
+{
+   void *tasks[GFX_THUMBNAIL_PREFETCH_CANCEL_MAX];
+   uint64_t id;
+   size_t count;
+} gfx_thumbnail_prefetch_stale_t;
+
 /* Setters */
 
 /* When streaming thumbnails, sets time in ms that an
@@ -82,6 +156,29 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Sets the largest size (in pixels) at which the menu
+ * driver draws thumbnails, used to scale the images of
+ * the derivative cache
+ * > Values are rounded up, so that small layout changes
+ *   do not invalidate the existing derivatives
+ * > 0 disables the derivative cache */
+void gfx_thumbnail_set_derivative_size(unsigned width, unsigned height)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   if ((width == 0) || (height == 0))
+   {
+      p_gfx_thumb->derivative_width  = 0;
+      p_gfx_thumb->derivative_height = 0;
+      return;
+   }
+
+   p_gfx_thumb->derivative_width  = (width  + GFX_THUMBNAIL_DERIVATIVE_ALIGN - 1)
+         / GFX_THUMBNAIL_DERIVATIVE_ALIGN * GFX_THUMBNAIL_DERIVATIVE_ALIGN;
+   p_gfx_thumb->derivative_height = (height + GFX_THUMBNAIL_DERIVATIVE_ALIGN - 1)
+         / GFX_THUMBNAIL_DERIVATIVE_ALIGN * GFX_THUMBNAIL_DERIVATIVE_ALIGN;
+}
+
 /* Getters */
 
 /* Fetches current streaming thumbnails request delay */
@@ -109,6 +206,687 @@ bool gfx_thumbnail_get_fade_missing(bool fade_missing)
    return p_gfx_thumb->fade_missing;
 }
 
+/* Image cache */
+
+static uint32_t gfx_thumbnail_cache_hash(const char *path)
+{
+   uint32_t hash = 5381;
+   while (*path)
+      hash = (hash << 5) + hash + (uint8_t)*path++;
+   return hash;
+}
+
+static void gfx_thumbnail_cache_unlink(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   if (entry->prev)
+      entry->prev->next       = entry->next;
+   else
+      p_gfx_thumb->cache_head = entry->next;
+
+   if (entry->next)
+      entry->next->prev       = entry->prev;
+   else
+      p_gfx_thumb->cache_tail = entry->prev;
+
+   entry->prev = NULL;
+   entry->next = NULL;
+}
+
+static void gfx_thumbnail_cache_push_front(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   entry->prev = NULL;
+   entry->next = p_gfx_thumb->cache_head;
+
+   if (p_gfx_thumb->cache_head)
+      p_gfx_thumb->cache_head->prev = entry;
+   else
+      p_gfx_thumb->cache_tail       = entry;
+
+   p_gfx_thumb->cache_head = entry;
+}
+
+static void gfx_thumbnail_cache_remove(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+   p_gfx_thumb->cache_size -= entry->size;
+
+   image_texture_free(&entry->image);
+   free(entry->path);
+   free(entry);
+}
+
+/* Evicts least recently used images until 'size'
+ * additional bytes fit within 'budget' */
+static void gfx_thumbnail_cache_trim(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      size_t budget, size_t size)
+{
+   while (p_gfx_thumb->cache_tail &&
+          (p_gfx_thumb->cache_size + size > budget))
+      gfx_thumbnail_cache_remove(p_gfx_thumb,
+            p_gfx_thumb->cache_tail);
+}
+
+static size_t gfx_thumbnail_cache_get_budget(void)
+{
+   settings_t *settings = config_get_ptr();
+   return settings ?
+         (size_t)settings->uints.gfx_thumbnail_cache_size << 20 : 0;
+}
+
+static const struct texture_image *gfx_thumbnail_cache_get_scaled(
+      const char *path, bool supports_rgba,
+      unsigned upscale_threshold,
+      unsigned scaled_width, unsigned scaled_height)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   uint32_t hash;
+
+   if (!p_gfx_thumb->cache_head || string_is_empty(path))
+      return NULL;
+
+   /* Cache was disabled or shrunk since the
+    * images were added */
+   gfx_thumbnail_cache_trim(p_gfx_thumb,
+         gfx_thumbnail_cache_get_budget(), 0);
+
+   hash = gfx_thumbnail_cache_hash(path);
+
+   for (entry = p_gfx_thumb->cache_head; entry; entry = entry->next)
+   {
+      if (     (entry->hash                != hash)
+            || (entry->upscale_threshold   != upscale_threshold)
+            || (entry->scaled_width        != scaled_width)
+            || (entry->scaled_height       != scaled_height)
+            || (entry->supports_rgba       != supports_rgba)
+            || !string_is_equal(entry->path, path))
+         continue;
+
+      /* Image file was replaced or deleted */
+      if (path_get_mtime(path) != entry->mtime)
+      {
+         gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+         return NULL;
+      }
+
+      if (entry != p_gfx_thumb->cache_head)
+      {
+         gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+         gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+      }
+
+      return &entry->image;
+   }
+
+   return NULL;
+}
+
+static bool gfx_thumbnail_cache_add_scaled(
+      const char *path, struct texture_image *img,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned scaled_width, unsigned scaled_height)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   size_t budget                      = gfx_thumbnail_cache_get_budget();
+   size_t size;
+
+   if (     string_is_empty(path)
+         || !img
+         || !img->pixels
+         || (img->width  < 1)
+         || (img->height < 1))
+      return false;
+
+   size = (size_t)img->width * img->height * sizeof(uint32_t);
+
+   if (size > budget)
+      return false;
+
+   /* Replace any stale image of the same file */
+   if (gfx_thumbnail_cache_get_scaled(path, supports_rgba,
+            upscale_threshold, scaled_width, scaled_height))
+      gfx_thumbnail_cache_remove(p_gfx_thumb, p_gfx_thumb->cache_head);
+
+   if (!(entry = (gfx_thumbnail_cache_entry_t*)
+            calloc(1, sizeof(*entry))))
+      return false;
+
+   if (!(entry->path = strdup(path)))
+   {
+      free(entry);
+      return false;
+   }
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb, budget, size);
+
+   entry->image             = *img;
+   entry->mtime             = path_get_mtime(path);
+   entry->size              = size;
+   entry->hash              = gfx_thumbnail_cache_hash(path);
+   entry->upscale_threshold = upscale_threshold;
+   entry->scaled_width      = scaled_width;
+   entry->scaled_height     = scaled_height;
+   entry->supports_rgba     = supports_rgba;
+
+   gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+   p_gfx_thumb->cache_size += size;
+
+   img->pixels = NULL;
+   img->width  = 0;
+   img->height = 0;
+
+   return true;
+}
+
+const struct texture_image *gfx_thumbnail_cache_get(
+      const char *path, bool supports_rgba,
+      unsigned upscale_threshold)
+{
+   return gfx_thumbnail_cache_get_scaled(path, supports_rgba,
+         upscale_threshold, 0, 0);
+}
+
+bool gfx_thumbnail_cache_add(
+      const char *path, struct texture_image *img,
+      bool supports_rgba, unsigned upscale_threshold)
+{
+   return gfx_thumbnail_cache_add_scaled(path, img, supports_rgba,
+         upscale_threshold, 0, 0);
+}
+
+void gfx_thumbnail_cache_free(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   while (p_gfx_thumb->cache_head)
+      gfx_thumbnail_cache_remove(p_gfx_thumb,
+            p_gfx_thumb->cache_head);
+}
+
+/* Derivative cache */
+
+#ifdef HAVE_RTGA
+/* Gets the directory under which the pre-scaled
+ * copies are stored, or NULL if there is none */
+static const char *gfx_thumbnail_get_derivative_base_dir(
+      settings_t *settings)
+{
+   if (!string_is_empty(settings->paths.directory_cache))
+      return settings->paths.directory_cache;
+   if (!string_is_empty(settings->paths.directory_thumbnails))
+      return settings->paths.directory_thumbnails;
+   return NULL;
+}
+
+/* Gets the location of the copy of 'path' scaled
+ * down to fit (width x height)
+ * Returns false if there is nowhere to store it */
+static bool gfx_thumbnail_get_derivative_path(
+      const char *path, unsigned width, unsigned height,
+      char *s, size_t len)
+{
+   char name[64];
+   char dir[PATH_MAX_LENGTH];
+   settings_t *settings = config_get_ptr();
+   const char *base_dir = NULL;
+   uint32_t hash_fnv    = 2166136261u;
+   const char *c        = path;
+
+   if (     !settings
+         || !(base_dir = gfx_thumbnail_get_derivative_base_dir(settings)))
+      return false;
+
+   /* Images of different systems share file names,
+    * so copies are named after the full source path */
+   while (*c)
+      hash_fnv = (hash_fnv ^ (uint8_t)*c++) * 16777619u;
+
+   snprintf(name, sizeof(name), "%08x%08x_%ux%u.tga",
+         (unsigned)hash_fnv,
+         (unsigned)gfx_thumbnail_cache_hash(path),
+         width, height);
+
+   fill_pathname_join(dir, base_dir,
+         GFX_THUMBNAIL_DERIVATIVE_DIR, sizeof(dir));
+   fill_pathname_join(s, dir, name, len);
+
+   return true;
+}
+#endif
+
+/* Gets the size to which thumbnails of the menu
+ * lists are scaled down when loaded
+ * > (0 x 0) if the derivative cache is not in use,
+ *   i.e. the original images are loaded */
+static void gfx_thumbnail_get_scaled_size(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      unsigned *width, unsigned *height)
+{
+#ifdef HAVE_RTGA
+   settings_t *settings = config_get_ptr();
+
+   if (     settings
+         && settings->bools.gfx_thumbnail_derivative_cache
+         && (p_gfx_thumb->derivative_width  > 0)
+         && (p_gfx_thumb->derivative_height > 0)
+         && gfx_thumbnail_get_derivative_base_dir(settings))
+   {
+      *width  = p_gfx_thumb->derivative_width;
+      *height = p_gfx_thumb->derivative_height;
+      return;
+   }
+#endif
+
+   *width  = 0;
+   *height = 0;
+}
+
+/* Pushes an image load of thumbnail 'path'
+ * > If a scaled size is given, the copy scaled down
+ *   to that size is loaded instead - or created, if
+ *   it does not exist or the image has been replaced
+ *   since */
+static bool gfx_thumbnail_push_image_load(
+      const char *path,
+      unsigned scaled_width, unsigned scaled_height,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+#ifdef HAVE_RTGA
+   char derivative_path[PATH_MAX_LENGTH];
+
+   if (     (scaled_width  > 0)
+         && (scaled_height > 0)
+         && gfx_thumbnail_get_derivative_path(path,
+               scaled_width, scaled_height,
+               derivative_path, sizeof(derivative_path)))
+   {
+      if (     path_is_valid(derivative_path)
+            && (path_get_mtime(derivative_path) >= path_get_mtime(path)))
+         return task_push_image_load(derivative_path, supports_rgba,
+               upscale_threshold, cb, user_data);
+
+      return task_push_image_derivative(path, derivative_path,
+            scaled_width, scaled_height,
+            supports_rgba, upscale_threshold, cb, user_data);
+   }
+#endif
+
+   return task_push_image_load(path, supports_rgba,
+         upscale_threshold, cb, user_data);
+}
+
+/* Uploads a cached image as the texture of 'thumbnail'
+ * Returns true if successful */
+static bool gfx_thumbnail_load_cached(
+      gfx_thumbnail_t *thumbnail, const char *path,
+      unsigned upscale_threshold,
+      unsigned scaled_width, unsigned scaled_height)
+{
+   const struct texture_image *img = gfx_thumbnail_cache_get_scaled(
+         path, video_driver_supports_rgba(), upscale_threshold,
+         scaled_width, scaled_height);
+
+   if (!img)
+      return false;
+
+   if (!video_driver_texture_load((void*)img,
+            TEXTURE_FILTER_MIPMAP_LINEAR, &thumbnail->texture))
+      return false;
+
+   thumbnail->width  = img->width;
+   thumbnail->height = img->height;
+   thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+   thumbnail->scaled = (scaled_width > 0);
+
+   return true;
+}
+
+/* Prefetching */
+
+static void gfx_thumbnail_handle_prefetch(
+      retro_task_t *task, void *task_data, void *user_data, const char *err)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb        = gfx_thumb_get_ptr();
+   struct texture_image *img                 = (struct texture_image*)task_data;
+   gfx_thumbnail_prefetch_tag_t *prefetch_tag =
+         (gfx_thumbnail_prefetch_tag_t*)user_data;
+
+   if (p_gfx_thumb->prefetch.pending > 0)
+      p_gfx_thumb->prefetch.pending--;
+
+   if (img)
+   {
+      if (!prefetch_tag || !gfx_thumbnail_cache_add_scaled(
+               prefetch_tag->path, img,
+               prefetch_tag->supports_rgba,
+               prefetch_tag->upscale_threshold,
+               prefetch_tag->scaled_width,
+               prefetch_tag->scaled_height))
+         image_texture_free(img);
+      free(img);
+   }
+
+   if (prefetch_tag)
+   {
+      if (prefetch_tag->path)
+         free(prefetch_tag->path);
+      free(prefetch_tag);
+   }
+}
+
+/* Collects the prefetch loads of an older generation
+ * > Tasks cannot be cancelled from within a finder
+ *   (the task queue is locked), so they are only
+ *   recorded here */
+static bool gfx_thumbnail_prefetch_finder(retro_task_t *task, void *user_data)
+{
+   gfx_thumbnail_prefetch_stale_t *stale =
+         (gfx_thumbnail_prefetch_stale_t*)user_data;
+   gfx_thumbnail_prefetch_tag_t *prefetch_tag = NULL;
+
+   if (!task || (task->callback != gfx_thumbnail_handle_prefetch))
+      return false;
+
+   prefetch_tag = (gfx_thumbnail_prefetch_tag_t*)task->user_data;
+
+   if (     prefetch_tag
+         && (prefetch_tag->id != stale->id)
+         && (stale->count < GFX_THUMBNAIL_PREFETCH_CANCEL_MAX))
+      stale->tasks[stale->count++] = task;
+
+   return false;
+}
+
+/* Starts a new prefetch generation, cancelling the
+ * loads of all previous ones */
+static void gfx_thumbnail_prefetch_restart(
+      gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   task_finder_data_t find_data;
+   gfx_thumbnail_prefetch_stale_t stale;
+   size_t i;
+
+   p_gfx_thumb->prefetch.id++;
+
+   if (p_gfx_thumb->prefetch.pending == 0)
+      return;
+
+   stale.id         = p_gfx_thumb->prefetch.id;
+   stale.count      = 0;
+   find_data.func     = gfx_thumbnail_prefetch_finder;
+   find_data.userdata = &stale;
+
+   task_queue_find(&find_data);
+
+   for (i = 0; i < stale.count; i++)
+      task_queue_cancel_task(stale.tasks[i]);
+}
+
+/* Queues the load of the thumbnails of playlist
+ * entry 'idx' that are not cached yet
+ * Returns false if no more loads can be queued */
+static bool gfx_thumbnail_prefetch_entry(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      playlist_t *playlist, size_t idx, bool load_left,
+      unsigned upscale_threshold)
+{
+   gfx_thumbnail_path_data_t *path_data = p_gfx_thumb->prefetch.path_data;
+   bool supports_rgba                   = video_driver_supports_rgba();
+   unsigned scaled_width                = 0;
+   unsigned scaled_height               = 0;
+   unsigned i;
+
+   if (!gfx_thumbnail_set_content_playlist(path_data, playlist, idx))
+      return true;
+
+   gfx_thumbnail_get_scaled_size(p_gfx_thumb,
+         &scaled_width, &scaled_height);
+
+   for (i = 0; i < (load_left ? 2 : 1); i++)
+   {
+      enum gfx_thumbnail_id thumbnail_id = (i == 0) ?
+            GFX_THUMBNAIL_RIGHT : GFX_THUMBNAIL_LEFT;
+      const char *thumbnail_path         = NULL;
+      gfx_thumbnail_prefetch_tag_t *prefetch_tag = NULL;
+
+      if (     !gfx_thumbnail_update_path(path_data, thumbnail_id)
+            || !gfx_thumbnail_get_path(path_data, thumbnail_id,
+                  &thumbnail_path))
+         continue;
+
+      if (gfx_thumbnail_cache_get_scaled(thumbnail_path, supports_rgba,
+               upscale_threshold, scaled_width, scaled_height))
+         continue;
+
+      /* Missing thumbnails are left to on demand
+       * downloads, once the entry is selected */
+      if (!path_is_valid(thumbnail_path))
+         continue;
+
+      if (!(prefetch_tag = (gfx_thumbnail_prefetch_tag_t*)
+               malloc(sizeof(*prefetch_tag))))
+         return false;
+
+      prefetch_tag->id                = p_gfx_thumb->prefetch.id;
+      prefetch_tag->path              = strdup(thumbnail_path);
+      prefetch_tag->upscale_threshold = upscale_threshold;
+      prefetch_tag->scaled_width      = scaled_width;
+      prefetch_tag->scaled_height     = scaled_height;
+      prefetch_tag->supports_rgba     = supports_rgba;
+
+      if (!gfx_thumbnail_push_image_load(thumbnail_path,
+               scaled_width, scaled_height,
+               supports_rgba, upscale_threshold,
+               gfx_thumbnail_handle_prefetch, prefetch_tag))
+      {
+         if (prefetch_tag->path)
+            free(prefetch_tag->path);
+         free(prefetch_tag);
+         return false;
+      }
+
+      p_gfx_thumb->prefetch.pending++;
+   }
+
+   return true;
+}
+
+/* Returns true if another prefetch load may be started.
+ * When images are decoded on several threads, there
+ * may be one prefetch load per thread, but only while
+ * a thread is idle: a load requested for an entry that
+ * is actually on screen must never wait behind a full
+ * decode queue */
+static bool gfx_thumbnail_prefetch_can_load(
+      gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   unsigned depth   = 0;
+   unsigned workers = 0;
+
+   task_image_get_decode_status(&depth, &workers);
+
+   if (workers == 0)
+      return p_gfx_thumb->prefetch.pending <
+            GFX_THUMBNAIL_PREFETCH_IN_FLIGHT;
+
+   return (p_gfx_thumb->prefetch.pending <
+         MAX(GFX_THUMBNAIL_PREFETCH_IN_FLIGHT, workers))
+         && (depth < workers);
+}
+
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, file_list_t *list,
+      size_t first, size_t last, bool load_left,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   retro_time_t current_time          = cpu_features_get_time_usec();
+   size_t playlist_size               = 0;
+   size_t ahead;
+   int direction;
+   bool restart;
+
+   if (     !path_data
+         || !playlist
+         || !list
+         || (first > last)
+         || (last >= list->size))
+      return;
+
+   /* Images are only ever prefetched into the cache */
+   if (gfx_thumbnail_cache_get_budget() == 0)
+      return;
+
+   if (!p_gfx_thumb->prefetch.path_data &&
+       !(p_gfx_thumb->prefetch.path_data = gfx_thumbnail_path_init()))
+      return;
+
+   playlist_size = playlist_get_size(playlist);
+
+   /* Start over whenever a different list is shown */
+   restart = gfx_thumbnail_copy_system(
+         p_gfx_thumb->prefetch.path_data, path_data);
+   restart = restart || (playlist   != p_gfx_thumb->prefetch.playlist);
+   restart = restart || (list->size != p_gfx_thumb->prefetch.list_size);
+
+   direction = p_gfx_thumb->prefetch.direction;
+
+   if (restart)
+   {
+      p_gfx_thumb->prefetch.playlist  = playlist;
+      p_gfx_thumb->prefetch.list_size = list->size;
+      p_gfx_thumb->prefetch.speed     = 0.0f;
+      direction                       = 1;
+   }
+   else
+   {
+      /* Track scroll speed (entries per second) as an
+       * exponential average, so that a single large
+       * jump does not inflate the prefetch window */
+      float delta_time = (float)(current_time -
+            p_gfx_thumb->prefetch.time) / 1000.0f;
+      size_t moved     = (first > p_gfx_thumb->prefetch.first) ?
+            first - p_gfx_thumb->prefetch.first :
+            p_gfx_thumb->prefetch.first - first;
+
+      if (first != p_gfx_thumb->prefetch.first)
+         direction = (first > p_gfx_thumb->prefetch.first) ? 1 : -1;
+
+      if (delta_time > 0.0f)
+      {
+         float speed  = (float)moved * 1000.0f / delta_time;
+         float weight = delta_time / GFX_THUMBNAIL_PREFETCH_SMOOTHING;
+
+         if (weight > 1.0f)
+            weight = 1.0f;
+
+         p_gfx_thumb->prefetch.speed +=
+               (speed - p_gfx_thumb->prefetch.speed) * weight;
+      }
+
+      /* Whatever is still loading for the opposite
+       * direction is no longer wanted */
+      restart = (direction != p_gfx_thumb->prefetch.direction);
+   }
+
+   p_gfx_thumb->prefetch.time      = current_time;
+   p_gfx_thumb->prefetch.first     = first;
+   p_gfx_thumb->prefetch.direction = direction;
+
+   ahead = GFX_THUMBNAIL_PREFETCH_MIN + (size_t)(p_gfx_thumb->prefetch.speed
+         * GFX_THUMBNAIL_PREFETCH_LOOKAHEAD / 1000.0f);
+   if (ahead > GFX_THUMBNAIL_PREFETCH_MAX)
+      ahead = GFX_THUMBNAIL_PREFETCH_MAX;
+
+   /* 'next' is the boundary of the entries handled so
+    * far: the next entry to load when scrolling down,
+    * one past it when scrolling up. If the visible
+    * entries moved past it (or away from it), the
+    * window is started again from the visible edge */
+   if (direction > 0)
+   {
+      size_t end = last + 1 + ahead;
+
+      if (end > list->size)
+         end = list->size;
+
+      if (     restart
+            || (p_gfx_thumb->prefetch.next < last + 1)
+            || (p_gfx_thumb->prefetch.next >
+                  last + 1 + GFX_THUMBNAIL_PREFETCH_MAX))
+      {
+         gfx_thumbnail_prefetch_restart(p_gfx_thumb);
+         p_gfx_thumb->prefetch.next = last + 1;
+      }
+
+      while (  (p_gfx_thumb->prefetch.next < end)
+            && gfx_thumbnail_prefetch_can_load(p_gfx_thumb))
+      {
+         size_t idx = list->list[p_gfx_thumb->prefetch.next].entry_idx;
+
+         if (     (idx < playlist_size)
+               && !gfx_thumbnail_prefetch_entry(p_gfx_thumb,
+                     playlist, idx, load_left,
+                     gfx_thumbnail_upscale_threshold))
+            break;
+
+         p_gfx_thumb->prefetch.next++;
+      }
+   }
+   else
+   {
+      size_t end = (first > ahead) ? first - ahead : 0;
+
+      if (     restart
+            || (p_gfx_thumb->prefetch.next > first)
+            || (p_gfx_thumb->prefetch.next +
+                  GFX_THUMBNAIL_PREFETCH_MAX < first))
+      {
+         gfx_thumbnail_prefetch_restart(p_gfx_thumb);
+         p_gfx_thumb->prefetch.next = first;
+      }
+
+      while (  (p_gfx_thumb->prefetch.next > end)
+            && gfx_thumbnail_prefetch_can_load(p_gfx_thumb))
+      {
+         size_t idx = list->list[p_gfx_thumb->prefetch.next - 1].entry_idx;
+
+         if (     (idx < playlist_size)
+               && !gfx_thumbnail_prefetch_entry(p_gfx_thumb,
+                     playlist, idx, load_left,
+                     gfx_thumbnail_upscale_threshold))
+            break;
+
+         p_gfx_thumb->prefetch.next--;
+      }
+   }
+}
+
+void gfx_thumbnail_prefetch_reset(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   gfx_thumbnail_prefetch_restart(p_gfx_thumb);
+
+   if (p_gfx_thumb->prefetch.path_data)
+      free(p_gfx_thumb->prefetch.path_data);
+
+   p_gfx_thumb->prefetch.path_data = NULL;
+   p_gfx_thumb->prefetch.playlist  = NULL;
+   p_gfx_thumb->prefetch.list_size = 0;
+   p_gfx_thumb->prefetch.speed     = 0.0f;
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -176,7 +954,10 @@ static void gfx_thumbnail_handle_upload(
       goto end;
 
    /* Ensure that we are operating on the correct
-    * thumbnail... */
+    * thumbnail...
+    * > Images that are no longer wanted (e.g. when
+    *   scrolling quickly) are still added to the
+    *   cache below, since they were decoded anyway */
    if (thumbnail_tag->list_id != p_gfx_thumb->list_id)
       goto end;
 
@@ -213,6 +994,7 @@ static void gfx_thumbnail_handle_upload(
    /* Cache dimensions */
    thumbnail_tag->thumbnail->width  = img->width;
    thumbnail_tag->thumbnail->height = img->height;
+   thumbnail_tag->thumbnail->scaled = (thumbnail_tag->scaled_width > 0);
 
    /* Update thumbnail status */
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
@@ -221,7 +1003,13 @@ end:
    /* Clean up */
    if (img)
    {
-      image_texture_free(img);
+      if (!thumbnail_tag || !gfx_thumbnail_cache_add_scaled(
+               thumbnail_tag->path, img,
+               thumbnail_tag->supports_rgba,
+               thumbnail_tag->upscale_threshold,
+               thumbnail_tag->scaled_width,
+               thumbnail_tag->scaled_height))
+         image_texture_free(img);
       free(img);
    }
 
@@ -232,10 +1020,62 @@ end:
          gfx_thumbnail_init_fade(p_gfx_thumb,
                thumbnail_tag->thumbnail);
 
+      if (thumbnail_tag->path)
+         free(thumbnail_tag->path);
       free(thumbnail_tag);
    }
 }
 
+/* Used to replace the scaled texture of a thumbnail
+ * with the original image, following completion of
+ * the image load task */
+static void gfx_thumbnail_handle_full_size_upload(
+      retro_task_t *task, void *task_data, void *user_data, const char *err)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   struct texture_image *img          = (struct texture_image*)task_data;
+   gfx_thumbnail_tag_t *thumbnail_tag = (gfx_thumbnail_tag_t*)user_data;
+   gfx_thumbnail_t *thumbnail         = NULL;
+   uintptr_t texture                  = 0;
+
+   if (!thumbnail_tag || (thumbnail_tag->list_id != p_gfx_thumb->list_id))
+      goto end;
+
+   /* Thumbnail may have been reset (or already
+    * replaced) while the image was loading */
+   thumbnail = thumbnail_tag->thumbnail;
+   if (     (thumbnail->status != GFX_THUMBNAIL_STATUS_AVAILABLE)
+         || !thumbnail->scaled)
+      goto end;
+
+   if (!img || (img->width < 1) || (img->height < 1))
+      goto end;
+
+   /* The scaled texture is only released once the
+    * original one is ready, so that the thumbnail
+    * never blinks out */
+   if (!video_driver_texture_load(
+            img, TEXTURE_FILTER_MIPMAP_LINEAR, &texture))
+      goto end;
+
+   video_driver_texture_unload(&thumbnail->texture);
+
+   thumbnail->texture = texture;
+   thumbnail->width   = img->width;
+   thumbnail->height  = img->height;
+   thumbnail->scaled  = false;
+
+end:
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+
+   if (thumbnail_tag)
+      free(thumbnail_tag);
+}
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -272,6 +1112,8 @@ void gfx_thumbnail_request(
 {
    const char *thumbnail_path         = NULL;
    bool has_thumbnail                 = false;
+   unsigned scaled_width              = 0;
+   unsigned scaled_height             = 0;
    gfx_thumbnail_state_t *p_gfx_thumb = NULL;
    p_gfx_thumb                        = NULL;
    
@@ -293,6 +1135,16 @@ void gfx_thumbnail_request(
    /* Load thumbnail, if required */
    if (has_thumbnail)
    {
+      gfx_thumbnail_get_scaled_size(p_gfx_thumb,
+            &scaled_width, &scaled_height);
+
+      /* Image was decoded recently - no need to
+       * touch the file at all */
+      if (gfx_thumbnail_load_cached(thumbnail, thumbnail_path,
+               gfx_thumbnail_upscale_threshold,
+               scaled_width, scaled_height))
+         goto end;
+
       if (path_is_valid(thumbnail_path))
       {
          gfx_thumbnail_tag_t *thumbnail_tag =
@@ -302,16 +1154,28 @@ void gfx_thumbnail_request(
             goto end;
 
          /* Configure user data */
-         thumbnail_tag->thumbnail = thumbnail;
-         thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+         thumbnail_tag->thumbnail         = thumbnail;
+         thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+         thumbnail_tag->path              = strdup(thumbnail_path);
+         thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+         thumbnail_tag->scaled_width      = scaled_width;
+         thumbnail_tag->scaled_height     = scaled_height;
+         thumbnail_tag->supports_rgba     = video_driver_supports_rgba();
 
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if (task_push_image_load(
-               thumbnail_path, video_driver_supports_rgba(),
+         if (gfx_thumbnail_push_image_load(thumbnail_path,
+               scaled_width, scaled_height,
+               thumbnail_tag->supports_rgba,
                gfx_thumbnail_upscale_threshold,
                gfx_thumbnail_handle_upload, thumbnail_tag))
             thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+         else
+         {
+            if (thumbnail_tag->path)
+               free(thumbnail_tag->path);
+            free(thumbnail_tag);
+         }
       }
 #ifdef HAVE_NETWORKING
       /* Handle on demand thumbnail downloads */
@@ -401,9 +1265,17 @@ void gfx_thumbnail_request_file(
    if (!thumbnail_tag)
       return;
 
-   /* Configure user data */
-   thumbnail_tag->thumbnail = thumbnail;
-   thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   /* Configure user data
+    * > Arbitrary files (e.g. savestate images) are
+    *   frequently overwritten in place, so they are
+    *   not added to the image cache */
+   thumbnail_tag->thumbnail         = thumbnail;
+   thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+   thumbnail_tag->path              = NULL;
+   thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+   thumbnail_tag->scaled_width      = 0;
+   thumbnail_tag->scaled_height     = 0;
+   thumbnail_tag->supports_rgba     = video_driver_supports_rgba();
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
@@ -412,6 +1284,64 @@ void gfx_thumbnail_request_file(
          gfx_thumbnail_upscale_threshold,
          gfx_thumbnail_handle_upload, thumbnail_tag))
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   else
+      free(thumbnail_tag);
+}
+
+/* Replaces the scaled down copy of the image loaded
+ * by gfx_thumbnail_request() with the original image,
+ * for display in the fullscreen thumbnail view
+ * - Does nothing unless 'thumbnail->status' is
+ *   GFX_THUMBNAIL_STATUS_AVAILABLE and the texture
+ *   holds a scaled copy
+ * - The current texture is kept (and drawn) until
+ *   the original image has been loaded
+ * - Full size images are not added to the image cache
+ * NOTE: Must be called *after* gfx_thumbnail_set_content*()
+ *       for the entry that owns 'thumbnail' */
+void gfx_thumbnail_request_full_size(
+      gfx_thumbnail_path_data_t *path_data, enum gfx_thumbnail_id thumbnail_id,
+      gfx_thumbnail_t *thumbnail,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+   const char *thumbnail_path         = NULL;
+
+   if (     !path_data
+         || !thumbnail
+         || (thumbnail->status != GFX_THUMBNAIL_STATUS_AVAILABLE)
+         || !thumbnail->scaled)
+      return;
+
+   if (     !gfx_thumbnail_is_enabled(path_data, thumbnail_id)
+         || !gfx_thumbnail_update_path(path_data, thumbnail_id)
+         || !gfx_thumbnail_get_path(path_data, thumbnail_id, &thumbnail_path)
+         || !path_is_valid(thumbnail_path))
+      return;
+
+   thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
+
+   if (!thumbnail_tag)
+      return;
+
+   /* Configure user data
+    * > Full size images are only needed while the
+    *   fullscreen view is open, and would take up
+    *   most of the image cache - so are not cached */
+   thumbnail_tag->thumbnail         = thumbnail;
+   thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+   thumbnail_tag->path              = NULL;
+   thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+   thumbnail_tag->scaled_width      = 0;
+   thumbnail_tag->scaled_height     = 0;
+   thumbnail_tag->supports_rgba     = video_driver_supports_rgba();
+
+   if (!task_push_image_load(
+         thumbnail_path, thumbnail_tag->supports_rgba,
+         gfx_thumbnail_upscale_threshold,
+         gfx_thumbnail_handle_full_size_upload, thumbnail_tag))
+      free(thumbnail_tag);
 }
 
 /* Resets (and free()s the current texture of) the
@@ -440,6 +1370,7 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    thumbnail->alpha       = 0.0f;
    thumbnail->delay_timer = 0.0f;
    thumbnail->fade_active = false;
+   thumbnail->scaled      = false;
 }
 
 /* Stream processing */
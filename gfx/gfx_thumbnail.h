@@ -27,6 +27,7 @@
 #include <libretro.h>
 
 #include <boolean.h>
+#include <lists/file_list.h>
 
 #include "gfx_thumbnail_path.h"
 
@@ -73,6 +74,9 @@ typedef struct
    float delay_timer;
    enum gfx_thumbnail_status status;
    bool fade_active;
+   /* True if 'texture' holds a copy of the image
+    * scaled down to the list thumbnail size */
+   bool scaled;
 } gfx_thumbnail_t;
 
 /* Holds all configuration parameters associated
@@ -92,6 +96,9 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+struct texture_image;
+struct gfx_thumbnail_cache_entry;
+
 /* Structure containing all gfx_thumbnail
  * global variables */
 struct gfx_thumbnail_state
@@ -108,6 +115,41 @@ struct gfx_thumbnail_state
     * at the time when the load completes */
    uint64_t list_id;
 
+   /* Decoded images of recently loaded thumbnails,
+    * most recently used first. Shared by all menu
+    * drivers, so that scrolling back to an entry does
+    * not read and decode the image file again */
+   struct gfx_thumbnail_cache_entry *cache_head;
+   struct gfx_thumbnail_cache_entry *cache_tail;
+   size_t cache_size;
+
+   /* Thumbnails of the entries about to scroll into
+    * view are decoded ahead of time into the cache.
+    * Loads are tagged with 'id', which is incremented
+    * whenever the pending loads are no longer wanted
+    * (scroll direction reversed, list changed...) */
+   struct
+   {
+      gfx_thumbnail_path_data_t *path_data;
+      playlist_t *playlist;
+      retro_time_t time;
+      uint64_t id;
+      size_t list_size;
+      size_t first;
+      size_t next;
+      float speed;
+      unsigned pending;
+      int direction;
+   } prefetch;
+
+   /* Largest size at which the active menu driver
+    * draws list (or sidebar) thumbnails. When the
+    * derivative cache is enabled, images are loaded
+    * from copies scaled down to fit this size
+    * (0: not set) */
+   unsigned derivative_width;
+   unsigned derivative_height;
+
    /* When streaming thumbnails, to minimise the processing
     * of unnecessary images (i.e. when scrolling rapidly through
     * playlists), we delay loading until an entry has been on screen
@@ -144,6 +186,16 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets the largest size (in pixels) at which the menu
+ * driver draws list (or sidebar) thumbnails, used to
+ * scale the images of the derivative cache
+ * > The fullscreen thumbnail view is not included:
+ *   use gfx_thumbnail_request_full_size() for it
+ * > Values are rounded up, so that small layout changes
+ *   do not invalidate the existing derivatives
+ * > 0 disables the derivative cache */
+void gfx_thumbnail_set_derivative_size(unsigned width, unsigned height);
+
 /* Getters */
 
 /* Fetches current streaming thumbnails request delay */
@@ -197,6 +249,22 @@ void gfx_thumbnail_request_file(
       const char *file_path, gfx_thumbnail_t *thumbnail,
       unsigned gfx_thumbnail_upscale_threshold);
 
+/* Replaces the scaled down copy of the image loaded
+ * by gfx_thumbnail_request() with the original image,
+ * for display in the fullscreen thumbnail view
+ * - Does nothing unless 'thumbnail->status' is
+ *   GFX_THUMBNAIL_STATUS_AVAILABLE and the texture
+ *   holds a scaled copy
+ * - The current texture is kept (and drawn) until
+ *   the original image has been loaded
+ * - Full size images are not added to the image cache
+ * NOTE: Must be called *after* gfx_thumbnail_set_content*()
+ *       for the entry that owns 'thumbnail' */
+void gfx_thumbnail_request_full_size(
+      gfx_thumbnail_path_data_t *path_data, enum gfx_thumbnail_id thumbnail_id,
+      gfx_thumbnail_t *thumbnail,
+      unsigned gfx_thumbnail_upscale_threshold);
+
 /* Resets (and free()s the current texture of) the
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
@@ -272,6 +340,56 @@ void gfx_thumbnail_draw(
       float alpha, float scale_factor,
       gfx_thumbnail_shadow_t *shadow);
 
+/* Image cache */
+
+/* Returns the cached decoded image of 'path' (at its
+ * original size), or NULL if not cached (or the file
+ * has changed since).
+ * The image must not be modified, and is only valid
+ * until the next call of any gfx_thumbnail function */
+const struct texture_image *gfx_thumbnail_cache_get(
+      const char *path, bool supports_rgba,
+      unsigned upscale_threshold);
+
+/* Adds the original size image of 'path' (decoded with
+ * the given 'supports_rgba' and 'upscale_threshold') to
+ * the cache, evicting the least recently used images to
+ * stay within the 'Thumbnail Cache Size' budget
+ * > On success, the cache takes ownership of the
+ *   pixels of 'img' and 'img' is cleared
+ * > On failure, 'img' is left untouched */
+bool gfx_thumbnail_cache_add(
+      const char *path, struct texture_image *img,
+      bool supports_rgba, unsigned upscale_threshold);
+
+/* Frees all cached images */
+void gfx_thumbnail_cache_free(void);
+
+/* Prefetching */
+
+/* Queues background loads of the thumbnails of the
+ * playlist entries that are about to scroll into view,
+ * so that they can be taken from the image cache when
+ * they are requested
+ * > 'first' and 'last' are the indices of the first and
+ *   last on screen entries of menu list 'list', whose
+ *   'entry_idx' values are indices into 'playlist'
+ * > The scroll direction and speed are tracked across
+ *   calls, so this should be called once per frame
+ *   while a playlist is displayed
+ * > Left thumbnails are only loaded if 'load_left'
+ *   is true
+ * NOTE: Must be called *after* gfx_thumbnail_set_system() */
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, file_list_t *list,
+      size_t first, size_t last, bool load_left,
+      unsigned gfx_thumbnail_upscale_threshold);
+
+/* Cancels all pending prefetch loads and releases
+ * the prefetch state */
+void gfx_thumbnail_prefetch_reset(void);
+
 gfx_thumbnail_state_t *gfx_thumb_get_ptr(void);
 
 RETRO_END_DECLS
@@ -316,6 +316,33 @@ bool gfx_thumbnail_set_system(gfx_thumbnail_path_data_t *path_data,
    return true;
 }
 
+/* Copies the current 'system' and thumbnail assignment
+ * metadata of 'src' to 'dst', so that 'dst' may be used
+ * to look up the thumbnails of other playlist entries
+ * without disturbing the content set on 'src'.
+ * Returns true if 'dst' was changed */
+bool gfx_thumbnail_copy_system(gfx_thumbnail_path_data_t *dst, gfx_thumbnail_path_data_t *src)
+{
+   if (!dst || !src)
+      return false;
+
+   if (     (dst->playlist_right_mode == src->playlist_right_mode)
+         && (dst->playlist_left_mode  == src->playlist_left_mode)
+         && string_is_equal(dst->system, src->system))
+      return false;
+
+   /* System determines the thumbnail directory, so
+    * right/left thumbnail paths must be regenerated */
+   dst->right_path[0]       = '\0';
+   dst->left_path[0]        = '\0';
+
+   dst->playlist_right_mode = src->playlist_right_mode;
+   dst->playlist_left_mode  = src->playlist_left_mode;
+   strlcpy(dst->system, src->system, sizeof(dst->system));
+
+   return true;
+}
+
 /* Sets current thumbnail content according to the specified label.
  * Returns true if content is valid */
 bool gfx_thumbnail_set_content(gfx_thumbnail_path_data_t *path_data, const char *label)
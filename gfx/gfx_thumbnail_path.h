@@ -90,6 +90,13 @@ bool gfx_thumbnail_is_enabled(gfx_thumbnail_path_data_t *path_data, enum gfx_thu
  *   associated database name */
 bool gfx_thumbnail_set_system(gfx_thumbnail_path_data_t *path_data, const char *system, playlist_t *playlist);
 
+/* Copies the current 'system' and thumbnail assignment
+ * metadata of 'src' to 'dst', so that 'dst' may be used
+ * to look up the thumbnails of other playlist entries
+ * without disturbing the content set on 'src'.
+ * Returns true if 'dst' was changed */
+bool gfx_thumbnail_copy_system(gfx_thumbnail_path_data_t *dst, gfx_thumbnail_path_data_t *src);
+
 /* Sets current thumbnail content according to the specified label.
  * Returns true if content is valid */
 bool gfx_thumbnail_set_content(gfx_thumbnail_path_data_t *path_data, const char *label);
@@ -95,6 +95,9 @@ COMPATIBILITY
 #include "../libretro-common/compat/compat_fnmatch.c"
 #include "../libretro-common/compat/fopen_utf8.c"
 #include "../libretro-common/memmap/memalign.c"
+#ifdef HAVE_MMAP
+#include "../libretro-common/memmap/memmap.c"
+#endif
 
 /*============================================================
 CONSOLE EXTENSIONS
@@ -1050,6 +1053,7 @@ FILE
 #include "../libretro-common/lists/dir_list.c"
 #include "../libretro-common/lists/string_list.c"
 #include "../libretro-common/lists/file_list.c"
+#include "../libretro-common/lists/trigram_index.c"
 #include "../libretro-common/file/retro_dirent.c"
 #include "../libretro-common/streams/file_stream.c"
 #include "../libretro-common/streams/file_stream_transforms.c"
@@ -1069,6 +1073,7 @@ FILE
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #if defined(__linux__)
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#include "../libretro-common/file/nbio/nbio_uring.c"
 #endif
 #if defined(HAVE_MMAP) && defined(BSD)
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
@@ -1316,6 +1321,9 @@ DATA RUNLOOP
 #include "../tasks/task_database.c"
 #include "../tasks/task_database_cue.c"
 #endif
+#ifdef HAVE_CHD
+#include "../tasks/task_chd_verify.c"
+#endif
 #if defined(HAVE_NETWORKING) && defined(HAVE_MENU)
 #include "../tasks/task_core_updater.c"
 #endif
@@ -1377,6 +1385,7 @@ MENU
 #include "../menu/menu_displaylist.c"
 #ifdef HAVE_LIBRETRODB
 #include "../menu/menu_explore.c"
+#include "../tasks/task_menu_explore.c"
 #endif
 #endif
 
@@ -58,6 +58,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_EXPLORE_ITEM,
    "explore_item"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST,
+   "explore_initialising_list"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_ADD_TAB,
    "add_tab"
@@ -1112,6 +1116,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_CHECK_FOR_MISSING_FIRMWARE,
    "check_for_missing_firmware"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_CONTENT_EXTRACTION_CACHE_SIZE,
+   "content_extraction_cache_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_DUMMY_ON_CORE_SHUTDOWN,
    "dummy_on_core_shutdown"
@@ -2566,6 +2574,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SCAN_FILE,
    "scan_file"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VERIFY_CHD,
+   "verify_chd"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_NETPLAY_REFRESH_ROOMS,
    "refresh_rooms"
@@ -2756,6 +2768,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "menu_thumbnail_cache_size"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_DERIVATIVE_CACHE,
+   "menu_thumbnail_derivative_cache"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
@@ -2736,6 +2736,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_CHECK_FOR_MISSING_FIRMWARE,
    "Check if all the required firmware is present before attempting to load content."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_CONTENT_EXTRACTION_CACHE_SIZE,
+   "Extraction Cache Size (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_CONTENT_EXTRACTION_CACHE_SIZE,
+   "The disk space (in MB) used in the cache directory to keep content extracted from archives, so loading it again does not decompress it again. Set to 0 to extract to a temporary file every time."
+   )
 #ifndef HAVE_DYNAMIC
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_ALWAYS_RELOAD_CORE_ON_RUN_CONTENT,
@@ -4435,6 +4443,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+   "Thumbnail Cache Size (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "The amount of memory (in MB) used to keep recently viewed thumbnails, so scrolling back to them does not load the image files again. Set to 0 to disable."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DERIVATIVE_CACHE,
+   "Cache Scaled Thumbnails"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_DERIVATIVE_CACHE,
+   "Save copies of thumbnail images scaled down to the size at which the menu displays them, in a format that loads quickly. Reduces loading times and video memory usage of large thumbnails. Copies are stored in the cache directory, or the thumbnails directory if no cache directory is set."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_TICKER_TYPE,
    "Ticker Text Animation"
@@ -5465,6 +5489,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SCAN_FILE,
    "Scans a file for content that matches the database."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VERIFY_CHD,
+   "Verify CHD"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VERIFY_CHD,
+   "Decompresses a CHD image and checks it against the checksum stored in it."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MANUAL_CONTENT_SCAN_LIST,
    "Manual Scan"
@@ -5657,6 +5689,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_EXPLORE_BY_SYSTEM_NAME,
    "By System Name"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_EXPLORE_INITIALISING_LIST,
+   "Initialising list..."
+   )
 
 /* Playlist > Playlist Item */
 
@@ -11246,6 +11282,30 @@ MSG_HASH(
    MSG_MANUAL_CONTENT_SCAN_END,
    "Scan complete: "
    )
+MSG_HASH(
+   MSG_CHD_VERIFY_START,
+   "Verifying CHD: "
+   )
+MSG_HASH(
+   MSG_CHD_VERIFY_PASSED,
+   "CHD verified: "
+   )
+MSG_HASH(
+   MSG_CHD_VERIFY_FAILED,
+   "CHD is corrupt: "
+   )
+MSG_HASH(
+   MSG_CHD_VERIFY_NO_CHECKSUM,
+   "CHD has no checksum: "
+   )
+MSG_HASH(
+   MSG_CHD_VERIFY_READ_ERROR,
+   "Could not open CHD: "
+   )
+MSG_HASH(
+   MSG_IMAGE_DECODE_QUEUE_DEPTH,
+   "Image decode queue: "
+   )
 MSG_HASH(
    MSG_CORE_BACKUP_SCANNING_CORE,
    "Scanning core: "
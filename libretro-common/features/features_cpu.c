@@ -281,7 +281,8 @@ void x86_cpuid(int func, int flags[4])
          "cpuid\n"
          "xchg %%" REG_b ", %%" REG_S "\n"
          : "=a"(flags[0]), "=S"(flags[1]), "=c"(flags[2]), "=d"(flags[3])
-         : "a"(func));
+         /* Leaf 7 has sub-leaves, we always want the first one */
+         : "a"(func), "c"(0));
 #elif defined(_MSC_VER)
    __cpuid(flags, func);
 #else
@@ -792,6 +793,66 @@ uint64_t cpu_features_get(void)
    return cpu;
 }
 
+/**
+ * cpu_features_get_extended:
+ *
+ * Gets the CPU features used by the hashing routines.
+ *
+ * Returns: bitmask of CPU_FEATURE_* flags.
+ **/
+uint64_t cpu_features_get_extended(void)
+{
+   uint64_t cpu        = 0;
+#if defined(__MACH__) && (defined(__aarch64__) || defined(__arm64__))
+   int value           = 0;
+   size_t len          = sizeof(value);
+   if (     sysctlbyname("hw.optional.armv8_crc32", &value, &len, NULL, 0) == 0
+         && value)
+      cpu |= CPU_FEATURE_CRC32;
+
+   /* Every Apple ARMv8 CPU has the SHA1 instructions */
+   cpu |= CPU_FEATURE_SHA1;
+#elif defined(_WIN32) && defined(_M_ARM64)
+   if (IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE))
+      cpu |= CPU_FEATURE_CRC32;
+   if (IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE))
+      cpu |= CPU_FEATURE_SHA1;
+#elif defined(CPU_X86) && !defined(__MACH__) && !defined(_XBOX1)
+   int flags[4];
+   unsigned max_flag   = 0;
+
+   x86_cpuid(0, flags);
+   max_flag = flags[0];
+   if (max_flag < 1)
+      return 0;
+
+   x86_cpuid(1, flags);
+
+   /* The accelerated routines also use SSSE3 and SSE4.1 */
+   if (     !(flags[2] & (1 << 9))
+         || !(flags[2] & (1 << 19)))
+      return 0;
+
+   if (flags[2] & (1 << 1))
+      cpu |= CPU_FEATURE_PCLMUL;
+
+   if (max_flag >= 7)
+   {
+      x86_cpuid(7, flags);
+      if (flags[1] & (1 << 29))
+         cpu |= CPU_FEATURE_SHA1;
+   }
+#elif defined(__linux__) && !defined(CPU_X86)
+   if (check_arm_cpu_feature("crc32"))
+      cpu |= CPU_FEATURE_CRC32;
+
+   if (check_arm_cpu_feature("sha1"))
+      cpu |= CPU_FEATURE_SHA1;
+#endif
+
+   return cpu;
+}
+
 void cpu_features_get_model_name(char *name, int len)
 {
 #if defined(CPU_X86) && !defined(__MACH__)
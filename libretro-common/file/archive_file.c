@@ -604,6 +604,31 @@ int file_archive_compressed_read(
    return 0;
 }
 
+int64_t file_archive_get_stored_file_offset(const char *path,
+      int64_t *size)
+{
+   const struct
+      file_archive_file_backend *backend = NULL;
+   struct string_list *str_list          = file_archive_filename_split(path);
+   int64_t offset                        = -1;
+
+   if (!str_list)
+      return -1;
+
+   if (str_list->size > 1)
+   {
+      backend = file_archive_get_file_backend(str_list->elems[0].data);
+
+      if (backend && backend->compressed_file_offset)
+         offset = backend->compressed_file_offset(str_list->elems[0].data,
+               str_list->elems[1].data, size);
+   }
+
+   string_list_free(str_list);
+
+   return offset;
+}
+
 const struct file_archive_file_backend *file_archive_get_zlib_file_backend(void)
 {
 #ifdef HAVE_ZLIB
@@ -656,19 +681,35 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
    return NULL;
 }
 
+static int file_archive_get_file_size_cb(const char *name,
+      const char *valid_exts, const uint8_t *cdata,
+      unsigned cmode, uint32_t csize, uint32_t size,
+      uint32_t checksum, struct archive_extract_userdata *userdata)
+{
+   *(uint32_t*)userdata->cb_data = size;
+   return 1;
+}
+
 /**
- * file_archive_get_file_crc32:
+ * file_archive_get_file_info:
  * @path                         : filename path of archive
+ * @crc                          : CRC32 of the file
+ * @size                         : uncompressed size of the file
  *
- * Returns: CRC32 of the specified file in the archive, otherwise 0.
+ * Looks up a file in an archive, without extracting it.
  * If no path within the archive is specified, the first
  * file found inside is used.
+ *
+ * Returns: true if the file was found, otherwise false.
  **/
-uint32_t file_archive_get_file_crc32(const char *path)
+bool file_archive_get_file_info(const char *path,
+      uint32_t *crc, uint32_t *size)
 {
    file_archive_transfer_t state;
    struct archive_extract_userdata userdata        = {0};
    bool returnerr                                  = false;
+   bool found                                      = false;
+   uint32_t file_size                              = 0;
    const char *archive_path                        = NULL;
    bool contains_compressed = path_contains_compressed_file(path);
 
@@ -693,37 +734,80 @@ uint32_t file_archive_get_file_crc32(const char *path)
    state.step_current      = 0;
    state.backend           = NULL;
 
+   userdata.cb_data        = &file_size;
+
    /* Initialize and open archive first.
       Sets next state type to ITERATE. */
    file_archive_parse_file_iterate(&state,
             &returnerr, path, NULL, NULL,
             &userdata);
 
-   for (;;)
+   /* Jump straight to the file if the backend can find it */
+   if (     archive_path
+         && state.type == ARCHIVE_TRANSFER_ITERATE
+         && state.backend->archive_parse_file_find)
    {
-      /* Now find the first file in the archive. */
-      if (state.type == ARCHIVE_TRANSFER_ITERATE)
+      if (state.backend->archive_parse_file_find(
+               state.context, archive_path) == 1)
+      {
          file_archive_parse_file_iterate(&state,
-                  &returnerr, path, NULL, NULL,
-                  &userdata);
+               &returnerr, path, NULL, file_archive_get_file_size_cb,
+               &userdata);
+         found = (state.step_current > 0);
+      }
+   }
+   else
+   {
+      while (state.type == ARCHIVE_TRANSFER_ITERATE)
+      {
+         /* Now find the first file in the archive. */
+         file_archive_parse_file_iterate(&state,
+               &returnerr, path, NULL, file_archive_get_file_size_cb,
+               &userdata);
 
-      /* If no path specified within archive, stop after
-       * finding the first file.
-       */
-      if (!contains_compressed)
-         break;
+         /* Stepped past the last file */
+         if (state.type != ARCHIVE_TRANSFER_ITERATE)
+            break;
 
-      /* Stop when the right file in the archive is found. */
-      if (archive_path)
-      {
+         /* If no path specified within archive, stop after
+          * finding the first file.
+          */
+         if (!contains_compressed || !archive_path)
+         {
+            found = true;
+            break;
+         }
+
+         /* Stop when the right file in the archive is found. */
          if (string_is_equal(userdata.current_file_path, archive_path))
+         {
+            found = true;
             break;
+         }
       }
-      else
-         break;
    }
 
    file_archive_parse_file_iterate_stop(&state);
 
-   return userdata.crc;
+   if (crc)
+      *crc  = found ? userdata.crc : 0;
+   if (size)
+      *size = found ? file_size    : 0;
+
+   return found;
+}
+
+/**
+ * file_archive_get_file_crc32:
+ * @path                         : filename path of archive
+ *
+ * Returns: CRC32 of the specified file in the archive, otherwise 0.
+ * If no path within the archive is specified, the first
+ * file found inside is used.
+ **/
+uint32_t file_archive_get_file_crc32(const char *path)
+{
+   uint32_t crc = 0;
+   file_archive_get_file_info(path, &crc, NULL);
+   return crc;
 }
@@ -515,9 +515,11 @@ const struct file_archive_file_backend sevenzip_backend = {
    sevenzip_parse_file_init,
    sevenzip_parse_file_iterate_step,
    sevenzip_parse_file_free,
+   NULL, /* find */
    sevenzip_stream_decompress_data_to_file_init,
    sevenzip_stream_decompress_data_to_file_iterate,
    sevenzip_stream_crc32_calculate,
    sevenzip_file_read,
+   NULL, /* offset */
    "7z"
 };
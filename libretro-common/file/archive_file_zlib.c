@@ -24,12 +24,18 @@
 #include <string.h>
 
 #include <file/archive_file.h>
+#include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
+#include <string/stdstring.h>
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <encodings/crc32.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 /* Only for MAX_WBITS */
 #include <zlib.h>
 
@@ -47,17 +53,52 @@ enum file_archive_compression_mode
    ZIP_MODE_DEFLATED = 8
 };
 
+/* Upper bound for file_archive_zip_index_cache_init() */
+#define ZIP_INDEX_CACHE_MAX 64
+
+/* Central directory of an archive, with its entries
+ * hashed by name */
+typedef struct zip_index
+{
+   char *path;
+   uint8_t *directory;
+   /* Offset of each entry in 'directory', in archive order */
+   uint32_t *entries;
+   /* Chains of entries with the same name hash;
+    * both hold entry numbers + 1, 0 ends a chain */
+   uint32_t *buckets;
+   uint32_t *next;
+   int64_t archive_size;
+   int64_t mtime;
+   uint32_t num_entries;
+   uint32_t bucket_mask;
+   uint32_t last_used;
+   /* Held by the cache and by each open archive */
+   unsigned refcount;
+   /* Set if the directory has an entry which
+    * cannot be parsed after the last indexed one */
+   bool bad_entry;
+} zip_index_t;
+
 typedef struct
 {
    struct file_archive_transfer *state;
-   uint8_t *directory;
-   uint8_t *directory_entry;
-   uint8_t *directory_end;
+   zip_index_t *index;
+   /* Next entry to be returned by the iterate step */
+   uint32_t entry;
    void    *current_stream;
    uint8_t *compressed_data;
    uint8_t *decompressed_data;
 } zip_context_t;
 
+static zip_index_t *zip_index_cache[ZIP_INDEX_CACHE_MAX];
+/* 0 while the cache is disabled */
+static unsigned zip_index_cache_size     = 0;
+static uint32_t zip_index_cache_counter  = 0;
+#ifdef HAVE_THREADS
+static slock_t *zip_index_cache_lock     = NULL;
+#endif
+
 static INLINE uint32_t read_le(const uint8_t *data, unsigned size)
 {
    unsigned i;
@@ -226,7 +267,8 @@ static bool zip_file_decompressed_handle(
       const uint8_t *cdata, unsigned cmode, uint32_t csize,
       uint32_t size, uint32_t crc32)
 {
-   int ret   = 0;
+   int ret                    = 0;
+   zip_context_t *zip_context = (zip_context_t*)transfer->context;
 
    transfer->backend = &zlib_backend;
 
@@ -240,6 +282,31 @@ static bool zip_file_decompressed_handle(
             transfer->context, handle);
    }while (ret == 0);
 
+   if (ret != 1 || !handle->data)
+   {
+      handle->data = NULL;
+      return false;
+   }
+
+   /* The caller owns the data, which must outlive the
+    * archive: take it from the context, or copy it out
+    * of the archive if it was stored */
+   if (handle->data == zip_context->decompressed_data)
+      zip_context->decompressed_data = NULL;
+   else
+   {
+      uint8_t *data = (uint8_t*)malloc(size ? size : 1);
+
+      if (!data)
+      {
+         handle->data = NULL;
+         return false;
+      }
+
+      memcpy(data, handle->data, size);
+      handle->data = data;
+   }
+
 #if 0
    handle->real_checksum = transfer->backend->stream_crc_calculate(0,
          handle->data, size);
@@ -323,17 +390,21 @@ static int zip_file_decompressed(
    return 1;
 }
 
+static int zip_parse_file_find(void *context, const char *needle);
+
 static int64_t zip_file_read(
       const char *path,
       const char *needle, void **buf,
       const char *optional_outfile)
 {
-   file_archive_transfer_t state            = {ARCHIVE_TRANSFER_INIT};
+   file_archive_transfer_t state            = {0};
    decomp_state_t decomp                    = {0};
    struct archive_extract_userdata userdata = {0};
    bool returnerr                           = true;
    int ret                                  = 0;
 
+   state.type        = ARCHIVE_TRANSFER_INIT;
+
    if (needle)
       decomp.needle          = strdup(needle);
    if (optional_outfile)
@@ -343,13 +414,22 @@ static int64_t zip_file_read(
    userdata.cb_data = &decomp;
    decomp.buf                = buf;
 
-   do
-   {
+   /* Open the archive, then jump straight to the
+    * entry if its name matches exactly */
+   ret = file_archive_parse_file_iterate(&state, &returnerr, path,
+         "", zip_file_decompressed, &userdata);
+
+   if (     ret == 0
+         && decomp.needle
+         && state.type == ARCHIVE_TRANSFER_ITERATE
+         && zip_parse_file_find(state.context, decomp.needle) == 1)
+      ret = file_archive_parse_file_iterate(&state, &returnerr, path,
+            "", zip_file_decompressed, &userdata);
+
+   /* Otherwise, take the first entry containing it */
+   while (ret == 0 && returnerr && !decomp.found)
       ret = file_archive_parse_file_iterate(&state, &returnerr, path,
             "", zip_file_decompressed, &userdata);
-      if (!returnerr)
-         break;
-   }while (ret == 0 && !decomp.found);
 
    file_archive_parse_file_iterate_stop(&state);
 
@@ -364,19 +444,74 @@ static int64_t zip_file_read(
    return (int64_t)decomp.size;
 }
 
-static int zip_parse_file_init(file_archive_transfer_t *state,
-      const char *file)
+/* FNV-1a */
+static uint32_t zip_index_hash(const uint8_t *name, size_t len)
+{
+   uint32_t hash = 0x811c9dc5;
+
+   while (len--)
+   {
+      hash ^= *name++;
+      hash *= 0x01000193;
+   }
+
+   return hash;
+}
+
+static void zip_index_free(zip_index_t *index)
+{
+   if (!index)
+      return;
+
+   if (index->path)
+      free(index->path);
+   if (index->directory)
+      free(index->directory);
+   if (index->entries)
+      free(index->entries);
+   if (index->buckets)
+      free(index->buckets);
+   if (index->next)
+      free(index->next);
+   free(index);
+}
+
+/* Must be called with the cache lock held */
+static void zip_index_unref(zip_index_t *index)
+{
+   if (index && --index->refcount == 0)
+      zip_index_free(index);
+}
+
+static void zip_index_release(zip_index_t *index)
+{
+#ifdef HAVE_THREADS
+   if (zip_index_cache_lock)
+      slock_lock(zip_index_cache_lock);
+#endif
+   zip_index_unref(index);
+#ifdef HAVE_THREADS
+   if (zip_index_cache_lock)
+      slock_unlock(zip_index_cache_lock);
+#endif
+}
+
+/* Reads the central directory of the archive and
+ * hashes the name of every entry in it */
+static zip_index_t *zip_index_load(RFILE *file, int64_t archive_size)
 {
    uint8_t footer_buf[1024];
    uint8_t *footer = footer_buf;
-   int64_t read_pos = state->archive_size;
+   int64_t read_pos = archive_size;
    int64_t read_block = MIN(read_pos, sizeof(footer_buf));
    int64_t directory_size, directory_offset;
-   zip_context_t *zip_context = NULL;
+   uint8_t *entry, *directory_end;
+   uint32_t i, num_buckets;
+   zip_index_t *index = NULL;
 
    /* Minimal ZIP file size is 22 bytes */
    if (read_block < 22)
-      return -1;
+      return NULL;
 
    /* Find the end of central directory record by scanning
     * the file from the end towards the beginning.
@@ -386,25 +521,25 @@ static int zip_parse_file_init(file_archive_transfer_t *state,
       if (--footer < footer_buf)
       {
          if (read_pos <= 0)
-            return -1; /* reached beginning of file */
+            return NULL; /* reached beginning of file */
 
          /* Read 21 bytes of overlaps except on the first block. */
-         if (read_pos == state->archive_size)
+         if (read_pos == archive_size)
             read_pos = read_pos - read_block;
          else
             read_pos = MAX(read_pos - read_block + 21, 0);
 
          /* Seek to read_pos and read read_block bytes. */
-         filestream_seek(state->archive_file, read_pos, RETRO_VFS_SEEK_POSITION_START);
-         if (filestream_read(state->archive_file, footer_buf, read_block) != read_block)
-            return -1;
+         filestream_seek(file, read_pos, RETRO_VFS_SEEK_POSITION_START);
+         if (filestream_read(file, footer_buf, read_block) != read_block)
+            return NULL;
 
          footer = footer_buf + read_block - 22;
       }
       if (read_le(footer, 4) == END_OF_CENTRAL_DIR_SIGNATURE)
       {
          unsigned comment_len = read_le(footer + 20, 2);
-         if (read_pos + (footer - footer_buf) + 22 + comment_len == state->archive_size)
+         if (read_pos + (footer - footer_buf) + 22 + comment_len == archive_size)
             break; /* found it! */
       }
    }
@@ -412,31 +547,241 @@ static int zip_parse_file_init(file_archive_transfer_t *state,
    /* Read directory info and do basic sanity checks. */
    directory_size   = read_le(footer + 12, 4);
    directory_offset = read_le(footer + 16, 4);
-   if (directory_size > state->archive_size
-         || directory_offset > state->archive_size)
+   if (directory_size > archive_size
+         || directory_offset > archive_size)
+      return NULL;
+
+   if (!(index = (zip_index_t*)calloc(1, sizeof(*index))))
+      return NULL;
+
+   index->archive_size = archive_size;
+
+   /* One extra byte, so that an empty directory
+    * is not a zero-sized allocation */
+   if (!(index->directory = (uint8_t*)malloc((size_t)directory_size + 1)))
+      goto error;
+
+   filestream_seek(file, directory_offset, RETRO_VFS_SEEK_POSITION_START);
+   if (filestream_read(file, index->directory, directory_size) != directory_size)
+      goto error;
+
+   /* Count the entries which can be parsed */
+   directory_end = index->directory + (size_t)directory_size;
+
+   for (entry = index->directory; entry + 46 <= directory_end;)
+   {
+      uint32_t namelength;
+      uint32_t payload;
+
+      if (read_le(entry, 4) != CENTRAL_FILE_HEADER_SIGNATURE)
+         break;
+
+      namelength = read_le(entry + 28, 2);
+      payload    = 46 + namelength
+         + read_le(entry + 30, 2)  /* extra field length */
+         + read_le(entry + 32, 2); /* file comment length */
+
+      if (namelength >= PATH_MAX_LENGTH)
+      {
+         index->bad_entry = true;
+         break;
+      }
+
+      if (entry + 46 + namelength > directory_end)
+         break;
+
+      index->num_entries++;
+      entry += payload;
+   }
+
+   for (num_buckets = 1; num_buckets < index->num_entries; num_buckets <<= 1);
+
+   index->bucket_mask = num_buckets - 1;
+   index->entries     = (uint32_t*)malloc(
+         (index->num_entries + 1) * sizeof(uint32_t));
+   index->next        = (uint32_t*)malloc(
+         (index->num_entries + 1) * sizeof(uint32_t));
+   index->buckets     = (uint32_t*)calloc(num_buckets, sizeof(uint32_t));
+
+   if (!index->entries || !index->next || !index->buckets)
+      goto error;
+
+   for (i = 0, entry = index->directory; i < index->num_entries; i++)
+   {
+      index->entries[i] = (uint32_t)(entry - index->directory);
+      entry            += 46
+         + read_le(entry + 28, 2)
+         + read_le(entry + 30, 2)
+         + read_le(entry + 32, 2);
+   }
+
+   /* Insert backwards, so that the first of several
+    * entries with the same name heads its chain */
+   for (i = index->num_entries; i-- > 0;)
+   {
+      const uint8_t *name = index->directory + index->entries[i];
+      uint32_t bucket     = zip_index_hash(name + 46,
+            read_le(name + 28, 2)) & index->bucket_mask;
+
+      index->next[i]          = index->buckets[bucket];
+      index->buckets[bucket]  = i + 1;
+   }
+
+   index->refcount = 1;
+
+   return index;
+
+error:
+   zip_index_free(index);
+   return NULL;
+}
+
+/* Returns the index of the archive at path, from the
+ * cache when the archive has not changed since */
+static zip_index_t *zip_index_acquire(const char *path,
+      RFILE *file, int64_t archive_size)
+{
+   unsigned i;
+   zip_index_t *index = NULL;
+   int64_t mtime      = 0;
+
+   /* Without a modification time, a cached index
+    * could not be told apart from a stale one */
+   if (zip_index_cache_size)
+      mtime = path_get_mtime(path);
+
+   if (mtime)
+   {
+#ifdef HAVE_THREADS
+      slock_lock(zip_index_cache_lock);
+#endif
+      for (i = 0; i < zip_index_cache_size; i++)
+      {
+         zip_index_t *cached = zip_index_cache[i];
+
+         if (     cached
+               && cached->archive_size == archive_size
+               && cached->mtime        == mtime
+               && string_is_equal(cached->path, path))
+         {
+            index            = cached;
+            index->refcount++;
+            index->last_used = ++zip_index_cache_counter;
+            break;
+         }
+      }
+#ifdef HAVE_THREADS
+      slock_unlock(zip_index_cache_lock);
+#endif
+
+      if (index)
+         return index;
+   }
+
+   if (!(index = zip_index_load(file, archive_size)))
+      return NULL;
+
+   if (mtime && (index->path = strdup(path)))
+   {
+      unsigned slot = 0;
+
+      index->mtime  = mtime;
+
+#ifdef HAVE_THREADS
+      slock_lock(zip_index_cache_lock);
+#endif
+      /* Replace an older index of the same archive,
+       * else an empty slot, else the least recently used */
+      for (i = 0; i < zip_index_cache_size; i++)
+      {
+         zip_index_t *cached = zip_index_cache[i];
+
+         if (!cached || string_is_equal(cached->path, path))
+         {
+            slot = i;
+            break;
+         }
+
+         if (cached->last_used < zip_index_cache[slot]->last_used)
+            slot = i;
+      }
+
+      /* The cache may have been disabled meanwhile */
+      if (slot < zip_index_cache_size)
+      {
+         zip_index_unref(zip_index_cache[slot]);
+         index->refcount++;
+         index->last_used      = ++zip_index_cache_counter;
+         zip_index_cache[slot] = index;
+      }
+#ifdef HAVE_THREADS
+      slock_unlock(zip_index_cache_lock);
+#endif
+   }
+
+   return index;
+}
+
+void file_archive_zip_index_cache_init(unsigned max)
+{
+   if (zip_index_cache_size)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!zip_index_cache_lock && !(zip_index_cache_lock = slock_new()))
+      return;
+#endif
+
+   zip_index_cache_size = MIN(max, ZIP_INDEX_CACHE_MAX);
+}
+
+void file_archive_zip_index_cache_deinit(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (!zip_index_cache_lock)
+      return;
+   slock_lock(zip_index_cache_lock);
+#endif
+   for (i = 0; i < zip_index_cache_size; i++)
+   {
+      zip_index_unref(zip_index_cache[i]);
+      zip_index_cache[i] = NULL;
+   }
+   zip_index_cache_size = 0;
+#ifdef HAVE_THREADS
+   slock_unlock(zip_index_cache_lock);
+   slock_free(zip_index_cache_lock);
+   zip_index_cache_lock = NULL;
+#endif
+}
+
+static int zip_parse_file_init(file_archive_transfer_t *state,
+      const char *file)
+{
+   zip_context_t *zip_context = NULL;
+   zip_index_t *index         = zip_index_acquire(file,
+         state->archive_file, state->archive_size);
+
+   if (!index)
       return -1;
 
-   /* This is a ZIP file, allocate one block of memory for both the
-    * context and the entire directory, then read the directory.
-    */
-   zip_context = (zip_context_t*)malloc(sizeof(zip_context_t) + (size_t)directory_size);
+   if (!(zip_context = (zip_context_t*)malloc(sizeof(zip_context_t))))
+   {
+      zip_index_release(index);
+      return -1;
+   }
+
    zip_context->state             = state;
-   zip_context->directory         = (uint8_t*)(zip_context + 1);
-   zip_context->directory_entry   = zip_context->directory;
-   zip_context->directory_end     = zip_context->directory + (size_t)directory_size;
+   zip_context->index             = index;
+   zip_context->entry             = 0;
    zip_context->current_stream    = NULL;
    zip_context->compressed_data   = NULL;
    zip_context->decompressed_data = NULL;
 
-   filestream_seek(state->archive_file, directory_offset, RETRO_VFS_SEEK_POSITION_START);
-   if (filestream_read(state->archive_file, zip_context->directory, directory_size) != directory_size)
-   {
-      free(zip_context);
-      return -1;
-   }
-
-   state->context = zip_context;
-   state->step_total = read_le(footer + 10, 2); /* total entries */;
+   state->context    = zip_context;
+   state->step_total = index->num_entries;
 
    return 0;
 }
@@ -445,40 +790,31 @@ static int zip_parse_file_iterate_step_internal(
       zip_context_t * zip_context, char *filename,
       const uint8_t **cdata,
       unsigned *cmode, uint32_t *size, uint32_t *csize,
-      uint32_t *checksum, unsigned *payback)
+      uint32_t *checksum)
 {
-   uint8_t *entry = zip_context->directory_entry;
-   uint32_t signature, namelength, extralength, commentlength, offset;
-
-   if (entry < zip_context->directory || entry >= zip_context->directory_end)
-      return 0;
+   const uint8_t *entry;
+   uint32_t namelength, offset;
+   zip_index_t *index = zip_context->index;
 
-   signature = read_le(zip_context->directory_entry + 0, 4);
-
-   if (signature != CENTRAL_FILE_HEADER_SIGNATURE)
-      return 0;
+   if (zip_context->entry >= index->num_entries)
+      return index->bad_entry ? -1 : 0;
 
-   *cmode         = read_le(zip_context->directory_entry + 10, 2); /* compression mode, 0 = store, 8 = deflate */
-   *checksum      = read_le(zip_context->directory_entry + 16, 4); /* CRC32 */
-   *csize         = read_le(zip_context->directory_entry + 20, 4); /* compressed size */
-   *size          = read_le(zip_context->directory_entry + 24, 4); /* uncompressed size */
+   entry          = index->directory + index->entries[zip_context->entry];
 
-   namelength     = read_le(zip_context->directory_entry + 28, 2); /* file name length */
-   extralength    = read_le(zip_context->directory_entry + 30, 2); /* extra field length */
-   commentlength  = read_le(zip_context->directory_entry + 32, 2); /* file comment length */
+   *cmode         = read_le(entry + 10, 2); /* compression mode, 0 = store, 8 = deflate */
+   *checksum      = read_le(entry + 16, 4); /* CRC32 */
+   *csize         = read_le(entry + 20, 4); /* compressed size */
+   *size          = read_le(entry + 24, 4); /* uncompressed size */
 
-   if (namelength >= PATH_MAX_LENGTH)
-      return -1;
+   namelength     = read_le(entry + 28, 2); /* file name length */
 
-   memcpy(filename, zip_context->directory_entry + 46, namelength); /* file name */
+   memcpy(filename, entry + 46, namelength); /* file name */
    filename[namelength] = '\0';
 
-   offset   = read_le(zip_context->directory_entry + 42, 4); /* relative offset of local file header */
+   offset   = read_le(entry + 42, 4); /* relative offset of local file header */
 
    *cdata   = (uint8_t*)(size_t)offset; /* store file offset in data pointer */
 
-   *payback = 46 + namelength + extralength + commentlength;
-
    return 1;
 }
 
@@ -492,9 +828,8 @@ static int zip_parse_file_iterate_step(void *context,
    uint32_t size                  = 0;
    uint32_t csize                 = 0;
    unsigned cmode                 = 0;
-   unsigned payload               = 0;
    int ret                        = zip_parse_file_iterate_step_internal(zip_context,
-         userdata->current_file_path, &cdata, &cmode, &size, &csize, &checksum, &payload);
+         userdata->current_file_path, &cdata, &cmode, &size, &csize, &checksum);
 
    if (ret != 1)
       return ret;
@@ -505,15 +840,92 @@ static int zip_parse_file_iterate_step(void *context,
             csize, size, checksum, userdata))
       return 0;
 
-   zip_context->directory_entry += payload;
+   zip_context->entry++;
 
    return 1;
 }
 
+/* Makes the entry named needle (not a directory) the
+ * next one to be iterated, if there is one */
+static int zip_parse_file_find(void *context, const char *needle)
+{
+   zip_context_t *zip_context = (zip_context_t *)context;
+   zip_index_t *index         = zip_context->index;
+   size_t len                 = strlen(needle);
+   uint32_t i                 = index->buckets[
+      zip_index_hash((const uint8_t*)needle, len) & index->bucket_mask];
+
+   if (!len || needle[len - 1] == '/' || needle[len - 1] == '\\')
+      return 0;
+
+   for (; i; i = index->next[i - 1])
+   {
+      const uint8_t *entry = index->directory + index->entries[i - 1];
+
+      if (     read_le(entry + 28, 2) == len
+            && !memcmp(entry + 46, needle, len))
+      {
+         zip_context->entry = i - 1;
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+static int64_t zip_file_stored_offset(const char *path,
+      const char *needle, int64_t *size)
+{
+   uint8_t local_header[4];
+   char name[PATH_MAX_LENGTH];
+   file_archive_transfer_t state = {0};
+   const uint8_t *cdata          = NULL;
+   uint32_t checksum             = 0;
+   uint32_t usize                = 0;
+   uint32_t csize                = 0;
+   unsigned cmode                = 0;
+   bool returnerr                = true;
+   int64_t offset                = -1;
+
+   state.type                    = ARCHIVE_TRANSFER_INIT;
+
+   file_archive_parse_file_iterate(&state, &returnerr, path,
+         NULL, NULL, NULL);
+
+   if (     state.type != ARCHIVE_TRANSFER_ITERATE
+         || zip_parse_file_find(state.context, needle) != 1
+         || zip_parse_file_iterate_step_internal(
+            (zip_context_t*)state.context, name, &cdata,
+            &cmode, &usize, &csize, &checksum) != 1
+         || cmode != ZIP_MODE_STORED
+         || csize != usize)
+      goto end;
+
+   /* The data follows the local header, whose name and
+    * extra field may differ from the central directory */
+   filestream_seek(state.archive_file, (int64_t)(size_t)cdata + 26,
+         RETRO_VFS_SEEK_POSITION_START);
+   if (filestream_read(state.archive_file, local_header, 4) != 4)
+      goto end;
+
+   offset = (int64_t)(size_t)cdata + 30
+      + read_le(local_header, 2) + read_le(local_header + 2, 2);
+
+   if (offset + usize > state.archive_size)
+      offset = -1;
+   else
+      *size  = usize;
+
+end:
+   file_archive_parse_file_iterate_stop(&state);
+   return offset;
+}
+
 static void zip_parse_file_free(void *context)
 {
    zip_context_t *zip_context = (zip_context_t *)context;
    zip_context_free_stream(zip_context, false);
+   zip_index_release(zip_context->index);
    free(zip_context);
 }
 
@@ -521,9 +933,11 @@ const struct file_archive_file_backend zlib_backend = {
    zip_parse_file_init,
    zip_parse_file_iterate_step,
    zip_parse_file_free,
+   zip_parse_file_find,
    zlib_stream_decompress_data_to_file_init,
    zlib_stream_decompress_data_to_file_iterate,
    zlib_stream_crc32_calculate,
    zip_file_read,
+   zip_file_stored_offset,
    "zlib"
 };
@@ -165,6 +165,58 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file or directory.
+ * Bypasses any frontend VFS interface, since it has no
+ * notion of timestamps.
+ *
+ * Returns: modification time in seconds since the epoch,
+ * or 0 if it cannot be determined on this platform.
+ **/
+int64_t path_get_mtime(const char *path)
+{
+#if defined(_WIN32)
+   struct _stat buf;
+#if defined(LEGACY_WIN32)
+   char *path_local   = NULL;
+#else
+   wchar_t *path_wide = NULL;
+#endif
+   int ret            = -1;
+
+   if (!path || !*path)
+      return 0;
+
+#if defined(LEGACY_WIN32)
+   path_local         = utf8_to_local_string_alloc(path);
+   if (path_local)
+   {
+      ret             = _stat(path_local, &buf);
+      free(path_local);
+   }
+#else
+   path_wide          = utf8_to_utf16_string_alloc(path);
+   if (path_wide)
+   {
+      ret             = _wstat(path_wide, &buf);
+      free(path_wide);
+   }
+#endif
+
+   if (ret == 0)
+      return (int64_t)buf.st_mtime;
+#elif !defined(VITA) && !defined(PSP) && !defined(ORBIS) && !(defined(__CELLOS_LV2__) && !defined(__PSL1GHT__))
+   struct stat buf;
+
+   if (path && *path && stat(path, &buf) == 0)
+      return (int64_t)buf.st_mtime;
+#endif
+   return 0;
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
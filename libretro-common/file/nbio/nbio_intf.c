@@ -30,6 +30,7 @@
 #include <file/nbio.h>
 
 extern nbio_intf_t nbio_linux;
+extern nbio_intf_t nbio_uring;
 extern nbio_intf_t nbio_mmap_unix;
 extern nbio_intf_t nbio_mmap_win32;
 #if defined(ORBIS)
@@ -55,7 +56,10 @@ extern nbio_intf_t nbio_stdio;
 
 #endif
 
-#if defined(_linux__)
+#if defined(__linux__) && defined(HAVE_IO_URING)
+/* Falls back to nbio_stdio by itself without io_uring */
+static nbio_intf_t *internal_nbio = &nbio_uring;
+#elif defined(_linux__)
 static nbio_intf_t *internal_nbio = &nbio_linux;
 #elif defined(HAVE_MMAP) && defined(BSD)
 static nbio_intf_t *internal_nbio = &nbio_mmap_unix;
@@ -0,0 +1,655 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <file/nbio.h>
+
+#if defined(__linux__) && defined(HAVE_IO_URING)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* C libraries older than the kernel headers may lack these */
+#ifndef __NR_io_uring_setup
+#if defined(__alpha__)
+#define __NR_io_uring_setup 535
+#define __NR_io_uring_enter 536
+#else
+#define __NR_io_uring_setup 425
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+/* Operations in flight at once, across all handles */
+#define NBIO_URING_ENTRIES 64
+
+/* All handles share one ring. Operations are only queued
+ * in it when they begin; the first nbio_iterate() after
+ * that submits everything queued so far with a single
+ * io_uring_enter(), and completions are then picked up
+ * from the shared memory ring without any system call.
+ *
+ * Without io_uring (old kernels, seccomp filters), each
+ * handle wraps a handle of the stdio backend instead. */
+
+enum nbio_uring_state
+{
+   /* No operation was done since open, the data is not valid */
+   NBIO_URING_NEW = 0,
+   NBIO_URING_IDLE,
+   /* Queued in the ring or in flight */
+   NBIO_URING_BUSY,
+   /* Waiting for room in the ring: it was full, or the
+    * last read or write was short */
+   NBIO_URING_RETRY
+};
+
+struct nbio_uring_t
+{
+   struct iovec iov;
+   struct nbio_uring_t *next;
+   void *ptr;
+   /* nbio_stdio handle, if there is no ring */
+   void *fallback;
+   size_t len;
+   size_t pos;
+   int fd;
+   unsigned mode;
+   enum nbio_uring_state state;
+   bool write;
+};
+
+struct nbio_uring_ring
+{
+   unsigned *sq_tail;
+   unsigned *sq_mask;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   unsigned *cq_mask;
+   struct io_uring_sqe *sqes;
+   struct io_uring_cqe *cqes;
+   /* Handles in the NBIO_URING_RETRY state, oldest first */
+   struct nbio_uring_t *waiting;
+   struct nbio_uring_t *waiting_tail;
+   void *sq_ptr;
+   void *cq_ptr;
+   size_t sq_size;
+   size_t cq_size;
+   unsigned sq_entries;
+   /* Queued and not submitted yet */
+   unsigned pending;
+   /* Submitted and not completed yet */
+   unsigned inflight;
+   int fd;
+   /* 0 not tried yet, 1 set up, -1 not available */
+   int status;
+};
+
+extern nbio_intf_t nbio_stdio;
+
+static struct nbio_uring_ring nbio_uring_ring;
+
+#ifdef HAVE_THREADS
+static slock_t *nbio_uring_lock = NULL;
+#define NBIO_URING_LOCK()   slock_lock(nbio_uring_lock)
+#define NBIO_URING_UNLOCK() slock_unlock(nbio_uring_lock)
+#else
+#define NBIO_URING_LOCK()
+#define NBIO_URING_UNLOCK()
+#endif
+
+static bool nbio_uring_setup(struct nbio_uring_ring *ring)
+{
+   struct io_uring_params p;
+   size_t sqes_size;
+   void *sqes;
+   int fd;
+
+   memset(&p, 0, sizeof(p));
+
+   fd = (int)syscall(__NR_io_uring_setup, NBIO_URING_ENTRIES, &p);
+   if (fd < 0)
+      return false;
+
+   ring->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   ring->cq_size = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   sqes_size     = p.sq_entries * sizeof(struct io_uring_sqe);
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      if (ring->cq_size > ring->sq_size)
+         ring->sq_size = ring->cq_size;
+      ring->cq_size    = ring->sq_size;
+   }
+#endif
+
+   ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+   if (ring->sq_ptr == MAP_FAILED)
+      goto error;
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+      ring->cq_ptr = ring->sq_ptr;
+   else
+#endif
+   {
+      ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (ring->cq_ptr == MAP_FAILED)
+         goto error_sq;
+   }
+
+   sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+   if (sqes == MAP_FAILED)
+      goto error_cq;
+
+   ring->sq_tail    = (unsigned*)((uint8_t*)ring->sq_ptr + p.sq_off.tail);
+   ring->sq_mask    = (unsigned*)((uint8_t*)ring->sq_ptr + p.sq_off.ring_mask);
+   ring->sq_array   = (unsigned*)((uint8_t*)ring->sq_ptr + p.sq_off.array);
+   ring->cq_head    = (unsigned*)((uint8_t*)ring->cq_ptr + p.cq_off.head);
+   ring->cq_tail    = (unsigned*)((uint8_t*)ring->cq_ptr + p.cq_off.tail);
+   ring->cq_mask    = (unsigned*)((uint8_t*)ring->cq_ptr + p.cq_off.ring_mask);
+   ring->cqes       = (struct io_uring_cqe*)
+      ((uint8_t*)ring->cq_ptr + p.cq_off.cqes);
+   ring->sqes       = (struct io_uring_sqe*)sqes;
+   ring->sq_entries = p.sq_entries;
+   ring->pending    = 0;
+   ring->inflight   = 0;
+   ring->fd         = fd;
+   return true;
+
+error_cq:
+   if (ring->cq_ptr != ring->sq_ptr)
+      munmap(ring->cq_ptr, ring->cq_size);
+error_sq:
+   munmap(ring->sq_ptr, ring->sq_size);
+error:
+   close(fd);
+   return false;
+}
+
+/* Sets the ring up the first time it is needed.
+ * Returns false if io_uring is not available. */
+static bool nbio_uring_init(void)
+{
+   bool ret;
+
+#ifdef HAVE_THREADS
+   /* rthreads has no static initializer and handles are
+    * opened from task threads, so publish the lock with a
+    * CAS and drop ours if another opener won the race. */
+   if (!__atomic_load_n(&nbio_uring_lock, __ATOMIC_ACQUIRE))
+   {
+      slock_t *lock     = slock_new();
+      slock_t *expected = NULL;
+      if (lock && !__atomic_compare_exchange_n(&nbio_uring_lock,
+               &expected, lock, false,
+               __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+         slock_free(lock);
+   }
+#endif
+
+   NBIO_URING_LOCK();
+   if (!nbio_uring_ring.status)
+      nbio_uring_ring.status = nbio_uring_setup(&nbio_uring_ring) ? 1 : -1;
+   ret = nbio_uring_ring.status > 0;
+   NBIO_URING_UNLOCK();
+
+   return ret;
+}
+
+/* Submits everything queued, waiting for 'wait'
+ * completions (of any handle) */
+static int nbio_uring_enter(unsigned wait)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+   int ret = (int)syscall(__NR_io_uring_enter, ring->fd, ring->pending,
+         wait, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+
+   if (ret > 0)
+   {
+      ring->pending  -= ret;
+      ring->inflight += ret;
+   }
+
+   return ret;
+}
+
+static void nbio_uring_wait_for_room(struct nbio_uring_t *handle)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+
+   handle->state = NBIO_URING_RETRY;
+   handle->next  = NULL;
+
+   if (ring->waiting_tail)
+      ring->waiting_tail->next = handle;
+   else
+      ring->waiting            = handle;
+   ring->waiting_tail          = handle;
+}
+
+static void nbio_uring_stop_waiting(struct nbio_uring_t *handle)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+   struct nbio_uring_t **prev   = &ring->waiting;
+   struct nbio_uring_t *last    = NULL;
+
+   while (*prev && *prev != handle)
+   {
+      last = *prev;
+      prev = &(*prev)->next;
+   }
+
+   if (!*prev)
+      return;
+
+   *prev = handle->next;
+   if (ring->waiting_tail == handle)
+      ring->waiting_tail = last;
+}
+
+/* Queues the rest of the handle's operation, if the ring has room */
+static void nbio_uring_queue(struct nbio_uring_t *handle)
+{
+   unsigned tail, index;
+   struct io_uring_sqe *sqe     = NULL;
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+
+   /* Keeps the completion ring (twice as large) from overflowing */
+   if (ring->pending + ring->inflight >= ring->sq_entries)
+   {
+      nbio_uring_wait_for_room(handle);
+      return;
+   }
+
+   tail                  = *ring->sq_tail;
+   index                 = tail & *ring->sq_mask;
+   sqe                   = &ring->sqes[index];
+
+   handle->iov.iov_base  = (uint8_t*)handle->ptr + handle->pos;
+   handle->iov.iov_len   = handle->len - handle->pos;
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode           = handle->write ? IORING_OP_WRITEV : IORING_OP_READV;
+   sqe->fd               = handle->fd;
+   sqe->off              = handle->pos;
+   sqe->addr             = (uint64_t)(uintptr_t)&handle->iov;
+   sqe->len              = 1;
+   sqe->user_data        = (uint64_t)(uintptr_t)handle;
+
+   ring->sq_array[index] = index;
+   __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+   ring->pending++;
+   handle->state         = NBIO_URING_BUSY;
+}
+
+/* Hands the completions posted so far to their handles */
+static void nbio_uring_reap(void)
+{
+   struct nbio_uring_ring *ring = &nbio_uring_ring;
+   unsigned head                = *ring->cq_head;
+   unsigned tail                = __atomic_load_n(ring->cq_tail,
+         __ATOMIC_ACQUIRE);
+
+   for (; head != tail; head++)
+   {
+      struct io_uring_cqe *cqe     = &ring->cqes[head & *ring->cq_mask];
+      struct nbio_uring_t *handle  = (struct nbio_uring_t*)
+         (uintptr_t)cqe->user_data;
+      int res                      = cqe->res;
+
+      ring->inflight--;
+
+      if (res > 0)
+      {
+         handle->pos += (size_t)res;
+         if (handle->pos < handle->len)
+         {
+            nbio_uring_wait_for_room(handle);
+            continue;
+         }
+      }
+      else if (res == -EAGAIN || res == -EINTR)
+      {
+         nbio_uring_wait_for_room(handle);
+         continue;
+      }
+      else if (!handle->write)
+      {
+         /* The file got shorter, or could not be read;
+          * only what was read is returned */
+         handle->len = handle->pos;
+      }
+
+      handle->state = NBIO_URING_IDLE;
+   }
+
+   __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+   /* Room was made for the handles waiting for it */
+   while (ring->waiting && ring->pending + ring->inflight < ring->sq_entries)
+   {
+      struct nbio_uring_t *handle = ring->waiting;
+
+      ring->waiting = handle->next;
+      if (!ring->waiting)
+         ring->waiting_tail = NULL;
+
+      nbio_uring_queue(handle);
+   }
+}
+
+/* Blocks until the handle's operation is over */
+static void nbio_uring_wait(struct nbio_uring_t *handle)
+{
+   for (;;)
+   {
+      nbio_uring_reap();
+
+      if (handle->state == NBIO_URING_IDLE)
+         break;
+
+      /* Something is queued or in flight when the handle
+       * is, so this does return */
+      if (     nbio_uring_enter(1) < 0
+            && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+         break;
+   }
+}
+
+/* Handle states are changed by whichever thread reaps
+ * their completion, so they are only looked at locked */
+static bool nbio_uring_busy(struct nbio_uring_t *handle)
+{
+   return handle->state == NBIO_URING_BUSY
+      ||  handle->state == NBIO_URING_RETRY;
+}
+
+static void nbio_uring_begin_op(struct nbio_uring_t *handle, bool write)
+{
+   NBIO_URING_LOCK();
+
+   if (nbio_uring_busy(handle))
+      abort();
+
+   handle->write = write;
+   handle->pos   = 0;
+
+   if (!handle->len)
+      handle->state = NBIO_URING_IDLE;
+   else
+   {
+      nbio_uring_queue(handle);
+      if (handle->mode == BIO_READ || handle->mode == BIO_WRITE)
+         nbio_uring_wait(handle);
+   }
+
+   NBIO_URING_UNLOCK();
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  = { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC, O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+   off_t len                   = 0;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)
+      calloc(1, sizeof(*handle));
+
+   if (!handle)
+      return NULL;
+
+   handle->fd   = -1;
+   handle->mode = mode;
+
+   if (!nbio_uring_init())
+   {
+      if (!(handle->fallback = nbio_stdio.open(filename, mode)))
+         goto error;
+      return handle;
+   }
+
+   handle->fd = open(filename, o_flags[mode] | O_CLOEXEC, 0644);
+   if (handle->fd < 0)
+      goto error;
+
+   len = lseek(handle->fd, 0, SEEK_END);
+   if (len < 0)
+      goto error;
+
+   if (len && !(handle->ptr = malloc((size_t)len)))
+      goto error;
+
+   handle->len   = (size_t)len;
+   handle->state = NBIO_URING_NEW;
+
+   return handle;
+
+error:
+   if (handle->fd >= 0)
+      close(handle->fd);
+   free(handle);
+   return NULL;
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+   if (handle->fallback)
+      nbio_stdio.begin_read(handle->fallback);
+   else
+      nbio_uring_begin_op(handle, false);
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+   if (handle->fallback)
+      nbio_stdio.begin_write(handle->fallback);
+   else
+      nbio_uring_begin_op(handle, true);
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   bool busy;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+
+   if (!handle)
+      return false;
+   if (handle->fallback)
+      return nbio_stdio.iterate(handle->fallback);
+
+   NBIO_URING_LOCK();
+
+   nbio_uring_reap();
+
+   /* Submits what every handle queued since the last call,
+    * completions which are ready right away come with it */
+   if (nbio_uring_ring.pending && nbio_uring_enter(0) > 0)
+      nbio_uring_reap();
+
+   busy = nbio_uring_busy(handle);
+
+   NBIO_URING_UNLOCK();
+
+   return !busy;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   void *ptr                   = NULL;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+   if (handle->fallback)
+   {
+      nbio_stdio.resize(handle->fallback, len);
+      return;
+   }
+
+   NBIO_URING_LOCK();
+   if (nbio_uring_busy(handle))
+      abort();
+   NBIO_URING_UNLOCK();
+
+   if (len < handle->len)
+      abort();
+
+   if (ftruncate(handle->fd, (off_t)len) != 0)
+      abort(); /* same as nbio_linux, there is no way to report it */
+
+   if (!(ptr = realloc(handle->ptr, len)))
+      abort();
+
+   handle->ptr   = ptr;
+   handle->len   = len;
+   handle->state = NBIO_URING_IDLE;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   void *ptr                   = NULL;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+   if (handle->fallback)
+      return nbio_stdio.get_ptr(handle->fallback, len);
+   NBIO_URING_LOCK();
+   if (len)
+      *len = handle->len;
+   if (handle->state == NBIO_URING_IDLE)
+      ptr = handle->ptr;
+   NBIO_URING_UNLOCK();
+
+   return ptr;
+}
+
+/* Reads and writes of regular files cannot be stopped
+ * halfway, so this waits for the operation to be over,
+ * after which the buffer can be freed */
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+   if (handle->fallback)
+   {
+      nbio_stdio.cancel(handle->fallback);
+      return;
+   }
+
+   NBIO_URING_LOCK();
+   if (handle->state == NBIO_URING_RETRY)
+   {
+      nbio_uring_stop_waiting(handle);
+      handle->state = NBIO_URING_IDLE;
+   }
+   else if (handle->state == NBIO_URING_BUSY)
+      nbio_uring_wait(handle);
+   NBIO_URING_UNLOCK();
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   /* Both kinds of handle can be freed while busy */
+   if (handle->fallback)
+   {
+      nbio_stdio.cancel(handle->fallback);
+      nbio_stdio.free(handle->fallback);
+   }
+   else
+   {
+      bool busy;
+
+      nbio_uring_cancel(handle);
+
+      NBIO_URING_LOCK();
+      busy = handle->state == NBIO_URING_BUSY;
+      NBIO_URING_UNLOCK();
+
+      /* The kernel still owns the buffer, leaking it
+       * is all that can be done */
+      if (busy)
+         return;
+
+      close(handle->fd);
+      free(handle->ptr);
+   }
+
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   "nbio_uring",
+};
+#else
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
@@ -27,6 +27,12 @@
 
 #include <boolean.h>
 #include <formats/image.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
+#ifdef HAVE_RJPEG
+#include <formats/rjpeg.h>
+#endif
 #include <file/nbio.h>
 #include <string/stdstring.h>
 
@@ -196,7 +202,8 @@ static bool image_texture_load_internal(
       size_t len,
       struct texture_image *out_img,
       unsigned a_shift, unsigned r_shift,
-      unsigned g_shift, unsigned b_shift)
+      unsigned g_shift, unsigned b_shift,
+      unsigned target_width, unsigned target_height)
 {
    int ret;
    bool success = false;
@@ -207,6 +214,11 @@ static bool image_texture_load_internal(
 
    image_transfer_set_buffer_ptr(img, type, (uint8_t*)ptr, len);
 
+#ifdef HAVE_RJPEG
+   if (type == IMAGE_TYPE_JPEG)
+      rjpeg_set_target_size((rjpeg_t*)img, target_width, target_height);
+#endif
+
    if (!image_transfer_start(img, type))
       goto end;
 
@@ -215,6 +227,15 @@ static bool image_texture_load_internal(
    if (!image_transfer_is_valid(img, type))
       goto end;
 
+#ifdef HAVE_RPNG
+   /* Nothing to interleave with here, so PNGs
+    * are decoded in a single call */
+   if (type == IMAGE_TYPE_PNG)
+      ret = rpng_decode_image((rpng_t*)img,
+            (void**)&out_img->pixels, &out_img->width,
+            &out_img->height);
+   else
+#endif
    do
    {
       ret = image_transfer_process(img, type,
@@ -268,7 +289,7 @@ bool image_texture_load_buffer(struct texture_image *out_img,
    {
       if (image_texture_load_internal(
          type, buffer, buffer_len, out_img,
-         a_shift, r_shift, g_shift, b_shift))
+         a_shift, r_shift, g_shift, b_shift, 0, 0))
       {
          return true;
       }
@@ -282,8 +303,8 @@ bool image_texture_load_buffer(struct texture_image *out_img,
    return false;
 }
 
-bool image_texture_load(struct texture_image *out_img,
-      const char *path)
+static bool image_texture_load_path(struct texture_image *out_img,
+      const char *path, unsigned target_width, unsigned target_height)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
    size_t file_len             = 0;
@@ -311,7 +332,8 @@ bool image_texture_load(struct texture_image *out_img,
       if (image_texture_load_internal(
                type,
                ptr, file_len, out_img,
-               a_shift, r_shift, g_shift, b_shift))
+               a_shift, r_shift, g_shift, b_shift,
+               target_width, target_height))
          goto success;
    }
 
@@ -331,3 +353,15 @@ success:
 
    return true;
 }
+
+bool image_texture_load(struct texture_image *out_img,
+      const char *path)
+{
+   return image_texture_load_path(out_img, path, 0, 0);
+}
+
+bool image_texture_load_scaled(struct texture_image *out_img,
+      const char *path, unsigned width, unsigned height)
+{
+   return image_texture_load_path(out_img, path, width, height);
+}
@@ -68,6 +68,8 @@ typedef struct
 struct rjpeg
 {
    uint8_t *buff_data;
+   unsigned target_width;
+   unsigned target_height;
 };
 
 #ifdef _MSC_VER
@@ -124,6 +126,17 @@ struct rjpeg
 
 #endif
 
+/* AVX2 colour conversion. Compilers which support per-function
+ * targets build it regardless of -m flags, it is only used when
+ * cpu_features_get() reports it. */
+#if defined(__SSE2__) && !defined(RJPEG_NO_SIMD)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#include <immintrin.h>
+#define RJPEG_AVX2
+#define RJPEG_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
 /* ARM NEON */
 #if defined(RJPEG_NO_SIMD) && defined(RJPEG_NEON)
 #undef RJPEG_NEON
@@ -204,6 +217,8 @@ typedef struct
       int x,y,w2,h2;
       int      coeff_w;          /* number of 8x8 coefficient blocks */
       int      coeff_h;          /* number of 8x8 coefficient blocks */
+      int      scale_shift;      /* blocks decode to (8 >> scale_shift) pixels */
+      void (*idct_block_kernel)(uint8_t *out, int out_stride, short data[64]);
    } img_comp[4];
 
    /* sizes for components, interleaved MCUs */
@@ -227,6 +242,13 @@ typedef struct
    int16_t fast_ac[4][1 << FAST_BITS];
    unsigned char  marker;        /* marker seen while filling entropy buffer */
    uint8_t dequant[4][64];
+
+   /* DCT scaling: the image is decoded at 1 / (1 << scale_shift)
+    * of its size, picked so that it is not made smaller than
+    * target_width x target_height (0 x 0 decodes at full size) */
+   unsigned target_width;
+   unsigned target_height;
+   int      scale_shift;
 } rjpeg_jpeg;
 
 #define RJPEG_F2F(x)  ((int) (((x) * 4096 + 0.5)))
@@ -774,7 +796,7 @@ static INLINE uint8_t rjpeg_clamp(int x)
 {
    /* trick to use a single test to catch both cases */
    if ((unsigned int) x > 255)
-      return 255;
+      return (x < 0) ? 0 : 255;
    return (uint8_t) x;
 }
 
@@ -893,6 +915,75 @@ static void rjpeg_idct_block(uint8_t *out, int out_stride, short data[64])
    }
 }
 
+/* Reduced IDCTs, used to decode at 1/2, 1/4 and 1/8 scale.
+ * Only the lowest n x n coefficients of a block are
+ * transformed, with an n-point IDCT, which gives the block
+ * scaled down by 8/n without ever producing the full size
+ * pixels. The n-point IDCT uses c(u) * cos((2x+1)*u*pi/2n),
+ * with c(0) = 1 and c(u) = sqrt(2) otherwise, scaled by 1<<12
+ * like the other kernels:
+ *   4-point: sqrt(2)*cos(pi/8) = 5352, sqrt(2)*sin(pi/8) = 2217,
+ *            sqrt(2)*cos(pi/4) = 4096
+ *   2-point: sqrt(2)*cos(pi/4) = 4096 */
+static void rjpeg_idct_block_4x4(uint8_t *out, int out_stride, short data[64])
+{
+   int i, val[16];
+
+   /* columns, keeping 2 extra bits of precision as
+    * rjpeg_idct_block does */
+   for (i = 0; i < 4; ++i)
+   {
+      const short *d = data + i;
+      int e0         = RJPEG_FSH(d[0] + d[16]);
+      int e1         = RJPEG_FSH(d[0] - d[16]);
+      int o0         = d[8] * 5352 + d[24] * 2217;
+      int o1         = d[8] * 2217 - d[24] * 5352;
+
+      val[i     ]    = (e0 + o0 + 512) >> 10;
+      val[i +  4]    = (e1 + o1 + 512) >> 10;
+      val[i +  8]    = (e1 - o1 + 512) >> 10;
+      val[i + 12]    = (e0 - o0 + 512) >> 10;
+   }
+
+   /* rows: 1<<12 from the constants, the 2 extra bits and
+    * the 1/8 normalisation of the 2D transform add up to
+    * 1<<17, removed with rounding after adding the bias */
+   for (i = 0; i < 4; ++i, out += out_stride)
+   {
+      const int *v = val + i * 4;
+      int e0       = RJPEG_FSH(v[0] + v[2]) + 65536 + (128 << 17);
+      int e1       = RJPEG_FSH(v[0] - v[2]) + 65536 + (128 << 17);
+      int o0       = v[1] * 5352 + v[3] * 2217;
+      int o1       = v[1] * 2217 - v[3] * 5352;
+
+      out[0]       = rjpeg_clamp((e0 + o0) >> 17);
+      out[1]       = rjpeg_clamp((e1 + o1) >> 17);
+      out[2]       = rjpeg_clamp((e1 - o1) >> 17);
+      out[3]       = rjpeg_clamp((e0 - o0) >> 17);
+   }
+}
+
+static void rjpeg_idct_block_2x2(uint8_t *out, int out_stride, short data[64])
+{
+   /* Both passes at once: all the constants are 1<<12,
+    * which cancels out with the descaling */
+   int a    = data[0] + data[8];
+   int b    = data[0] - data[8];
+   int bias = 4 + (128 << 3);
+
+   out[0]              = rjpeg_clamp((a + data[1] + data[9] + bias) >> 3);
+   out[1]              = rjpeg_clamp((a - data[1] - data[9] + bias) >> 3);
+   out[out_stride]     = rjpeg_clamp((b + data[1] - data[9] + bias) >> 3);
+   out[out_stride + 1] = rjpeg_clamp((b - data[1] + data[9] + bias) >> 3);
+}
+
+/* At 1/8 scale a block is just its (rounded) average */
+static void rjpeg_idct_block_1x1(uint8_t *out, int out_stride, short data[64])
+{
+   (void)out_stride;
+   out[0] = rjpeg_clamp((data[0] + 4 + (128 << 3)) >> 3);
+}
+
 #if defined(__SSE2__)
 /* sse2 integer IDCT. not the fastest possible implementation but it
  * produces bit-identical results to the generic C version so it's
@@ -1391,7 +1482,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                         z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq]))
                   return 0;
 
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+               z->img_comp[n].idct_block_kernel(z->img_comp[n].data
+                     + ((z->img_comp[n].w2*j*8+i*8) >> z->img_comp[n].scale_shift),
                      z->img_comp[n].w2, data);
 
                /* every data block is an MCU, so countdown the restart interval */
@@ -1481,7 +1573,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                                  n, z->dequant[z->img_comp[n].tq]))
                            return 0;
 
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2,
+                        z->img_comp[n].idct_block_kernel(z->img_comp[n].data
+                              + ((z->img_comp[n].w2*y2+x2) >> z->img_comp[n].scale_shift),
                               z->img_comp[n].w2, data);
                      }
                   }
@@ -1530,7 +1623,8 @@ static void rjpeg_jpeg_finish(rjpeg_jpeg *z)
          {
             short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
             rjpeg_jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-            z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+            z->img_comp[n].idct_block_kernel(z->img_comp[n].data
+                  + ((z->img_comp[n].w2*j*8+i*8) >> z->img_comp[n].scale_shift),
                   z->img_comp[n].w2, data);
          }
       }
@@ -1808,6 +1902,60 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
    z->img_mcu_x = (s->img_x + z->img_mcu_w-1) / z->img_mcu_w;
    z->img_mcu_y = (s->img_y + z->img_mcu_h-1) / z->img_mcu_h;
 
+   /* Pick the smallest scale at which the image, fitted
+    * within the target size, would not need enlarging */
+   z->scale_shift = 0;
+   if (z->target_width > 0 && z->target_height > 0)
+   {
+      while (z->scale_shift < 3)
+      {
+         int shift  = z->scale_shift + 1;
+         uint32_t w = (s->img_x + (1 << shift) - 1) >> shift;
+         uint32_t h = (s->img_y + (1 << shift) - 1) >> shift;
+
+         if (w < z->target_width && h < z->target_height)
+            break;
+
+         z->scale_shift = shift;
+      }
+   }
+
+   /* Subsampled components are scaled down less, as far as
+    * their full resolution allows, so that chroma is not
+    * left coarser than in a full size decode */
+   for (i = 0; i < s->img_n; ++i)
+   {
+      int ratio = h_max / z->img_comp[i].h;
+
+      z->img_comp[i].scale_shift = z->scale_shift;
+
+      if (ratio == v_max / z->img_comp[i].v)
+      {
+         while (     z->img_comp[i].scale_shift > 0
+               && (ratio > 1) && !(ratio & 1))
+         {
+            z->img_comp[i].scale_shift--;
+            ratio >>= 1;
+         }
+      }
+
+      switch (z->img_comp[i].scale_shift)
+      {
+         case 1:
+            z->img_comp[i].idct_block_kernel = rjpeg_idct_block_4x4;
+            break;
+         case 2:
+            z->img_comp[i].idct_block_kernel = rjpeg_idct_block_2x2;
+            break;
+         case 3:
+            z->img_comp[i].idct_block_kernel = rjpeg_idct_block_1x1;
+            break;
+         default:
+            z->img_comp[i].idct_block_kernel = z->idct_block_kernel;
+            break;
+      }
+   }
+
    if (z->progressive)
    {
       for (i = 0; i < s->img_n; ++i)
@@ -1820,8 +1968,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = (z->img_mcu_x * z->img_comp[i].h * 8) >> z->img_comp[i].scale_shift;
+         z->img_comp[i].h2       = (z->img_mcu_y * z->img_comp[i].v * 8) >> z->img_comp[i].scale_shift;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -1839,8 +1987,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
          /* align blocks for IDCT using MMX/SSE */
          z->img_comp[i].data      = (uint8_t*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
          z->img_comp[i].linebuf   = NULL;
-         z->img_comp[i].coeff_w   = (z->img_comp[i].w2 + 7) >> 3;
-         z->img_comp[i].coeff_h   = (z->img_comp[i].h2 + 7) >> 3;
+         z->img_comp[i].coeff_w   = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h   = z->img_mcu_y * z->img_comp[i].v;
          z->img_comp[i].raw_coeff = malloc(z->img_comp[i].coeff_w *
                                     z->img_comp[i].coeff_h * 64 * sizeof(short) + 15);
          z->img_comp[i].coeff     = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -1858,8 +2006,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = (z->img_mcu_x * z->img_comp[i].h * 8) >> z->img_comp[i].scale_shift;
+         z->img_comp[i].h2       = (z->img_mcu_y * z->img_comp[i].v * 8) >> z->img_comp[i].scale_shift;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -1972,6 +2120,26 @@ static int rjpeg_decode_jpeg_image(rjpeg_jpeg *j)
 
    if (j->progressive)
       rjpeg_jpeg_finish(j);
+
+   /* From here on, only the decoded pixels are used. A
+    * component that was scaled down less than the image
+    * now has a smaller subsampling factor */
+   if (j->scale_shift)
+   {
+      j->s->img_x = (j->s->img_x + (1 << j->scale_shift) - 1) >> j->scale_shift;
+      j->s->img_y = (j->s->img_y + (1 << j->scale_shift) - 1) >> j->scale_shift;
+
+      for (m = 0; m < j->s->img_n; m++)
+      {
+         int shift = j->img_comp[m].scale_shift;
+
+         j->img_comp[m].x  = (j->img_comp[m].x + (1 << shift) - 1) >> shift;
+         j->img_comp[m].y  = (j->img_comp[m].y + (1 << shift) - 1) >> shift;
+         j->img_comp[m].h <<= j->scale_shift - shift;
+         j->img_comp[m].v <<= j->scale_shift - shift;
+      }
+   }
+
    return 1;
 }
 
@@ -2216,15 +2384,9 @@ static void rjpeg_YCbCr_to_RGB_row(uint8_t *out, const uint8_t *y,
       r >>= 20;
       g >>= 20;
       b >>= 20;
-      if ((unsigned) r > 255)
-         r = 255;
-      if ((unsigned) g > 255)
-         g = 255;
-      if ((unsigned) b > 255)
-         b = 255;
-      out[0] = (uint8_t)r;
-      out[1] = (uint8_t)g;
-      out[2] = (uint8_t)b;
+      out[0] = rjpeg_clamp(r);
+      out[1] = rjpeg_clamp(g);
+      out[2] = rjpeg_clamp(b);
       out[3] = 255;
       out += step;
    }
@@ -2360,21 +2522,87 @@ static void rjpeg_YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
       r >>= 20;
       g >>= 20;
       b >>= 20;
-      if ((unsigned) r > 255)
-         r = 255;
-      if ((unsigned) g > 255)
-         g = 255;
-      if ((unsigned) b > 255)
-         b = 255;
-      out[0] = (uint8_t)r;
-      out[1] = (uint8_t)g;
-      out[2] = (uint8_t)b;
+      out[0] = rjpeg_clamp(r);
+      out[1] = rjpeg_clamp(g);
+      out[2] = rjpeg_clamp(b);
       out[3] = 255;
       out += step;
    }
 }
 #endif
 
+#ifdef RJPEG_AVX2
+/* Same arithmetic as the SSE2 kernel, 16 pixels at a time */
+RJPEG_AVX2_TARGET
+static void rjpeg_YCbCr_to_RGB_avx2(uint8_t *out, const uint8_t *y,
+      const uint8_t *pcb, const uint8_t *pcr, int count, int step)
+{
+   int i = 0;
+
+   if (step == 4)
+   {
+      __m256i signflip  = _mm256_set1_epi16((short)0x8000);
+      __m256i cr_const0 = _mm256_set1_epi16(   (short) ( 1.40200f*4096.0f+0.5f));
+      __m256i cr_const1 = _mm256_set1_epi16( - (short) ( 0.71414f*4096.0f+0.5f));
+      __m256i cb_const0 = _mm256_set1_epi16( - (short) ( 0.34414f*4096.0f+0.5f));
+      __m256i cb_const1 = _mm256_set1_epi16(   (short) ( 1.77200f*4096.0f+0.5f));
+      __m256i y_bias    = _mm256_set1_epi16(128);
+      __m256i xw        = _mm256_set1_epi16(255); /* alpha channel */
+
+      for (; i+15 < count; i += 16)
+      {
+         /* load and widen to 16 bits, keeping the pixel order */
+         __m256i y_words   = _mm256_cvtepu8_epi16(
+               _mm_loadu_si128((const __m128i*)(y + i)));
+         __m256i cr_words  = _mm256_cvtepu8_epi16(
+               _mm_loadu_si128((const __m128i*)(pcr + i)));
+         __m256i cb_words  = _mm256_cvtepu8_epi16(
+               _mm_loadu_si128((const __m128i*)(pcb + i)));
+
+         /* (y << 8) + 128, (cr - 128) << 8, (cb - 128) << 8 */
+         __m256i yw  = _mm256_or_si256(_mm256_slli_epi16(y_words, 8), y_bias);
+         __m256i crw = _mm256_xor_si256(_mm256_slli_epi16(cr_words, 8), signflip);
+         __m256i cbw = _mm256_xor_si256(_mm256_slli_epi16(cb_words, 8), signflip);
+
+         /* color transform */
+         __m256i yws = _mm256_srli_epi16(yw, 4);
+         __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+         __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+         __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+         __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+         __m256i rws = _mm256_add_epi16(cr0, yws);
+         __m256i gwt = _mm256_add_epi16(cb0, yws);
+         __m256i bws = _mm256_add_epi16(yws, cb1);
+         __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+         /* descale */
+         __m256i rw  = _mm256_srai_epi16(rws, 4);
+         __m256i bw  = _mm256_srai_epi16(bws, 4);
+         __m256i gw  = _mm256_srai_epi16(gws, 4);
+
+         /* back to byte and interleave, within each 128-bit
+          * lane: pixels 0-7 in the low lane, 8-15 in the high */
+         __m256i brb = _mm256_packus_epi16(rw, bw);
+         __m256i gxb = _mm256_packus_epi16(gw, xw);
+         __m256i t0  = _mm256_unpacklo_epi8(brb, gxb);
+         __m256i t1  = _mm256_unpackhi_epi8(brb, gxb);
+         __m256i o0  = _mm256_unpacklo_epi16(t0, t1);
+         __m256i o1  = _mm256_unpackhi_epi16(t0, t1);
+
+         /* store, putting the lanes back in pixel order */
+         _mm256_storeu_si256((__m256i*)(out + 0),
+               _mm256_permute2x128_si256(o0, o1, 0x20));
+         _mm256_storeu_si256((__m256i*)(out + 32),
+               _mm256_permute2x128_si256(o0, o1, 0x31));
+         out += 64;
+      }
+   }
+
+   if (i < count)
+      rjpeg_YCbCr_to_RGB_simd(out, y + i, pcb + i, pcr + i, count - i, step);
+}
+#endif
+
 /* set up the kernels */
 static void rjpeg_setup_jpeg(rjpeg_jpeg *j)
 {
@@ -2395,6 +2623,11 @@ static void rjpeg_setup_jpeg(rjpeg_jpeg *j)
    }
 #endif
 
+#ifdef RJPEG_AVX2
+   if (mask & RETRO_SIMD_AVX2)
+      j->YCbCr_to_RGB_kernel      = rjpeg_YCbCr_to_RGB_avx2;
+#endif
+
 #ifdef RJPEG_NEON
    j->idct_block_kernel           = rjpeg_idct_simd;
    j->YCbCr_to_RGB_kernel         = rjpeg_YCbCr_to_RGB_simd;
@@ -2555,6 +2788,46 @@ error:
    return NULL;
 }
 
+/* Swaps R and B in place, turning the RGBA bytes
+ * written by the decoder into ARGB words */
+static void rjpeg_rgba_to_argb(uint32_t *pixels, size_t count)
+{
+   size_t i = 0;
+
+#if defined(__SSE2__)
+   {
+      const __m128i ag_mask = _mm_set1_epi32(0xFF00FF00);
+      const __m128i rb_mask = _mm_set1_epi32(0x000000FF);
+
+      for (; i + 4 <= count; i += 4)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+         __m128i r = _mm_slli_epi32(_mm_and_si128(v, rb_mask), 16);
+         __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), rb_mask);
+         _mm_storeu_si128((__m128i*)(pixels + i),
+               _mm_or_si128(_mm_and_si128(v, ag_mask), _mm_or_si128(r, b)));
+      }
+   }
+#elif defined(RJPEG_NEON)
+   for (; i + 16 <= count; i += 16)
+   {
+      uint8x16x4_t v = vld4q_u8((const uint8_t*)(pixels + i));
+      uint8x16_t   r = v.val[0];
+      v.val[0]       = v.val[2];
+      v.val[2]       = r;
+      vst4q_u8((uint8_t*)(pixels + i), v);
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      uint32_t texel = pixels[i];
+      pixels[i]      = (texel & 0xFF00FF00)
+                     | ((texel & 0x000000FF) << 16)
+                     | ((texel & 0x00FF0000) >> 16);
+   }
+}
+
 int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
       size_t size, unsigned *width, unsigned *height)
 {
@@ -2562,8 +2835,6 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    rjpeg_context s;
    int comp;
    uint32_t *img         = NULL;
-   uint32_t *pixels      = NULL;
-   unsigned size_tex     = 0;
 
    if (!rjpeg)
       return IMAGE_PROCESS_ERROR;
@@ -2573,6 +2844,8 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    s.img_buffer_end      = (uint8_t*)rjpeg->buff_data + (int)size;
 
    j.s                   = &s;
+   j.target_width        = rjpeg->target_width;
+   j.target_height       = rjpeg->target_height;
 
    rjpeg_setup_jpeg(&j);
 
@@ -2581,31 +2854,23 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    if (!img)
       return IMAGE_PROCESS_ERROR;
 
-   size_tex = (*width) * (*height);
-   pixels   = (uint32_t*)malloc(size_tex * sizeof(uint32_t));
+   /* The decoder output has the size of the texture, so it
+    * is converted in place rather than copied */
+   rjpeg_rgba_to_argb(img, (size_t)(*width) * (*height));
 
-   if (!pixels)
-   {
-      free(img);
-      return IMAGE_PROCESS_ERROR;
-   }
+   *buf_data = img;
 
-   *buf_data = pixels;
-
-   /* Convert RGBA to ARGB */
-   while (size_tex--)
-   {
-      unsigned int texel = img[size_tex];
-      unsigned int A     = texel & 0xFF000000;
-      unsigned int B     = texel & 0x00FF0000;
-      unsigned int G     = texel & 0x0000FF00;
-      unsigned int R     = texel & 0x000000FF;
-      ((unsigned int*)pixels)[size_tex] = A | (R << 16) | G | (B >> 16);
-   }
+   return IMAGE_PROCESS_END;
+}
 
-   free(img);
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height)
+{
+   if (!rjpeg)
+      return;
 
-   return IMAGE_PROCESS_END;
+   rjpeg->target_width  = width;
+   rjpeg->target_height = height;
 }
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data)
@@ -62,6 +62,10 @@
 #include <retro_inline.h>
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define TRUE 1
 #define FALSE 0
 
@@ -229,6 +233,9 @@ struct _chd_file
 	UINT32					maxhunk;		/* maximum hunk accessed */
 #endif
    UINT8 *              file_cache; /* cache of underlying file */
+#ifdef HAVE_THREADS
+   slock_t *            io_lock;    /* serialises file access of chd_read_hunks() workers */
+#endif
 };
 
 /***************************************************************************
@@ -761,6 +768,154 @@ static INLINE void map_extract_old(const UINT8 *base, map_entry *entry, UINT32 h
     CHD FILE MANAGEMENT
 ***************************************************************************/
 
+/*-------------------------------------------------
+    chd_init_codecs - find and initialize the
+    decompression codecs of a CHD file
+-------------------------------------------------*/
+
+static chd_error chd_init_codecs(chd_file *chd)
+{
+	chd_error err;
+	int intfnum;
+
+	if (chd->header.version < 5)
+	{
+		for (intfnum = 0; intfnum < ARRAY_SIZE(codec_interfaces); intfnum++)
+			if (codec_interfaces[intfnum].compression == chd->header.compression[0])
+			{
+				chd->codecintf[0] = &codec_interfaces[intfnum];
+				break;
+			}
+		if (intfnum == ARRAY_SIZE(codec_interfaces))
+			return CHDERR_UNSUPPORTED_FORMAT;
+
+#ifdef HAVE_ZLIB
+		/* initialize the codec */
+		if (chd->codecintf[0]->init != NULL)
+      {
+         err = (*chd->codecintf[0]->init)(&chd->zlib_codec_data, chd->header.hunkbytes);
+         (void)err;
+      }
+#endif
+	}
+	else
+	{
+		int i, decompnum;
+		/* verify the compression types and initialize the codecs */
+		for (decompnum = 0; decompnum < ARRAY_SIZE(chd->header.compression); decompnum++)
+		{
+			for (i = 0 ; i < ARRAY_SIZE(codec_interfaces) ; i++)
+			{
+				if (codec_interfaces[i].compression == chd->header.compression[decompnum])
+				{
+					chd->codecintf[decompnum] = &codec_interfaces[i];
+					if (chd->codecintf[decompnum] == NULL && chd->header.compression[decompnum] != 0)
+                    {
+						err = CHDERR_UNSUPPORTED_FORMAT;
+                        (void)err;
+                    }
+
+					/* initialize the codec */
+					if (chd->codecintf[decompnum]->init != NULL)
+					{
+						void* codec = NULL;
+						switch (chd->header.compression[decompnum])
+						{
+                     case CHD_CODEC_ZLIB:
+#ifdef HAVE_ZLIB
+								codec = &chd->zlib_codec_data;
+#endif
+								break;
+
+							case CHD_CODEC_CD_ZLIB:
+#ifdef HAVE_ZLIB
+								codec = &chd->cdzl_codec_data;
+#endif
+								break;
+
+							case CHD_CODEC_CD_LZMA:
+#ifdef HAVE_7ZIP
+								codec = &chd->cdlz_codec_data;
+#endif
+								break;
+
+							case CHD_CODEC_CD_FLAC:
+#ifdef HAVE_FLAC
+								codec = &chd->cdfl_codec_data;
+#endif
+								break;
+						}
+						if (codec != NULL)
+                        {
+							err = (*chd->codecintf[decompnum]->init)(codec, chd->header.hunkbytes);
+                            (void)err;
+                        }
+					}
+
+				}
+			}
+		}
+	}
+
+	return CHDERR_NONE;
+}
+
+/*-------------------------------------------------
+    chd_free_codecs - free the decompression
+    codecs of a CHD file
+-------------------------------------------------*/
+
+static void chd_free_codecs(chd_file *chd)
+{
+	if (chd->header.version < 5)
+	{
+#ifdef HAVE_ZLIB
+		if (chd->codecintf[0] != NULL && chd->codecintf[0]->free != NULL)
+			(*chd->codecintf[0]->free)(&chd->zlib_codec_data);
+#endif
+	}
+	else
+	{
+		int i;
+		/* Free the codecs */
+		for (i = 0 ; i < 4 ; i++)
+      {
+         void* codec = NULL;
+         if (!chd->codecintf[i])
+            continue;
+
+         switch (chd->codecintf[i]->compression)
+         {
+            case CHD_CODEC_CD_LZMA:
+#ifdef HAVE_7ZIP
+               codec = &chd->cdlz_codec_data;
+#endif
+               break;
+
+            case CHD_CODEC_ZLIB:
+#ifdef HAVE_ZLIB
+               codec = &chd->zlib_codec_data;
+#endif
+               break;
+
+            case CHD_CODEC_CD_ZLIB:
+#ifdef HAVE_ZLIB
+               codec = &chd->cdzl_codec_data;
+#endif
+               break;
+
+            case CHD_CODEC_CD_FLAC:
+#ifdef HAVE_FLAC
+               codec = &chd->cdfl_codec_data;
+#endif
+               break;
+         }
+         if (codec)
+            (*chd->codecintf[i]->free)(codec);
+      }
+	}
+}
+
 /*-------------------------------------------------
     chd_open_file - open a CHD file for access
 -------------------------------------------------*/
@@ -769,7 +924,6 @@ chd_error chd_open_file(RFILE *file, int mode, chd_file *parent, chd_file **chd)
 {
 	chd_file *newchd = NULL;
 	chd_error err;
-	int intfnum;
 
 	/* verify parameters */
 	if (file == NULL)
@@ -853,85 +1007,10 @@ chd_error chd_open_file(RFILE *file, int mode, chd_file *parent, chd_file **chd)
 	if (newchd->compressed == NULL)
 		EARLY_EXIT(err = CHDERR_OUT_OF_MEMORY);
 
-	/* find the codec interface */
-	if (newchd->header.version < 5)
-	{
-		for (intfnum = 0; intfnum < ARRAY_SIZE(codec_interfaces); intfnum++)
-			if (codec_interfaces[intfnum].compression == newchd->header.compression[0])
-			{
-				newchd->codecintf[0] = &codec_interfaces[intfnum];
-				break;
-			}
-		if (intfnum == ARRAY_SIZE(codec_interfaces))
-			EARLY_EXIT(err = CHDERR_UNSUPPORTED_FORMAT);
-
-#ifdef HAVE_ZLIB
-		/* initialize the codec */
-		if (newchd->codecintf[0]->init != NULL)
-      {
-         err = (*newchd->codecintf[0]->init)(&newchd->zlib_codec_data, newchd->header.hunkbytes);
-         (void)err;
-      }
-#endif
-	}
-	else
-	{
-		int i, decompnum;
-		/* verify the compression types and initialize the codecs */
-		for (decompnum = 0; decompnum < ARRAY_SIZE(newchd->header.compression); decompnum++)
-		{
-			for (i = 0 ; i < ARRAY_SIZE(codec_interfaces) ; i++)
-			{
-				if (codec_interfaces[i].compression == newchd->header.compression[decompnum])
-				{
-					newchd->codecintf[decompnum] = &codec_interfaces[i];
-					if (newchd->codecintf[decompnum] == NULL && newchd->header.compression[decompnum] != 0)
-                    {
-						err = CHDERR_UNSUPPORTED_FORMAT;
-                        (void)err;
-                    }
-
-					/* initialize the codec */
-					if (newchd->codecintf[decompnum]->init != NULL)
-					{
-						void* codec = NULL;
-						switch (newchd->header.compression[decompnum])
-						{
-                     case CHD_CODEC_ZLIB:
-#ifdef HAVE_ZLIB
-								codec = &newchd->zlib_codec_data;
-#endif
-								break;
-
-							case CHD_CODEC_CD_ZLIB:
-#ifdef HAVE_ZLIB
-								codec = &newchd->cdzl_codec_data;
-#endif
-								break;
-
-							case CHD_CODEC_CD_LZMA:
-#ifdef HAVE_7ZIP
-								codec = &newchd->cdlz_codec_data;
-#endif
-								break;
-
-							case CHD_CODEC_CD_FLAC:
-#ifdef HAVE_FLAC
-								codec = &newchd->cdfl_codec_data;
-#endif
-								break;
-						}
-						if (codec != NULL)
-                        {
-							err = (*newchd->codecintf[decompnum]->init)(codec, newchd->header.hunkbytes);
-                            (void)err;
-                        }
-					}
-
-				}
-			}
-		}
-	}
+	/* find the codec interfaces and initialize them */
+	err = chd_init_codecs(newchd);
+	if (err != CHDERR_NONE)
+		EARLY_EXIT(err);
 
 #if 0
 	/* HACK */
@@ -1037,58 +1116,12 @@ void chd_close(chd_file *chd)
 	if (chd == NULL || chd->cookie != COOKIE_VALUE)
 		return;
 
-	/* deinit the codec */
-	if (chd->header.version < 5)
-	{
-#ifdef HAVE_ZLIB
-		if (chd->codecintf[0] != NULL && chd->codecintf[0]->free != NULL)
-			(*chd->codecintf[0]->free)(&chd->zlib_codec_data);
-#endif
-	}
-	else
-	{
-		int i;
-		/* Free the codecs */
-		for (i = 0 ; i < 4 ; i++)
-      {
-         void* codec = NULL;
-         if (!chd->codecintf[i])
-            continue;
-
-         switch (chd->codecintf[i]->compression)
-         {
-            case CHD_CODEC_CD_LZMA:
-#ifdef HAVE_7ZIP
-               codec = &chd->cdlz_codec_data;
-#endif
-               break;
+	/* deinit the codecs */
+	chd_free_codecs(chd);
 
-            case CHD_CODEC_ZLIB:
-#ifdef HAVE_ZLIB
-               codec = &chd->zlib_codec_data;
-#endif
-               break;
-
-            case CHD_CODEC_CD_ZLIB:
-#ifdef HAVE_ZLIB
-               codec = &chd->cdzl_codec_data;
-#endif
-               break;
-
-            case CHD_CODEC_CD_FLAC:
-#ifdef HAVE_FLAC
-               codec = &chd->cdfl_codec_data;
-#endif
-               break;
-         }
-         if (codec)
-            (*chd->codecintf[i]->free)(codec);
-      }
-
-		/* Free the raw map */
-		if (chd->header.rawmap != NULL)
-			free(chd->header.rawmap);
-	}
+	/* free the raw map */
+	if (chd->header.version >= 5 && chd->header.rawmap != NULL)
+		free(chd->header.rawmap);
 
 	/* free the compressed data buffer */
 	if (chd->compressed != NULL)
@@ -1209,6 +1242,420 @@ chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer)
 	return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
 }
 
+/* decompresses hunks for one or more chd_hunk_reader_read() calls */
+struct _chd_hunk_reader
+{
+	chd_file *				chd;
+	UINT8 *					buffer;			/* hunk buffer of the serial fallback */
+#ifdef HAVE_THREADS
+	struct _chd_hunk_worker *	workers;
+	struct _chd_hunk_slot *	slots;			/* hunk n goes to slots[(n - first) % numslots] */
+	slock_t *				lock;			/* guards everything below */
+	scond_t *				cond;			/* signalled on any progress */
+	slock_t *				io_lock;		/* serialises file reads */
+	unsigned				numworkers;		/* workers with a clone of the CHD */
+	unsigned				started;		/* workers with a running thread */
+	UINT32					numslots;
+	UINT32					first;			/* first hunk of the current read */
+	UINT32					end;			/* one past the last hunk to be claimed */
+	UINT32					next;			/* next hunk to be claimed by a worker */
+	UINT32					done;			/* next hunk to be passed to the callback */
+	UINT8					quit;			/* set to stop the workers */
+#endif
+};
+
+#ifdef HAVE_THREADS
+/* one decompressed hunk of the chd_hunk_reader_read() window */
+typedef struct _chd_hunk_slot chd_hunk_slot;
+struct _chd_hunk_slot
+{
+	UINT8 *					data;			/* decompressed hunk */
+	chd_error				err;			/* result of decompressing it */
+	UINT8					ready;			/* set once a worker is done with it */
+};
+
+/* a worker thread, with codecs of its own */
+typedef struct _chd_hunk_worker chd_hunk_worker;
+struct _chd_hunk_worker
+{
+	chd_file *				chd;
+	chd_hunk_reader *		reader;
+	sthread_t *				thread;
+};
+
+/*-------------------------------------------------
+    chd_clone - make a copy of a CHD file with
+    codecs and a compressed data buffer of its
+    own, sharing the map and file handle
+-------------------------------------------------*/
+
+static chd_file *chd_clone(chd_file *chd, slock_t *io_lock)
+{
+	chd_file *clone = (chd_file *)malloc(sizeof(*clone));
+	if (clone == NULL)
+		return NULL;
+
+	memcpy(clone, chd, sizeof(*clone));
+	clone->owns_file = FALSE;
+	clone->io_lock = io_lock;
+#ifdef NEED_CACHE_HUNK
+	clone->cache = NULL;
+	clone->compare = NULL;
+#endif
+
+	clone->compressed = (UINT8 *)malloc(chd->header.hunkbytes);
+	if (clone->compressed == NULL)
+	{
+		free(clone);
+		return NULL;
+	}
+
+	/* nothing of the codec state may be shared */
+	memset(clone->codecintf, 0, sizeof(clone->codecintf));
+#ifdef HAVE_ZLIB
+	memset(&clone->zlib_codec_data, 0, sizeof(clone->zlib_codec_data));
+	memset(&clone->cdzl_codec_data, 0, sizeof(clone->cdzl_codec_data));
+#endif
+#ifdef HAVE_7ZIP
+	memset(&clone->cdlz_codec_data, 0, sizeof(clone->cdlz_codec_data));
+#endif
+#ifdef HAVE_FLAC
+	memset(&clone->cdfl_codec_data, 0, sizeof(clone->cdfl_codec_data));
+#endif
+	if (chd_init_codecs(clone) != CHDERR_NONE)
+	{
+		chd_free_codecs(clone);
+		free(clone->compressed);
+		free(clone);
+		return NULL;
+	}
+
+	return clone;
+}
+
+static void chd_clone_free(chd_file *clone)
+{
+	chd_free_codecs(clone);
+	free(clone->compressed);
+	free(clone);
+}
+
+/*-------------------------------------------------
+    chd_hunk_worker_thread - wait for a read,
+    then claim its hunks in ascending order and
+    decompress each into its slot once the
+    callback is done with the previous occupant
+-------------------------------------------------*/
+
+static void chd_hunk_worker_thread(void *data)
+{
+	chd_hunk_worker *worker = (chd_hunk_worker *)data;
+	chd_hunk_reader *reader = worker->reader;
+
+	slock_lock(reader->lock);
+	for (;;)
+	{
+		UINT32 hunknum;
+		chd_hunk_slot *slot;
+		chd_error err;
+
+		while (!reader->quit && reader->next >= reader->end)
+			scond_wait(reader->cond, reader->lock);
+		if (reader->quit)
+			break;
+
+		hunknum = reader->next++;
+		slot = &reader->slots[(hunknum - reader->first) % reader->numslots];
+
+		while (!reader->quit && hunknum >= reader->done + reader->numslots)
+			scond_wait(reader->cond, reader->lock);
+		if (reader->quit)
+			break;
+
+		slock_unlock(reader->lock);
+		err = hunk_read_into_memory(worker->chd, hunknum, slot->data);
+		slock_lock(reader->lock);
+
+		slot->err = err;
+		slot->ready = 1;
+		scond_broadcast(reader->cond);
+	}
+	slock_unlock(reader->lock);
+}
+
+/*-------------------------------------------------
+    chd_hunk_reader_start - set up the workers,
+    leaves the reader serial if they could not be
+-------------------------------------------------*/
+
+static void chd_hunk_reader_start(chd_hunk_reader *reader, unsigned threads)
+{
+	chd_file *chd = reader->chd;
+	unsigned i;
+
+	reader->numslots = threads * 2;
+	reader->lock = slock_new();
+	reader->cond = scond_new();
+	reader->io_lock = slock_new();
+	reader->slots = (chd_hunk_slot *)calloc(reader->numslots, sizeof(*reader->slots));
+	reader->workers = (chd_hunk_worker *)calloc(threads, sizeof(*reader->workers));
+	if (!reader->lock || !reader->cond || !reader->io_lock || !reader->slots || !reader->workers)
+		return;
+
+	for (i = 0; i < reader->numslots; i++)
+		if ((reader->slots[i].data = (UINT8 *)malloc(chd->header.hunkbytes)) == NULL)
+			return;
+
+	for (reader->numworkers = 0; reader->numworkers < threads; reader->numworkers++)
+	{
+		chd_hunk_worker *worker = &reader->workers[reader->numworkers];
+		worker->reader = reader;
+		if ((worker->chd = chd_clone(chd, reader->io_lock)) == NULL)
+			return;
+	}
+
+	for (reader->started = 0; reader->started < threads; reader->started++)
+	{
+		chd_hunk_worker *worker = &reader->workers[reader->started];
+		if ((worker->thread = sthread_create(chd_hunk_worker_thread, worker)) == NULL)
+			break;
+	}
+}
+
+/*-------------------------------------------------
+    chd_hunk_reader_stop - stop the workers and
+    free everything chd_hunk_reader_start() set up
+-------------------------------------------------*/
+
+static void chd_hunk_reader_stop(chd_hunk_reader *reader)
+{
+	unsigned i;
+
+	if (reader->started)
+	{
+		slock_lock(reader->lock);
+		reader->quit = 1;
+		scond_broadcast(reader->cond);
+		slock_unlock(reader->lock);
+
+		for (i = 0; i < reader->started; i++)
+			sthread_join(reader->workers[i].thread);
+		reader->started = 0;
+	}
+
+	if (reader->workers)
+	{
+		for (i = 0; i < reader->numworkers; i++)
+			chd_clone_free(reader->workers[i].chd);
+		free(reader->workers);
+		reader->workers = NULL;
+	}
+	if (reader->slots)
+	{
+		for (i = 0; i < reader->numslots; i++)
+			free(reader->slots[i].data);
+		free(reader->slots);
+		reader->slots = NULL;
+	}
+	if (reader->io_lock)
+		slock_free(reader->io_lock);
+	if (reader->cond)
+		scond_free(reader->cond);
+	if (reader->lock)
+		slock_free(reader->lock);
+	reader->io_lock = NULL;
+	reader->cond = NULL;
+	reader->lock = NULL;
+}
+
+/*-------------------------------------------------
+    chd_hunk_reader_read_parallel - hand the
+    hunks the workers decompress to the callback
+    in order
+-------------------------------------------------*/
+
+static chd_error chd_hunk_reader_read_parallel(chd_hunk_reader *reader, UINT32 first, UINT32 count,
+	chd_hunk_callback callback, void *userdata)
+{
+	chd_error err = CHDERR_NONE;
+	UINT32 hunknum;
+
+	slock_lock(reader->lock);
+	reader->first = reader->next = reader->done = first;
+	reader->end = first + count;
+	scond_broadcast(reader->cond);
+	slock_unlock(reader->lock);
+
+	for (hunknum = first; ; hunknum++)
+	{
+		chd_hunk_slot *slot = &reader->slots[(hunknum - first) % reader->numslots];
+
+		slock_lock(reader->lock);
+		if (hunknum >= reader->end)
+		{
+			slock_unlock(reader->lock);
+			break;
+		}
+		while (!slot->ready)
+			scond_wait(reader->cond, reader->lock);
+		slot->ready = 0;
+		slock_unlock(reader->lock);
+
+		/* after an error, the hunks already claimed are only drained,
+		   so that the workers are idle again when this returns */
+		if (err == CHDERR_NONE)
+		{
+			err = slot->err;
+			if (err == CHDERR_NONE)
+				err = callback(userdata, hunknum, slot->data);
+			if (err != CHDERR_NONE)
+			{
+				slock_lock(reader->lock);
+				reader->end = reader->next;
+				slock_unlock(reader->lock);
+			}
+		}
+
+		slock_lock(reader->lock);
+		reader->done = hunknum + 1;
+		scond_broadcast(reader->cond);
+		slock_unlock(reader->lock);
+	}
+
+	return err;
+}
+#endif
+
+/*-------------------------------------------------
+    chd_hunk_reader_open - set up a reader that
+    decompresses hunks on up to 'threads' threads
+    for any number of chd_hunk_reader_read() calls
+-------------------------------------------------*/
+
+chd_error chd_hunk_reader_open(chd_file *chd, unsigned threads, chd_hunk_reader **reader)
+{
+	chd_hunk_reader *newreader;
+
+	/* punt if NULL or invalid */
+	if (chd == NULL || chd->cookie != COOKIE_VALUE || reader == NULL)
+		return CHDERR_INVALID_PARAMETER;
+
+	newreader = (chd_hunk_reader *)calloc(1, sizeof(*newreader));
+	if (newreader == NULL)
+		return CHDERR_OUT_OF_MEMORY;
+	newreader->chd = chd;
+
+#ifdef HAVE_THREADS
+	if (threads > chd->header.totalhunks)
+		threads = chd->header.totalhunks;
+
+	/* the parent's codecs would be shared by all workers */
+	if (threads > 1 && chd->parent == NULL)
+	{
+		chd_hunk_reader_start(newreader, threads);
+
+		/* no worker could be started, read serially */
+		if (newreader->started == 0)
+			chd_hunk_reader_stop(newreader);
+	}
+
+	if (newreader->started == 0)
+#endif
+	{
+		newreader->buffer = (UINT8 *)malloc(chd->header.hunkbytes);
+		if (newreader->buffer == NULL)
+		{
+			free(newreader);
+			return CHDERR_OUT_OF_MEMORY;
+		}
+	}
+
+	*reader = newreader;
+	return CHDERR_NONE;
+}
+
+/*-------------------------------------------------
+    chd_hunk_reader_read - read a range of hunks,
+    passing them to the callback in order
+-------------------------------------------------*/
+
+chd_error chd_hunk_reader_read(chd_hunk_reader *reader, UINT32 first, UINT32 count,
+	chd_hunk_callback callback, void *userdata)
+{
+	chd_error err = CHDERR_NONE;
+	chd_file *chd;
+	UINT32 hunknum;
+
+	/* punt if NULL or invalid */
+	if (reader == NULL || callback == NULL)
+		return CHDERR_INVALID_PARAMETER;
+	chd = reader->chd;
+	if (first > chd->header.totalhunks || count > chd->header.totalhunks - first)
+		return CHDERR_HUNK_OUT_OF_RANGE;
+
+#ifdef HAVE_THREADS
+	if (reader->started)
+		return chd_hunk_reader_read_parallel(reader, first, count, callback, userdata);
+#endif
+
+	for (hunknum = first; hunknum < first + count && err == CHDERR_NONE; hunknum++)
+	{
+		err = hunk_read_into_memory(chd, hunknum, reader->buffer);
+		if (err == CHDERR_NONE)
+			err = callback(userdata, hunknum, reader->buffer);
+	}
+
+	return err;
+}
+
+/*-------------------------------------------------
+    chd_hunk_reader_close - stop the workers of a
+    reader and free it
+-------------------------------------------------*/
+
+void chd_hunk_reader_close(chd_hunk_reader *reader)
+{
+	if (reader == NULL)
+		return;
+
+#ifdef HAVE_THREADS
+	chd_hunk_reader_stop(reader);
+#endif
+	free(reader->buffer);
+	free(reader);
+}
+
+/*-------------------------------------------------
+    chd_read_hunks - read a range of hunks,
+    decompressing them on up to 'threads' threads
+    and passing them to the callback in order
+-------------------------------------------------*/
+
+chd_error chd_read_hunks(chd_file *chd, UINT32 first, UINT32 count,
+	unsigned threads, chd_hunk_callback callback, void *userdata)
+{
+	chd_hunk_reader *reader = NULL;
+	chd_error err;
+
+	/* punt if NULL or invalid */
+	if (chd == NULL || chd->cookie != COOKIE_VALUE || callback == NULL)
+		return CHDERR_INVALID_PARAMETER;
+	if (first > chd->header.totalhunks || count > chd->header.totalhunks - first)
+		return CHDERR_HUNK_OUT_OF_RANGE;
+
+	/* threads that would have nothing to do are not started */
+	if (threads > count)
+		threads = count;
+
+	err = chd_hunk_reader_open(chd, threads, &reader);
+	if (err != CHDERR_NONE)
+		return err;
+
+	err = chd_hunk_reader_read(reader, first, count, callback, userdata);
+	chd_hunk_reader_close(reader);
+	return err;
+}
+
 /***************************************************************************
     METADATA MANAGEMENT
 ***************************************************************************/
@@ -1563,8 +2010,16 @@ static UINT8* hunk_read_compressed(chd_file *chd, UINT64 offset, size_t size)
    int64_t bytes;
    if (chd->file_cache)
       return chd->file_cache + offset;
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_lock(chd->io_lock);
+#endif
    filestream_seek(chd->file, offset, SEEK_SET);
    bytes = filestream_read(chd->file, chd->compressed, size);
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_unlock(chd->io_lock);
+#endif
    if (bytes != size)
       return NULL;
    return chd->compressed;
@@ -1583,8 +2038,16 @@ static chd_error hunk_read_uncompressed(chd_file *chd, UINT64 offset, size_t siz
       memcpy(dest, chd->file_cache + offset, size);
       return CHDERR_NONE;
    }
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_lock(chd->io_lock);
+#endif
    filestream_seek(chd->file, offset, SEEK_SET);
    bytes = filestream_read(chd->file, dest, size);
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_unlock(chd->io_lock);
+#endif
    if (bytes != size)
       return CHDERR_READ_ERROR;
    return CHDERR_NONE;
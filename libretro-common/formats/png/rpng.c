@@ -39,6 +39,14 @@
 
 #include "rpng_internal.h"
 
+#if defined(__SSE2__) && !defined(RPNG_NO_SIMD)
+#define RPNG_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(MSB_FIRST) && !defined(DONT_WANT_ARM_OPTIMIZATIONS) && !defined(RPNG_NO_SIMD)
+#define RPNG_NEON
+#include <arm_neon.h>
+#endif
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -80,6 +88,7 @@ struct idat_buffer
 {
    uint8_t *data;
    size_t size;
+   size_t capacity;
 };
 
 struct rpng_process
@@ -88,8 +97,7 @@ struct rpng_process
    uint32_t *palette;
    void *stream;
    const struct trans_stream_backend *stream_backend;
-   uint8_t *prev_scanline;
-   uint8_t *decoded_scanline;
+   uint8_t *prev_scanline; /* all zero, the line above the first one */
    uint8_t *inflate_buf;
    size_t restore_buf_size;
    size_t adam7_restore_buf_size;
@@ -222,11 +230,28 @@ static bool png_process_ihdr(struct png_ihdr *ihdr)
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 16 <= width; i += 16, decoded += 48)
+      {
+         uint8x16x3_t rgb = vld3q_u8(decoded);
+         uint8x16x4_t argb;
+
+         argb.val[0] = rgb.val[2];
+         argb.val[1] = rgb.val[1];
+         argb.val[2] = rgb.val[0];
+         argb.val[3] = vdupq_n_u8(0xff);
+         vst4q_u8((uint8_t*)(data + i), argb);
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b;
 
@@ -243,11 +268,43 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_SSE2)
+   if (bpp == 1)
+   {
+      /* Swap R and B in each little endian RGBA word */
+      const __m128i mask_ga = _mm_set1_epi32((int)0xff00ff00);
+      const __m128i mask_rb = _mm_set1_epi32(0x00ff00ff);
+
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i px = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i ga = _mm_and_si128(px, mask_ga);
+         __m128i rb = _mm_and_si128(px, mask_rb);
+
+         rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+         _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(ga, rb));
+      }
+   }
+#elif defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 16 <= width; i += 16, decoded += 64)
+      {
+         uint8x16x4_t px = vld4q_u8(decoded);
+         uint8x16_t r    = px.val[0];
+
+         px.val[0]       = px.val[2];
+         px.val[2]       = r;
+         vst4q_u8((uint8_t*)(data + i), px);
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -476,9 +533,6 @@ static void png_reverse_filter_deinit(struct rpng_process *pngp)
 {
    if (!pngp)
       return;
-   if (pngp->decoded_scanline)
-      free(pngp->decoded_scanline);
-   pngp->decoded_scanline = NULL;
    if (pngp->prev_scanline)
       free(pngp->prev_scanline);
    pngp->prev_scanline    = NULL;
@@ -539,9 +593,8 @@ static int png_reverse_filter_init(const struct png_ihdr *ihdr,
    pngp->restore_buf_size      = 0;
    pngp->data_restore_buf_size = 0;
    pngp->prev_scanline         = (uint8_t*)calloc(1, pngp->pitch);
-   pngp->decoded_scanline      = (uint8_t*)calloc(1, pngp->pitch);
 
-   if (!pngp->prev_scanline || !pngp->decoded_scanline)
+   if (!pngp->prev_scanline)
       goto error;
 
    pngp->h = 0;
@@ -554,73 +607,319 @@ error:
    return -1;
 }
 
-static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
-      struct rpng_process *pngp, unsigned filter)
+/* Line filters are reversed in place: 'line' holds the
+ * filtered bytes on entry and the raw ones on return,
+ * 'prev' is the already reversed line above it. */
+
+static void png_unfilter_sub(uint8_t *line, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+   for (i = bpp; i < pitch; i++)
+      line[i] += line[i - bpp];
+}
+
+static void png_unfilter_up(uint8_t *line, const uint8_t *prev,
+      unsigned pitch)
+{
+   unsigned i = 0;
+
+#if defined(RPNG_SSE2)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(line + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_NEON)
+   for (; i + 16 <= pitch; i += 16)
+      vst1q_u8(line + i, vaddq_u8(vld1q_u8(line + i), vld1q_u8(prev + i)));
+#endif
+
+   for (; i < pitch; i++)
+      line[i] += prev[i];
+}
+
+static void png_unfilter_avg(uint8_t *line, const uint8_t *prev,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i] >> 1;
+   for (i = bpp; i < pitch; i++)
+      line[i] += (line[i - bpp] + prev[i]) >> 1;
+}
+
+static void png_unfilter_paeth(uint8_t *line, const uint8_t *prev,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i];
+   for (i = bpp; i < pitch; i++)
+      line[i] += paeth(line[i - bpp], prev[i], prev[i - bpp]);
+}
+
+#if defined(RPNG_SSE2)
+/* Sub, Average and Paeth depend on the pixel to the left,
+ * so the vector versions work on one 3 or 4 byte pixel at
+ * a time. Callers pass a constant 'bpp' so these inline to
+ * plain 24/32-bit loads and stores. */
+static INLINE __m128i png_sse2_load(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_sse2_store(uint8_t *p, __m128i v, unsigned bpp)
+{
+   uint32_t x = (uint32_t)_mm_cvtsi128_si32(v);
+   memcpy(p, &x, bpp);
+}
+
+static INLINE __m128i png_sse2_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_sse2_select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static INLINE void png_unfilter_sub_sse2(uint8_t *line,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_sse2_load(line + i, bpp));
+      png_sse2_store(line + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_avg_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
 {
    unsigned i;
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i a         = _mm_setzero_si128();
+
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      __m128i b   = png_sse2_load(prev + i, bpp);
+      /* _mm_avg_epu8 rounds up, PNG rounds down */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+
+      a = _mm_add_epi8(png_sse2_load(line + i, bpp), avg);
+      png_sse2_store(line + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_paeth_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   /* a, b and c are widened to 16 bits, since
+    * the predictor distances can be negative */
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      __m128i d, smallest, nearest;
+      __m128i b  = _mm_unpacklo_epi8(png_sse2_load(prev + i, bpp), zero);
+      __m128i pa = _mm_sub_epi16(b, c);   /* p - a */
+      __m128i pb = _mm_sub_epi16(a, c);   /* p - b */
+      __m128i pc = _mm_add_epi16(pa, pb); /* p - c */
+
+      pa       = png_sse2_abs_epi16(pa);
+      pb       = png_sse2_abs_epi16(pb);
+      pc       = png_sse2_abs_epi16(pc);
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+      /* Ties prefer a, then b, as in paeth() */
+      nearest  = png_sse2_select(_mm_cmpeq_epi16(smallest, pa), a,
+                 png_sse2_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      d = _mm_add_epi8(png_sse2_load(line + i, bpp),
+            _mm_packus_epi16(nearest, nearest));
+      png_sse2_store(line + i, d, bpp);
+
+      a = _mm_unpacklo_epi8(d, zero);
+      c = b;
+   }
+}
+#elif defined(RPNG_NEON)
+/* See the SSE2 versions above */
+static INLINE uint8x8_t png_neon_load(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+static INLINE void png_neon_store(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   uint32_t x = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+   memcpy(p, &x, bpp);
+}
 
+static INLINE void png_unfilter_sub_neon(uint8_t *line,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      a = vadd_u8(a, png_neon_load(line + i, bpp));
+      png_neon_store(line + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_avg_neon(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      a = vadd_u8(png_neon_load(line + i, bpp),
+            vhadd_u8(a, png_neon_load(prev + i, bpp)));
+      png_neon_store(line + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_paeth_neon(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = vdup_n_u8(0);
+
+   for (i = 0; i + bpp <= pitch; i += bpp)
+   {
+      uint8x8_t b     = png_neon_load(prev + i, bpp);
+      uint16x8_t pa   = vabdl_u8(b, c);
+      uint16x8_t pb   = vabdl_u8(a, c);
+      uint16x8_t pc   = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+      uint8x8_t use_a = vmovn_u16(vandq_u16(
+               vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+      uint8x8_t use_b = vmovn_u16(vcleq_u16(pb, pc));
+
+      a = vadd_u8(png_neon_load(line + i, bpp),
+            vbsl_u8(use_a, a, vbsl_u8(use_b, b, c)));
+      png_neon_store(line + i, a, bpp);
+      c = b;
+   }
+}
+#endif
+
+static bool png_reverse_filter_line(uint8_t *line, const uint8_t *prev,
+      unsigned pitch, unsigned bpp, unsigned filter)
+{
    switch (filter)
    {
       case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+#if defined(RPNG_SSE2)
+         if (bpp == 4)
+            png_unfilter_sub_sse2(line, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_sub_sse2(line, pitch, 3);
+         else
+#elif defined(RPNG_NEON)
+         if (bpp == 4)
+            png_unfilter_sub_neon(line, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_sub_neon(line, pitch, 3);
+         else
+#endif
+            png_unfilter_sub(line, pitch, bpp);
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+         png_unfilter_up(line, prev, pitch);
          break;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
+#if defined(RPNG_SSE2)
+         if (bpp == 4)
+            png_unfilter_avg_sse2(line, prev, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_avg_sse2(line, prev, pitch, 3);
+         else
+#elif defined(RPNG_NEON)
+         if (bpp == 4)
+            png_unfilter_avg_neon(line, prev, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_avg_neon(line, prev, pitch, 3);
+         else
+#endif
+            png_unfilter_avg(line, prev, pitch, bpp);
          break;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+#if defined(RPNG_SSE2)
+         if (bpp == 4)
+            png_unfilter_paeth_sse2(line, prev, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_paeth_sse2(line, prev, pitch, 3);
+         else
+#elif defined(RPNG_NEON)
+         if (bpp == 4)
+            png_unfilter_paeth_neon(line, prev, pitch, 4);
+         else if (bpp == 3)
+            png_unfilter_paeth_neon(line, prev, pitch, 3);
+         else
+#endif
+            png_unfilter_paeth(line, prev, pitch, bpp);
          break;
-
       default:
-         return IMAGE_PROCESS_ERROR_END;
+         return false;
    }
 
+   return true;
+}
+
+static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   /* The line above the first one is all zeros, every
+    * other line is reversed in place in the inflate buffer */
+   uint8_t *line       = pngp->inflate_buf;
+   const uint8_t *prev = pngp->h
+      ? line - pngp->pitch - 1 : pngp->prev_scanline;
+
+   if (!png_reverse_filter_line(line, prev, pngp->pitch, pngp->bpp, filter))
+      return IMAGE_PROCESS_ERROR_END;
+
    switch (ihdr->color_type)
    {
       case PNG_IHDR_COLOR_GRAY:
-         png_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         png_reverse_filter_copy_line_bw(data, line, ihdr->width, ihdr->depth);
          break;
       case PNG_IHDR_COLOR_RGB:
-         png_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         png_reverse_filter_copy_line_rgb(data, line, ihdr->width, ihdr->depth);
          break;
       case PNG_IHDR_COLOR_PLT:
-         png_reverse_filter_copy_line_plt(data, pngp->decoded_scanline, ihdr->width,
+         png_reverse_filter_copy_line_plt(data, line, ihdr->width,
                ihdr->depth, pngp->palette);
          break;
       case PNG_IHDR_COLOR_GRAY_ALPHA:
-         png_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
+         png_reverse_filter_copy_line_gray_alpha(data, line, ihdr->width,
                ihdr->depth);
          break;
       case PNG_IHDR_COLOR_RGBA:
-         png_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         png_reverse_filter_copy_line_rgba(data, line, ihdr->width, ihdr->depth);
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
-
    return IMAGE_PROCESS_NEXT;
 }
 
@@ -761,18 +1060,22 @@ static int rpng_load_image_argb_process_inflate_init(rpng_t *rpng, uint32_t **da
    if (!to_continue)
       goto end;
 
-   zstatus = process->stream_backend->trans(process->stream, false, &rd, &wn, &terror);
+   /* All IDAT data is available and the output buffer holds
+    * the whole image, so this is a single Z_FINISH inflate,
+    * which lets zlib skip maintaining its sliding window.
+    * Running out of input or output space is not fatal here,
+    * the line filters check for truncated data themselves. */
+   zstatus = process->stream_backend->trans(process->stream, true, &rd, &wn, &terror);
 
-   if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+   if (     !zstatus
+         && terror != TRANS_STREAM_ERROR_BUFFER_FULL
+         && terror != TRANS_STREAM_ERROR_AGAIN)
       goto error;
 
    process->avail_in -= rd;
    process->avail_out -= wn;
    process->total_out += wn;
 
-   if (terror)
-      return 0;
-
 end:
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
@@ -833,12 +1136,19 @@ static bool png_read_trns(uint8_t *buf, uint32_t *palette, unsigned entries)
 
 bool png_realloc_idat(struct idat_buffer *buf, uint32_t chunk_size)
 {
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk_size);
+   uint8_t *new_buffer;
+   size_t capacity = buf->size + chunk_size;
+
+   if (capacity <= buf->capacity)
+      return true;
+
+   new_buffer = (uint8_t*)realloc(buf->data, capacity);
 
    if (!new_buffer)
       return false;
 
-   buf->data  = new_buffer;
+   buf->data     = new_buffer;
+   buf->capacity = capacity;
    return true;
 }
 
@@ -854,7 +1164,6 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
    process->adam7_pass_initialized = false;
    process->pass_initialized       = false;
    process->prev_scanline          = NULL;
-   process->decoded_scanline       = NULL;
    process->inflate_buf            = NULL;
 
    process->ihdr.width             = 0;
@@ -986,9 +1295,29 @@ static enum png_chunk_type read_chunk_header(
    return PNG_CHUNK_NOOP;
 }
 
+static uint32_t png_idat_total_size(const uint8_t *buf,
+      const uint8_t *buf_end)
+{
+   uint32_t total = 0;
+
+   while (buf_end - buf >= 8)
+   {
+      uint32_t chunk_size = dword_be(buf);
+
+      if (     chunk_size > (uint32_t)(buf_end - buf) - 8
+            || chunk_size > UINT32_MAX - total
+            || read_chunk_header((uint8_t*)buf, chunk_size) != PNG_CHUNK_IDAT)
+         break;
+
+      total += chunk_size;
+      buf   += chunk_size + 12;
+   }
+
+   return total;
+}
+
 bool rpng_iterate_image(rpng_t *rpng)
 {
-   unsigned i;
    uint8_t *buf             = (uint8_t*)rpng->buff_data;
    uint32_t chunk_size      = 0;
 
@@ -1101,13 +1430,17 @@ bool rpng_iterate_image(rpng_t *rpng)
          if (!(rpng->has_ihdr) || rpng->has_iend || (rpng->ihdr.color_type == PNG_IHDR_COLOR_PLT && !(rpng->has_plte)))
             return false;
 
-         if (!png_realloc_idat(&rpng->idat_buf, chunk_size))
+         /* IDAT chunks are consecutive and the whole file is
+          * in memory, so the compressed stream is allocated
+          * once instead of being grown chunk by chunk */
+         if (!png_realloc_idat(&rpng->idat_buf, rpng->has_idat
+                  ? chunk_size
+                  : png_idat_total_size(buf, rpng->buff_end)))
             return false;
 
          buf += 8;
 
-         for (i = 0; i < chunk_size; i++)
-            rpng->idat_buf.data[i + rpng->idat_buf.size] = buf[i];
+         memcpy(rpng->idat_buf.data + rpng->idat_buf.size, buf, chunk_size);
 
          rpng->idat_buf.size += chunk_size;
 
@@ -1168,10 +1501,46 @@ error:
       if (rpng->process->stream)
          rpng->process->stream_backend->stream_free(rpng->process->stream);
       free(rpng->process);
+      rpng->process = NULL;
    }
    return IMAGE_PROCESS_ERROR;
 }
 
+int rpng_decode_image(rpng_t *rpng,
+      void **_data, unsigned *width, unsigned *height)
+{
+   int ret;
+   uint32_t **data = (uint32_t**)_data;
+
+   if (!rpng)
+      return IMAGE_PROCESS_ERROR;
+
+   do
+   {
+      /* Once inflated, the remaining lines of a non
+       * interlaced image are reversed in one loop */
+      if (     rpng->process
+            && rpng->process->inflate_initialized
+            && !rpng->ihdr.interlace)
+      {
+         *width  = rpng->ihdr.width;
+         *height = rpng->ihdr.height;
+
+         do
+         {
+            ret = png_reverse_filter_regular_iterate(data,
+                  &rpng->ihdr, rpng->process);
+         } while (ret == IMAGE_PROCESS_NEXT);
+
+         return ret;
+      }
+
+      ret = rpng_process_image(rpng, _data, 0, width, height);
+   } while (ret == IMAGE_PROCESS_NEXT);
+
+   return ret;
+}
+
 void rpng_free(rpng_t *rpng)
 {
    if (!rpng)
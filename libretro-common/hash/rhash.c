@@ -32,6 +32,36 @@
 #include <retro_endianness.h>
 #include <streams/file_stream.h>
 
+/* SHA1 with the x86 SHA extensions. Compilers which support
+ * per-function targets build it regardless of -m flags, it is
+ * only used when cpu_features_get_extended() reports it. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define SHA1_NI
+#define SHA1_NI_TARGET __attribute__((target("sha,ssse3,sse4.1")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1900
+#define SHA1_NI
+#define SHA1_NI_TARGET
+#endif
+#endif
+
+/* The ARMv8 SHA1 instructions, when the compiler targets them */
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define SHA1_ARMV8
+#endif
+
+#ifdef SHA1_NI
+#include <immintrin.h>
+#endif
+
+#ifdef SHA1_ARMV8
+#include <arm_neon.h>
+#endif
+
+#if defined(SHA1_NI) || defined(SHA1_ARMV8)
+#include <features/features_cpu.h>
+#endif
+
 #define LSL32(x, n) ((uint32_t)(x) << (n))
 #define LSR32(x, n) ((uint32_t)(x) >> (n))
 #define ROR32(x, n) (LSR32(x, n) | LSL32(x, 32 - (n)))
@@ -307,20 +337,6 @@ uint32_t crc32_calculate(const uint8_t *data, size_t length)
 /* Define the circular shift macro */
 #define SHA1CircularShift(bits,word) ((((word) << (bits)) & 0xFFFFFFFF) | ((word) >> (32-(bits))))
 
-struct sha1_context
-{
-   unsigned Message_Digest[5]; /* Message Digest (output)          */
-
-   unsigned Length_Low;        /* Message length in bits           */
-   unsigned Length_High;       /* Message length in bits           */
-
-   unsigned char Message_Block[64]; /* 512-bit message blocks      */
-   int Message_Block_Index;    /* Index into message block array   */
-
-   int Computed;               /* Is the digest computed?          */
-   int Corrupted;              /* Is the message digest corruped?  */
-};
-
 
 static void SHA1Reset(struct sha1_context *context)
 {
@@ -341,7 +357,7 @@ static void SHA1Reset(struct sha1_context *context)
    context->Corrupted  = 0;
 }
 
-static void SHA1ProcessMessageBlock(struct sha1_context *context)
+static void SHA1ProcessBlock(unsigned *digest, const unsigned char *block)
 {
    const unsigned K[] =            /* Constants defined in SHA-1   */
    {
@@ -358,20 +374,20 @@ static void SHA1ProcessMessageBlock(struct sha1_context *context)
    /* Initialize the first 16 words in the array W */
    for (t = 0; t < 16; t++)
    {
-      W[t] = ((unsigned) context->Message_Block[t * 4]) << 24;
-      W[t] |= ((unsigned) context->Message_Block[t * 4 + 1]) << 16;
-      W[t] |= ((unsigned) context->Message_Block[t * 4 + 2]) << 8;
-      W[t] |= ((unsigned) context->Message_Block[t * 4 + 3]);
+      W[t] = ((unsigned) block[t * 4]) << 24;
+      W[t] |= ((unsigned) block[t * 4 + 1]) << 16;
+      W[t] |= ((unsigned) block[t * 4 + 2]) << 8;
+      W[t] |= ((unsigned) block[t * 4 + 3]);
    }
 
    for (t = 16; t < 80; t++)
       W[t] = SHA1CircularShift(1,W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
 
-   A = context->Message_Digest[0];
-   B = context->Message_Digest[1];
-   C = context->Message_Digest[2];
-   D = context->Message_Digest[3];
-   E = context->Message_Digest[4];
+   A = digest[0];
+   B = digest[1];
+   C = digest[2];
+   D = digest[3];
+   E = digest[4];
 
    for (t = 0; t < 20; t++)
    {
@@ -419,17 +435,411 @@ static void SHA1ProcessMessageBlock(struct sha1_context *context)
       A = temp;
    }
 
-   context->Message_Digest[0] =
-      (context->Message_Digest[0] + A) & 0xFFFFFFFF;
-   context->Message_Digest[1] =
-      (context->Message_Digest[1] + B) & 0xFFFFFFFF;
-   context->Message_Digest[2] =
-      (context->Message_Digest[2] + C) & 0xFFFFFFFF;
-   context->Message_Digest[3] =
-      (context->Message_Digest[3] + D) & 0xFFFFFFFF;
-   context->Message_Digest[4] =
-      (context->Message_Digest[4] + E) & 0xFFFFFFFF;
+   digest[0] = (digest[0] + A) & 0xFFFFFFFF;
+   digest[1] = (digest[1] + B) & 0xFFFFFFFF;
+   digest[2] = (digest[2] + C) & 0xFFFFFFFF;
+   digest[3] = (digest[3] + D) & 0xFFFFFFFF;
+   digest[4] = (digest[4] + E) & 0xFFFFFFFF;
+}
+
+static void sha1_blocks_generic(unsigned *digest,
+      const unsigned char *data, size_t blocks)
+{
+   while (blocks--)
+   {
+      SHA1ProcessBlock(digest, data);
+      data += 64;
+   }
+}
+
+#ifdef SHA1_NI
+SHA1_NI_TARGET
+static void sha1_blocks_ni(unsigned *digest,
+      const unsigned char *data, size_t blocks)
+{
+   __m128i abcd, abcd_save, e0, e0_save, e1;
+   __m128i msg0, msg1, msg2, msg3;
+   /* Message words are big endian */
+   const __m128i mask = _mm_setr_epi8(
+         15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+   abcd = _mm_shuffle_epi32(
+         _mm_loadu_si128((const __m128i*)digest), 0x1B);
+   e0   = _mm_setr_epi32(0, 0, 0, (int)digest[4]);
+
+   while (blocks--)
+   {
+      abcd_save = abcd;
+      e0_save   = e0;
+
+      /* Rounds 0-3 */
+      msg0 = _mm_shuffle_epi8(_mm_loadu_si128(
+            (const __m128i*)(data + 0)), mask);
+      e0   = _mm_add_epi32(e0, msg0);
+      e1   = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+      /* Rounds 4-7 */
+      msg1 = _mm_shuffle_epi8(_mm_loadu_si128(
+            (const __m128i*)(data + 16)), mask);
+      e1   = _mm_sha1nexte_epu32(e1, msg1);
+      e0   = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+      /* Rounds 8-11 */
+      msg2 = _mm_shuffle_epi8(_mm_loadu_si128(
+            (const __m128i*)(data + 32)), mask);
+      e0   = _mm_sha1nexte_epu32(e0, msg2);
+      e1   = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 12-15 */
+      msg3 = _mm_shuffle_epi8(_mm_loadu_si128(
+            (const __m128i*)(data + 48)), mask);
+      e1   = _mm_sha1nexte_epu32(e1, msg3);
+      e0   = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 16-19 */
+      e0   = _mm_sha1nexte_epu32(e0, msg0);
+      e1   = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 20-23 */
+      e1   = _mm_sha1nexte_epu32(e1, msg1);
+      e0   = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 24-27 */
+      e0   = _mm_sha1nexte_epu32(e0, msg2);
+      e1   = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 28-31 */
+      e1   = _mm_sha1nexte_epu32(e1, msg3);
+      e0   = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 32-35 */
+      e0   = _mm_sha1nexte_epu32(e0, msg0);
+      e1   = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 36-39 */
+      e1   = _mm_sha1nexte_epu32(e1, msg1);
+      e0   = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 40-43 */
+      e0   = _mm_sha1nexte_epu32(e0, msg2);
+      e1   = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 44-47 */
+      e1   = _mm_sha1nexte_epu32(e1, msg3);
+      e0   = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 48-51 */
+      e0   = _mm_sha1nexte_epu32(e0, msg0);
+      e1   = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 52-55 */
+      e1   = _mm_sha1nexte_epu32(e1, msg1);
+      e0   = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 56-59 */
+      e0   = _mm_sha1nexte_epu32(e0, msg2);
+      e1   = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 60-63 */
+      e1   = _mm_sha1nexte_epu32(e1, msg3);
+      e0   = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 64-67 */
+      e0   = _mm_sha1nexte_epu32(e0, msg0);
+      e1   = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 68-71 */
+      e1   = _mm_sha1nexte_epu32(e1, msg1);
+      e0   = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 72-75 */
+      e0   = _mm_sha1nexte_epu32(e0, msg2);
+      e1   = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+      /* Rounds 76-79 */
+      e1   = _mm_sha1nexte_epu32(e1, msg3);
+      e0   = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      e0   = _mm_sha1nexte_epu32(e0, e0_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+
+      data += 64;
+   }
+
+   _mm_storeu_si128((__m128i*)digest, _mm_shuffle_epi32(abcd, 0x1B));
+   digest[4] = (unsigned)_mm_extract_epi32(e0, 3);
+}
+#endif
+
+#ifdef SHA1_ARMV8
+static void sha1_blocks_armv8(unsigned *digest,
+      const unsigned char *data, size_t blocks)
+{
+   uint32x4_t abcd, abcd_save;
+   uint32x4_t tmp0, tmp1;
+   uint32x4_t msg0, msg1, msg2, msg3;
+   uint32_t e0, e0_save, e1;
+
+   abcd = vld1q_u32(digest);
+   e0   = digest[4];
+
+   while (blocks--)
+   {
+      abcd_save = abcd;
+      e0_save   = e0;
+
+      /* Message words are big endian */
+      msg0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data +  0)));
+      msg1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+      msg2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+      msg3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+      tmp0 = vaddq_u32(msg0, vdupq_n_u32(0x5A827999));
+      tmp1 = vaddq_u32(msg1, vdupq_n_u32(0x5A827999));
+
+      /* Rounds 0-3 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, vdupq_n_u32(0x5A827999));
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 4-7 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, vdupq_n_u32(0x5A827999));
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 8-11 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, vdupq_n_u32(0x5A827999));
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 12-15 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, vdupq_n_u32(0x6ED9EBA1));
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 16-19 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, vdupq_n_u32(0x6ED9EBA1));
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 20-23 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, vdupq_n_u32(0x6ED9EBA1));
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 24-27 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, vdupq_n_u32(0x6ED9EBA1));
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 28-31 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, vdupq_n_u32(0x6ED9EBA1));
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 32-35 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, vdupq_n_u32(0x8F1BBCDC));
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 36-39 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, vdupq_n_u32(0x8F1BBCDC));
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 40-43 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, vdupq_n_u32(0x8F1BBCDC));
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 44-47 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, vdupq_n_u32(0x8F1BBCDC));
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 48-51 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, vdupq_n_u32(0x8F1BBCDC));
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 52-55 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, vdupq_n_u32(0xCA62C1D6));
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 56-59 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, vdupq_n_u32(0xCA62C1D6));
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 60-63 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, vdupq_n_u32(0xCA62C1D6));
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 64-67 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, vdupq_n_u32(0xCA62C1D6));
+      msg3 = vsha1su1q_u32(msg3, msg2);
+
+      /* Rounds 68-71 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, vdupq_n_u32(0xCA62C1D6));
+
+      /* Rounds 72-75 */
+      e1   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+
+      /* Rounds 76-79 */
+      e0   = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      e0   += e0_save;
+      abcd  = vaddq_u32(abcd, abcd_save);
+
+      data += 64;
+   }
+
+   vst1q_u32(digest, abcd);
+   digest[4] = e0;
+}
+#endif
+
+typedef void (*sha1_blocks_t)(unsigned *digest,
+      const unsigned char *data, size_t blocks);
 
+static sha1_blocks_t sha1_select_blocks(void)
+{
+#if defined(SHA1_NI) || defined(SHA1_ARMV8)
+   uint64_t features = cpu_features_get_extended();
+#ifdef SHA1_NI
+   if (features & CPU_FEATURE_SHA1)
+      return sha1_blocks_ni;
+#endif
+#ifdef SHA1_ARMV8
+   if (features & CPU_FEATURE_SHA1)
+      return sha1_blocks_armv8;
+#endif
+#endif
+   return sha1_blocks_generic;
+}
+
+/* Hashes whole 64 byte blocks into 'digest' */
+static void sha1_blocks(unsigned *digest,
+      const unsigned char *data, size_t blocks)
+{
+   /* Picked on first use. Threads racing here all store
+    * the same pointer, so no locking is needed */
+   static sha1_blocks_t blocks_impl = NULL;
+
+   if (!blocks_impl)
+      blocks_impl = sha1_select_blocks();
+
+   blocks_impl(digest, data, blocks);
+}
+
+static void SHA1ProcessMessageBlock(struct sha1_context *context)
+{
+   sha1_blocks(context->Message_Digest, context->Message_Block, 1);
    context->Message_Block_Index = 0;
 }
 
@@ -446,7 +856,7 @@ static void SHA1PadMessage(struct sha1_context *context)
     */
    context->Message_Block[context->Message_Block_Index++] = 0x80;
 
-   if (context->Message_Block_Index > 55)
+   if (context->Message_Block_Index > 56)
    {
       while (context->Message_Block_Index < 64)
          context->Message_Block[context->Message_Block_Index++] = 0;
@@ -488,6 +898,10 @@ static void SHA1Input(struct sha1_context *context,
       const unsigned char *message_array,
       unsigned length)
 {
+   unsigned bits;
+   unsigned high;
+   size_t blocks;
+
    if (!length)
       return;
 
@@ -497,28 +911,82 @@ static void SHA1Input(struct sha1_context *context,
       return;
    }
 
-   while (length-- && !context->Corrupted)
+   /* Count the whole input at once, in bits */
+   bits                = (length << 3) & 0xFFFFFFFF;
+   high                = (context->Length_High + (length >> 29)) & 0xFFFFFFFF;
+   context->Length_Low = (context->Length_Low + bits) & 0xFFFFFFFF;
+   if (context->Length_Low < bits)
+      high = (high + 1) & 0xFFFFFFFF;
+   if (high < context->Length_High)
+   {
+      context->Corrupted = 1; /* Message is too long */
+      return;
+   }
+   context->Length_High = high;
+
+   /* Top up a partially filled block first */
+   if (context->Message_Block_Index)
+   {
+      unsigned amount = 64 - context->Message_Block_Index;
+      if (amount > length)
+         amount = length;
+
+      memcpy(context->Message_Block + context->Message_Block_Index,
+            message_array, amount);
+      context->Message_Block_Index += amount;
+      message_array                += amount;
+      length                       -= amount;
+
+      if (context->Message_Block_Index < 64)
+         return;
+
+      SHA1ProcessMessageBlock(context);
+   }
+
+   /* Whole blocks are hashed straight from the input */
+   blocks = length >> 6;
+   if (blocks)
    {
-      context->Message_Block[context->Message_Block_Index++] =
-         (*message_array & 0xFF);
-
-      context->Length_Low += 8;
-      /* Force it to 32 bits */
-      context->Length_Low &= 0xFFFFFFFF;
-      if (context->Length_Low == 0)
-      {
-         context->Length_High++;
-         /* Force it to 32 bits */
-         context->Length_High &= 0xFFFFFFFF;
-         if (context->Length_High == 0)
-            context->Corrupted = 1; /* Message is too long */
-      }
-
-      if (context->Message_Block_Index == 64)
-         SHA1ProcessMessageBlock(context);
-
-      message_array++;
+      sha1_blocks(context->Message_Digest, message_array, blocks);
+      message_array += blocks << 6;
+      length        -= (unsigned)(blocks << 6);
    }
+
+   memcpy(context->Message_Block, message_array, length);
+   context->Message_Block_Index = length;
+}
+
+void sha1_context_init(struct sha1_context *context)
+{
+   SHA1Reset(context);
+}
+
+void sha1_context_update(struct sha1_context *context,
+      const void *data, size_t len)
+{
+   const unsigned char *in = (const unsigned char*)data;
+
+   /* SHA1Input() takes an unsigned length */
+   while (len)
+   {
+      unsigned amount = len > 0x10000000 ? 0x10000000 : (unsigned)len;
+      SHA1Input(context, in, amount);
+      in  += amount;
+      len -= amount;
+   }
+}
+
+bool sha1_context_final(struct sha1_context *context, uint8_t *digest)
+{
+   unsigned i;
+
+   if (!SHA1Result(context))
+      return false;
+
+   for (i = 0; i < 20; i++)
+      digest[i] = (uint8_t)(context->Message_Digest[i >> 2]
+            >> (24 - ((i & 3) << 3)));
+   return true;
 }
 
 int sha1_calculate(const char *path, char *result)
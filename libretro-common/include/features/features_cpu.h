@@ -59,6 +59,25 @@ retro_time_t cpu_features_get_time_usec(void);
  **/
 uint64_t cpu_features_get(void);
 
+/* CPU features without a RETRO_SIMD_* flag. These are only
+ * used to pick hardware accelerated routines within
+ * libretro-common, and are not reported to cores. */
+#define CPU_FEATURE_PCLMUL (1 << 0) /* x86 carry-less multiply */
+#define CPU_FEATURE_SHA1   (1 << 1) /* x86 SHA extensions, ARMv8 SHA1 */
+#define CPU_FEATURE_CRC32  (1 << 2) /* ARMv8 CRC32 */
+
+/**
+ * cpu_features_get_extended:
+ *
+ * Gets the CPU features used by the hashing routines.
+ * Unlike cpu_features_get(), only features which the
+ * accelerated routines can use as-is are reported, e.g.
+ * CPU_FEATURE_PCLMUL is only set alongside SSE4.1.
+ *
+ * Returns: bitmask of CPU_FEATURE_* flags.
+ **/
+uint64_t cpu_features_get_extended(void);
+
 /**
  * cpu_features_get_core_amount:
  *
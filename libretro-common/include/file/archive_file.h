@@ -121,6 +121,11 @@ struct file_archive_file_backend
       file_archive_file_cb file_cb);
    void (*archive_parse_file_free)(
       void *context);
+   /* Optional. Makes the file named needle the next one
+    * to be iterated. Returns 1 if found, otherwise 0. */
+   int (*archive_parse_file_find)(
+      void *context,
+      const char *needle);
 
    bool     (*stream_decompress_data_to_file_init)(
       void *context, file_archive_file_handle_t *handle,
@@ -132,6 +137,10 @@ struct file_archive_file_backend
    uint32_t (*stream_crc_calculate)(uint32_t, const uint8_t *, size_t);
    int64_t (*compressed_file_read)(const char *path, const char *needle, void **buf,
          const char *optional_outfile);
+   /* Optional. Returns the offset of file needle in the
+    * archive if it is stored uncompressed, otherwise -1. */
+   int64_t (*compressed_file_offset)(const char *path, const char *needle,
+         int64_t *size);
    const char *ident;
 };
 
@@ -182,11 +191,39 @@ int file_archive_compressed_read(
       const char* path, void **buf,
       const char* optional_filename, int64_t *length);
 
+/**
+ * file_archive_get_stored_file_offset:
+ * @path                         : filename path of archive, with
+ *                                 the path within the archive
+ * @size                         : size of the file
+ *
+ * Returns: offset of the file within the archive if its data
+ * is stored there as is (so that it can be read or mapped
+ * directly), otherwise -1.
+ **/
+int64_t file_archive_get_stored_file_offset(const char *path,
+      int64_t *size);
+
 const struct file_archive_file_backend* file_archive_get_zlib_file_backend(void);
 const struct file_archive_file_backend* file_archive_get_7z_file_backend(void);
 
 const struct file_archive_file_backend* file_archive_get_file_backend(const char *path);
 
+/**
+ * file_archive_get_file_info:
+ * @path                         : filename path of archive
+ * @crc                          : CRC32 of the file
+ * @size                         : uncompressed size of the file
+ *
+ * Looks up a file in an archive, without extracting it.
+ * If no path within the archive is specified, the first
+ * file found inside is used.
+ *
+ * Returns: true if the file was found, otherwise false.
+ **/
+bool file_archive_get_file_info(const char *path,
+      uint32_t *crc, uint32_t *size);
+
 /**
  * file_archive_get_file_crc32:
  * @path                         : filename path of archive
@@ -197,6 +234,20 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
  **/
 uint32_t file_archive_get_file_crc32(const char *path);
 
+/**
+ * file_archive_zip_index_cache_init:
+ * @max                          : number of archives to keep
+ *
+ * Keeps the central directory of the last @max ZIP archives
+ * opened, so that opening one of them again does not read
+ * and parse its directory. Cached directories are checked
+ * against the size and modification time of the archive.
+ * Caching is disabled until this is called.
+ **/
+void file_archive_zip_index_cache_init(unsigned max);
+
+void file_archive_zip_index_cache_deinit(void);
+
 extern const struct file_archive_file_backend zlib_backend;
 extern const struct file_archive_file_backend sevenzip_backend;
 
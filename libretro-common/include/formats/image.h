@@ -71,6 +71,13 @@ bool image_texture_load_buffer(struct texture_image *img,
    enum image_type_enum type, void *buffer, size_t buffer_len);
 
 bool image_texture_load(struct texture_image *img, const char *path);
+
+/* As image_texture_load(), but formats that can decode at a
+ * reduced size (JPEG) may return an image smaller than the
+ * original, though never smaller than it would be when
+ * fitted within 'width' x 'height' */
+bool image_texture_load_scaled(struct texture_image *img,
+      const char *path, unsigned width, unsigned height);
 void image_texture_free(struct texture_image *img);
 
 /* Image transfer */
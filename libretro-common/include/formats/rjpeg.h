@@ -39,6 +39,21 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf,
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data);
 
+/**
+ * rjpeg_set_target_size:
+ * @rjpeg            : decoder
+ * @width            : width the image will be displayed at
+ * @height           : height the image will be displayed at
+ *
+ * Lets the decoder produce the image at 1/2, 1/4 or 1/8 of
+ * its size (using DCT scaling, which is much cheaper than
+ * a full decode) if it would still be no smaller than when
+ * fitted within @width x @height. 0 x 0 (the default)
+ * always decodes at full size.
+ */
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height);
+
 void rjpeg_free(rjpeg_t *rjpeg);
 
 rjpeg_t *rjpeg_alloc(void);
@@ -49,6 +49,12 @@ bool rpng_iterate_image(rpng_t *rpng);
 int rpng_process_image(rpng_t *rpng,
       void **data, size_t size, unsigned *width, unsigned *height);
 
+/* Same as calling rpng_process_image() until it stops
+ * returning IMAGE_PROCESS_NEXT, for callers which do not
+ * need to spread decoding over several frames. */
+int rpng_decode_image(rpng_t *rpng,
+      void **data, unsigned *width, unsigned *height);
+
 bool rpng_start(rpng_t *rpng);
 
 bool rpng_save_image_argb(const char *path, const uint32_t *data,
@@ -375,6 +375,26 @@ const chd_header *chd_get_header(chd_file *chd);
 /* read one hunk from the CHD file */
 chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer);
 
+/* called by chd_read_hunks() for each hunk in ascending order; returning anything
+   but CHDERR_NONE stops the read, and chd_read_hunks() returns that error */
+typedef chd_error (*chd_hunk_callback)(void *userdata, UINT32 hunknum, const void *data);
+
+/* read 'count' hunks starting at 'first'; with HAVE_THREADS they are decompressed
+   on up to 'threads' threads with codecs of their own, but still passed to the
+   callback in order, on the calling thread */
+chd_error chd_read_hunks(chd_file *chd, UINT32 first, UINT32 count,
+	unsigned threads, chd_hunk_callback callback, void *userdata);
+
+/* like chd_read_hunks(), but the threads and their codecs are set up once by
+   chd_hunk_reader_open() and kept for every chd_hunk_reader_read() until
+   chd_hunk_reader_close(), which must be called before chd_close() */
+typedef struct _chd_hunk_reader chd_hunk_reader;
+
+chd_error chd_hunk_reader_open(chd_file *chd, unsigned threads, chd_hunk_reader **reader);
+chd_error chd_hunk_reader_read(chd_hunk_reader *reader, UINT32 first, UINT32 count,
+	chd_hunk_callback callback, void *userdata);
+void chd_hunk_reader_close(chd_hunk_reader *reader);
+
 /* ----- metadata management ----- */
 
 /* get indexed metadata of a particular sort */
@@ -0,0 +1,113 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trigram_index.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_TRIGRAM_INDEX_H
+#define __LIBRETRO_SDK_TRIGRAM_INDEX_H
+
+#include <retro_common_api.h>
+
+#include <boolean.h>
+#include <stdint.h>
+#include <stddef.h>
+
+RETRO_BEGIN_DECLS
+
+/* Inverted index over a set of strings, answering
+ * case-insensitive substring queries without scanning
+ * every string.
+ *
+ * Strings are identified by the order in which they
+ * were added (0, 1, 2...). Each string is split into
+ * its overlapping three-character sequences, and every
+ * sequence maps to the ids of the strings containing it.
+ * A query term is looked up through its rarest sequence
+ * and the (few) candidates are then verified, so results
+ * are identical to a strcasestr() scan.
+ *
+ * Case folding is ASCII-only, matching strcasestr(). */
+typedef struct trigram_index trigram_index_t;
+
+/**
+ * trigram_index_new:
+ *
+ * Returns: new empty index, or NULL on allocation failure.
+ */
+trigram_index_t *trigram_index_new(void);
+
+/**
+ * trigram_index_free:
+ * @index            : index to free (may be NULL)
+ */
+void trigram_index_free(trigram_index_t *index);
+
+/**
+ * trigram_index_add:
+ * @index            : index which has not been finalized yet
+ * @str              : string to add (NULL is treated as empty)
+ *
+ * Adds @str with the next sequential id.
+ *
+ * Returns: true if successful, otherwise false.
+ */
+bool trigram_index_add(trigram_index_t *index, const char *str);
+
+/**
+ * trigram_index_finalize:
+ * @index            : index to finalize
+ *
+ * Sorts the collected sequences into their final lookup
+ * tables. Must be called once after the last string was
+ * added and before searching; the index cannot grow
+ * afterwards.
+ *
+ * Returns: true if successful, otherwise false.
+ */
+bool trigram_index_finalize(trigram_index_t *index);
+
+/**
+ * trigram_index_size:
+ * @index            : index
+ *
+ * Returns: number of strings added to @index.
+ */
+size_t trigram_index_size(const trigram_index_t *index);
+
+/**
+ * trigram_index_search:
+ * @index            : finalized index
+ * @terms            : search terms
+ * @num_terms        : number of entries in @terms
+ * @num_matches      : receives the number of matches
+ *
+ * Finds the strings containing every one of @terms
+ * (ignoring case). Empty or NULL terms match anything.
+ *
+ * Returns: array of matching ids in ascending order, to be
+ * freed by the caller. NULL if there are no matches or on
+ * allocation failure (@num_matches is 0 in both cases).
+ */
+uint32_t *trigram_index_search(const trigram_index_t *index,
+      const char **terms, size_t num_terms, size_t *num_matches);
+
+RETRO_END_DECLS
+
+#endif
@@ -26,6 +26,8 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#include <boolean.h>
+
 #if defined(__CELLOS_LV2__) || defined(PSP) || defined(PS2) || defined(GEKKO) || defined(VITA) || defined(_XBOX) || defined(_3DS) || defined(WIIU) || defined(SWITCH) || defined(HAVE_LIBNX)
 /* No mman available */
 #elif defined(_WIN32) && !defined(_XBOX)
@@ -49,4 +51,34 @@ int memsync(void *start, void *end);
 
 int memprotect(void *addr, size_t len);
 
+/* A private mapping of (part of) a file */
+struct memmap_file_region
+{
+   void *data;      /* First byte requested */
+   void *base;      /* Start of the mapping, page aligned */
+   size_t len;      /* Bytes available at 'data' */
+   size_t base_len; /* Size of the mapping */
+};
+
+/**
+ * memmap_file_region:
+ * @path                 : path of the file.
+ * @offset               : offset of the first byte to map.
+ * @len                  : number of bytes to map, 0 for the
+ *                         rest of the file.
+ * @region               : filled in on success.
+ *
+ * Maps part of a file copy-on-write: the pages are read from
+ * the file as they are accessed, and writing to them never
+ * changes the file.
+ *
+ * Returns: true on success, false if the file could not be
+ * mapped (which is always the case on platforms without
+ * mmap), in which case it should be read instead.
+ **/
+bool memmap_file_region(const char *path, uint64_t offset, uint64_t len,
+      struct memmap_file_region *region);
+
+void memunmap_file_region(struct memmap_file_region *region);
+
 #endif
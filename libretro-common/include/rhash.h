@@ -31,6 +31,7 @@
 #include "config.h"
 #endif
 
+#include <boolean.h>
 #include <retro_inline.h>
 
 #include <retro_common_api.h>
@@ -49,6 +50,48 @@ void sha256_hash(char *out, const uint8_t *in, size_t size);
 
 int sha1_calculate(const char *path, char *result);
 
+struct sha1_context
+{
+   unsigned Message_Digest[5]; /* Message Digest (output)          */
+
+   unsigned Length_Low;        /* Message length in bits           */
+   unsigned Length_High;       /* Message length in bits           */
+
+   unsigned char Message_Block[64]; /* 512-bit message blocks      */
+   int Message_Block_Index;    /* Index into message block array   */
+
+   int Computed;               /* Is the digest computed?          */
+   int Corrupted;              /* Is the message digest corruped?  */
+};
+
+/**
+ * sha1_context_init:
+ * @context           : SHA1 state.
+ *
+ * Starts an incremental SHA1 computation.
+ **/
+void sha1_context_init(struct sha1_context *context);
+
+/**
+ * sha1_context_update:
+ * @context           : SHA1 state.
+ * @data              : Input.
+ * @len               : Size of @data.
+ *
+ * Adds @data to the message.
+ **/
+void sha1_context_update(struct sha1_context *context,
+      const void *data, size_t len);
+
+/**
+ * sha1_context_final:
+ * @context           : SHA1 state.
+ * @digest            : Receives the 20 byte digest.
+ *
+ * Returns: false if the message was too long, otherwise true.
+ **/
+bool sha1_context_final(struct sha1_context *context, uint8_t *digest);
+
 uint32_t djb2_calculate(const char *str);
 
 /* Any 32-bit or wider unsigned integer data type will do */
@@ -26,6 +26,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <boolean.h>
+
 #include <retro_common_api.h>
 
 RETRO_BEGIN_DECLS
@@ -39,6 +41,23 @@ typedef struct chdstream chdstream_t;
 /* Primary (largest) data track, used for CRC identification purposes */
 #define CHDSTREAM_TRACK_PRIMARY (-3)
 
+/* Decompressed hunks kept per stream */
+#define CHDSTREAM_CACHE_HUNKS_DEFAULT 16
+/* Hunks decompressed in the background ahead of
+ * sequential reads (HAVE_THREADS only) */
+#define CHDSTREAM_READAHEAD_HUNKS_DEFAULT 4
+
+/**
+ * chdstream_set_cache_size:
+ * @cache_hunks      : decompressed hunks kept per stream (at least 1)
+ * @readahead_hunks  : hunks to load ahead of sequential reads on a
+ *                     background thread, 0 to disable
+ *
+ * Applies to streams opened afterwards. The cache is enlarged as
+ * needed to hold the read-ahead window.
+ */
+void chdstream_set_cache_size(unsigned cache_hunks, unsigned readahead_hunks);
+
 chdstream_t *chdstream_open(const char *path, int32_t track);
 
 void chdstream_close(chdstream_t *stream);
@@ -61,6 +80,19 @@ uint32_t chdstream_get_track_start(chdstream_t* stream);
 
 uint32_t chdstream_get_frame_size(chdstream_t* stream);
 
+/**
+ * chdstream_get_crc:
+ * @stream           : stream
+ * @crc              : receives the CRC32
+ *
+ * Computes the CRC32 of the whole track, as reading it from the
+ * start would. With HAVE_THREADS the hunks are decompressed on
+ * one thread per core. The read cursor is left unchanged.
+ *
+ * Returns: true if successful, otherwise false.
+ */
+bool chdstream_get_crc(chdstream_t *stream, uint32_t *crc);
+
 RETRO_END_DECLS
 
 #endif
@@ -97,6 +97,16 @@ int filestream_error(RFILE *stream);
 
 int filestream_flush(RFILE *stream);
 
+/**
+ * filestream_get_stats:
+ * @stream             : file stream
+ * @stats              : filled with the I/O done for @stream so far
+ *
+ * Returns: false if the frontend's VFS interface is in use,
+ * which does not report statistics.
+ **/
+bool filestream_get_stats(RFILE *stream, struct retro_vfs_file_stats *stats);
+
 int filestream_delete(const char *path);
 
 int filestream_rename(const char *old_path, const char *new_path);
@@ -23,6 +23,8 @@
 #ifndef __LIBRETRO_SDK_VFS_H
 #define __LIBRETRO_SDK_VFS_H
 
+#include <stdint.h>
+
 #include <retro_common_api.h>
 #include <boolean.h>
 
@@ -62,6 +64,17 @@ enum vfs_scheme
    VFS_SCHEME_CDROM
 };
 
+/* I/O done on behalf of a file handle */
+struct retro_vfs_file_stats
+{
+   /* Bytes returned to the caller */
+   uint64_t bytes_read;
+   /* Reads, seeks and hints passed on to the OS */
+   uint64_t syscalls;
+   /* Seeks passed on to the OS */
+   uint64_t seeks;
+};
+
 #ifndef __WINRT__
 #ifdef VFS_FRONTEND
 struct retro_vfs_file_handle
@@ -72,7 +85,16 @@ struct libretro_vfs_implementation_file
 #ifdef HAVE_CDROM
    vfs_cdrom_t cdrom; /* int64_t alignment */
 #endif
+   struct retro_vfs_file_stats stats;
    int64_t size;
+   /* Read-ahead of read-only stdio streams: 'ra_buf' holds
+    * 'ra_len' bytes of the file from 'ra_offset' on. 'ra_pos'
+    * is the position of the stream, 'ra_fpos' that of 'fp'. */
+   int64_t ra_offset;
+   int64_t ra_pos;
+   int64_t ra_fpos;
+   uint64_t ra_size;
+   uint64_t ra_len;
    uint64_t mappos;
    uint64_t mapsize;
    FILE *fp;
@@ -82,9 +104,12 @@ struct libretro_vfs_implementation_file
    char *buf;
    char* orig_path;
    uint8_t *mapped;
+   uint8_t *ra_buf;
    int fd;
    unsigned hints;
    enum vfs_scheme scheme;
+   /* Still read front to back, as hinted to the OS */
+   bool ra_sequential;
 };
 #endif
 
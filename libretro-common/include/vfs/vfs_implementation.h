@@ -49,6 +49,12 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream, void
 
 int64_t retro_vfs_file_write_impl(libretro_vfs_implementation_file *stream, const void *s, uint64_t len);
 
+bool retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream, struct retro_vfs_file_stats *stats);
+
+/* Sets the read-ahead block size of read-only files
+ * opened from then on, 0 disables read-ahead */
+void retro_vfs_file_set_read_ahead_size(uint64_t size);
+
 int retro_vfs_file_flush_impl(libretro_vfs_implementation_file *stream);
 
 int retro_vfs_file_remove_impl(const char *path);
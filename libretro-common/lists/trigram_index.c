@@ -0,0 +1,325 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trigram_index.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <array/rbuf.h>
+#include <lists/trigram_index.h>
+
+/* Sequences are sorted with two stable 12-bit radix passes */
+#define TRIGRAM_RADIX_BITS 12
+#define TRIGRAM_RADIX_SIZE (1 << TRIGRAM_RADIX_BITS)
+
+struct trigram_index
+{
+   char *text;        /* rbuf: case folded strings, NUL terminated */
+   uint32_t *offsets; /* rbuf: start of each string in 'text' */
+   uint64_t *pairs;   /* rbuf: (trigram << 32) | id, until finalized */
+   uint32_t *keys;    /* unique trigrams, ascending */
+   uint32_t *starts;  /* ids of keys[i] are ids[starts[i]..starts[i+1]) */
+   uint32_t *ids;
+   size_t num_keys;
+   bool finalized;
+};
+
+static INLINE char trigram_fold(char c)
+{
+   return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static INLINE uint32_t trigram_key(const char *s)
+{
+   return ((uint32_t)(uint8_t)s[0] << 16)
+        | ((uint32_t)(uint8_t)s[1] <<  8)
+        |  (uint32_t)(uint8_t)s[2];
+}
+
+trigram_index_t *trigram_index_new(void)
+{
+   return (trigram_index_t*)calloc(1, sizeof(trigram_index_t));
+}
+
+void trigram_index_free(trigram_index_t *index)
+{
+   if (!index)
+      return;
+
+   RBUF_FREE(index->text);
+   RBUF_FREE(index->offsets);
+   RBUF_FREE(index->pairs);
+   if (index->keys)
+      free(index->keys);
+   if (index->starts)
+      free(index->starts);
+   if (index->ids)
+      free(index->ids);
+   free(index);
+}
+
+bool trigram_index_add(trigram_index_t *index, const char *str)
+{
+   size_t i, len, offset, num_pairs;
+   uint32_t id;
+   char *folded;
+
+   if (!index || index->finalized)
+      return false;
+
+   len       = str ? strlen(str) : 0;
+   offset    = RBUF_LEN(index->text);
+   num_pairs = RBUF_LEN(index->pairs);
+   id        = (uint32_t)RBUF_LEN(index->offsets);
+
+   if (     !RBUF_TRYFIT(index->text, offset + len + 1)
+         || !RBUF_TRYFIT(index->pairs, num_pairs + (len > 2 ? len - 2 : 0))
+         || !RBUF_TRYFIT(index->offsets, id + 1))
+      return false;
+
+   folded = index->text + offset;
+   for (i = 0; i < len; i++)
+      folded[i] = trigram_fold(str[i]);
+   folded[len] = '\0';
+   RBUF_RESIZE(index->text, offset + len + 1);
+
+   /* Repeated sequences within one string are
+    * removed when the index is finalized */
+   for (i = 0; i + 2 < len; i++)
+      index->pairs[num_pairs++] =
+         ((uint64_t)trigram_key(folded + i) << 32) | id;
+   RBUF_RESIZE(index->pairs, num_pairs);
+
+   RBUF_PUSH(index->offsets, (uint32_t)offset);
+   return true;
+}
+
+bool trigram_index_finalize(trigram_index_t *index)
+{
+   size_t i, num_ids;
+   unsigned pass;
+   uint64_t *src;
+   uint64_t *tmp;
+   size_t n;
+
+   if (!index || index->finalized)
+      return false;
+
+   n   = RBUF_LEN(index->pairs);
+   src = index->pairs;
+   tmp = (uint64_t*)malloc((n ? n : 1) * sizeof(*tmp));
+
+   index->keys   = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+   index->starts = (uint32_t*)malloc((n + 1)     * sizeof(uint32_t));
+   index->ids    = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+
+   if (!tmp || !index->keys || !index->starts || !index->ids)
+   {
+      if (tmp)
+         free(tmp);
+      return false;
+   }
+
+   /* Pairs were added in id order, so a stable sort on
+    * the trigram alone leaves each key's ids ascending */
+   for (pass = 0; pass < 2; pass++)
+   {
+      size_t counts[TRIGRAM_RADIX_SIZE];
+      size_t sum   = 0;
+      unsigned shift = 32 + pass * TRIGRAM_RADIX_BITS;
+      uint64_t *dst  = (src == index->pairs) ? tmp : index->pairs;
+
+      memset(counts, 0, sizeof(counts));
+      for (i = 0; i < n; i++)
+         counts[(src[i] >> shift) & (TRIGRAM_RADIX_SIZE - 1)]++;
+      for (i = 0; i < TRIGRAM_RADIX_SIZE; i++)
+      {
+         size_t count = counts[i];
+         counts[i]    = sum;
+         sum         += count;
+      }
+      for (i = 0; i < n; i++)
+         dst[counts[(src[i] >> shift) & (TRIGRAM_RADIX_SIZE - 1)]++] = src[i];
+
+      src = dst;
+   }
+
+   num_ids         = 0;
+   index->num_keys = 0;
+
+   for (i = 0; i < n; i++)
+   {
+      uint32_t key = (uint32_t)(src[i] >> 32);
+      uint32_t id  = (uint32_t)src[i];
+
+      if (index->num_keys == 0 || index->keys[index->num_keys - 1] != key)
+      {
+         index->keys  [index->num_keys] = key;
+         index->starts[index->num_keys] = (uint32_t)num_ids;
+         index->num_keys++;
+      }
+      else if (index->ids[num_ids - 1] == id)
+         continue;
+
+      index->ids[num_ids++] = id;
+   }
+   index->starts[index->num_keys] = (uint32_t)num_ids;
+
+   free(tmp);
+   RBUF_FREE(index->pairs);
+
+   index->finalized = true;
+   return true;
+}
+
+size_t trigram_index_size(const trigram_index_t *index)
+{
+   return index ? RBUF_LEN(index->offsets) : 0;
+}
+
+/* Returns the position of 'key' in index->keys, or -1 */
+static int64_t trigram_index_find_key(const trigram_index_t *index,
+      uint32_t key)
+{
+   size_t lo = 0;
+   size_t hi = index->num_keys;
+
+   while (lo < hi)
+   {
+      size_t mid = lo + ((hi - lo) >> 1);
+      if (index->keys[mid] < key)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if (lo < index->num_keys && index->keys[lo] == key)
+      return (int64_t)lo;
+   return -1;
+}
+
+uint32_t *trigram_index_search(const trigram_index_t *index,
+      const char **terms, size_t num_terms, size_t *num_matches)
+{
+   size_t i, j;
+   size_t total_len         = 0;
+   size_t num_folded        = 0;
+   size_t num_candidates    = 0;
+   const uint32_t *cand     = NULL;
+   char **folded            = NULL;
+   char *folded_buf         = NULL;
+   uint32_t *matches        = NULL;
+   size_t count             = 0;
+
+   *num_matches = 0;
+
+   if (!index || !index->finalized)
+      return NULL;
+
+   count = RBUF_LEN(index->offsets);
+   if (count == 0)
+      return NULL;
+
+   for (i = 0; i < num_terms; i++)
+      if (terms[i])
+         total_len += strlen(terms[i]) + 1;
+
+   if (total_len)
+   {
+      char *out;
+
+      folded     = (char**)malloc(num_terms * sizeof(*folded));
+      folded_buf = (char*)malloc(total_len);
+      if (!folded || !folded_buf)
+         goto end;
+
+      out = folded_buf;
+      for (i = 0; i < num_terms; i++)
+      {
+         const char *term = terms[i];
+         if (!term || !*term)
+            continue;
+         folded[num_folded++] = out;
+         while (*term)
+            *out++ = trigram_fold(*term++);
+         *out++ = '\0';
+      }
+   }
+
+   /* Candidates are the ids of the rarest sequence
+    * of any term. Without a term of three or more
+    * characters every string is a candidate. */
+   num_candidates = count;
+
+   for (i = 0; i < num_folded; i++)
+   {
+      const char *term = folded[i];
+      size_t len       = strlen(term);
+
+      for (j = 0; j + 2 < len; j++)
+      {
+         size_t size;
+         int64_t pos = trigram_index_find_key(index, trigram_key(term + j));
+
+         /* A sequence no string contains */
+         if (pos < 0)
+            goto end;
+
+         size = index->starts[pos + 1] - index->starts[pos];
+         if (!cand || size < num_candidates)
+         {
+            cand           = index->ids + index->starts[pos];
+            num_candidates = size;
+         }
+      }
+   }
+
+   matches = (uint32_t*)malloc(num_candidates * sizeof(*matches));
+   if (!matches)
+      goto end;
+
+   for (i = 0; i < num_candidates; i++)
+   {
+      uint32_t id     = cand ? cand[i] : (uint32_t)i;
+      const char *str = index->text + index->offsets[id];
+
+      for (j = 0; j < num_folded; j++)
+         if (!strstr(str, folded[j]))
+            break;
+
+      if (j == num_folded)
+         matches[(*num_matches)++] = id;
+   }
+
+   if (*num_matches == 0)
+   {
+      free(matches);
+      matches = NULL;
+   }
+
+end:
+   if (folded)
+      free(folded);
+   if (folded_buf)
+      free(folded_buf);
+   return matches;
+}
@@ -21,8 +21,15 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <memmap.h>
 
+#if defined(HAVE_MMAN) && !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PROT_READ
 #define PROT_READ         0x1  /* Page can be read */
 #endif
@@ -161,3 +168,69 @@ int memprotect(void *addr, size_t len)
 {
    return mprotect(addr, len, PROT_READ | PROT_WRITE | PROT_EXEC);
 }
+
+bool memmap_file_region(const char *path, uint64_t offset, uint64_t len,
+      struct memmap_file_region *region)
+{
+#if defined(HAVE_MMAN) && !defined(_WIN32)
+   struct stat st;
+   uint64_t aligned;
+   void *base;
+   long page_size = sysconf(_SC_PAGESIZE);
+   int fd         = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   if (     fstat(fd, &st) != 0
+         || !S_ISREG(st.st_mode)
+         || offset >= (uint64_t)st.st_size
+         || page_size <= 0)
+      goto error;
+
+   if (!len)
+      len = (uint64_t)st.st_size - offset;
+   else if (len > (uint64_t)st.st_size - offset)
+      goto error;
+
+   /* mmap wants the offset to be a multiple of the page size */
+   aligned = offset - (offset % (uint64_t)page_size);
+
+   if ((uint64_t)(size_t)(len + (offset - aligned)) != len + (offset - aligned))
+      goto error;
+
+   base = mmap(NULL, (size_t)(len + (offset - aligned)),
+         PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)aligned);
+
+   /* The mapping holds its own reference to the file */
+   close(fd);
+
+   if (base == MAP_FAILED)
+      return false;
+
+#ifdef MADV_WILLNEED
+   madvise(base, (size_t)(len + (offset - aligned)), MADV_WILLNEED);
+#endif
+
+   region->base     = base;
+   region->base_len = (size_t)(len + (offset - aligned));
+   region->data     = (uint8_t*)base + (offset - aligned);
+   region->len      = (size_t)len;
+   return true;
+
+error:
+   close(fd);
+#endif
+   return false;
+}
+
+void memunmap_file_region(struct memmap_file_region *region)
+{
+   if (!region || !region->base)
+      return;
+
+#if defined(HAVE_MMAN) && !defined(_WIN32)
+   munmap(region->base, region->base_len);
+#endif
+   memset(region, 0, sizeof(*region));
+}
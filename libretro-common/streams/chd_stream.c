@@ -25,29 +25,73 @@
 #include <string.h>
 
 #include <boolean.h>
+#include <retro_inline.h>
 
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
 #include <libchdr/chd.h>
 #include <string/stdstring.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   CHDSTREAM_HUNK_LOADING,
+   CHDSTREAM_HUNK_READY
+};
+
+typedef struct chdstream_hunk
+{
+   uint8_t *mem;
+   int32_t hunknum;
+   uint32_t last_used;
+   enum chdstream_hunk_state state;
+} chdstream_hunk_t;
+
 struct chdstream
 {
    chd_file *chd;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Decompressed hunks, least recently used is replaced */
+   chdstream_hunk_t *hunks;
+#ifdef HAVE_THREADS
+   /* Guards 'hunks' and the read-ahead window */
+   slock_t *lock;
+   /* Serialises chd_read(), libchdr is not thread-safe */
+   slock_t *chd_lock;
+   /* Signalled when a hunk is loaded or read-ahead is requested */
+   scond_t *cond;
+   sthread_t *thread;
+   /* Hunks [readahead_next, readahead_end) are to be loaded */
+   int32_t readahead_next;
+   int32_t readahead_end;
+   bool quit;
+#endif
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
    /* Byte offset where track data ends */
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
+   /* Last hunk read, to detect sequential access */
+   int32_t last_hunk;
+   /* Consecutive hunks read in ascending order */
+   uint32_t sequential;
+   /* Number of entries in 'hunks' */
+   uint32_t num_hunks;
+   /* Number of hunks to load ahead of sequential reads */
+   uint32_t readahead;
+   uint32_t usage_counter;
+   uint32_t hunkbytes;
+   uint32_t totalhunks;
    /* Size of frame taken from each hunk */
    uint32_t frame_size;
    /* Offset of data within frame */
@@ -60,6 +104,15 @@ struct chdstream
    bool swab;
 };
 
+static unsigned chdstream_cache_hunks     = CHDSTREAM_CACHE_HUNKS_DEFAULT;
+static unsigned chdstream_readahead_hunks = CHDSTREAM_READAHEAD_HUNKS_DEFAULT;
+
+void chdstream_set_cache_size(unsigned cache_hunks, unsigned readahead_hunks)
+{
+   chdstream_cache_hunks     = cache_hunks ? cache_hunks : 1;
+   chdstream_readahead_hunks = readahead_hunks;
+}
+
 typedef struct metadata
 {
    uint32_t frame_offset;
@@ -208,7 +261,6 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
    uint32_t pregap         = 0;
-   uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
    chdstream_t *stream     = NULL;
    chd_file *chd           = NULL;
@@ -220,28 +272,42 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
-   stream                  = (chdstream_t*)malloc(sizeof(*stream));
+   stream                  = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
-   stream->chd             = NULL;
-   stream->swab            = false;
-   stream->frame_size      = 0;
-   stream->frame_offset    = 0;
-   stream->frames_per_hunk = 0;
-   stream->track_frame     = 0;
-   stream->track_start     = 0;
-   stream->track_end       = 0;
-   stream->offset          = 0;
-   stream->hunkmem         = NULL;
-   stream->hunknum         = -1;
+   stream->last_hunk       = -1;
 
    hd                      = chd_get_header(chd);
-   hunkmem                 = (uint8_t*)malloc(hd->hunkbytes);
-   if (!hunkmem)
+   stream->hunkbytes       = hd->hunkbytes;
+   stream->totalhunks      = hd->totalhunks;
+   stream->num_hunks       = chdstream_cache_hunks;
+#ifdef HAVE_THREADS
+   /* The reader and the read-ahead thread may each be
+    * loading a hunk while others are in use */
+   stream->readahead       = chdstream_readahead_hunks;
+   if (stream->readahead && stream->num_hunks < stream->readahead + 2)
+      stream->num_hunks    = stream->readahead + 2;
+#endif
+
+   /* Buffers are allocated on first use */
+   stream->hunks           = (chdstream_hunk_t*)calloc(
+         stream->num_hunks, sizeof(*stream->hunks));
+   if (!stream->hunks)
       goto error;
 
-   stream->hunkmem         = hunkmem;
+#ifdef HAVE_THREADS
+   if (stream->readahead)
+   {
+      stream->lock         = slock_new();
+      stream->chd_lock     = slock_new();
+      stream->cond         = scond_new();
+
+      /* Read-ahead is an optimisation, carry on without it */
+      if (!stream->lock || !stream->chd_lock || !stream->cond)
+         stream->readahead = 0;
+   }
+#endif
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -280,40 +346,285 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   uint32_t i;
+
    if (!stream)
       return;
 
-   if (stream->hunkmem)
-      free(stream->hunkmem);
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
+   }
+
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   if (stream->hunks)
+   {
+      for (i = 0; i < stream->num_hunks; i++)
+         if (stream->hunks[i].mem)
+            free(stream->hunks[i].mem);
+      free(stream->hunks);
+   }
    if (stream->chd)
       chd_close(stream->chd);
    free(stream);
 }
 
-static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+static INLINE void chdstream_lock(chdstream_t *stream)
 {
-   uint16_t *array;
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_lock(stream->lock);
+#endif
+}
 
-   if (hunknum == stream->hunknum)
-      return true;
+static INLINE void chdstream_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_unlock(stream->lock);
+#endif
+}
 
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
+/* Waits for another thread to finish loading a hunk.
+ * Only reached while the read-ahead thread exists. */
+static INLINE void chdstream_wait(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   scond_wait(stream->cond, stream->lock);
+#endif
+}
+
+static chdstream_hunk_t *chdstream_find_hunk(chdstream_t *stream,
+      int32_t hunknum)
+{
+   uint32_t i;
+
+   for (i = 0; i < stream->num_hunks; i++)
+      if (     stream->hunks[i].hunknum == hunknum
+            && stream->hunks[i].state   != CHDSTREAM_HUNK_EMPTY)
+         return &stream->hunks[i];
+
+   return NULL;
+}
+
+/* Returns an empty entry, or else the least recently used
+ * one which is not being loaded. Called with the stream
+ * locked. */
+static chdstream_hunk_t *chdstream_evict_hunk(chdstream_t *stream)
+{
+   uint32_t i;
+   chdstream_hunk_t *victim = NULL;
+
+   for (i = 0; i < stream->num_hunks; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->hunks[i];
+
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return hunk;
+
+      if (     hunk->state == CHDSTREAM_HUNK_READY
+            && (!victim
+               || (stream->usage_counter - hunk->last_used)
+                > (stream->usage_counter - victim->last_used)))
+         victim = hunk;
+   }
+
+   return victim;
+}
+
+/* Decompresses 'hunk->hunknum' into 'hunk', which the caller
+ * has marked as loading. Called with the stream unlocked. */
+static bool chdstream_decompress_hunk(chdstream_t *stream,
+      chdstream_hunk_t *hunk)
+{
+   chd_error err;
+
+   if (!hunk->mem && !(hunk->mem = (uint8_t*)malloc(stream->hunkbytes)))
+      return false;
+
+#ifdef HAVE_THREADS
+   if (stream->chd_lock)
+      slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunk->hunknum, hunk->mem);
+#ifdef HAVE_THREADS
+   if (stream->chd_lock)
+      slock_unlock(stream->chd_lock);
+#endif
+
+   if (err != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
       uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
+      uint32_t count  = stream->hunkbytes / 2;
+      uint16_t *array = (uint16_t*)hunk->mem;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
-   stream->hunknum = hunknum;
    return true;
 }
 
+/* Loads 'hunknum' into the entry 'hunk' and publishes the
+ * result. Called with the stream locked; unlocks while
+ * decompressing. */
+static bool chdstream_fill_hunk(chdstream_t *stream,
+      chdstream_hunk_t *hunk, int32_t hunknum)
+{
+   bool ok;
+
+   hunk->hunknum   = hunknum;
+   hunk->state     = CHDSTREAM_HUNK_LOADING;
+
+   chdstream_unlock(stream);
+   ok              = chdstream_decompress_hunk(stream, hunk);
+   chdstream_lock(stream);
+
+   hunk->state     = ok ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+   hunk->last_used = ++stream->usage_counter;
+#ifdef HAVE_THREADS
+   if (stream->cond)
+      scond_broadcast(stream->cond);
+#endif
+
+   return ok;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_readahead_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   while (!stream->quit)
+   {
+      int32_t hunknum;
+      chdstream_hunk_t *hunk;
+
+      if (stream->readahead_next >= stream->readahead_end)
+      {
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      hunknum = stream->readahead_next++;
+
+      if (chdstream_find_hunk(stream, hunknum))
+         continue;
+
+      /* Everything else is being loaded, the reader
+       * is ahead of us anyway */
+      if (!(hunk = chdstream_evict_hunk(stream)))
+      {
+         stream->readahead_next = stream->readahead_end;
+         continue;
+      }
+
+      chdstream_fill_hunk(stream, hunk, hunknum);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Queues the hunks following 'hunknum' for loading in the
+ * background. Called with the stream locked. */
+static void chdstream_request_readahead(chdstream_t *stream,
+      int32_t hunknum)
+{
+   int32_t end = hunknum + 1 + (int32_t)stream->readahead;
+
+   if (end > (int32_t)stream->totalhunks)
+      end = (int32_t)stream->totalhunks;
+
+   /* Keep loading an existing window, unless the reader
+    * has moved past or away from it */
+   if (     stream->readahead_next <= hunknum
+         || stream->readahead_next >  end)
+      stream->readahead_next = hunknum + 1;
+   stream->readahead_end     = end;
+
+   if (!stream->thread)
+   {
+      stream->thread = sthread_create(chdstream_readahead_thread, stream);
+      if (!stream->thread)
+      {
+         stream->readahead = 0;
+         return;
+      }
+   }
+
+   scond_broadcast(stream->cond);
+}
+#endif
+
+/* Returns the decompressed hunk, loading it if needed.
+ * Called with the stream locked; the result stays valid
+ * until the stream is unlocked. */
+static chdstream_hunk_t *chdstream_load_hunk(chdstream_t *stream,
+      int32_t hunknum)
+{
+   chdstream_hunk_t *hunk = NULL;
+
+   for (;;)
+   {
+      if ((hunk = chdstream_find_hunk(stream, hunknum)))
+      {
+         if (hunk->state == CHDSTREAM_HUNK_READY)
+         {
+            hunk->last_used = ++stream->usage_counter;
+            break;
+         }
+
+         /* Being loaded ahead of us */
+         chdstream_wait(stream);
+         continue;
+      }
+
+      if (!(hunk = chdstream_evict_hunk(stream)))
+      {
+         chdstream_wait(stream);
+         continue;
+      }
+
+      if (!chdstream_fill_hunk(stream, hunk, hunknum))
+         return NULL;
+      break;
+   }
+
+   if (hunknum != stream->last_hunk)
+   {
+      if (hunknum == stream->last_hunk + 1)
+         stream->sequential++;
+      else
+         stream->sequential = 0;
+#ifdef HAVE_THREADS
+      /* Only read ahead once three consecutive hunks were
+       * read. A small read straddling two hunks is common
+       * with random access and would just waste the work. */
+      if (stream->readahead && stream->sequential >= 2)
+         chdstream_request_readahead(stream, hunknum);
+#endif
+      stream->last_hunk = hunknum;
+   }
+
+   return hunk;
+}
+
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 {
    size_t end;
@@ -345,12 +656,21 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
          uint32_t hunk_offset = (chd_frame % stream->frames_per_hunk) 
             * hd->unitbytes;
 
-         if (!chdstream_load_hunk(stream, hunk))
+         chdstream_hunk_t *loaded;
+
+         chdstream_lock(stream);
+
+         if (!(loaded = chdstream_load_hunk(stream, hunk)))
+         {
+            chdstream_unlock(stream);
             return -1;
+         }
 
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                loaded->mem + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
+
+         chdstream_unlock(stream);
       }
 
       data_offset    += amount;
@@ -450,3 +770,111 @@ uint32_t chdstream_get_frame_size(chdstream_t *stream)
 {
    return stream->frame_size;
 }
+
+typedef struct chdstream_crc_state
+{
+   chdstream_t *stream;
+   /* Byte-swapped copy of the hunk for audio tracks */
+   uint8_t *swabbed;
+   /* Frames [first_frame, end_frame) belong to the track */
+   uint32_t first_frame;
+   uint32_t end_frame;
+   uint32_t unitbytes;
+   uint32_t crc;
+} chdstream_crc_state_t;
+
+static chd_error chdstream_crc_hunk(void *userdata,
+      uint32_t hunknum, const void *data)
+{
+   chdstream_crc_state_t *state = (chdstream_crc_state_t*)userdata;
+   chdstream_t *stream          = state->stream;
+   const uint8_t *mem           = (const uint8_t*)data;
+   uint32_t frame               = hunknum * stream->frames_per_hunk;
+   uint32_t end                 = frame + stream->frames_per_hunk;
+
+   if (frame < state->first_frame)
+      frame = state->first_frame;
+   if (end > state->end_frame)
+      end   = state->end_frame;
+
+   if (stream->swab)
+   {
+      uint32_t i;
+      uint32_t count       = stream->hunkbytes / 2;
+      const uint16_t *src  = (const uint16_t*)data;
+      uint16_t *dst        = (uint16_t*)state->swabbed;
+      for (i = 0; i < count; ++i)
+         dst[i] = SWAP16(src[i]);
+      mem                  = state->swabbed;
+   }
+
+   for (; frame < end; frame++)
+      state->crc = encoding_crc32(state->crc, mem
+            + (frame % stream->frames_per_hunk) * state->unitbytes
+            + stream->frame_offset, stream->frame_size);
+
+   return CHDERR_NONE;
+}
+
+bool chdstream_get_crc(chdstream_t *stream, uint32_t *crc)
+{
+   chdstream_crc_state_t state;
+   uint32_t first_hunk, end_hunk;
+   chd_error err;
+   unsigned threads      = 1;
+   size_t pregap         = stream->track_start;
+   uint8_t zeros[4096];
+
+   state.stream          = stream;
+   state.swabbed         = NULL;
+   state.unitbytes       = chd_get_header(stream->chd)->unitbytes;
+   state.first_frame     = stream->track_frame;
+   state.end_frame       = stream->track_frame + (uint32_t)
+      ((stream->track_end - stream->track_start) / stream->frame_size);
+   state.crc             = 0;
+
+   /* Pregap data which is not in the file reads as zeroes */
+   memset(zeros, 0, sizeof(zeros));
+   while (pregap)
+   {
+      size_t amount = pregap < sizeof(zeros) ? pregap : sizeof(zeros);
+      state.crc     = encoding_crc32(state.crc, zeros, amount);
+      pregap       -= amount;
+   }
+
+   if (state.end_frame > state.first_frame)
+   {
+      first_hunk = state.first_frame / stream->frames_per_hunk;
+      end_hunk   = (state.end_frame - 1) / stream->frames_per_hunk + 1;
+
+      if (stream->swab)
+         if (!(state.swabbed = (uint8_t*)malloc(stream->hunkbytes)))
+            return false;
+
+#ifdef HAVE_THREADS
+      /* Hunks are independent, so they are decompressed
+       * on every core while the CRC is computed here */
+      threads    = cpu_features_get_core_amount();
+
+      /* The workers share the file handle with the
+       * read-ahead thread */
+      if (stream->chd_lock)
+         slock_lock(stream->chd_lock);
+#endif
+      err = chd_read_hunks(stream->chd, first_hunk, end_hunk - first_hunk,
+            threads, chdstream_crc_hunk, &state);
+#ifdef HAVE_THREADS
+      if (stream->chd_lock)
+         slock_unlock(stream->chd_lock);
+#endif
+
+      if (state.swabbed)
+         free(state.swabbed);
+
+      if (err != CHDERR_NONE)
+         return false;
+   }
+
+   *crc = state.crc;
+   return true;
+}
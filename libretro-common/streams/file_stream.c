@@ -373,6 +373,14 @@ int64_t filestream_tell(RFILE *stream)
    return output;
 }
 
+bool filestream_get_stats(RFILE *stream, struct retro_vfs_file_stats *stats)
+{
+   if (!stream || filestream_read_cb)
+      return false;
+   return retro_vfs_file_get_stats_impl(
+         (libretro_vfs_implementation_file*)stream->hfile, stats);
+}
+
 void filestream_rewind(RFILE *stream)
 {
    if (!stream)
@@ -276,6 +276,19 @@ static bool zlib_inflate_trans(
       if (error)
          *error = TRANS_STREAM_ERROR_NONE;
    }
+   else if (zret == Z_BUF_ERROR && flush)
+   {
+      /* Z_FINISH could not complete the stream, either
+       * the output is full or the input was truncated.
+       * Report how far it got so callers can decide. */
+      if (error)
+         *error = (z->avail_out == 0)
+            ? TRANS_STREAM_ERROR_BUFFER_FULL
+            : TRANS_STREAM_ERROR_AGAIN;
+      *rd = pre_avail_in - z->avail_in;
+      *wn = pre_avail_out - z->avail_out;
+      return false;
+   }
    else
    {
       if (error)
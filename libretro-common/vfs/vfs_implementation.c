@@ -185,6 +185,140 @@
 
 #define RFILE_HINT_UNBUFFERED (1 << 8)
 
+#if defined(__linux__) && defined(POSIX_FADV_SEQUENTIAL) && (!defined(__ANDROID_API__) || __ANDROID_API__ >= 21)
+#define HAVE_VFS_FADVISE
+#endif
+
+/* Block size of the read-ahead buffer of read-only
+ * streams. 0 leaves their buffering to stdio. */
+static uint64_t vfs_read_ahead_size = 0x10000;
+
+void retro_vfs_file_set_read_ahead_size(uint64_t size)
+{
+   vfs_read_ahead_size = size;
+}
+
+#ifndef ORBIS
+static int retro_vfs_file_seek_fp(FILE *fp, int64_t offset, int whence)
+{
+#ifdef ATLEAST_VC2005
+   /* VC2005 and up have a special 64-bit fseek */
+   return _fseeki64(fp, offset, whence);
+#elif defined(HAVE_64BIT_OFFSETS)
+   return fseeko(fp, (off_t)offset, whence);
+#else
+   return fseek(fp, (long)offset, whence);
+#endif
+}
+
+/* Tells the OS whether the file will be read front
+ * to back, so that it reads ahead further (or not) */
+static void retro_vfs_file_advise(
+      libretro_vfs_implementation_file *stream, bool sequential)
+{
+#ifdef HAVE_VFS_FADVISE
+   posix_fadvise(fileno(stream->fp), 0, 0,
+         sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+   stream->stats.syscalls++;
+#endif
+   stream->ra_sequential = sequential;
+}
+
+/* Only moves the position, 'fp' follows when
+ * data outside the buffer is read */
+static int64_t retro_vfs_file_seek_read_ahead(
+      libretro_vfs_implementation_file *stream,
+      int64_t offset, int whence)
+{
+   int64_t pos = offset;
+
+   /* The file is opened read-only, its size is known */
+   if (whence == SEEK_CUR)
+      pos += stream->ra_pos;
+   else if (whence == SEEK_END)
+      pos += stream->size;
+
+   if (pos < 0)
+      return -1;
+
+   if (stream->ra_sequential && pos < stream->ra_offset)
+      retro_vfs_file_advise(stream, false);
+
+   stream->ra_pos = pos;
+   return 0;
+}
+
+static int64_t retro_vfs_file_read_ahead(
+      libretro_vfs_implementation_file *stream,
+      void *s, uint64_t len)
+{
+   uint8_t *out   = (uint8_t*)s;
+   uint64_t total = 0;
+   bool eof       = false;
+
+   while (len)
+   {
+      size_t count;
+      int64_t end = stream->ra_offset + (int64_t)stream->ra_len;
+
+      if (stream->ra_pos >= stream->ra_offset && stream->ra_pos < end)
+      {
+         uint64_t avail = (uint64_t)(end - stream->ra_pos);
+         if (avail > len)
+            avail = len;
+
+         memcpy(out, stream->ra_buf + (stream->ra_pos - stream->ra_offset),
+               (size_t)avail);
+         stream->ra_pos += avail;
+         out            += avail;
+         total          += avail;
+         len            -= avail;
+         continue;
+      }
+
+      /* Like SEEK_END, this takes the size at open as final */
+      if (eof || stream->ra_pos >= stream->size)
+         break;
+
+      if (stream->ra_fpos != stream->ra_pos)
+      {
+         stream->stats.seeks++;
+         stream->stats.syscalls++;
+
+         if (retro_vfs_file_seek_fp(stream->fp,
+                  stream->ra_pos, SEEK_SET) != 0)
+         {
+            stream->ra_fpos = -1;
+            break;
+         }
+      }
+
+      stream->stats.syscalls++;
+
+      /* A block or more is read straight into the
+       * caller's buffer, the buffer is left as it is */
+      if (len >= stream->ra_size)
+      {
+         count            = fread(out, 1, (size_t)len, stream->fp);
+         stream->ra_pos  += count;
+         stream->ra_fpos  = stream->ra_pos;
+         total           += count;
+         break;
+      }
+
+      count             = fread(stream->ra_buf, 1,
+            (size_t)stream->ra_size, stream->fp);
+      stream->ra_offset = stream->ra_pos;
+      stream->ra_len    = count;
+      stream->ra_fpos   = stream->ra_pos + (int64_t)count;
+      eof               = count < stream->ra_size;
+   }
+
+   stream->stats.bytes_read += total;
+   return (int64_t)total;
+}
+#endif
+
 int64_t retro_vfs_file_seek_internal(
       libretro_vfs_implementation_file *stream,
       int64_t offset, int whence)
@@ -198,20 +332,22 @@ int64_t retro_vfs_file_seek_internal(
       if (stream->scheme == VFS_SCHEME_CDROM)
          return retro_vfs_file_seek_cdrom(stream, offset, whence);
 #endif
-#ifdef ATLEAST_VC2005
-      /* VC2005 and up have a special 64-bit fseek */
-      return _fseeki64(stream->fp, offset, whence);
-#elif defined(ORBIS)
+#ifdef ORBIS
       {
          int ret = orbisLseek(stream->fd, offset, whence);
+         stream->stats.seeks++;
+         stream->stats.syscalls++;
          if (ret < 0)
             return -1;
          return 0;
       }
-#elif defined(HAVE_64BIT_OFFSETS)
-      return fseeko(stream->fp, (off_t)offset, whence);
 #else
-      return fseek(stream->fp, (long)offset, whence);
+      if (stream->ra_size)
+         return retro_vfs_file_seek_read_ahead(stream, offset, whence);
+
+      stream->stats.seeks++;
+      stream->stats.syscalls++;
+      return retro_vfs_file_seek_fp(stream->fp, offset, whence);
 #endif
    }
 #ifdef HAVE_MMAP
@@ -251,6 +387,9 @@ int64_t retro_vfs_file_seek_internal(
    }
 #endif
 
+   stream->stats.seeks++;
+   stream->stats.syscalls++;
+
    if (lseek(stream->fd, (off_t)offset, whence) < 0)
       return -1;
 
@@ -285,6 +424,7 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
 #endif
    int                                flags = 0;
    const char                     *mode_str = NULL;
+   uint64_t                   read_ahead_size = vfs_read_ahead_size;
    libretro_vfs_implementation_file *stream = 
       (libretro_vfs_implementation_file*)
       malloc(sizeof(*stream));
@@ -305,6 +445,14 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
    stream->mapsize                = 0;
    stream->mapped                 = NULL;
    stream->scheme                 = VFS_SCHEME_NONE;
+   stream->ra_offset              = 0;
+   stream->ra_fpos                = -1;
+   stream->ra_size                = 0;
+   stream->ra_len                 = 0;
+   stream->ra_pos                 = 0;
+   stream->ra_buf                 = NULL;
+   stream->ra_sequential          = false;
+   memset(&stream->stats, 0, sizeof(stream->stats));
 
 #ifdef VFS_FRONTEND
    if (path_len >= dumb_prefix_len)
@@ -449,9 +597,20 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
 #if !defined(PSP)
       if (stream->scheme != VFS_SCHEME_CDROM)
       {
-         stream->buf = (char*)calloc(1, 0x4000);
-         if (stream->fp)
-            setvbuf(stream->fp, stream->buf, _IOFBF, 0x4000);
+         /* Read-only streams are buffered here instead, in
+          * larger blocks which big reads bypass, and seeking
+          * within the current block is free */
+         if (     mode == RETRO_VFS_FILE_ACCESS_READ
+               && read_ahead_size
+               && (stream->ra_buf = (uint8_t*)
+                  malloc((size_t)read_ahead_size)))
+            setvbuf(stream->fp, NULL, _IONBF, 0);
+         else
+         {
+            stream->buf = (char*)calloc(1, 0x4000);
+            if (stream->fp)
+               setvbuf(stream->fp, stream->buf, _IOFBF, 0x4000);
+         }
       }
 #endif
 #endif
@@ -520,6 +679,13 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
       stream->size = retro_vfs_file_tell_impl(stream);
 
       retro_vfs_file_seek_internal(stream, 0, SEEK_SET);
+
+      if (stream->ra_buf)
+      {
+         stream->ra_size = read_ahead_size;
+         stream->ra_fpos = 0;
+         retro_vfs_file_advise(stream, true);
+      }
    }
 #endif
    return stream;
@@ -572,6 +738,9 @@ end:
    if (stream->buf)
       free(stream->buf);
 
+   if (stream->ra_buf)
+      free(stream->ra_buf);
+
    if (stream->orig_path)
       free(stream->orig_path);
 
@@ -636,6 +805,8 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
          return ret;
       }
 #else
+      if (stream->ra_size)
+         return stream->ra_pos;
 #ifdef ATLEAST_VC2005
       /* VC2005 and up have a special 64-bit ftell */
       return _ftelli64(stream->fp);
@@ -692,11 +863,20 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream,
          return retro_vfs_file_read_cdrom(stream, s, len);
 #endif
 #ifdef ORBIS
+      stream->stats.syscalls++;
       if (orbisRead(stream->fd, s, (size_t)len) < 0)
          return -1;
       return 0;
 #else
-      return fread(s, 1, (size_t)len, stream->fp);
+      if (stream->ra_size)
+         return retro_vfs_file_read_ahead(stream, s, len);
+      else
+      {
+         size_t count = fread(s, 1, (size_t)len, stream->fp);
+         stream->stats.syscalls++;
+         stream->stats.bytes_read += count;
+         return count;
+      }
 #endif
    }
 #ifdef HAVE_MMAP
@@ -709,13 +889,29 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream,
          len = stream->mapsize - stream->mappos;
 
       memcpy(s, &stream->mapped[stream->mappos], len);
-      stream->mappos += len;
+      stream->mappos            += len;
+      stream->stats.bytes_read  += len;
 
       return len;
    }
 #endif
 
-   return read(stream->fd, s, (size_t)len);
+   {
+      int64_t count = read(stream->fd, s, (size_t)len);
+      stream->stats.syscalls++;
+      if (count > 0)
+         stream->stats.bytes_read += count;
+      return count;
+   }
+}
+
+bool retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      struct retro_vfs_file_stats *stats)
+{
+   if (!stream)
+      return false;
+   *stats = stream->stats;
+   return true;
 }
 
 int64_t retro_vfs_file_write_impl(libretro_vfs_implementation_file *stream, const void *s, uint64_t len)
@@ -537,6 +537,18 @@ int64_t retro_vfs_file_write_impl(
          }, -1);
 }
 
+bool retro_vfs_file_get_stats_impl(
+      libretro_vfs_implementation_file *stream,
+      struct retro_vfs_file_stats *stats)
+{
+   /* Not tracked */
+   return false;
+}
+
+void retro_vfs_file_set_read_ahead_size(uint64_t size)
+{
+}
+
 int retro_vfs_file_flush_impl(libretro_vfs_implementation_file *stream)
 {
 	if (!stream || !stream->fp)
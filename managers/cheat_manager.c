@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <math.h>
 
+#include <retro_inline.h>
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <compat/strl.h>
@@ -32,6 +33,21 @@
 #include "../config.h"
 #endif
 
+#if defined(__SSE2__)
+#define CHEAT_SEARCH_SSE2
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(MSB_FIRST) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define CHEAT_SEARCH_NEON
+#include <arm_neon.h>
+#endif
+
+/* Number of search items covered by a single
+ * word of the candidate bitset */
+#define CHEAT_MATCH_WORD_BITS 32
+
 #ifdef HAVE_MENU
 #include "../menu/menu_driver.h"
 #endif
@@ -83,6 +99,8 @@ void cheat_manager_apply_cheats(void)
    if (!cheat_st->cheats)
       return;
 
+   cheat_st->apply_dirty = true;
+
    core_reset_cheat();
 
    for (i = 0; i < cheat_st->size; i++)
@@ -282,6 +300,8 @@ bool cheat_manager_copy_working_to_idx(unsigned idx)
    memcpy(&cheat_st->cheats[idx], &cheat_st->working_cheat,
          sizeof(struct item_cheat));
 
+   cheat_st->apply_dirty = true;
+
    if (cheat_st->cheats[idx].desc)
       free(cheat_st->cheats[idx].desc);
 
@@ -325,6 +345,12 @@ static void cheat_manager_free(void)
    if (cheat_st->memory_size_list)
       free(cheat_st->memory_size_list);
 
+   if (cheat_st->apply_entries)
+      free(cheat_st->apply_entries);
+
+   if (cheat_st->apply_writes)
+      free(cheat_st->apply_writes);
+
    cheat_st->cheats                    = NULL;
    cheat_st->size                      = 0;
    cheat_st->buf_size                  = 0;
@@ -333,10 +359,14 @@ static void cheat_manager_free(void)
    cheat_st->memory_buf_list           = NULL;
    cheat_st->memory_size_list          = NULL;
    cheat_st->matches                   = NULL;
+   cheat_st->apply_entries             = NULL;
+   cheat_st->apply_writes              = NULL;
+   cheat_st->num_apply_entries         = 0;
    cheat_st->num_memory_buffers        = 0;
    cheat_st->total_memory_size         = 0;
    cheat_st->memory_initialized        = false;
    cheat_st->memory_search_initialized = false;
+   cheat_st->apply_dirty               = true;
 }
 
 static void cheat_manager_new(unsigned size)
@@ -580,8 +610,9 @@ bool cheat_manager_realloc(unsigned new_size, unsigned default_handler)
       return false;
    }
 
-   cheat_st->buf_size = new_size;
-   cheat_st->size     = new_size;
+   cheat_st->buf_size    = new_size;
+   cheat_st->size        = new_size;
+   cheat_st->apply_dirty = true;
 
    for (i = orig_size; i < cheat_st->size; i++)
    {
@@ -626,6 +657,7 @@ void cheat_manager_toggle_index(bool apply_cheats_after_toggle,
       return;
 
    cheat_st->cheats[i].state = !cheat_st->cheats[i].state;
+   cheat_st->apply_dirty     = true;
    cheat_manager_update(&cheat_manager_state, i);
 
    if (apply_cheats_after_toggle)
@@ -639,6 +671,7 @@ void cheat_manager_toggle(void)
       return;
 
    cheat_st->cheats[cheat_st->ptr].state ^= true;
+   cheat_st->apply_dirty                  = true;
    cheat_manager_apply_cheats();
    cheat_manager_update(&cheat_manager_state, cheat_st->ptr);
 }
@@ -775,6 +808,53 @@ bool cheat_manager_alloc_if_empty(void)
    return true;
 }
 
+static INLINE unsigned cheat_manager_popcount32(uint32_t v)
+{
+   v = v - ((v >> 1) & 0x55555555);
+   v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+   return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+/**
+ * cheat_manager_reset_matches:
+ *
+ * (Re)allocates the candidate bitset for the current
+ * search size, marking every search item as a match.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool cheat_manager_reset_matches(void)
+{
+   unsigned num_words;
+   unsigned remainder;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   if (cheat_st->matches)
+      free(cheat_st->matches);
+
+   cheat_st->num_search_items = (cheat_st->total_memory_size * 8) /
+      (1 << cheat_st->search_bit_size);
+   cheat_st->num_matches      = cheat_st->num_search_items;
+   cheat_st->matches_bit_size = cheat_st->search_bit_size;
+
+   num_words                  = (cheat_st->num_search_items
+         + CHEAT_MATCH_WORD_BITS - 1) / CHEAT_MATCH_WORD_BITS;
+   cheat_st->matches          = (uint32_t*)malloc(
+         (num_words ? num_words : 1) * sizeof(uint32_t));
+
+   if (!cheat_st->matches)
+      return false;
+
+   memset(cheat_st->matches, 0xFF, num_words * sizeof(uint32_t));
+
+   /* Items past the end of memory must never be reported */
+   remainder = cheat_st->num_search_items % CHEAT_MATCH_WORD_BITS;
+   if (remainder)
+      cheat_st->matches[num_words - 1] = (1u << remainder) - 1;
+
+   return true;
+}
+
 int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool wraparound)
 {
    unsigned i;
@@ -788,6 +868,7 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
    cheat_st->num_memory_buffers           = 0;
    cheat_st->total_memory_size            = 0;
    cheat_st->curr_memory_buf              = NULL;
+   cheat_st->apply_dirty                  = true;
 
    if (cheat_st->memory_buf_list)
    {
@@ -890,16 +971,7 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          return 0;
       }
 
-      if (cheat_st->matches)
-      {
-         free(cheat_st->matches);
-         cheat_st->matches = NULL;
-      }
-
-      cheat_st->matches = (uint8_t*)calloc(
-            cheat_st->total_memory_size, sizeof(uint8_t));
-
-      if (!cheat_st->matches)
+      if (!cheat_manager_reset_matches())
       {
          free(cheat_st->prev_memory_buf);
          cheat_st->prev_memory_buf = NULL;
@@ -907,8 +979,6 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          return 0;
       }
 
-      memset(cheat_st->matches, 0xFF, cheat_st->total_memory_size);
-
       offset = 0;
 
       for (i = 0; i < cheat_st->num_memory_buffers; i++)
@@ -998,119 +1068,536 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
+static INLINE unsigned cheat_manager_read_value(const uint8_t *p,
+      unsigned bytes_per_item, bool big_endian)
+{
+   switch (bytes_per_item)
+   {
+      case 2:
+         return big_endian
+            ? ((unsigned)p[0] << 8) | p[1]
+            : p[0] | ((unsigned)p[1] << 8);
+      case 4:
+         return big_endian
+            ? ((unsigned)p[0] << 24) | ((unsigned)p[1] << 16)
+            | ((unsigned)p[2] << 8)  | p[3]
+            : p[0] | ((unsigned)p[1] << 8)
+            | ((unsigned)p[2] << 16) | ((unsigned)p[3] << 24);
+      default:
+         break;
+   }
+
+   return p[0];
+}
+
+/* Reads a single byte of (current) memory at a flat
+ * search address, crossing memory regions as required */
+static uint8_t cheat_manager_read_byte(unsigned address)
+{
+   unsigned char *curr       = NULL;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+   unsigned offset           = translate_address(address, &curr);
+
+   if (!curr || address >= cheat_st->total_memory_size)
+      return 0;
+
+   return curr[address - offset];
+}
+
+static unsigned cheat_manager_get_curr_value(unsigned address,
+      unsigned bytes_per_item, bool big_endian)
+{
+   unsigned i;
+   uint8_t bytes[4];
+
+   for (i = 0; i < bytes_per_item; i++)
+      bytes[i] = cheat_manager_read_byte(address + i);
+
+   return cheat_manager_read_value(bytes, bytes_per_item, big_endian);
+}
+
+static INLINE bool cheat_manager_search_compare(
+      enum cheat_search_type search_type, unsigned value,
+      unsigned curr_val, unsigned prev_val)
+{
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         return (curr_val == value);
+      case CHEAT_SEARCH_TYPE_LT:
+         return (curr_val < prev_val);
+      case CHEAT_SEARCH_TYPE_GT:
+         return (curr_val > prev_val);
+      case CHEAT_SEARCH_TYPE_LTE:
+         return (curr_val <= prev_val);
+      case CHEAT_SEARCH_TYPE_GTE:
+         return (curr_val >= prev_val);
+      case CHEAT_SEARCH_TYPE_EQ:
+         return (curr_val == prev_val);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return (curr_val != prev_val);
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         return (curr_val == prev_val + value);
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return (curr_val == prev_val - value);
+   }
+
+   return false;
+}
+
+/**
+ * cheat_manager_search_word_scalar:
+ *
+ * Compares the CHEAT_MATCH_WORD_BITS search items starting
+ * at @curr/@prev, only looking at items still set
+ * in @candidates.
+ *
+ * Returns: bitmask of the candidates that still match.
+ **/
+static uint32_t cheat_manager_search_word_scalar(
+      enum cheat_search_type search_type, unsigned value,
+      const uint8_t *curr, const uint8_t *prev,
+      unsigned bytes_per_item, unsigned bits, unsigned mask,
+      bool big_endian, uint32_t candidates)
+{
+   unsigned i;
+   uint32_t result = 0;
+
+   for (i = 0; i < CHEAT_MATCH_WORD_BITS; i++)
+   {
+      unsigned curr_val, prev_val;
+
+      if (!(candidates & (1u << i)))
+         continue;
+
+      if (bits < 8)
+      {
+         unsigned items_per_byte = 8 / bits;
+         unsigned byte_idx       = i / items_per_byte;
+         unsigned shift          = (i % items_per_byte) * bits;
+         curr_val                = (curr[byte_idx] >> shift) & mask;
+         prev_val                = (prev[byte_idx] >> shift) & mask;
+      }
+      else
+      {
+         curr_val = cheat_manager_read_value(curr + i * bytes_per_item,
+               bytes_per_item, big_endian);
+         prev_val = cheat_manager_read_value(prev + i * bytes_per_item,
+               bytes_per_item, big_endian);
+      }
+
+      if (cheat_manager_search_compare(search_type, value,
+               curr_val, prev_val))
+         result |= (1u << i);
+   }
+
+   return result;
+}
+
+#if defined(CHEAT_SEARCH_SSE2)
+/* Lane-wise comparison returning all-ones lanes on match.
+ * Unsigned ordering is obtained by biasing both operands
+ * into the signed range. EQPLUS/EQMINUS must not match on
+ * wraparound (the scalar path compares in unsigned int),
+ * which is detected by checking that the saturated and the
+ * wrapped results agree. */
+#define CHEAT_SEARCH_LANES(name, vec, cmpeq, cmpgt, add, adds, sub, subs, xor_, and_, andnot) \
+static INLINE vec name(enum cheat_search_type search_type, \
+      vec c, vec p, vec value, vec bias) \
+{ \
+   vec ones = cmpeq(c, c); \
+   switch (search_type) \
+   { \
+      case CHEAT_SEARCH_TYPE_EXACT: \
+         return cmpeq(c, value); \
+      case CHEAT_SEARCH_TYPE_LT: \
+         return cmpgt(xor_(p, bias), xor_(c, bias)); \
+      case CHEAT_SEARCH_TYPE_GT: \
+         return cmpgt(xor_(c, bias), xor_(p, bias)); \
+      case CHEAT_SEARCH_TYPE_LTE: \
+         return andnot(cmpgt(xor_(c, bias), xor_(p, bias)), ones); \
+      case CHEAT_SEARCH_TYPE_GTE: \
+         return andnot(cmpgt(xor_(p, bias), xor_(c, bias)), ones); \
+      case CHEAT_SEARCH_TYPE_EQ: \
+         return cmpeq(c, p); \
+      case CHEAT_SEARCH_TYPE_NEQ: \
+         return andnot(cmpeq(c, p), ones); \
+      case CHEAT_SEARCH_TYPE_EQPLUS: \
+         return and_(cmpeq(c, add(p, value)), cmpeq(c, adds(p, value))); \
+      case CHEAT_SEARCH_TYPE_EQMINUS: \
+         return and_(cmpeq(c, sub(p, value)), cmpeq(c, subs(p, value))); \
+   } \
+   return andnot(ones, ones); \
+}
+
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes8, __m128i,
+      _mm_cmpeq_epi8, _mm_cmpgt_epi8,
+      _mm_add_epi8, _mm_adds_epu8, _mm_sub_epi8, _mm_subs_epu8,
+      _mm_xor_si128, _mm_and_si128, _mm_andnot_si128)
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes16, __m128i,
+      _mm_cmpeq_epi16, _mm_cmpgt_epi16,
+      _mm_add_epi16, _mm_adds_epu16, _mm_sub_epi16, _mm_subs_epu16,
+      _mm_xor_si128, _mm_and_si128, _mm_andnot_si128)
+/* 32-bit values wrap around in the scalar path as well */
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes32, __m128i,
+      _mm_cmpeq_epi32, _mm_cmpgt_epi32,
+      _mm_add_epi32, _mm_add_epi32, _mm_sub_epi32, _mm_sub_epi32,
+      _mm_xor_si128, _mm_and_si128, _mm_andnot_si128)
+#if defined(__AVX2__)
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes8_avx2, __m256i,
+      _mm256_cmpeq_epi8, _mm256_cmpgt_epi8,
+      _mm256_add_epi8, _mm256_adds_epu8, _mm256_sub_epi8, _mm256_subs_epu8,
+      _mm256_xor_si256, _mm256_and_si256, _mm256_andnot_si256)
+#endif
+
+static INLINE __m128i cheat_manager_bswap16_sse2(__m128i v)
+{
+   return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static INLINE __m128i cheat_manager_bswap32_sse2(__m128i v)
+{
+   v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+   v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+   return cheat_manager_bswap16_sse2(v);
+}
+
+static uint32_t cheat_manager_search_word_simd(
+      enum cheat_search_type search_type, unsigned value,
+      const uint8_t *curr, const uint8_t *prev,
+      unsigned bytes_per_item, bool big_endian)
+{
+   unsigned i, j;
+   __m128i m[4];
+   uint32_t result = 0;
+
+   switch (bytes_per_item)
+   {
+      case 1:
+#if defined(__AVX2__)
+         result = (uint32_t)_mm256_movemask_epi8(
+               cheat_manager_search_lanes8_avx2(search_type,
+                  _mm256_loadu_si256((const __m256i*)curr),
+                  _mm256_loadu_si256((const __m256i*)prev),
+                  _mm256_set1_epi8((char)value),
+                  _mm256_set1_epi8((char)0x80)));
+#else
+         for (i = 0; i < 2; i++)
+         {
+            __m128i c = _mm_loadu_si128((const __m128i*)(curr + i * 16));
+            __m128i p = _mm_loadu_si128((const __m128i*)(prev + i * 16));
+            m[0]      = cheat_manager_search_lanes8(search_type, c, p,
+                  _mm_set1_epi8((char)value), _mm_set1_epi8((char)0x80));
+            result   |= (uint32_t)_mm_movemask_epi8(m[0]) << (i * 16);
+         }
+#endif
+         break;
+      case 2:
+         for (i = 0; i < 2; i++)
+         {
+            for (j = 0; j < 2; j++)
+            {
+               unsigned ofs = i * 32 + j * 16;
+               __m128i c    = _mm_loadu_si128((const __m128i*)(curr + ofs));
+               __m128i p    = _mm_loadu_si128((const __m128i*)(prev + ofs));
+               if (big_endian)
+               {
+                  c = cheat_manager_bswap16_sse2(c);
+                  p = cheat_manager_bswap16_sse2(p);
+               }
+               m[j] = cheat_manager_search_lanes16(search_type, c, p,
+                     _mm_set1_epi16((short)value),
+                     _mm_set1_epi16((short)0x8000));
+            }
+            result |= (uint32_t)_mm_movemask_epi8(
+                  _mm_packs_epi16(m[0], m[1])) << (i * 16);
+         }
+         break;
+      case 4:
+         for (i = 0; i < 2; i++)
+         {
+            for (j = 0; j < 4; j++)
+            {
+               unsigned ofs = i * 64 + j * 16;
+               __m128i c    = _mm_loadu_si128((const __m128i*)(curr + ofs));
+               __m128i p    = _mm_loadu_si128((const __m128i*)(prev + ofs));
+               if (big_endian)
+               {
+                  c = cheat_manager_bswap32_sse2(c);
+                  p = cheat_manager_bswap32_sse2(p);
+               }
+               m[j] = cheat_manager_search_lanes32(search_type, c, p,
+                     _mm_set1_epi32((int)value),
+                     _mm_set1_epi32((int)0x80000000));
+            }
+            result |= (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(
+                     _mm_packs_epi32(m[0], m[1]),
+                     _mm_packs_epi32(m[2], m[3]))) << (i * 16);
+         }
+         break;
+   }
+
+   return result;
+}
+#elif defined(CHEAT_SEARCH_NEON)
+/* NEON has native unsigned comparisons, so only the
+ * wraparound check for EQPLUS/EQMINUS needs care
+ * (see the scalar path). */
+#define CHEAT_SEARCH_LANES(name, vec, cmpeq, cmplt, add, adds, sub, subs, and_, not_) \
+static INLINE vec name(enum cheat_search_type search_type, \
+      vec c, vec p, vec value) \
+{ \
+   switch (search_type) \
+   { \
+      case CHEAT_SEARCH_TYPE_EXACT: \
+         return cmpeq(c, value); \
+      case CHEAT_SEARCH_TYPE_LT: \
+         return cmplt(c, p); \
+      case CHEAT_SEARCH_TYPE_GT: \
+         return cmplt(p, c); \
+      case CHEAT_SEARCH_TYPE_LTE: \
+         return not_(cmplt(p, c)); \
+      case CHEAT_SEARCH_TYPE_GTE: \
+         return not_(cmplt(c, p)); \
+      case CHEAT_SEARCH_TYPE_EQ: \
+         return cmpeq(c, p); \
+      case CHEAT_SEARCH_TYPE_NEQ: \
+         return not_(cmpeq(c, p)); \
+      case CHEAT_SEARCH_TYPE_EQPLUS: \
+         return and_(cmpeq(c, add(p, value)), cmpeq(c, adds(p, value))); \
+      case CHEAT_SEARCH_TYPE_EQMINUS: \
+         return and_(cmpeq(c, sub(p, value)), cmpeq(c, subs(p, value))); \
+   } \
+   return cmplt(c, c); \
+}
+
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes8, uint8x16_t,
+      vceqq_u8, vcltq_u8, vaddq_u8, vqaddq_u8, vsubq_u8, vqsubq_u8,
+      vandq_u8, vmvnq_u8)
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes16, uint16x8_t,
+      vceqq_u16, vcltq_u16, vaddq_u16, vqaddq_u16, vsubq_u16, vqsubq_u16,
+      vandq_u16, vmvnq_u16)
+/* 32-bit values wrap around in the scalar path as well */
+CHEAT_SEARCH_LANES(cheat_manager_search_lanes32, uint32x4_t,
+      vceqq_u32, vcltq_u32, vaddq_u32, vaddq_u32, vsubq_u32, vsubq_u32,
+      vandq_u32, vmvnq_u32)
+
+/* Equivalent of SSE2 movemask for 0x00/0xFF byte lanes */
+static INLINE uint32_t cheat_manager_movemask_neon(uint8x16_t v)
+{
+   static const uint8_t weights[16] = {
+      1, 2, 4, 8, 16, 32, 64, 128,
+      1, 2, 4, 8, 16, 32, 64, 128
+   };
+   uint8x16_t t = vandq_u8(v, vld1q_u8(weights));
+   uint8x8_t  s = vpadd_u8(vget_low_u8(t), vget_high_u8(t));
+   s            = vpadd_u8(s, s);
+   s            = vpadd_u8(s, s);
+   return vget_lane_u8(s, 0) | ((uint32_t)vget_lane_u8(s, 1) << 8);
+}
+
+static uint32_t cheat_manager_search_word_simd(
+      enum cheat_search_type search_type, unsigned value,
+      const uint8_t *curr, const uint8_t *prev,
+      unsigned bytes_per_item, bool big_endian)
+{
+   unsigned i, j;
+   uint32_t result = 0;
+
+   switch (bytes_per_item)
+   {
+      case 1:
+         for (i = 0; i < 2; i++)
+            result |= cheat_manager_movemask_neon(
+                  cheat_manager_search_lanes8(search_type,
+                     vld1q_u8(curr + i * 16), vld1q_u8(prev + i * 16),
+                     vdupq_n_u8((uint8_t)value))) << (i * 16);
+         break;
+      case 2:
+         for (i = 0; i < 2; i++)
+         {
+            uint16x8_t m[2];
+            for (j = 0; j < 2; j++)
+            {
+               unsigned ofs = i * 32 + j * 16;
+               uint8x16_t c = vld1q_u8(curr + ofs);
+               uint8x16_t p = vld1q_u8(prev + ofs);
+               if (big_endian)
+               {
+                  c = vrev16q_u8(c);
+                  p = vrev16q_u8(p);
+               }
+               m[j] = cheat_manager_search_lanes16(search_type,
+                     vreinterpretq_u16_u8(c), vreinterpretq_u16_u8(p),
+                     vdupq_n_u16((uint16_t)value));
+            }
+            result |= cheat_manager_movemask_neon(vcombine_u8(
+                     vmovn_u16(m[0]), vmovn_u16(m[1]))) << (i * 16);
+         }
+         break;
+      case 4:
+         for (i = 0; i < 2; i++)
+         {
+            uint32x4_t m[4];
+            for (j = 0; j < 4; j++)
+            {
+               unsigned ofs = i * 64 + j * 16;
+               uint8x16_t c = vld1q_u8(curr + ofs);
+               uint8x16_t p = vld1q_u8(prev + ofs);
+               if (big_endian)
+               {
+                  c = vrev32q_u8(c);
+                  p = vrev32q_u8(p);
+               }
+               m[j] = cheat_manager_search_lanes32(search_type,
+                     vreinterpretq_u32_u8(c), vreinterpretq_u32_u8(p),
+                     vdupq_n_u32(value));
+            }
+            result |= cheat_manager_movemask_neon(vcombine_u8(
+                     vmovn_u16(vcombine_u16(vmovn_u32(m[0]), vmovn_u32(m[1]))),
+                     vmovn_u16(vcombine_u16(vmovn_u32(m[2]), vmovn_u32(m[3])))))
+               << (i * 16);
+         }
+         break;
+   }
+
+   return result;
+}
+#endif
+
+static INLINE uint32_t cheat_manager_search_word(
+      enum cheat_search_type search_type, unsigned value,
+      const uint8_t *curr, const uint8_t *prev,
+      unsigned bytes_per_item, unsigned bits, unsigned mask,
+      bool big_endian, uint32_t candidates)
+{
+#if defined(CHEAT_SEARCH_SSE2) || defined(CHEAT_SEARCH_NEON)
+   /* Values that don't fit the search size can never
+    * match - leave those to the scalar path */
+   if (bits == 8 && value <= mask)
+      return candidates & cheat_manager_search_word_simd(search_type,
+            value, curr, prev, bytes_per_item, big_endian);
+#endif
+   return cheat_manager_search_word_scalar(search_type, value,
+         curr, prev, bytes_per_item, bits, mask, big_endian, candidates);
+}
+
+/**
+ * cheat_manager_search:
+ * @search_type               : Comparison to perform.
+ *
+ * Narrows down the candidate bitset by comparing current
+ * memory against the snapshot taken by the previous search.
+ *
+ * Memory is walked one bitset word at a time; words without
+ * any remaining candidates are skipped entirely, and words
+ * lying inside a single memory region are compared in place
+ * (vectorised where available). Only words straddling two
+ * regions or the end of memory are gathered byte by byte.
+ **/
 static int cheat_manager_search(enum cheat_search_type search_type)
 {
    char msg[100];
+   uint8_t curr_tmp[CHEAT_MATCH_WORD_BITS * 4];
+   uint8_t prev_tmp[CHEAT_MATCH_WORD_BITS * 4];
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char *curr         = cheat_st->curr_memory_buf;
-   unsigned char *prev         = cheat_st->prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
+   unsigned int value          = 0;
    unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
    unsigned int bits           = 8;
+   unsigned int word_size      = 0;
+   unsigned int num_words      = 0;
+   unsigned int region         = 0;
+   unsigned int region_start   = 0;
    unsigned int offset         = 0;
    unsigned int i              = 0;
    bool refresh                = false;
 
-   if (cheat_st->num_memory_buffers == 0)
+   if (cheat_st->num_memory_buffers == 0 || !cheat_st->prev_memory_buf)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
       return 0;
    }
 
+   /* Changing the search size restarts the narrowing */
+   if (     !cheat_st->matches
+         || cheat_st->matches_bit_size != cheat_st->search_bit_size)
+   {
+      if (!cheat_manager_reset_matches())
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_INIT_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return 0;
+      }
+   }
+
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         value = cheat_st->search_exact_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         value = cheat_st->search_eqplus_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         value = cheat_st->search_eqminus_value;
+         break;
+      default:
+         break;
+   }
+
+   /* Bytes of memory covered by one bitset word */
+   word_size = (CHEAT_MATCH_WORD_BITS << cheat_st->search_bit_size) / 8;
+   num_words = (cheat_st->num_search_items
+         + CHEAT_MATCH_WORD_BITS - 1) / CHEAT_MATCH_WORD_BITS;
+
+   for (i = 0; i < num_words; i++)
    {
-      unsigned byte_part;
+      uint32_t survivors;
+      const uint8_t *curr      = NULL;
+      const uint8_t *prev      = NULL;
+      uint32_t candidates      = cheat_st->matches[i];
+      unsigned address         = i * word_size;
 
-      offset = translate_address(idx, &curr);
+      if (!candidates)
+         continue;
+
+      while (region < cheat_st->num_memory_buffers &&
+            address >= region_start + cheat_st->memory_size_list[region])
+         region_start += cheat_st->memory_size_list[region++];
 
-      switch (bytes_per_item)
+      if (     region < cheat_st->num_memory_buffers
+            && address + word_size <= region_start
+            + cheat_st->memory_size_list[region])
       {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256) + *(prev + idx + 1) :
-               *(prev + idx) + (*(prev + idx + 1) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            prev_val = *(prev + idx);
-            break;
+         curr = cheat_st->memory_buf_list[region] + (address - region_start);
+         prev = cheat_st->prev_memory_buf + address;
       }
-
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      else
       {
-         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
-         unsigned int prev_match;
-
-         if (bits < 8)
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-         else
-            prev_match = *(cheat_st->matches + idx);
+         /* Word straddles two memory regions or the end of memory */
+         unsigned j;
 
-         if (prev_match > 0)
+         for (j = 0; j < word_size; j++)
          {
-            bool match = false;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT:
-                  match = (curr_subval == cheat_st->search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT:
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT:
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE:
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE:
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ:
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ:
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS:
-                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS:
-                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
-                  break;
-            }
-
-            if (!match)
-            {
-               if (bits < 8)
-                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                     ((~(mask << (byte_part * bits))) & 0xFF);
-               else
-                  memset(cheat_st->matches + idx, 0, bytes_per_item);
-               if (cheat_st->num_matches > 0)
-                  cheat_st->num_matches--;
-            }
+            bool in_range = (address + j < cheat_st->total_memory_size);
+            curr_tmp[j]   = cheat_manager_read_byte(address + j);
+            prev_tmp[j]   = in_range
+               ? cheat_st->prev_memory_buf[address + j] : 0;
          }
+
+         curr = curr_tmp;
+         prev = prev_tmp;
       }
+
+      survivors = cheat_manager_search_word(search_type, value,
+            curr, prev, bytes_per_item, bits, mask,
+            cheat_st->big_endian, candidates);
+
+      cheat_st->matches[i]   = survivors;
+      cheat_st->num_matches -= cheat_manager_popcount32(
+            candidates & ~survivors);
    }
 
    offset = 0;
@@ -1196,83 +1683,73 @@ bool cheat_manager_add_new_code(unsigned int memory_search_size, unsigned int ad
    return true;
 }
 
+/* Maps a search item (bit of the candidate bitset) back
+ * to its flat memory address and address mask */
+static unsigned cheat_manager_item_to_address(unsigned item,
+      unsigned bytes_per_item, unsigned bits, unsigned mask,
+      unsigned *address_mask)
+{
+   if (bits < 8)
+   {
+      unsigned items_per_byte = 8 / bits;
+      *address_mask           = mask << ((item % items_per_byte) * bits);
+      return item / items_per_byte;
+   }
+
+   *address_mask = 0xFF;
+   return item * bytes_per_item;
+}
+
 int cheat_manager_add_matches(const char *path,
       const char *label, unsigned type, size_t menuidx, size_t entry_idx)
 {
    char msg[100];
    bool                refresh = false;
-   unsigned          byte_part = 0;
-   unsigned            int idx = 0;
-   unsigned           int mask = 0;
+   unsigned int              i = 0;
+   unsigned int           mask = 0;
    unsigned int bytes_per_item = 1;
-   unsigned           int bits = 8;
-   unsigned       int curr_val = 0;
-   unsigned      int num_added = 0;
-   unsigned         int offset = 0;
+   unsigned int           bits = 8;
+   unsigned int      num_words = 0;
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char         *curr = cheat_st->curr_memory_buf;
 
    if (cheat_st->num_matches + cheat_st->size > 100)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_TOO_MANY), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
       return 0;
    }
-   cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   if (!cheat_st->matches)
+      return 0;
+
+   cheat_manager_setup_search_meta(cheat_st->matches_bit_size, &bytes_per_item, &mask, &bits);
+
+   num_words = (cheat_st->num_search_items
+         + CHEAT_MATCH_WORD_BITS - 1) / CHEAT_MATCH_WORD_BITS;
+
+   for (i = 0; i < num_words; i++)
    {
-      offset = translate_address(idx, &curr);
+      unsigned j;
+      uint32_t candidates = cheat_st->matches[i];
 
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            break;
-      }
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      for (j = 0; candidates; j++, candidates >>= 1)
       {
-         unsigned int prev_match;
+         unsigned address_mask, address, curr_val;
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-               num_added++;
-            }
-         }
-         else
+         if (!(candidates & 1))
+            continue;
+
+         address  = cheat_manager_item_to_address(
+               i * CHEAT_MATCH_WORD_BITS + j,
+               bytes_per_item, bits, mask, &address_mask);
+         curr_val = cheat_manager_get_curr_value(address,
+               bytes_per_item, cheat_st->big_endian);
+
+         if (!cheat_manager_add_new_code(cheat_st->matches_bit_size,
+                  address, address_mask, cheat_st->big_endian, curr_val))
          {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-               num_added++;
-            }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            return 0;
          }
-
       }
    }
 
@@ -1373,14 +1850,201 @@ void cheat_manager_apply_rumble(struct item_cheat *cheat, unsigned int curr_valu
       input_driver_set_rumble_state(cheat->rumble_port, RETRO_RUMBLE_WEAK, cheat->rumble_secondary_strength);
 }
 
+/* Returns a pointer to @bytes bytes of memory at flat
+ * address @address, or NULL if they don't lie inside
+ * a single memory region */
+static uint8_t *cheat_manager_translate_ptr(unsigned address,
+      unsigned bytes)
+{
+   unsigned i;
+   unsigned offset           = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   for (i = 0; i < cheat_st->num_memory_buffers; i++)
+   {
+      unsigned size = cheat_st->memory_size_list[i];
+
+      if (address >= offset && address < offset + size)
+      {
+         if (address + bytes > offset + size)
+            break;
+         return cheat_st->memory_buf_list[i] + (address - offset);
+      }
+
+      offset += size;
+   }
+
+   return NULL;
+}
+
+/**
+ * cheat_manager_compile_retro_cheats:
+ *
+ * Flattens all enabled RetroArch-handled cheats into a list
+ * of pre-translated reads and writes, so that applying them
+ * every frame doesn't have to redo the metadata lookups and
+ * address translation. Only rebuilt when cheats or memory
+ * have changed.
+ **/
+static void cheat_manager_compile_retro_cheats(void)
+{
+   unsigned i;
+   unsigned num_entries      = 0;
+   unsigned num_writes       = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   if (cheat_st->apply_entries)
+      free(cheat_st->apply_entries);
+   if (cheat_st->apply_writes)
+      free(cheat_st->apply_writes);
+
+   cheat_st->apply_entries     = NULL;
+   cheat_st->apply_writes      = NULL;
+   cheat_st->num_apply_entries = 0;
+
+   for (i = 0; i < cheat_st->size; i++)
+   {
+      if (     cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO
+            || !cheat_st->cheats[i].state)
+         continue;
+      num_entries++;
+      num_writes += cheat_st->cheats[i].repeat_count;
+   }
+
+   if (num_entries == 0)
+   {
+      cheat_st->apply_dirty = false;
+      return;
+   }
+
+   if (!cheat_st->memory_initialized)
+      cheat_manager_initialize_memory(NULL, 0, false);
+
+   /* If we're still not initialized, something
+    * must have gone wrong - try again next frame */
+   if (!cheat_st->memory_initialized || cheat_st->total_memory_size == 0)
+      return;
+
+   cheat_st->apply_entries = (struct cheat_apply_entry*)
+      calloc(num_entries, sizeof(*cheat_st->apply_entries));
+   cheat_st->apply_writes  = (struct cheat_apply_write*)
+      calloc(num_writes ? num_writes : 1, sizeof(*cheat_st->apply_writes));
+
+   if (!cheat_st->apply_entries || !cheat_st->apply_writes)
+      return;
+
+   num_writes = 0;
+
+   for (i = 0; i < cheat_st->size; i++)
+   {
+      unsigned repeat_iter;
+      unsigned mask                   = 0;
+      struct item_cheat *cheat        = &cheat_st->cheats[i];
+      struct cheat_apply_entry *entry = NULL;
+      unsigned idx                    = cheat->address;
+      unsigned address_mask           = cheat->address_mask;
+
+      if (cheat->handler != CHEAT_HANDLER_TYPE_RETRO || !cheat->state)
+         continue;
+
+      entry = &cheat_st->apply_entries[cheat_st->num_apply_entries++];
+
+      cheat_manager_setup_search_meta(cheat->memory_search_size,
+            &entry->bytes_per_item, &mask, &entry->bits);
+
+      entry->ptr                 = cheat_manager_translate_ptr(idx,
+            entry->bytes_per_item);
+      entry->cheat_idx           = i;
+      entry->cheat_type          = cheat->cheat_type;
+      entry->value               = cheat->value;
+      /* Sub-byte values wrap at their bit width, 0 means
+       * an unknown search size and no wrapping */
+      entry->value_wrap          = (entry->bits < 8 && mask != 0)
+         ? mask + 1 : mask;
+      entry->repeat_add_to_value = cheat->repeat_add_to_value;
+      entry->big_endian          = cheat->big_endian;
+      entry->first_write         = num_writes;
+      entry->num_writes          = cheat->repeat_count;
+
+      for (repeat_iter = 0; repeat_iter < cheat->repeat_count; repeat_iter++)
+      {
+         struct cheat_apply_write *write = &cheat_st->apply_writes[num_writes++];
+
+         write->ptr          = cheat_manager_translate_ptr(idx,
+               entry->bytes_per_item);
+         write->address_mask = address_mask;
+
+         if (entry->bits < 8)
+         {
+            unsigned bit_iter;
+            for (bit_iter = 0; bit_iter < cheat->repeat_add_to_address; bit_iter++)
+            {
+               address_mask = (address_mask << entry->bits) & 0xFF;
+
+               if (address_mask == 0)
+               {
+                  address_mask = mask;
+                  idx++;
+               }
+            }
+         }
+         else
+            idx += (cheat->repeat_add_to_address * entry->bytes_per_item);
+
+         idx = idx % cheat_st->total_memory_size;
+      }
+   }
+
+   cheat_st->apply_dirty = false;
+}
+
+static INLINE void cheat_manager_write_value(uint8_t *p,
+      const struct cheat_apply_entry *entry,
+      unsigned address_mask, unsigned value)
+{
+   switch (entry->bytes_per_item)
+   {
+      case 2:
+         if (entry->big_endian)
+         {
+            p[0] = (value >> 8) & 0xFF;
+            p[1] = value & 0xFF;
+         }
+         else
+         {
+            p[0] = value & 0xFF;
+            p[1] = (value >> 8) & 0xFF;
+         }
+         break;
+      case 4:
+         if (entry->big_endian)
+         {
+            p[0] = (value >> 24) & 0xFF;
+            p[1] = (value >> 16) & 0xFF;
+            p[2] = (value >> 8) & 0xFF;
+            p[3] = value & 0xFF;
+         }
+         else
+         {
+            p[0] = value & 0xFF;
+            p[1] = (value >> 8) & 0xFF;
+            p[2] = (value >> 16) & 0xFF;
+            p[3] = (value >> 24) & 0xFF;
+         }
+         break;
+      default:
+         /* Only inject the cheat bits selected by the address mask */
+         if (entry->bits < 8)
+            p[0] = (p[0] & ~address_mask) | (value & address_mask);
+         else
+            p[0] = value & 0xFF;
+         break;
+   }
+}
+
 void cheat_manager_apply_retro_cheats(void)
 {
    unsigned i;
-   unsigned int offset;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
    bool run_cheat              = true;
 #ifdef HAVE_CHEEVOS
    bool cheat_applied          = false;
@@ -1390,180 +2054,79 @@ void cheat_manager_apply_retro_cheats(void)
    if ((!cheat_st->cheats))
       return;
 
-   for (i = 0; i < cheat_st->size; i++)
-   {
-      unsigned char *curr       = NULL;
-      bool set_value            = false;
-      unsigned int idx          = 0;
-      unsigned int value_to_set = 0;
-      unsigned int repeat_iter  = 0;
-      unsigned int address_mask = cheat_st->cheats[i].address_mask;
-
-      if (cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_st->cheats[i].state)
-         continue;
-      if (!cheat_st->memory_initialized)
-         cheat_manager_initialize_memory(NULL, 0, false);
+   if (cheat_st->apply_dirty)
+      cheat_manager_compile_retro_cheats();
 
-      /* If we're still not initialized, something
-       * must have gone wrong - just bail */
-      if (!cheat_st->memory_initialized)
-         return;
+   for (i = 0; i < cheat_st->num_apply_entries; i++)
+   {
+      unsigned int w;
+      bool set_value                        = false;
+      unsigned int curr_val                 = 0;
+      unsigned int value_to_set             = 0;
+      const struct cheat_apply_entry *entry = &cheat_st->apply_entries[i];
+      const struct cheat_apply_write *write = &cheat_st->apply_writes[entry->first_write];
 
       if (!run_cheat)
       {
          run_cheat = true;
          continue;
       }
-      cheat_manager_setup_search_meta(cheat_st->cheats[i].memory_search_size, &bytes_per_item, &mask, &bits);
 
-      curr   = cheat_st->curr_memory_buf;
-      idx    = cheat_st->cheats[i].address;
+      if (entry->ptr)
+         curr_val = cheat_manager_read_value(entry->ptr,
+               entry->bytes_per_item, cheat_st->big_endian);
 
-      offset = translate_address(idx, &curr);
+      cheat_manager_apply_rumble(&cheat_st->cheats[entry->cheat_idx], curr_val);
 
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr + idx - offset);
-            break;
-      }
-
-      cheat_manager_apply_rumble(&cheat_st->cheats[i], curr_val);
-
-      switch (cheat_st->cheats[i].cheat_type)
+      switch (entry->cheat_type)
       {
          case CHEAT_TYPE_SET_TO_VALUE:
             set_value = true;
-            value_to_set = cheat_st->cheats[i].value;
+            value_to_set = entry->value;
             break;
          case CHEAT_TYPE_INCREASE_VALUE:
             set_value = true;
-            value_to_set = curr_val + cheat_st->cheats[i].value;
+            value_to_set = curr_val + entry->value;
             break;
          case CHEAT_TYPE_DECREASE_VALUE:
             set_value = true;
-            value_to_set = curr_val - cheat_st->cheats[i].value;
+            value_to_set = curr_val - entry->value;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_EQ:
-            if (!(curr_val == cheat_st->cheats[i].value))
+            if (!(curr_val == entry->value))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_NEQ:
-            if (!(curr_val != cheat_st->cheats[i].value))
+            if (!(curr_val != entry->value))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_LT:
-            if (!(cheat_st->cheats[i].value < curr_val))
+            if (!(entry->value < curr_val))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_GT:
-            if (!(cheat_st->cheats[i].value > curr_val))
+            if (!(entry->value > curr_val))
                run_cheat = false;
             break;
       }
 
-      if (set_value)
-      {
+      if (!set_value)
+         continue;
+
 #ifdef HAVE_CHEEVOS
-         cheat_applied = true;
+      cheat_applied = true;
 #endif
-         for (repeat_iter = 1; repeat_iter <= cheat_st->cheats[i].repeat_count; repeat_iter++)
-         {
-            switch (bytes_per_item)
-            {
-               case 2:
-                  if (cheat_st->cheats[i].big_endian)
-                  {
-                     *(curr + idx - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 1 - offset) = value_to_set & 0xFF;
-                  }
-                  else
-                  {
-                     *(curr + idx - offset) = value_to_set & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
-                  }
-                  break;
-               case 4:
-                  if (cheat_st->cheats[i].big_endian)
-                  {
-                     *(curr + idx - offset) = (value_to_set >> 24) & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr + idx + 2 - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 3 - offset) = value_to_set & 0xFF;
-                  }
-                  else
-                  {
-                     *(curr + idx - offset) = value_to_set & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 2 - offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr + idx + 3 - offset) = (value_to_set >> 24) & 0xFF;
-                  }
-                  break;
-               case 1:
-                  if (bits < 8)
-                  {
-                     unsigned bitpos;
-                     unsigned char val = *(curr + idx - offset);
-
-                     for (bitpos = 0; bitpos < 8; bitpos++)
-                     {
-                        if ((address_mask >> bitpos) & 0x01)
-                        {
-                           mask = (~(1 << bitpos) & 0xFF);
-                           /* Clear current bit value */
-                           val = val & mask;
-                           /* Inject cheat bit value */
-                           val = val | (((value_to_set >> bitpos) & 0x01) << bitpos);
-                        }
-                     }
-
-                     *(curr + idx - offset) = val;
-                  }
-                  else
-                     *(curr + idx - offset) = value_to_set & 0xFF;
-                  break;
-               default:
-                  *(curr + idx - offset) = value_to_set & 0xFF;
-                  break;
-            }
-
-            value_to_set += cheat_st->cheats[i].repeat_add_to_value;
-
-            if (mask != 0)
-               value_to_set = value_to_set % mask;
-
-            if (bits < 8)
-            {
-               unsigned int bit_iter;
-               for (bit_iter = 0; bit_iter < cheat_st->cheats[i].repeat_add_to_address; bit_iter++)
-               {
-                  address_mask = (address_mask << mask) & 0xFF;
 
-                  if (address_mask == 0)
-                  {
-                     address_mask = mask;
-                     idx++;
-                  }
-               }
-            }
-            else
-               idx += (cheat_st->cheats[i].repeat_add_to_address * bytes_per_item);
+      for (w = 0; w < entry->num_writes; w++, write++)
+      {
+         if (write->ptr)
+            cheat_manager_write_value(write->ptr, entry,
+                  write->address_mask, value_to_set);
 
-            idx = idx % cheat_st->total_memory_size;
+         value_to_set += entry->repeat_add_to_value;
 
-            offset = translate_address(idx, &curr);
-         }
+         if (entry->value_wrap != 0)
+            value_to_set = value_to_set % entry->value_wrap;
       }
    }
 
@@ -1579,19 +2142,14 @@ void cheat_manager_apply_retro_cheats(void)
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
-   unsigned int byte_part;
-   unsigned int idx;
-   unsigned int start_idx;
+   unsigned int i;
    unsigned int           mask = 0;
    unsigned int bytes_per_item = 1;
    unsigned int           bits = 8;
-   unsigned int       curr_val = 0;
-   unsigned int       prev_val = 0;
-   unsigned int         offset = 0;
+   unsigned int      num_words = 0;
+   unsigned int         remain = target_match_idx;
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char         *curr = cheat_st->curr_memory_buf;
    unsigned char         *prev = cheat_st->prev_memory_buf;
-   unsigned int curr_match_idx = 0;
 
    if (target_match_idx > cheat_st->num_matches - 1)
       return;
@@ -1599,139 +2157,89 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
    if (cheat_st->num_memory_buffers == 0)
       return;
 
-   cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
-
    if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      start_idx = *address;
-   else
-      start_idx = 0;
-
-   for (idx = start_idx; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
-      offset = translate_address(idx, &curr);
+      unsigned idx = *address;
 
-      switch (bytes_per_item)
-      {
-      case 2:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256) + *(prev + idx + 1) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256);
-         break;
-      case 4:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-         break;
-      case 1:
-      default:
-         curr_val = *(curr + idx - offset);
-         if (prev)
-            prev_val = *(prev + idx);
-         break;
-      }
+      cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-      if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      {
-         *curr_value = curr_val;
-         *prev_value = prev_val;
+      if (idx >= cheat_st->total_memory_size)
          return;
-      }
 
-      if (!prev)
-         return;
+      *curr_value = cheat_manager_get_curr_value(idx,
+            bytes_per_item, cheat_st->big_endian);
+      *prev_value = 0;
+      if (prev && idx + bytes_per_item <= cheat_st->total_memory_size)
+         *prev_value = cheat_manager_read_value(prev + idx,
+               bytes_per_item, cheat_st->big_endian);
+      return;
+   }
+
+   if (!prev || !cheat_st->matches)
+      return;
+
+   cheat_manager_setup_search_meta(cheat_st->matches_bit_size, &bytes_per_item, &mask, &bits);
+
+   num_words = (cheat_st->num_search_items
+         + CHEAT_MATCH_WORD_BITS - 1) / CHEAT_MATCH_WORD_BITS;
+
+   /* Skip whole words until the one holding the target match */
+   for (i = 0; i < num_words; i++)
+   {
+      unsigned count = cheat_manager_popcount32(cheat_st->matches[i]);
+      if (remain < count)
+         break;
+      remain -= count;
+   }
 
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+   if (i < num_words)
+   {
+      unsigned j;
+      uint32_t candidates = cheat_st->matches[i];
+
+      for (j = 0; j < CHEAT_MATCH_WORD_BITS; j++)
       {
-         unsigned int prev_match;
+         unsigned idx, idx_mask, curr_val, prev_val;
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = (mask << (byte_part * bits));
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-                  return;
-               }
-               curr_match_idx++;
-            }
-         }
-         else
-         {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = 0xFF;
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-               }
+         if (!(candidates & (1u << j)))
+            continue;
 
-               curr_match_idx++;
-            }
+         if (remain-- > 0)
+            continue;
+
+         idx      = cheat_manager_item_to_address(
+               i * CHEAT_MATCH_WORD_BITS + j,
+               bytes_per_item, bits, mask, &idx_mask);
+         curr_val = cheat_manager_get_curr_value(idx,
+               bytes_per_item, cheat_st->big_endian);
+         prev_val = cheat_manager_read_value(prev + idx,
+               bytes_per_item, cheat_st->big_endian);
+
+         switch (match_action)
+         {
+            case CHEAT_MATCH_ACTION_TYPE_BROWSE:
+               return;
+            case CHEAT_MATCH_ACTION_TYPE_VIEW:
+               *address      = idx;
+               *address_mask = idx_mask;
+               *curr_value   = curr_val;
+               *prev_value   = prev_val;
+               return;
+            case CHEAT_MATCH_ACTION_TYPE_COPY:
+               if (!cheat_manager_add_new_code(cheat_st->matches_bit_size, idx, idx_mask,
+                        cheat_st->big_endian, curr_val))
+                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               else
+                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return;
+            case CHEAT_MATCH_ACTION_TYPE_DELETE:
+               cheat_st->matches[i] &= ~(1u << j);
+               if (cheat_st->num_matches > 0)
+                  cheat_st->num_matches--;
+               runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return;
          }
+         return;
       }
    }
 }
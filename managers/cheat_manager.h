@@ -17,6 +17,8 @@
 #ifndef __CHEAT_MANAGER_H
 #define __CHEAT_MANAGER_H
 
+#include <stdint.h>
+
 #include <boolean.h>
 #include <retro_common_api.h>
 
@@ -155,15 +157,43 @@ struct item_cheat
    bool big_endian;
 };
 
+/* A single pre-translated memory write of a compiled cheat */
+struct cheat_apply_write
+{
+   uint8_t *ptr;
+   unsigned address_mask;
+};
+
+/* An enabled RetroArch-handled cheat, compiled down to what
+ * cheat_manager_apply_retro_cheats() needs every frame */
+struct cheat_apply_entry
+{
+   uint8_t *ptr;
+   unsigned cheat_idx;
+   unsigned cheat_type;
+   unsigned value;
+   unsigned value_wrap;
+   unsigned repeat_add_to_value;
+   unsigned first_write;
+   unsigned num_writes;
+   unsigned bytes_per_item;
+   unsigned bits;
+   bool big_endian;
+};
+
 struct cheat_manager
 {
    struct item_cheat working_cheat; /* retro_time_t alignment */
    struct item_cheat *cheats;
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
-   uint8_t *matches;
+   /* Candidate bitset - one bit per search item,
+    * cleared as successive searches narrow it down */
+   uint32_t *matches;
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
+   struct cheat_apply_entry *apply_entries;
+   struct cheat_apply_write *apply_writes;
    unsigned int delete_state;
    unsigned int loading_cheat_size;
    unsigned int loading_cheat_offset;
@@ -180,12 +210,18 @@ struct cheat_manager
    unsigned search_eqplus_value;
    unsigned search_eqminus_value;
    unsigned num_matches;
+   unsigned num_search_items;
+   unsigned matches_bit_size;
    unsigned browse_address;
+   unsigned num_apply_entries;
    char working_desc[CHEAT_DESC_SCRATCH_SIZE];
    char working_code[CHEAT_CODE_SCRATCH_SIZE];
    bool  big_endian;
    bool  memory_initialized;
    bool  memory_search_initialized;
+   /* Set whenever cheats or memory change, forces
+    * the apply list to be recompiled */
+   bool  apply_dirty;
 };
 
 typedef struct cheat_manager cheat_manager_t;
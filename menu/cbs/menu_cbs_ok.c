@@ -3207,6 +3207,23 @@ static int action_ok_path_scan_directory(const char *path,
 }
 #endif
 
+#ifdef HAVE_CHD
+static int action_ok_verify_chd(const char *path,
+      const char *label, unsigned type, size_t idx, size_t entry_idx)
+{
+   char fullpath[PATH_MAX_LENGTH];
+   const char *menu_path = NULL;
+
+   fullpath[0]           = '\0';
+
+   menu_entries_get_last_stack(&menu_path, NULL, NULL, NULL, NULL);
+   fill_pathname_join(fullpath, menu_path, path, sizeof(fullpath));
+
+   task_push_chd_verify(fullpath);
+   return 0;
+}
+#endif
+
 static int action_ok_path_manual_scan_directory(const char *path,
       const char *label, unsigned type, size_t idx, size_t entry_idx)
 {
@@ -5243,6 +5260,9 @@ static int action_ok_netplay_lan_scan(const char *path,
 DEFAULT_ACTION_OK_DL_PUSH(action_ok_content_collection_list, FILEBROWSER_SELECT_COLLECTION, ACTION_OK_DL_CONTENT_COLLECTION_LIST, NULL)
 DEFAULT_ACTION_OK_DL_PUSH(action_ok_push_content_list, FILEBROWSER_SELECT_FILE, ACTION_OK_DL_CONTENT_LIST, settings->paths.directory_menu_content)
 DEFAULT_ACTION_OK_DL_PUSH(action_ok_push_scan_file, FILEBROWSER_SCAN_FILE, ACTION_OK_DL_CONTENT_LIST, settings->paths.directory_menu_content)
+#ifdef HAVE_CHD
+DEFAULT_ACTION_OK_DL_PUSH(action_ok_push_verify_chd, FILEBROWSER_VERIFY_CHD, ACTION_OK_DL_CONTENT_LIST, settings->paths.directory_menu_content)
+#endif
 
 #ifdef HAVE_NETWORKING
 static void netplay_refresh_rooms_cb(retro_task_t *task,
@@ -7111,6 +7131,9 @@ static int menu_cbs_init_bind_ok_compare_label(menu_file_list_cbs_t *cbs,
          {MENU_ENUM_LABEL_LOAD_CONTENT_SPECIAL,                action_ok_push_filebrowser_list_file_select},
          {MENU_ENUM_LABEL_SCAN_DIRECTORY,                      action_ok_scan_directory_list},
          {MENU_ENUM_LABEL_SCAN_FILE,                           action_ok_push_scan_file},
+#ifdef HAVE_CHD
+         {MENU_ENUM_LABEL_VERIFY_CHD,                          action_ok_push_verify_chd},
+#endif
          {MENU_ENUM_LABEL_FAVORITES,                           action_ok_push_content_list},
          {MENU_ENUM_LABEL_FILE_DETECT_CORE_LIST_PUSH_DIR,      action_ok_push_random_dir},
          {MENU_ENUM_LABEL_DOWNLOADED_FILE_DETECT_CORE_LIST,    action_ok_push_downloads_dir},
@@ -7646,6 +7669,12 @@ static int menu_cbs_init_bind_ok_compare_type(menu_file_list_cbs_t *cbs,
                BIND_ACTION_OK(cbs, action_ok_scan_file);
 #endif
             }
+#ifdef HAVE_CHD
+            else if (filebrowser_get_type() == FILEBROWSER_VERIFY_CHD)
+            {
+               BIND_ACTION_OK(cbs, action_ok_verify_chd);
+            }
+#endif
             else if (cbs->enum_idx != MSG_UNKNOWN)
             {
                switch (cbs->enum_idx)
@@ -3660,6 +3660,41 @@ static void materialui_render(void *data,
          break;
    }
 
+   /* Decode thumbnails of the entries that are
+    * about to scroll into view */
+   if (entries_end > 0)
+   {
+      switch (mui->list_view_type)
+      {
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_SMALL:
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_MEDIUM:
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_LARGE:
+            gfx_thumbnail_prefetch(
+                  mui->thumbnail_path_data, mui->playlist, list,
+                  mui->first_onscreen_entry, mui->last_onscreen_entry,
+                  mui->secondary_thumbnail_enabled,
+                  thumbnail_upscale_threshold);
+            break;
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON:
+            gfx_thumbnail_prefetch(
+                  mui->thumbnail_path_data, mui->playlist, list,
+                  mui->first_onscreen_entry, mui->last_onscreen_entry,
+                  true, thumbnail_upscale_threshold);
+            break;
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_DESKTOP:
+            /* Only the thumbnails of the selected
+             * entry are shown */
+            if (selection < entries_end)
+               gfx_thumbnail_prefetch(
+                     mui->thumbnail_path_data, mui->playlist, list,
+                     selection, selection,
+                     true, thumbnail_upscale_threshold);
+            break;
+         default:
+            break;
+      }
+   }
+
    menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &mui->first_onscreen_entry);
 }
 
@@ -5997,6 +6032,8 @@ static void materialui_show_fullscreen_thumbnails(
    uintptr_t                  alpha_tag = (uintptr_t)
       &mui->fullscreen_thumbnail_alpha;
    const char *thumbnail_label          = NULL;
+   settings_t *settings                 = config_get_ptr();
+   file_list_t *list                    = menu_entries_get_selection_buf_ptr(0);
 
    /* Before showing fullscreen thumbnails, must
     * ensure that any existing fullscreen thumbnail
@@ -6069,6 +6106,23 @@ static void materialui_show_fullscreen_thumbnails(
    /* Push animation */
    gfx_animation_push(&animation_entry);
 
+   /* Thumbnails were loaded at list view size
+    * > Replace them with the original images */
+   if (     list
+         && (selection < list->size)
+         && gfx_thumbnail_set_content_playlist(mui->thumbnail_path_data,
+               mui->playlist, list->list[selection].entry_idx))
+   {
+      gfx_thumbnail_request_full_size(mui->thumbnail_path_data,
+            GFX_THUMBNAIL_RIGHT, primary_thumbnail,
+            settings->uints.gfx_thumbnail_upscale_threshold);
+
+      if (mui->secondary_thumbnail_enabled)
+         gfx_thumbnail_request_full_size(mui->thumbnail_path_data,
+               GFX_THUMBNAIL_LEFT, secondary_thumbnail,
+               settings->uints.gfx_thumbnail_upscale_threshold);
+   }
+
    /* Enable fullscreen thumbnails */
    mui->fullscreen_thumbnail_selection = selection;
    mui->show_fullscreen_thumbnails     = true;
@@ -7176,6 +7230,11 @@ static void materialui_set_thumbnail_dimensions(materialui_handle_t *mui)
          mui->thumbnail_width_max  = 0;
          break;
    }
+
+   /* Thumbnails are never drawn larger than this
+    * (except in the fullscreen thumbnail view) */
+   gfx_thumbnail_set_derivative_size(
+         mui->thumbnail_width_max, mui->thumbnail_height_max);
 }
 
 /* Checks global 'Secondary Thumbnail' option - if
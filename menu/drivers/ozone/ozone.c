@@ -976,6 +976,8 @@ static void ozone_set_layout(ozone_handle_t *ozone, bool is_threaded)
    char font_path[PATH_MAX_LENGTH];
    float scale_factor  = 0.0f;
    bool font_inited    = false;
+   int thumbnail_width;
+   int thumbnail_height;
 
    font_path[0] = s1[0]= '\0';
 
@@ -1027,6 +1029,21 @@ static void ozone_set_layout(ozone_handle_t *ozone, bool is_threaded)
    ozone->dimensions.spacer_3px = (unsigned)((scale_factor * 3.0f) + 0.5f);
    ozone->dimensions.spacer_5px = (unsigned)((scale_factor * 5.0f) + 0.5f);
 
+   /* Thumbnails are drawn at most at the size of
+    * the thumbnail bar images - see
+    * ozone_draw_thumbnail_bar() */
+   thumbnail_width  = ozone->dimensions.thumbnail_bar_width -
+         (ozone->dimensions.sidebar_entry_icon_padding * 2);
+   thumbnail_height = ((int)ozone->last_height -
+         ozone->dimensions.header_height -
+         ozone->dimensions.spacer_2px -
+         ozone->dimensions.footer_height -
+         (ozone->dimensions.sidebar_entry_icon_padding * 3)) / 2;
+
+   gfx_thumbnail_set_derivative_size(
+         (thumbnail_width  > 0) ? (unsigned)thumbnail_width  : 0,
+         (thumbnail_height > 0) ? (unsigned)thumbnail_height : 0);
+
    /* Determine movement delta size for activating
     * pointer input (note: not a dimension as such,
     * so not included in the 'dimensions' struct) */
@@ -1952,6 +1969,21 @@ static void ozone_render(void *data,
       }
    }
 
+   /* Decode thumbnails of the entries that follow
+    * the selection in the scroll direction */
+   if (ozone->is_playlist && (ozone->depth == 1) && (entries_end > 0))
+   {
+      settings_t *settings = config_get_ptr();
+      size_t selection     = menu_navigation_get_selection();
+      file_list_t *list    = menu_entries_get_selection_buf_ptr(0);
+
+      if (selection < entries_end)
+         gfx_thumbnail_prefetch(
+               ozone->thumbnail_path_data, playlist_get_cached(), list,
+               selection, selection, !ozone->selection_core_is_viewer,
+               settings->uints.gfx_thumbnail_upscale_threshold);
+   }
+
    menu_entries_ctl(MENU_ENTRIES_CTL_START_GET, &i);
 
    if (i >= entries_end)
@@ -3768,6 +3800,7 @@ void ozone_show_fullscreen_thumbnails(ozone_handle_t *ozone)
    file_list_t *selection_buf       = menu_entries_get_selection_buf_ptr(0);
    uintptr_t alpha_tag              = (uintptr_t)&ozone->animations.fullscreen_thumbnail_alpha;
    uintptr_t scroll_tag             = (uintptr_t)selection_buf;
+   settings_t *settings             = config_get_ptr();
 
    /* Before showing fullscreen thumbnails, must
     * ensure that any existing fullscreen thumbnail
@@ -3857,6 +3890,15 @@ void ozone_show_fullscreen_thumbnails(ozone_handle_t *ozone)
    /* Push animation */
    gfx_animation_push(&animation_entry);
 
+   /* Thumbnails were loaded at thumbnail bar size
+    * > Replace them with the original images */
+   gfx_thumbnail_request_full_size(ozone->thumbnail_path_data,
+         GFX_THUMBNAIL_RIGHT, &ozone->thumbnails.right,
+         settings->uints.gfx_thumbnail_upscale_threshold);
+   gfx_thumbnail_request_full_size(ozone->thumbnail_path_data,
+         GFX_THUMBNAIL_LEFT, &ozone->thumbnails.left,
+         settings->uints.gfx_thumbnail_upscale_threshold);
+
    /* Enable fullscreen thumbnails */
    ozone->fullscreen_thumbnail_selection = (size_t)ozone->selection;
    ozone->show_fullscreen_thumbnails     = true;
@@ -55,6 +55,7 @@
 
 /* Thumbnail additions */
 #include "../../gfx/gfx_thumbnail_path.h"
+#include "../../gfx/gfx_thumbnail.h"
 #include "../../tasks/tasks_internal.h"
 
 #if defined(GEKKO)
@@ -1754,7 +1755,11 @@ static void process_wallpaper(rgui_t *rgui, struct texture_image *image)
    rgui->force_redraw = true;
 }
 
+static bool rgui_load_image(void *userdata, void *data,
+      enum menu_image_type type);
+
 static bool request_thumbnail(
+      rgui_t *rgui,
       thumbnail_t *thumbnail,
       enum gfx_thumbnail_id thumbnail_id,
       uint32_t *queue_size,
@@ -1775,20 +1780,48 @@ static bool request_thumbnail(
    /* Ensure that new path is valid... */
    if (!string_is_empty(path))
    {
+      const struct texture_image *cached_image = NULL;
+      enum menu_image_type image_type          =
+            (thumbnail_id == GFX_THUMBNAIL_LEFT) ?
+                  MENU_IMAGE_LEFT_THUMBNAIL : MENU_IMAGE_THUMBNAIL;
+
       strlcpy(thumbnail->path, path, sizeof(thumbnail->path));
+
+      /* Use the cached image, if available
+       * > Only possible when no other load is pending,
+       *   since just the last image of the queue is
+       *   processed */
+      if (*queue_size == 0)
+         cached_image = gfx_thumbnail_cache_get(path,
+               video_driver_supports_rgba(), 0);
+
+      if (cached_image)
+      {
+         *queue_size = *queue_size + 1;
+         rgui_load_image(rgui, (void*)cached_image, image_type);
+         return true;
+      }
+
       if (path_is_valid(path))
       {
+         /* Image path is passed as user data, so the
+          * decoded image can be added to the cache */
+         char *image_path = strdup(thumbnail->path);
+
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
          if (task_push_image_load(thumbnail->path,
                   video_driver_supports_rgba(), 0,
-                  (thumbnail_id == GFX_THUMBNAIL_LEFT) ?
+                  (image_type == MENU_IMAGE_LEFT_THUMBNAIL) ?
             menu_display_handle_left_thumbnail_upload 
-            : menu_display_handle_thumbnail_upload, NULL))
+            : menu_display_handle_thumbnail_upload, image_path))
          {
             *queue_size = *queue_size + 1;
             return true;
          }
+
+         if (image_path)
+            free(image_path);
       }
       else
          *file_missing = true;
@@ -4909,6 +4942,7 @@ static void rgui_load_current_thumbnails(rgui_t *rgui, bool download_missing)
          GFX_THUMBNAIL_RIGHT, &thumbnail_path))
    {
       rgui->entry_has_thumbnail = request_thumbnail(
+            rgui,
             rgui->show_fs_thumbnail ? &fs_thumbnail : &mini_thumbnail,
             GFX_THUMBNAIL_RIGHT,
             &rgui->thumbnail_queue_size,
@@ -4925,6 +4959,7 @@ static void rgui_load_current_thumbnails(rgui_t *rgui, bool download_missing)
             GFX_THUMBNAIL_LEFT, &left_thumbnail_path))
       {
          rgui->entry_has_left_thumbnail = request_thumbnail(
+               rgui,
                &mini_left_thumbnail,
                GFX_THUMBNAIL_LEFT,
                &rgui->left_thumbnail_queue_size,
@@ -3740,6 +3740,20 @@ static void xmb_render(void *data,
       }
    }
 
+   /* Decode thumbnails of the entries that follow
+    * the selection in the scroll direction */
+   if (xmb->is_playlist && (end > 0))
+   {
+      size_t selection  = menu_navigation_get_selection();
+      file_list_t *list = menu_entries_get_selection_buf_ptr(0);
+
+      if (selection < end)
+         gfx_thumbnail_prefetch(
+               xmb->thumbnail_path_data, playlist_get_cached(), list,
+               selection, selection, true,
+               settings->uints.gfx_thumbnail_upscale_threshold);
+   }
+
    menu_entries_ctl(MENU_ENTRIES_CTL_START_GET, &i);
 
    if (i >= end)
@@ -3964,6 +3978,7 @@ static void xmb_show_fullscreen_thumbnails(
    gfx_animation_ctx_entry_t animation_entry;
    const char *core_name            = NULL;
    const char *thumbnail_label      = NULL;
+   settings_t *settings             = config_get_ptr();
    uintptr_t              alpha_tag = (uintptr_t)
       &xmb->fullscreen_thumbnail_alpha;
 
@@ -4051,6 +4066,15 @@ static void xmb_show_fullscreen_thumbnails(
    /* Push animation */
    gfx_animation_push(&animation_entry);
 
+   /* Thumbnails were loaded at side panel size
+    * > Replace them with the original images */
+   gfx_thumbnail_request_full_size(xmb->thumbnail_path_data,
+         GFX_THUMBNAIL_RIGHT, &xmb->thumbnails.right,
+         settings->uints.gfx_thumbnail_upscale_threshold);
+   gfx_thumbnail_request_full_size(xmb->thumbnail_path_data,
+         GFX_THUMBNAIL_LEFT, &xmb->thumbnails.left,
+         settings->uints.gfx_thumbnail_upscale_threshold);
+
    /* Enable fullscreen thumbnails */
    xmb->fullscreen_thumbnail_selection = selection;
    xmb->show_fullscreen_thumbnails     = true;
@@ -5235,6 +5259,46 @@ static void xmb_layout_psp(xmb_handle_t *xmb, int width)
    gfx_display_set_header_height(new_header_height);
 }
 
+/* Sets the largest size at which xmb_frame() draws
+ * the thumbnails of the selected entry (at 100%
+ * thumbnail scale factor) */
+static void xmb_set_thumbnail_derivative_size(
+      xmb_handle_t *xmb, unsigned width, unsigned height)
+{
+   float thumbnail_width;
+   float thumbnail_height;
+   float height_under = ((float)height * 0.96f) -
+         xmb->margins_screen_top - xmb->icon_size;
+
+   if (xmb->use_ps3_layout)
+   {
+      float pseudo_font_length = xmb->icon_spacing_horizontal * 4 -
+            xmb->icon_size / 4.0f;
+      float right_width        = (float)width - (xmb->icon_size / 6) -
+            (xmb->margins_screen_left * scale_mod[5]) -
+            xmb->icon_spacing_horizontal - pseudo_font_length;
+      float stacked_height     = ((float)height - xmb->margins_title_top -
+            ((xmb->icon_size / 4.0f) * 3.0f)) / 2.0f;
+
+      /* Right side, or left side (xmb->icon_size * 3.4f);
+       * vertically stacked thumbnails are half the
+       * height of the right side */
+      thumbnail_width  = MAX(right_width, xmb->icon_size * 3.4f);
+      thumbnail_height = MAX(height_under, stacked_height);
+   }
+   else
+   {
+      /* Left side only */
+      thumbnail_width  = xmb->icon_size * 2.4f;
+      thumbnail_height = height_under - xmb->margins_title_bottom +
+            (xmb->icon_size / 12.0f);
+   }
+
+   gfx_thumbnail_set_derivative_size(
+         (thumbnail_width  > 0.0f) ? (unsigned)thumbnail_width  : 0,
+         (thumbnail_height > 0.0f) ? (unsigned)thumbnail_height : 0);
+}
+
 static void xmb_layout(xmb_handle_t *xmb)
 {
    unsigned width, height, i, current, end;
@@ -5248,6 +5312,8 @@ static void xmb_layout(xmb_handle_t *xmb)
    else
       xmb_layout_psp(xmb, width);
 
+   xmb_set_thumbnail_derivative_size(xmb, width, height);
+
 #ifdef XMB_DEBUG
    RARCH_LOG("[XMB] margin screen left: %.2f\n",  xmb->margins_screen_left);
    RARCH_LOG("[XMB] margin screen top:  %.2f\n",  xmb->margins_screen_top);
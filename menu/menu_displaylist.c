@@ -23,6 +23,7 @@
 
 #include <lists/file_list.h>
 #include <lists/dir_list.h>
+#include <lists/trigram_index.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
 #include <playlists/label_sanitization.h>
@@ -134,6 +135,23 @@ struct menu_displaylist_state
 };
 
 static struct menu_displaylist_state menu_displist_st;
+
+/* Index of the playlist labels while a menu search
+ * is active, so that adding or removing search terms
+ * does not rescan every label. It is identified by the
+ * playlist and the options that affect the labels, and
+ * dropped as soon as the playlist is shown unfiltered. */
+struct menu_displaylist_search_index
+{
+   trigram_index_t *index;
+   const playlist_t *playlist;
+   void (*sanitization)(char*);
+   size_t size;
+   bool show_inline_core_name;
+   char path[PATH_MAX_LENGTH];
+};
+
+static struct menu_displaylist_search_index menu_displist_search_index;
 /* TODO/FIXME - static public global variables */
 static enum filebrowser_enums filebrowser_types = FILEBROWSER_NONE;
 
@@ -215,6 +233,9 @@ static void filebrowser_parse(
       else if (info && ((info->type_default == FILE_TYPE_MANUAL_SCAN_DAT) || (info->type_default == FILE_TYPE_SIDELOAD_CORE)))
          str_list = dir_list_new(path,
                info->exts, true, show_hidden_files, false, false);
+      else if (filebrowser_types == FILEBROWSER_VERIFY_CHD)
+         str_list = dir_list_new(path,
+               "chd", true, show_hidden_files, false, false);
       else
          str_list = dir_list_new(path,
                (filter_ext && info) ? info->exts : NULL,
@@ -1385,6 +1406,40 @@ static unsigned menu_displaylist_parse_system_info(file_list_t *list)
    return count;
 }
 
+static void menu_displaylist_free_search_index(void)
+{
+   struct menu_displaylist_search_index *search =
+      &menu_displist_search_index;
+
+   trigram_index_free(search->index);
+   search->index    = NULL;
+   search->playlist = NULL;
+   search->path[0]  = '\0';
+}
+
+static uint32_t *menu_displaylist_search_playlist(
+      struct string_list *search_terms, size_t *num_matches)
+{
+   size_t i;
+   uint32_t *matches  = NULL;
+   const char **terms = (const char**)malloc(
+         (search_terms->size + 1) * sizeof(*terms));
+
+   *num_matches = 0;
+
+   if (!terms)
+      return NULL;
+
+   for (i = 0; i < search_terms->size; i++)
+      terms[i] = search_terms->elems[i].data;
+
+   matches = trigram_index_search(menu_displist_search_index.index,
+         terms, search_terms->size, num_matches);
+
+   free(terms);
+   return matches;
+}
+
 static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       playlist_t *playlist, const char *path_playlist, bool is_collection)
 {
@@ -1397,6 +1452,13 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
    struct string_list *search_terms  = menu_driver_search_get_terms();
    unsigned pl_show_inline_core_name = settings->uints.playlist_show_inline_core_name;
    bool pl_show_sublabels            = settings->bools.playlist_show_sublabels;
+   trigram_index_t *new_search_index = NULL;
+   uint32_t *search_matches          = NULL;
+   size_t num_search_matches         = 0;
+   size_t search_pos                 = 0;
+   bool use_search_index             = false;
+   struct menu_displaylist_search_index
+      *search_index                  = &menu_displist_search_index;
    void (*sanitization)(char*);
 
    label_spacer[0] = '\0';
@@ -1481,6 +1543,31 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
          sanitization = NULL;
    }
 
+   /* Search the index of this playlist if the labels are
+    * unchanged since it was built, otherwise build a new
+    * one while filtering this time around */
+   if (search_terms)
+   {
+      if (     search_index->index
+            && search_index->playlist              == playlist
+            && search_index->size                  == list_size
+            && search_index->sanitization          == sanitization
+            && search_index->show_inline_core_name == show_inline_core_name
+            && string_is_equal(search_index->path, path_playlist))
+      {
+         search_matches   = menu_displaylist_search_playlist(
+               search_terms, &num_search_matches);
+         use_search_index = true;
+      }
+      else
+      {
+         menu_displaylist_free_search_index();
+         new_search_index = trigram_index_new();
+      }
+   }
+   else if (search_index->index)
+      menu_displaylist_free_search_index();
+
    for (i = 0; i < list_size; i++)
    {
       char menu_entry_label[PATH_MAX_LENGTH];
@@ -1540,7 +1627,15 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
 
       /* Check whether entry matches search terms,
        * if required */
-      if (search_terms)
+      if (use_search_index)
+      {
+         if (     search_pos < num_search_matches
+               && search_matches[search_pos] == i)
+            search_pos++;
+         else
+            entry_valid = false;
+      }
+      else if (search_terms)
       {
          size_t j;
 
@@ -1557,6 +1652,13 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
          }
       }
 
+      if (     new_search_index
+            && !trigram_index_add(new_search_index, menu_entry_label))
+      {
+         trigram_index_free(new_search_index);
+         new_search_index = NULL;
+      }
+
       /* Add menu entry */
       if (entry_valid && menu_entries_append_enum(info->list,
             menu_entry_label, entry_path,
@@ -1564,6 +1666,25 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
          info->count++;
    }
 
+   if (search_matches)
+      free(search_matches);
+
+   if (new_search_index)
+   {
+      if (trigram_index_finalize(new_search_index))
+      {
+         search_index->index                 = new_search_index;
+         search_index->playlist              = playlist;
+         search_index->size                  = list_size;
+         search_index->sanitization          = sanitization;
+         search_index->show_inline_core_name = show_inline_core_name;
+         strlcpy(search_index->path, path_playlist,
+               sizeof(search_index->path));
+      }
+      else
+         trigram_index_free(new_search_index);
+   }
+
    if (info->count < 1)
       goto error;
 
@@ -5482,6 +5603,14 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_MANUAL_CONTENT_SCAN_LIST,
                   MENU_SETTING_ACTION, 0, 0))
             count++;
+#ifdef HAVE_CHD
+         if (menu_entries_append_enum(list,
+                  msg_hash_to_str(MENU_ENUM_LABEL_VALUE_VERIFY_CHD),
+                  msg_hash_to_str(MENU_ENUM_LABEL_VERIFY_CHD),
+                  MENU_ENUM_LABEL_VERIFY_CHD,
+                  MENU_SETTING_ACTION, 0, 0))
+            count++;
+#endif
          break;
       case DISPLAYLIST_INFORMATION_LIST:
          count              = menu_displaylist_parse_information_list(list);
@@ -6120,6 +6249,14 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_MANUAL_CONTENT_SCAN_LIST,
                   MENU_SETTING_ACTION, 0, 0))
             count++;
+#ifdef HAVE_CHD
+         if (menu_entries_append_enum(list,
+                  msg_hash_to_str(MENU_ENUM_LABEL_VALUE_VERIFY_CHD),
+                  msg_hash_to_str(MENU_ENUM_LABEL_VERIFY_CHD),
+                  MENU_ENUM_LABEL_VERIFY_CHD,
+                  MENU_SETTING_ACTION, 0, 0))
+            count++;
+#endif
          break;
       case DISPLAYLIST_NETWORK_INFO:
 #if defined(HAVE_NETWORKING) && !defined(HAVE_SOCKET_LEGACY) && (!defined(SWITCH) || defined(SWITCH) && defined(HAVE_LIBNX))
@@ -8302,6 +8439,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_VIDEO_ALLOW_ROTATE,    PARSE_ONLY_BOOL},
 #ifndef HAVE_DYNAMIC
                {MENU_ENUM_LABEL_ALWAYS_RELOAD_CORE_ON_RUN_CONTENT, PARSE_ONLY_BOOL},
+#endif
+#ifdef HAVE_COMPRESSION
+               {MENU_ENUM_LABEL_CONTENT_EXTRACTION_CACHE_SIZE, PARSE_ONLY_UINT},
 #endif
             };
 
@@ -8608,6 +8748,8 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_XMB_VERTICAL_THUMBNAILS,                      PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_XMB_THUMBNAIL_SCALE_FACTOR,              PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,             PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,                    PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_MENU_THUMBNAIL_DERIVATIVE_CACHE,              PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_SWAP_THUMBNAILS,                    PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,               PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DELAY,                    PARSE_ONLY_UINT,   true},
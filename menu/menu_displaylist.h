@@ -252,6 +252,7 @@ enum filebrowser_enums
    FILEBROWSER_SELECT_DIR,
    FILEBROWSER_SCAN_DIR,
    FILEBROWSER_SCAN_FILE,
+   FILEBROWSER_VERIFY_CHD,
    FILEBROWSER_MANUAL_SCAN_DIR,
    FILEBROWSER_SELECT_FILE,
    FILEBROWSER_SELECT_FILE_SUBSYSTEM,
@@ -495,6 +495,20 @@ void menu_display_handle_wallpaper_upload(retro_task_t *task,
       void *user_data, const char *err);
 
 #if defined(HAVE_LIBRETRODB)
+typedef struct explore_state explore_state_t;
+
+/* Builds the explore index. Safe to call from a task
+ * thread. If @cache_path is not empty, a previously
+ * saved index is reused as long as none of the playlists
+ * and databases it was built from have changed, and a
+ * freshly built index is written back to it. */
+explore_state_t *menu_explore_build_list(const char *directory_playlist,
+      const char *directory_database, const char *cache_path);
+/* Hands an index built by menu_explore_build_list()
+ * over to the explore menu. Must be called on the
+ * main thread. */
+void menu_explore_set_state(explore_state_t *state);
+void menu_explore_free_state(explore_state_t *state);
 uintptr_t menu_explore_get_entry_icon(unsigned type);
 void menu_explore_context_init(void);
 void menu_explore_context_deinit(void);
@@ -21,14 +21,24 @@
 #include "../configuration.h"
 #include "../playlist.h"
 #include "../libretro-db/libretrodb.h"
+#include "../tasks/tasks_internal.h"
+#include "../verbosity.h"
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
 #include <array/rbuf.h>
+#include <file/file_path.h>
+#include <lists/string_list.h>
+#include <lists/trigram_index.h>
+#include <streams/file_stream.h>
 
 #define EX_ARENA_ALIGNMENT 8
 #define EX_ARENA_BLOCK_SIZE (64 * 1024)
 #define EX_ARENA_ALIGN_UP(n, a) (((n) + (a) - 1) & ~((a) - 1))
 
+#define EXPLORE_CACHE_FILE    "explore.cache"
+#define EXPLORE_CACHE_MAGIC   0x4C505845 /* 'EXPL' */
+#define EXPLORE_CACHE_VERSION 1
+
 /* Explore */
 enum
 {
@@ -88,13 +98,23 @@ typedef struct
 #endif
 } explore_entry_t;
 
-typedef struct 
+/* A playlist or database the explore index was built from */
+typedef struct
+{
+   const char *path;
+   int64_t mtime;
+   int32_t size;
+} explore_source_t;
+
+struct explore_state
 {
    ex_arena arena; /* ptr alignment */
    explore_string_t **by[EXPLORE_CAT_COUNT];
    explore_entry_t *entries;
    playlist_t **playlists;
    uintptr_t *icons;
+   explore_source_t *sources;
+   trigram_index_t *search_index;
    const char *label_explore_item_str;
    unsigned top_depth;
    unsigned show_icons;
@@ -102,7 +122,16 @@ typedef struct
    char title[1024];
    char find_string[1024];
    bool has_unknown[EXPLORE_CAT_COUNT];
-} explore_state_t;
+};
+
+/* Cursor over a cache file loaded into memory. Any
+ * out-of-bounds read sets 'error' and yields zeroes. */
+typedef struct
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+   bool error;
+} explore_cache_reader_t;
 
 static const struct
 {
@@ -124,8 +153,10 @@ explore_by_info[EXPLORE_CAT_COUNT] =
    { "system",      MENU_ENUM_LABEL_VALUE_CORE_INFO_SYSTEM_NAME,         MENU_ENUM_LABEL_VALUE_EXPLORE_BY_SYSTEM_NAME,  false, false, false },
 };
 
-/* TODO/FIXME - static global */
+/* TODO/FIXME - static globals */
 static explore_state_t* explore_state;
+/* Set while a task is building the index for the menu */
+static bool explore_state_pending;
 
 static void ex_arena_grow(ex_arena *arena, size_t min_size)
 {
@@ -477,6 +508,8 @@ static void explore_free(explore_state_t *state)
 
    explore_unload_icons(state);
    RBUF_FREE(state->icons);
+   RBUF_FREE(state->sources);
+   trigram_index_free(state->search_index);
 
    ex_arena_free(&state->arena);
 }
@@ -531,7 +564,45 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
-static explore_state_t *explore_build_list(void)
+static char *explore_arena_strdup(ex_arena *arena, const char *str)
+{
+   size_t len = strlen(str) + 1;
+   char *copy = (char*)ex_arena_alloc(arena, len);
+   memcpy(copy, str, len);
+   return copy;
+}
+
+/* Records the size and modification time of a file the
+ * index depends on. This must happen before the file is
+ * read, so a change made during the build invalidates
+ * the cache on the next load. */
+static void explore_add_source(explore_state_t *explore, const char *path)
+{
+   explore_source_t source;
+   source.path  = explore_arena_strdup(&explore->arena, path);
+   source.mtime = path_get_mtime(path);
+   source.size  = path_get_size(path);
+   RBUF_PUSH(explore->sources, source);
+}
+
+static playlist_t *explore_load_playlist(const char *path)
+{
+   playlist_config_t playlist_config;
+
+   playlist_config.base_content_directory[0] = '\0';
+   playlist_config.capacity                  = COLLECTION_SIZE;
+   playlist_config.old_format                = false;
+   playlist_config.compress                  = false;
+   playlist_config.fuzzy_archive_match       = false;
+   playlist_config.autofix_paths             = false;
+   strlcpy(playlist_config.path, path, sizeof(playlist_config.path));
+
+   return playlist_init(&playlist_config);
+}
+
+static explore_state_t *explore_build_list(
+      const char *directory_playlist,
+      const char *directory_database)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
@@ -547,9 +618,6 @@ static explore_state_t *explore_build_list(void)
    ex_hashmap32 rdb_indices                 = {0};
    ex_hashmap32 cat_maps[EXPLORE_CAT_COUNT] = {{0}};
    explore_string_t **split_buf             = NULL;
-   settings_t *settings                     = config_get_ptr();
-   const char *directory_playlist           = settings->paths.directory_playlist;
-   const char *directory_database           = settings->paths.path_content_database;
    libretro_vfs_implementation_dir *dir     = NULL;
 
    explore_state_t *explore                 = (explore_state_t*)calloc(
@@ -564,21 +632,12 @@ static explore_state_t *explore_build_list(void)
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
-      playlist_config_t playlist_config;
       size_t j, used_entries                    = 0;
       playlist_t *playlist                      = NULL;
       const char *fext                          = NULL;
       const char *fname                         = NULL;
       uint32_t fhash;
 
-      playlist_config.path[0]                   = '\0';
-      playlist_config.base_content_directory[0] = '\0';
-      playlist_config.capacity                  = 0;
-      playlist_config.old_format                = false;
-      playlist_config.compress                  = false;
-      playlist_config.fuzzy_archive_match       = false;
-      playlist_config.autofix_paths             = false;
-
       if (!retro_vfs_readdir_impl(dir))
       {
          retro_vfs_closedir_impl(dir);
@@ -592,10 +651,9 @@ static explore_state_t *explore_build_list(void)
       if (!fext || strcasecmp(fext, ".lpl"))
          continue;
 
-      fill_pathname_join(playlist_config.path,
-            directory_playlist, fname, sizeof(playlist_config.path));
-      playlist_config.capacity          = COLLECTION_SIZE;
-      playlist                          = playlist_init(&playlist_config);
+      fill_pathname_join(tmp, directory_playlist, fname, sizeof(tmp));
+      explore_add_source(explore, tmp);
+      playlist                          = explore_load_playlist(tmp);
 
       fhash = ex_hash32_nocase_filtered(
             (unsigned char*)fname, fext - fname, '0', 255);
@@ -648,6 +706,7 @@ static explore_state_t *explore_build_list(void)
             fill_pathname_join_noext(
                   tmp, directory_database, db_name, sizeof(tmp));
             strlcat(tmp, ".rdb", sizeof(tmp));
+            explore_add_source(explore, tmp);
 
             if (libretrodb_open(tmp, newrdb.handle) != 0)
             {
@@ -862,6 +921,469 @@ static explore_state_t *explore_build_list(void)
    return explore;
 }
 
+/* Explore cache
+ *
+ * The finished index is stored as a flat binary file.
+ * Category strings are written in their sorted order, and
+ * entries refer to them by index. Playlist entries are
+ * referenced by playlist and entry index, so loading the
+ * cache only needs to parse the playlists, not the
+ * databases. The file is only valid on the machine that
+ * wrote it (native byte order). */
+
+static void explore_cache_write(char **buf, const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void explore_cache_write_u32(char **buf, uint32_t val)
+{
+   explore_cache_write(buf, &val, sizeof(val));
+}
+
+static void explore_cache_write_i64(char **buf, int64_t val)
+{
+   explore_cache_write(buf, &val, sizeof(val));
+}
+
+static void explore_cache_write_str(char **buf, const char *str)
+{
+   uint32_t len = (uint32_t)(str ? strlen(str) : 0);
+   explore_cache_write_u32(buf, len);
+   explore_cache_write(buf, str ? str : "", len + 1);
+}
+
+static void explore_cache_read(explore_cache_reader_t *reader,
+      void *data, size_t len)
+{
+   if (reader->error || len > (size_t)(reader->end - reader->ptr))
+   {
+      reader->error = true;
+      memset(data, 0, len);
+      return;
+   }
+   memcpy(data, reader->ptr, len);
+   reader->ptr += len;
+}
+
+static uint32_t explore_cache_read_u32(explore_cache_reader_t *reader)
+{
+   uint32_t val;
+   explore_cache_read(reader, &val, sizeof(val));
+   return val;
+}
+
+static int64_t explore_cache_read_i64(explore_cache_reader_t *reader)
+{
+   int64_t val;
+   explore_cache_read(reader, &val, sizeof(val));
+   return val;
+}
+
+/* Returns a pointer into the cache buffer, strings are
+ * stored with their terminator */
+static const char *explore_cache_read_str(
+      explore_cache_reader_t *reader, uint32_t *len)
+{
+   const char *str = NULL;
+   uint32_t str_len = explore_cache_read_u32(reader);
+
+   if (reader->error || str_len >= (size_t)(reader->end - reader->ptr)
+         || reader->ptr[str_len] != '\0')
+   {
+      reader->error = true;
+      if (len)
+         *len = 0;
+      return "";
+   }
+
+   str          = (const char*)reader->ptr;
+   reader->ptr += str_len + 1;
+   if (len)
+      *len      = str_len;
+   return str;
+}
+
+static bool explore_cache_save(explore_state_t *explore,
+      const char *cache_path,
+      const char *directory_playlist,
+      const char *directory_database)
+{
+   unsigned i, cat;
+   char tmp_path[PATH_MAX_LENGTH];
+   size_t pl_idx = 0;
+   char *buf     = NULL;
+   bool ret      = false;
+
+   explore_cache_write_u32(&buf, EXPLORE_CACHE_MAGIC);
+   explore_cache_write_u32(&buf, EXPLORE_CACHE_VERSION);
+   explore_cache_write_str(&buf, directory_playlist);
+   explore_cache_write_str(&buf, directory_database);
+
+   explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(explore->sources));
+   for (i = 0; i != RBUF_LEN(explore->sources); i++)
+   {
+      explore_cache_write_str(&buf, explore->sources[i].path);
+      explore_cache_write_i64(&buf, explore->sources[i].mtime);
+      explore_cache_write_u32(&buf, (uint32_t)explore->sources[i].size);
+   }
+
+   explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(explore->playlists));
+   for (i = 0; i != RBUF_LEN(explore->playlists); i++)
+      explore_cache_write_str(&buf,
+            playlist_get_conf_path(explore->playlists[i]));
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_cache_write_u32(&buf, explore->has_unknown[cat]);
+      explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(explore->by[cat]));
+      for (i = 0; i != RBUF_LEN(explore->by[cat]); i++)
+         explore_cache_write_str(&buf, explore->by[cat][i]->str);
+   }
+
+   explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(explore->entries));
+   for (i = 0; i != RBUF_LEN(explore->entries); i++)
+   {
+      size_t tries;
+      uint32_t j, split_count;
+      const struct playlist_entry *pl_first = NULL;
+      explore_entry_t *e                    = &explore->entries[i];
+      size_t num_playlists                  = RBUF_LEN(explore->playlists);
+
+      /* Entries are sorted by label, but usually come in runs
+       * from the same playlist, so start at the last match */
+      for (tries = 0; tries != num_playlists;
+            tries++, pl_idx = (pl_idx + 1) % num_playlists)
+      {
+         playlist_t *pl = explore->playlists[pl_idx];
+         playlist_get_index(pl, 0, &pl_first);
+         if (   e->playlist_entry >= pl_first
+             && e->playlist_entry <  pl_first + playlist_size(pl))
+            break;
+      }
+
+      if (tries == num_playlists)
+         goto end;
+
+      explore_cache_write_u32(&buf, (uint32_t)pl_idx);
+      explore_cache_write_u32(&buf,
+            (uint32_t)(e->playlist_entry - pl_first));
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         explore_cache_write_u32(&buf, e->by[cat] ? e->by[cat]->idx + 1 : 0);
+
+      /* Split strings do not know their category, find it
+       * by checking which category has them at their index */
+      for (split_count = 0; e->split && e->split[split_count]; split_count++);
+      explore_cache_write_u32(&buf, split_count);
+      for (j = 0; j != split_count; j++)
+      {
+         explore_string_t *str = e->split[j];
+
+         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+            if (     str->idx < RBUF_LEN(explore->by[cat])
+                  && explore->by[cat][str->idx] == str)
+               break;
+
+         explore_cache_write_u32(&buf, cat);
+         explore_cache_write_u32(&buf, str->idx);
+      }
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      explore_cache_write_str(&buf, e->original_title);
+#else
+      explore_cache_write_str(&buf, NULL);
+#endif
+   }
+
+   /* Write to a temporary file first, so a reader never
+    * sees a partially written cache */
+   strlcpy(tmp_path, cache_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, buf, RBUF_LEN(buf)))
+   {
+      filestream_delete(cache_path);
+      ret = (filestream_rename(tmp_path, cache_path) == 0);
+      if (!ret)
+         filestream_delete(tmp_path);
+   }
+
+end:
+   RBUF_FREE(buf);
+   return ret;
+}
+
+static explore_state_t *explore_cache_load(const char *cache_path,
+      const char *directory_playlist,
+      const char *directory_database)
+{
+   unsigned i, cat;
+   explore_cache_reader_t reader;
+   size_t lpl_sources                   = 0;
+   size_t lpl_files                     = 0;
+   uint32_t count                       = 0;
+   void *buf                            = NULL;
+   int64_t len                          = 0;
+   explore_state_t *explore             = NULL;
+   explore_string_t **split_buf         = NULL;
+   libretro_vfs_implementation_dir *dir = NULL;
+
+   if (!path_is_valid(cache_path) ||
+       !filestream_read_file(cache_path, &buf, &len))
+      return NULL;
+
+   reader.ptr   = (const uint8_t*)buf;
+   reader.end   = reader.ptr + len;
+   reader.error = false;
+
+   if (     explore_cache_read_u32(&reader) != EXPLORE_CACHE_MAGIC
+         || explore_cache_read_u32(&reader) != EXPLORE_CACHE_VERSION
+         || !string_is_equal(explore_cache_read_str(&reader, NULL),
+               directory_playlist)
+         || !string_is_equal(explore_cache_read_str(&reader, NULL),
+               directory_database))
+      goto error;
+
+   /* Every playlist and database must be unchanged */
+   count = explore_cache_read_u32(&reader);
+   for (i = 0; i != count && !reader.error; i++)
+   {
+      uint32_t path_len;
+      const char *path = explore_cache_read_str(&reader, &path_len);
+      int64_t mtime    = explore_cache_read_i64(&reader);
+      int32_t size     = (int32_t)explore_cache_read_u32(&reader);
+
+      if (     reader.error
+            || path_get_mtime(path) != mtime
+            || path_get_size(path)  != size)
+         goto error;
+
+      if (path_len > 4 && !strcasecmp(path + path_len - 4, ".lpl"))
+         lpl_sources++;
+   }
+
+   /* ...and no playlist may have been added */
+   for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
+   {
+      const char *fname = NULL;
+      const char *fext  = NULL;
+
+      if (!retro_vfs_readdir_impl(dir))
+      {
+         retro_vfs_closedir_impl(dir);
+         break;
+      }
+
+      fname = retro_vfs_dirent_get_name_impl(dir);
+      if (fname)
+         fext = strrchr(fname, '.');
+      if (fext && !strcasecmp(fext, ".lpl"))
+         lpl_files++;
+   }
+
+   if (lpl_files != lpl_sources)
+      goto error;
+
+   if (!(explore = (explore_state_t*)calloc(1, sizeof(*explore))))
+      goto error;
+
+   explore->label_explore_item_str =
+      msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
+
+   count = explore_cache_read_u32(&reader);
+   for (i = 0; i != count && !reader.error; i++)
+   {
+      playlist_t *playlist = explore_load_playlist(
+            explore_cache_read_str(&reader, NULL));
+      if (!playlist)
+         goto error;
+      RBUF_PUSH(explore->playlists, playlist);
+   }
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT && !reader.error; cat++)
+   {
+      explore->has_unknown[cat] = (explore_cache_read_u32(&reader) != 0);
+      count                     = explore_cache_read_u32(&reader);
+
+      if (reader.error || !RBUF_TRYFIT(explore->by[cat], count))
+         goto error;
+
+      for (i = 0; i != count && !reader.error; i++)
+      {
+         uint32_t str_len;
+         const char *str         = explore_cache_read_str(&reader, &str_len);
+         explore_string_t *entry = (explore_string_t*)ex_arena_alloc(
+               &explore->arena, sizeof(explore_string_t) + str_len);
+         entry->idx              = i;
+         memcpy(entry->str, str, str_len + 1);
+         RBUF_PUSH(explore->by[cat], entry);
+      }
+   }
+
+   count = explore_cache_read_u32(&reader);
+   if (reader.error || !RBUF_TRYFIT(explore->entries, count))
+      goto error;
+
+   for (i = 0; i != count && !reader.error; i++)
+   {
+      explore_entry_t e;
+      uint32_t j, split_count;
+      uint32_t pl_idx = explore_cache_read_u32(&reader);
+      uint32_t idx    = explore_cache_read_u32(&reader);
+
+      if (     pl_idx >= RBUF_LEN(explore->playlists)
+            || idx    >= playlist_size(explore->playlists[pl_idx]))
+         goto error;
+
+      playlist_get_index(explore->playlists[pl_idx], idx, &e.playlist_entry);
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         uint32_t str_idx = explore_cache_read_u32(&reader);
+         if (str_idx > RBUF_LEN(explore->by[cat]))
+            goto error;
+         e.by[cat]        = str_idx ? explore->by[cat][str_idx - 1] : NULL;
+      }
+
+      e.split     = NULL;
+      split_count = explore_cache_read_u32(&reader);
+      for (j = 0; j != split_count && !reader.error; j++)
+      {
+         uint32_t split_cat = explore_cache_read_u32(&reader);
+         uint32_t split_idx = explore_cache_read_u32(&reader);
+         if (     split_cat >= EXPLORE_CAT_COUNT
+               || split_idx >= RBUF_LEN(explore->by[split_cat]))
+            goto error;
+         RBUF_PUSH(split_buf, explore->by[split_cat][split_idx]);
+      }
+
+      if (RBUF_LEN(split_buf))
+      {
+         size_t split_len;
+
+         RBUF_PUSH(split_buf, NULL); /* terminator */
+         split_len = RBUF_SIZEOF(split_buf);
+         e.split   = (explore_string_t **)
+            ex_arena_alloc(&explore->arena, split_len);
+         memcpy(e.split, split_buf, split_len);
+         RBUF_CLEAR(split_buf);
+      }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      {
+         uint32_t title_len;
+         const char *title = explore_cache_read_str(&reader, &title_len);
+         e.original_title  = title_len
+            ? explore_arena_strdup(&explore->arena, title) : NULL;
+      }
+#else
+      explore_cache_read_str(&reader, NULL);
+#endif
+
+      RBUF_PUSH(explore->entries, e);
+   }
+
+   if (reader.error)
+      goto error;
+
+   RBUF_FREE(split_buf);
+   free(buf);
+   return explore;
+
+error:
+   RBUF_FREE(split_buf);
+   if (explore)
+   {
+      explore_free(explore);
+      free(explore);
+   }
+   free(buf);
+   return NULL;
+}
+
+/* Indexes the entry labels for 'Search Name'. Id i of
+ * the index is entries[i]. The index is cheap to rebuild
+ * from the entries, so it is not part of the cache. */
+static void explore_build_search_index(explore_state_t *explore)
+{
+   explore_entry_t *e     = explore->entries;
+   explore_entry_t *e_end = RBUF_END(explore->entries);
+
+   explore->search_index  = trigram_index_new();
+   if (!explore->search_index)
+      return;
+
+   for (; e != e_end; e++)
+      if (!trigram_index_add(explore->search_index, e->playlist_entry->label))
+         break;
+
+   if (e != e_end || !trigram_index_finalize(explore->search_index))
+   {
+      /* Searching falls back to scanning every label */
+      trigram_index_free(explore->search_index);
+      explore->search_index = NULL;
+   }
+}
+
+explore_state_t *menu_explore_build_list(const char *directory_playlist,
+      const char *directory_database, const char *cache_path)
+{
+   explore_state_t *explore = NULL;
+   bool use_cache           = !string_is_empty(cache_path);
+
+   if (use_cache)
+   {
+      explore = explore_cache_load(cache_path,
+            directory_playlist, directory_database);
+      if (explore)
+         RARCH_LOG("[Explore]: Loaded %u entries from cache \"%s\".\n",
+               (unsigned)RBUF_LEN(explore->entries), cache_path);
+   }
+
+   if (!explore)
+   {
+      explore = explore_build_list(directory_playlist, directory_database);
+
+      if (explore && use_cache && !explore_cache_save(explore, cache_path,
+               directory_playlist, directory_database))
+         RARCH_WARN("[Explore]: Failed to write cache \"%s\".\n",
+               cache_path);
+   }
+
+   if (explore)
+      explore_build_search_index(explore);
+
+   return explore;
+}
+
+void menu_explore_free_state(explore_state_t *state)
+{
+   if (!state)
+      return;
+
+   explore_free(state);
+   free(state);
+}
+
+void menu_explore_set_state(explore_state_t *state)
+{
+   /* Discard the result if the menu was freed while the
+    * index was being built, or another build won the race */
+   if (!explore_state_pending || explore_state)
+   {
+      menu_explore_free_state(state);
+      return;
+   }
+
+   explore_state_pending = false;
+   explore_state         = state;
+
+   if (explore_state)
+      explore_load_icons(explore_state);
+}
+
 static int explore_action_get_title(
       const char *path, const char *label,
       unsigned menu_type, char *s, size_t len)
@@ -932,6 +1454,60 @@ static void explore_menu_add_spacer(file_list_t *list)
       ((menu_file_list_cbs_t*)list->list[list->size-1].actiondata)->action_sublabel = explore_action_sublabel_spacer;
 }
 
+/* Returns the ascending indices of the entries whose label
+ * contains every space separated word of the find string */
+static uint32_t *explore_find_entries(explore_state_t *state,
+      size_t *num_found)
+{
+   size_t i;
+   const char **terms       = NULL;
+   uint32_t *found          = NULL;
+   struct string_list *list = string_split(state->find_string, " ");
+
+   *num_found = 0;
+
+   if (!list)
+      return NULL;
+
+   terms = (const char**)malloc((list->size + 1) * sizeof(*terms));
+   if (!terms)
+      goto end;
+
+   for (i = 0; i < list->size; i++)
+      terms[i] = list->elems[i].data;
+
+   if (state->search_index)
+      found = trigram_index_search(state->search_index,
+            terms, list->size, num_found);
+   else
+   {
+      size_t count = RBUF_LEN(state->entries);
+
+      found        = (uint32_t*)malloc((count + 1) * sizeof(*found));
+      if (!found)
+         goto end;
+
+      for (i = 0; i < count; i++)
+      {
+         size_t j;
+         const char *label = state->entries[i].playlist_entry->label;
+
+         for (j = 0; j < list->size; j++)
+            if (!strcasestr(label, terms[j]))
+               break;
+
+         if (j == list->size)
+            found[(*num_found)++] = (uint32_t)i;
+      }
+   }
+
+end:
+   if (terms)
+      free(terms);
+   string_list_free(list);
+   return found;
+}
+
 static void explore_action_find_complete(void *userdata, const char *line)
 {
    menu_input_dialog_end();
@@ -963,13 +1539,46 @@ unsigned menu_displaylist_explore(file_list_t *list)
    struct item_file *stack_top  = NULL;
    file_list_t *menu_stack      = menu_entries_get_menu_stack_ptr(0);
 
+   /* The index is built by a task, show a placeholder
+    * until it is ready. The task refreshes this list. */
    if (!explore_state)
    {
-      explore_state             = explore_build_list();
-      explore_state->top_depth  = (unsigned)menu_stack->size - 1;
-      explore_load_icons(explore_state);
+      if (!explore_state_pending)
+      {
+         char cache_path[PATH_MAX_LENGTH];
+         settings_t *settings           = config_get_ptr();
+         const char *directory_playlist = settings->paths.directory_playlist;
+         const char *directory_cache    = settings->paths.directory_cache;
+
+         /* Without a cache directory, keep the cache next
+          * to the playlists it was built from */
+         if (string_is_empty(directory_cache))
+            directory_cache             = directory_playlist;
+
+         cache_path[0]                  = '\0';
+         if (!string_is_empty(directory_cache))
+            fill_pathname_join(cache_path, directory_cache,
+                  EXPLORE_CACHE_FILE, sizeof(cache_path));
+
+         explore_state_pending = task_push_menu_explore_init(
+               directory_playlist,
+               settings->paths.path_content_database,
+               cache_path);
+      }
+
+      menu_entries_append_enum(list,
+            msg_hash_to_str(MENU_ENUM_LABEL_VALUE_EXPLORE_INITIALISING_LIST),
+            msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST),
+            MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST,
+            MENU_INFO_MESSAGE, 0, 0);
+      return list->size;
    }
 
+   /* The explore root can be reached from different
+    * menu depths (horizontal tab or main menu entry) */
+   if (menu_stack->list[menu_stack->size - 1].type == MENU_EXPLORE_TAB)
+      explore_state->top_depth  = (unsigned)menu_stack->size - 1;
+
    if (menu_stack->size > 1)
    {
       struct item_file *stack   = &menu_stack->list[menu_stack->size - 1];
@@ -1128,6 +1737,9 @@ SKIP_EXPLORE_BY_CATEGORY:;
       explore_string_t* filter[10];
       explore_entry_t *e                  = NULL;
       explore_entry_t *e_end              = NULL;
+      uint32_t *found                     = NULL;
+      size_t num_found                    = 0;
+      size_t found_pos                    = 0;
       ex_hashmap32 map_filtered_category  = {0};
       unsigned levels                     = 0;
       bool use_find                       = (
@@ -1193,9 +1805,22 @@ SKIP_EXPLORE_BY_CATEGORY:;
       e                             = explore_state->entries;
       e_end                         = RBUF_END(explore_state->entries);
 
+      if (use_find)
+         found                      = explore_find_entries(
+               explore_state, &num_found);
+
       for (; e != e_end; e++)
       {
          unsigned lvl;
+
+         /* Only visit the entries matching the search */
+         if (use_find)
+         {
+            if (found_pos == num_found)
+               break;
+            e = explore_state->entries + found[found_pos++];
+         }
+
          for (lvl = 0; lvl != levels; lvl++)
          {
             if (filter[lvl] == e->by[cats[lvl]])
@@ -1214,11 +1839,6 @@ SKIP_EXPLORE_BY_CATEGORY:;
             goto SKIP_ENTRY;
          }
 
-         if (use_find && 
-               !strcasestr(e->playlist_entry->label,
-                  explore_state->find_string))
-            goto SKIP_ENTRY;
-
          if (is_filtered_category)
          {
             explore_string_t* str = e->by[current_cat];
@@ -1263,6 +1883,8 @@ SKIP_ENTRY:;
             " (%u)", (unsigned) (list->size - (is_filtered_category ? 0 : 1)));
 
       ex_hashmap32_free(&map_filtered_category);
+      if (found)
+         free(found);
    }
    else
    {
@@ -1345,10 +1967,9 @@ void menu_explore_context_deinit(void)
 
 void menu_explore_free(void)
 {
-   if (!explore_state)
-      return;
+   /* An index still being built is discarded when it arrives */
+   explore_state_pending = false;
 
-   explore_free(explore_state);
-   free(explore_state);
-   explore_state = NULL;
+   menu_explore_free_state(explore_state);
+   explore_state         = NULL;
 }
@@ -8876,6 +8876,23 @@ static bool setting_append_list(
                      bool_entries[i].flags);
             }
 
+#ifdef HAVE_COMPRESSION
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.content_extraction_cache_size,
+                  MENU_ENUM_LABEL_CONTENT_EXTRACTION_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_CONTENT_EXTRACTION_CACHE_SIZE,
+                  DEFAULT_CONTENT_EXTRACTION_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 16384, 256, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -14926,6 +14943,42 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
          }
 
+         CONFIG_UINT(
+               list, list_info,
+               &settings->uints.gfx_thumbnail_cache_size,
+               MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+               MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+               DEFAULT_GFX_THUMBNAIL_CACHE_SIZE,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+         (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 0, 256, 4, true, true);
+
+#ifdef HAVE_RTGA
+         if (string_is_equal(settings->arrays.menu_driver, "xmb") ||
+             string_is_equal(settings->arrays.menu_driver, "ozone") ||
+             string_is_equal(settings->arrays.menu_driver, "glui"))
+         {
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.gfx_thumbnail_derivative_cache,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_DERIVATIVE_CACHE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_DERIVATIVE_CACHE,
+                  DEFAULT_GFX_THUMBNAIL_DERIVATIVE_CACHE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+         }
+#endif
+
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
          {
             CONFIG_UINT(
@@ -1097,6 +1097,8 @@ enum msg_hash_enums
    MENU_LABEL(XMB_VERTICAL_THUMBNAILS),
    MENU_LABEL(MENU_XMB_THUMBNAIL_SCALE_FACTOR),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_SIZE),
+   MENU_LABEL(MENU_THUMBNAIL_DERIVATIVE_CACHE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_THUMBNAIL_DOWNSCALER),
@@ -1486,6 +1488,7 @@ enum msg_hash_enums
    MENU_LABEL(SCAN_THIS_DIRECTORY),
    MENU_LABEL(SCAN_DIRECTORY),
    MENU_LABEL(SCAN_FILE),
+   MENU_LABEL(VERIFY_CHD),
    MENU_LABEL(NETPLAY_REFRESH_ROOMS),
    MENU_LABEL(NETPLAY_ROOM_NICKNAME),
    MENU_LABEL(NETPLAY_ROOM_NICKNAME_LAN),
@@ -1894,6 +1897,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_EXPLORE_BY_FRANCHISE,
    MENU_ENUM_LABEL_VALUE_EXPLORE_BY_TAG,
    MENU_ENUM_LABEL_VALUE_EXPLORE_BY_SYSTEM_NAME,
+   MENU_ENUM_LABEL_VALUE_EXPLORE_INITIALISING_LIST,
 
    /* Content information settings */
    MENU_LABEL(CONTENT_INFO_LABEL),
@@ -1929,6 +1933,7 @@ enum msg_hash_enums
    MENU_LABEL(FAVORITES_TAB),
    MENU_ENUM_LABEL_EXPLORE_TAB,
    MENU_ENUM_LABEL_EXPLORE_ITEM,
+   MENU_ENUM_LABEL_EXPLORE_INITIALISING_LIST,
    MENU_ENUM_LABEL_VALUE_EXPLORE_TAB,
    MENU_LABEL(ADD_TAB),
    MENU_LABEL(NETPLAY_TAB),
@@ -1997,6 +2002,7 @@ enum msg_hash_enums
 
    MENU_LABEL(DUMMY_ON_CORE_SHUTDOWN),
    MENU_LABEL(CHECK_FOR_MISSING_FIRMWARE),
+   MENU_LABEL(CONTENT_EXTRACTION_CACHE_SIZE),
 #ifndef HAVE_DYNAMIC
    MENU_LABEL(ALWAYS_RELOAD_CORE_ON_RUN_CONTENT),
 #endif
@@ -2975,6 +2981,14 @@ enum msg_hash_enums
    MSG_MANUAL_CONTENT_SCAN_M3U_CLEANUP,
    MSG_MANUAL_CONTENT_SCAN_END,
 
+   MSG_CHD_VERIFY_START,
+   MSG_CHD_VERIFY_PASSED,
+   MSG_CHD_VERIFY_FAILED,
+   MSG_CHD_VERIFY_NO_CHECKSUM,
+   MSG_CHD_VERIFY_READ_ERROR,
+
+   MSG_IMAGE_DECODE_QUEUE_DEPTH,
+
    MSG_LAST,
 
    /* Ensure sizeof(enum) == sizeof(int) */
@@ -328,7 +328,7 @@ bool netplay_lan_ad_server(netplay_t *netplay)
 
                   /* Now build our response */
                   buf[0]      = '\0';
-                  content_crc = content_get_crc();
+                  content_crc = content_wait_for_crc();
 
                   memset(&ad_packet_buffer, 0, sizeof(struct ad_packet));
                   memcpy(&ad_packet_buffer, "RANS", 4);
@@ -524,7 +524,7 @@ static bool netplay_handshake_info(netplay_t *netplay,
    }
 
    /* Get our content CRC */
-   content_crc = content_get_crc();
+   content_crc = content_wait_for_crc();
 
    if (content_crc != 0)
       info_buf.content_crc = htonl(content_crc);
@@ -901,7 +901,7 @@ static bool netplay_handshake_pre_info(netplay_t *netplay,
    }
 
    /* Check the content CRC */
-   content_crc = content_get_crc();
+   content_crc = content_wait_for_crc();
 
    if (content_crc != 0)
    {
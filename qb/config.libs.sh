@@ -170,6 +170,12 @@ fi
 
 check_platform 'Linux Win32' CDROM 'CD-ROM is' user
 
+if [ "$OS" = 'Linux' ]; then
+   check_header '' IO_URING linux/io_uring.h
+fi
+
+check_platform Linux IO_URING 'io_uring is' true
+
 if [ "$OS" = 'Win32' ]; then
    add_opt DYLIB yes
 else
@@ -168,6 +168,7 @@ HAVE_VIDEOCORE=auto        # Broadcom Videocore 4 support
 HAVE_DRMINGW=no            # DrMingw exception handler
 HAVE_GONG=no               # Gong core embedded
 HAVE_CDROM=auto            # CD-ROM support
+HAVE_IO_URING=auto         # io_uring file loading (Linux)
 HAVE_GLSL=yes              # GLSL shaders support
 HAVE_SLANG=auto            # slang support
 C89_SLANG=no
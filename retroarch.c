@@ -98,6 +98,7 @@
 #include <streams/file_stream.h>
 #include <streams/interface_stream.h>
 #include <file/file_path.h>
+#include <file/archive_file.h>
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
 #include <queues/message_queue.h>
@@ -1138,6 +1139,9 @@ static const camera_driver_t *camera_drivers[] = {
 #endif
 
 #define SHADER_FILE_WATCH_DELAY_MSEC 500
+
+/* Number of ZIP central directories kept in memory */
+#define ZIP_INDEX_CACHE_SIZE 16
 #define HOLD_BTN_DELAY_SEC 2
 
 #define QUIT_DELAY_USEC 3 * 1000000 /* 3 seconds */
@@ -6325,7 +6329,14 @@ static void menu_display_common_image_upload(
       p_rarch->menu_driver_ctx->load_image(p_rarch->menu_userdata,
             load_image_info.data, load_image_info.type);
 
-   image_texture_free(img);
+   /* Thumbnail images are kept for reuse when the
+    * requester passed the image path as user data */
+   if (     !user_data
+         || (  (type != MENU_IMAGE_THUMBNAIL)
+            && (type != MENU_IMAGE_LEFT_THUMBNAIL))
+         || !gfx_thumbnail_cache_add((const char*)user_data, img,
+               video_driver_supports_rgba(), 0))
+      image_texture_free(img);
    free(img);
    free(user_data);
 }
@@ -7652,6 +7663,8 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
 #if defined(HAVE_MENU) && defined(HAVE_LIBRETRODB)
          menu_explore_free();
 #endif
+         gfx_thumbnail_prefetch_reset();
+         gfx_thumbnail_cache_free();
 
          if (p_rarch->menu_driver_data)
          {
@@ -9919,7 +9932,7 @@ static void netplay_announce(struct rarch_state *p_rarch)
    char *frontend_ident             = NULL;
    settings_t *settings             = p_rarch->configuration_settings;
    struct retro_system_info *system = &p_rarch->runloop_system.info;
-   uint32_t content_crc             = content_get_crc();
+   uint32_t content_crc             = content_wait_for_crc();
    struct string_list *subsystem    = path_get_subsystem_list();
 
    buf[0] = '\0';
@@ -17536,6 +17549,10 @@ void main_exit(void *args)
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+   task_image_decode_deinit();
+#ifdef HAVE_ZLIB
+   file_archive_zip_index_cache_deinit();
+#endif
 
    if (p_rarch->configuration_settings)
       free(p_rarch->configuration_settings);
@@ -22228,7 +22245,7 @@ static bool bsv_movie_init_playback(
       return false;
    }
 
-   content_crc               = content_get_crc();
+   content_crc               = content_wait_for_crc();
 
    if (content_crc != 0)
       if (swap_if_big32(header[CRC_INDEX]) != content_crc)
@@ -22298,7 +22315,7 @@ static bool bsv_movie_init_record(
 
    handle->file             = file;
 
-   content_crc              = content_get_crc();
+   content_crc              = content_wait_for_crc();
 
    /* This value is supposed to show up as
     * BSV1 in a HEX editor, big-endian. */
@@ -37415,6 +37432,10 @@ void retroarch_init_task_queue(void)
 
    task_queue_deinit();
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+
+#ifdef HAVE_ZLIB
+   file_archive_zip_index_cache_init(ZIP_INDEX_CACHE_SIZE);
+#endif
 }
 
 static void retroarch_core_options_intl_init(
@@ -303,17 +303,21 @@ typedef struct content_state
    int pending_subsystem_rom_num;
    int pending_subsystem_id;
    unsigned pending_subsystem_rom_id;
+   /* Bumped whenever content changes, so that the CRC32
+    * of previous content is never published */
+   unsigned rom_crc_generation;
+   /* Set by a background task, 0 until then */
    uint32_t rom_crc;
+   /* Set while that task is still hashing */
+   bool rom_crc_pending;
 
    char companion_ui_crc32[32];
    char pending_subsystem_ident[255];
-   char pending_rom_crc_path[PATH_MAX_LENGTH];
    char companion_ui_db_name[PATH_MAX_LENGTH];
 
    bool is_inited;
    bool core_does_not_need_content;
    bool pending_subsystem_init;
-   bool pending_rom_crc;
 } content_state_t;
 
 bool rarch_ctl(enum rarch_ctl_state state, void *data);
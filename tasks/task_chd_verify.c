@@ -0,0 +1,346 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2020 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <boolean.h>
+
+#include <rhash.h>
+#include <compat/strl.h>
+#include <string/stdstring.h>
+#include <file/file_path.h>
+#include <libchdr/chd.h>
+#include <features/features_cpu.h>
+
+#include "tasks_internal.h"
+
+#include "../msg_hash.h"
+#include "../verbosity.h"
+
+/* Hunks decompressed per iteration, so that progress
+ * is shown and the task can be cancelled */
+#define CHD_VERIFY_HUNKS_PER_ITERATION 256
+
+enum chd_verify_status
+{
+   CHD_VERIFY_BEGIN = 0,
+   CHD_VERIFY_ITERATE,
+   CHD_VERIFY_END
+};
+
+typedef struct chd_verify_handle
+{
+   char *path;
+   chd_file *chd;
+   /* Keeps the decompression threads for the whole task */
+   chd_hunk_reader *reader;
+   struct sha1_context sha1;
+   MD5_CTX md5;
+   /* Raw data not hashed yet; the last hunk may be padded */
+   uint64_t remaining;
+   uint32_t next_hunk;
+   uint32_t total_hunks;
+   uint32_t hunkbytes;
+   unsigned threads;
+   enum chd_verify_status status;
+   /* Versions 1 and 2 only have an MD5 of the raw data */
+   bool use_md5;
+} chd_verify_handle_t;
+
+static void free_chd_verify_handle(chd_verify_handle_t *verify)
+{
+   if (!verify)
+      return;
+
+   if (verify->reader)
+      chd_hunk_reader_close(verify->reader);
+   if (verify->chd)
+      chd_close(verify->chd);
+   if (verify->path)
+      free(verify->path);
+   free(verify);
+}
+
+static void task_chd_verify_free(retro_task_t *task)
+{
+   if (task)
+      free_chd_verify_handle((chd_verify_handle_t*)task->state);
+}
+
+static void task_chd_verify_set_title(retro_task_t *task,
+      chd_verify_handle_t *verify, enum msg_hash_enums msg)
+{
+   char task_title[PATH_MAX_LENGTH];
+
+   strlcpy(task_title, msg_hash_to_str(msg), sizeof(task_title));
+   strlcat(task_title, path_basename(verify->path), sizeof(task_title));
+
+   task_free_title(task);
+   task_set_title(task, strdup(task_title));
+}
+
+static chd_error task_chd_verify_hunk(void *userdata,
+      uint32_t hunknum, const void *data)
+{
+   chd_verify_handle_t *verify = (chd_verify_handle_t*)userdata;
+   uint32_t len                = verify->hunkbytes;
+
+   if (len > verify->remaining)
+      len = (uint32_t)verify->remaining;
+
+   if (verify->use_md5)
+      MD5_Update(&verify->md5, data, len);
+   else
+      sha1_context_update(&verify->sha1, data, len);
+
+   verify->remaining -= len;
+   return CHDERR_NONE;
+}
+
+/* Returns the checksum of the raw data stored in the
+ * header, NULL if the file does not have one */
+static const uint8_t *task_chd_verify_expected(
+      const chd_header *header, size_t *len)
+{
+   const uint8_t *expected;
+   size_t i;
+
+   if (header->version <= 2)
+   {
+      expected = header->md5;
+      *len     = CHD_MD5_BYTES;
+   }
+   else if (header->version == 3)
+   {
+      expected = header->sha1;
+      *len     = CHD_SHA1_BYTES;
+   }
+   else
+   {
+      expected = header->rawsha1;
+      *len     = CHD_SHA1_BYTES;
+   }
+
+   for (i = 0; i < *len; i++)
+      if (expected[i])
+         return expected;
+
+   return NULL;
+}
+
+static void task_chd_verify_handler(retro_task_t *task)
+{
+   chd_verify_handle_t *verify = NULL;
+
+   if (!task)
+      goto task_finished;
+
+   verify = (chd_verify_handle_t*)task->state;
+
+   if (!verify)
+      goto task_finished;
+
+   if (task_get_cancelled(task))
+      goto task_finished;
+
+   switch (verify->status)
+   {
+      case CHD_VERIFY_BEGIN:
+         {
+            const chd_header *header = NULL;
+            size_t len               = 0;
+
+            if (chd_open(verify->path, CHD_OPEN_READ,
+                     NULL, &verify->chd) != CHDERR_NONE)
+            {
+               RARCH_ERR("[CHD]: Could not open \"%s\".\n", verify->path);
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_READ_ERROR);
+               goto task_finished;
+            }
+
+            header = chd_get_header(verify->chd);
+
+            if (!task_chd_verify_expected(header, &len))
+            {
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_NO_CHECKSUM);
+               goto task_finished;
+            }
+
+            /* Hunks are decompressed on every core, and
+             * hashed here in order */
+            if (chd_hunk_reader_open(verify->chd, verify->threads,
+                     &verify->reader) != CHDERR_NONE)
+            {
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_READ_ERROR);
+               goto task_finished;
+            }
+
+            verify->use_md5     = (header->version <= 2);
+            verify->remaining   = header->logicalbytes;
+            verify->hunkbytes   = header->hunkbytes;
+            verify->total_hunks = header->totalhunks;
+            verify->status      = CHD_VERIFY_ITERATE;
+
+            if (verify->use_md5)
+               MD5_Init(&verify->md5);
+            else
+               sha1_context_init(&verify->sha1);
+         }
+         break;
+      case CHD_VERIFY_ITERATE:
+         {
+            chd_error err;
+            uint32_t count = verify->total_hunks - verify->next_hunk;
+
+            if (count > CHD_VERIFY_HUNKS_PER_ITERATION)
+               count = CHD_VERIFY_HUNKS_PER_ITERATION;
+
+            err = chd_hunk_reader_read(verify->reader, verify->next_hunk,
+                  count, task_chd_verify_hunk, verify);
+
+            if (err != CHDERR_NONE)
+            {
+               RARCH_ERR("[CHD]: \"%s\": %s in hunk range %u-%u.\n",
+                     verify->path, chd_error_string(err),
+                     verify->next_hunk, verify->next_hunk + count - 1);
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_FAILED);
+               goto task_finished;
+            }
+
+            verify->next_hunk += count;
+            task_set_progress(task, (int8_t)(
+                  ((uint64_t)verify->next_hunk * 100) / verify->total_hunks));
+
+            if (verify->next_hunk >= verify->total_hunks)
+               verify->status = CHD_VERIFY_END;
+         }
+         break;
+      case CHD_VERIFY_END:
+         {
+            uint8_t digest[CHD_SHA1_BYTES];
+            size_t len                = 0;
+            bool valid                = false;
+            const uint8_t *expected   = task_chd_verify_expected(
+                  chd_get_header(verify->chd), &len);
+
+            if (verify->use_md5)
+            {
+               MD5_Final(digest, &verify->md5);
+               valid = true;
+            }
+            else
+               valid = sha1_context_final(&verify->sha1, digest);
+
+            if (valid && !memcmp(digest, expected, len))
+            {
+               RARCH_LOG("[CHD]: \"%s\" verified.\n", verify->path);
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_PASSED);
+            }
+            else
+            {
+               RARCH_ERR("[CHD]: \"%s\" does not match its checksum.\n",
+                     verify->path);
+               task_chd_verify_set_title(task, verify,
+                     MSG_CHD_VERIFY_FAILED);
+            }
+
+            task_set_progress(task, 100);
+         }
+         goto task_finished;
+   }
+
+   return;
+
+task_finished:
+
+   if (task)
+      task_set_finished(task, true);
+}
+
+static bool task_chd_verify_finder(retro_task_t *task, void *user_data)
+{
+   chd_verify_handle_t *verify = NULL;
+
+   if (!task || !user_data)
+      return false;
+
+   if (task->handler != task_chd_verify_handler)
+      return false;
+
+   verify = (chd_verify_handle_t*)task->state;
+   if (!verify)
+      return false;
+
+   return string_is_equal((const char*)user_data, verify->path);
+}
+
+bool task_push_chd_verify(const char *path)
+{
+   task_finder_data_t find_data;
+   char task_title[PATH_MAX_LENGTH];
+   retro_task_t *task          = NULL;
+   chd_verify_handle_t *verify = NULL;
+
+   if (string_is_empty(path))
+      return false;
+
+   /* Verifying the same file twice at once is pointless */
+   find_data.func     = task_chd_verify_finder;
+   find_data.userdata = (void*)path;
+
+   if (task_queue_find(&find_data))
+      return false;
+
+   verify = (chd_verify_handle_t*)calloc(1, sizeof(*verify));
+   if (!verify)
+      return false;
+
+   verify->path    = strdup(path);
+   verify->status  = CHD_VERIFY_BEGIN;
+   verify->threads = 1;
+#ifdef HAVE_THREADS
+   verify->threads = cpu_features_get_core_amount();
+#endif
+
+   task = task_init();
+
+   if (!verify->path || !task)
+   {
+      if (task)
+         free(task);
+      free_chd_verify_handle(verify);
+      return false;
+   }
+
+   strlcpy(task_title, msg_hash_to_str(MSG_CHD_VERIFY_START),
+         sizeof(task_title));
+   strlcat(task_title, path_basename(path), sizeof(task_title));
+
+   task->handler          = task_chd_verify_handler;
+   task->state            = verify;
+   task->title            = strdup(task_title);
+   task->alternative_look = true;
+   task->progress         = 0;
+   task->cleanup          = task_chd_verify_free;
+
+   task_queue_push(task);
+
+   return true;
+}
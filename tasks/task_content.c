@@ -66,7 +66,16 @@
 #include <retro_miscellaneous.h>
 #include <streams/file_stream.h>
 #include <retro_assert.h>
+#ifdef HAVE_MMAP
+#include <memmap.h>
+#endif
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
+#include <rhash.h>
+#include <file/config_file.h>
+#include <lists/dir_list.h>
 #include <lists/string_list.h>
 #include <string/stdstring.h>
 
@@ -119,6 +128,15 @@ extern bool discord_is_inited;
 typedef struct content_stream content_stream_t;
 typedef struct content_information_ctx content_information_ctx_t;
 
+enum content_crc_source
+{
+   CONTENT_CRC_NONE = 0,
+   /* The buffer passed to the core */
+   CONTENT_CRC_BUFFER,
+   /* The file, for cores which load it themselves */
+   CONTENT_CRC_FILE
+};
+
 #ifdef HAVE_CDROM
 enum cdrom_dump_state
 {
@@ -169,6 +187,20 @@ struct content_information_ctx
 
    struct string_list *temporary_content;
 
+   /* Where the CRC32 of the first content file is
+    * computed from once it has been loaded */
+   enum content_crc_source crc_source;
+
+   /* Bytes of extracted content kept in the cache
+    * directory, 0 if it is not kept */
+   uint64_t extraction_cache_size;
+
+#ifdef HAVE_MMAP
+   /* One per content file, set for those mapped
+    * instead of read into memory */
+   struct memmap_file_region *maps;
+#endif
+
    struct
    {
       struct retro_subsystem_info *data;
@@ -479,6 +511,266 @@ static int64_t content_file_read(const char *path, void **buf, int64_t *length)
    return filestream_read_file(path, buf, length);
 }
 
+#ifdef HAVE_MMAP
+/* Maps a content file, or a file stored uncompressed
+ * in a ZIP archive, instead of reading it. Pages are only
+ * copied if written to, so cores modifying the buffer
+ * they are passed still work. */
+static bool content_file_map(const char *path,
+      struct memmap_file_region *region)
+{
+#ifdef HAVE_COMPRESSION
+   if (path_contains_compressed_file(path))
+   {
+      char archive_path[PATH_MAX_LENGTH];
+      char *delim    = NULL;
+      int64_t size   = 0;
+      int64_t offset = file_archive_get_stored_file_offset(path, &size);
+
+      if (offset < 0 || size <= 0)
+         return false;
+
+      strlcpy(archive_path, path, sizeof(archive_path));
+      if ((delim = (char*)path_get_archive_delim(archive_path)))
+         *delim = '\0';
+
+      return memmap_file_region(archive_path,
+            (uint64_t)offset, (uint64_t)size, region);
+   }
+#endif
+   return memmap_file_region(path, 0, 0, region);
+}
+#endif
+
+/* Frees a buffer returned by load_content_into_memory() */
+static void content_file_free_buffer(
+      content_information_ctx_t *content_ctx,
+      unsigned i, void *buf)
+{
+#ifdef HAVE_MMAP
+   if (     content_ctx->maps
+         && content_ctx->maps[i].base
+         && content_ctx->maps[i].data == buf)
+   {
+      memunmap_file_region(&content_ctx->maps[i]);
+      return;
+   }
+#endif
+   free(buf);
+}
+
+/* The CRC32 of the first content file is computed in the
+ * background once the core has loaded it, a piece at a time
+ * so that builds without threads do not stall either.
+ * Content which is not loaded into memory is read from its
+ * file, of which only the first CONTENT_CRC_FILE_MAX bytes
+ * are hashed. */
+#define CONTENT_CRC_CHUNK_SIZE (4 * 1024 * 1024)
+#define CONTENT_CRC_FILE_MAX   (64 * 1024 * 1024)
+
+typedef struct content_crc_state
+{
+   /* The content, or a read buffer if 'file' is set */
+   uint8_t *buf;
+   RFILE *file;
+#ifdef HAVE_MMAP
+   /* Set if 'buf' is mapped */
+   struct memmap_file_region map;
+#endif
+   int64_t len;
+   int64_t pos;
+   /* Value of rom_crc_generation when the task was pushed */
+   unsigned generation;
+   uint32_t crc;
+} content_crc_state_t;
+
+#ifdef HAVE_THREADS
+/* Guards rom_crc and rom_crc_generation of the content
+ * state, which the task may publish to from its thread */
+static slock_t *content_crc_lock = NULL;
+#define CONTENT_CRC_LOCK()   slock_lock(content_crc_lock)
+#define CONTENT_CRC_UNLOCK() slock_unlock(content_crc_lock)
+#else
+#define CONTENT_CRC_LOCK()
+#define CONTENT_CRC_UNLOCK()
+#endif
+
+/* Forgets the CRC32 of the current content, and makes sure
+ * that a task still hashing it never publishes its result */
+static void content_crc_invalidate(content_state_t *p_content)
+{
+#ifdef HAVE_THREADS
+   if (!content_crc_lock)
+      content_crc_lock = slock_new();
+#endif
+
+   CONTENT_CRC_LOCK();
+   p_content->rom_crc         = 0;
+   p_content->rom_crc_pending = false;
+   p_content->rom_crc_generation++;
+   CONTENT_CRC_UNLOCK();
+}
+
+static void task_content_crc_free(retro_task_t *task)
+{
+   content_crc_state_t *state = NULL;
+   content_state_t *p_content = content_state_get_ptr();
+
+   if (!task || !(state = (content_crc_state_t*)task->state))
+      return;
+
+   /* Done, cancelled or failed, nothing is left to wait for */
+   CONTENT_CRC_LOCK();
+   if (state->generation == p_content->rom_crc_generation)
+      p_content->rom_crc_pending = false;
+   CONTENT_CRC_UNLOCK();
+
+   if (state->file)
+   {
+      filestream_close(state->file);
+      free(state->buf);
+   }
+#ifdef HAVE_MMAP
+   else if (state->map.base)
+      memunmap_file_region(&state->map);
+#endif
+   else
+      free(state->buf);
+
+   free(state);
+}
+
+static void task_content_crc_handler(retro_task_t *task)
+{
+   int64_t amount;
+   bool current;
+   content_crc_state_t *state = (content_crc_state_t*)task->state;
+   content_state_t *p_content = content_state_get_ptr();
+
+   CONTENT_CRC_LOCK();
+   current = state->generation == p_content->rom_crc_generation;
+   CONTENT_CRC_UNLOCK();
+
+   /* Other content has been loaded since */
+   if (!current || task_get_cancelled(task))
+      goto task_finished;
+
+   amount = state->len - state->pos;
+   if (amount > CONTENT_CRC_CHUNK_SIZE)
+      amount = CONTENT_CRC_CHUNK_SIZE;
+
+   if (state->file)
+   {
+      amount = filestream_read(state->file, state->buf, amount);
+      if (amount < 0)
+      {
+         RARCH_ERR("[CONTENT LOAD]: Could not read content for CRC32.\n");
+         goto task_finished;
+      }
+
+      state->crc = encoding_crc32(state->crc, state->buf, (size_t)amount);
+
+      /* The file is shorter than it claimed */
+      if (amount == 0)
+         state->len = state->pos;
+   }
+   else
+      state->crc = encoding_crc32(state->crc,
+            state->buf + state->pos, (size_t)amount);
+
+   state->pos += amount;
+   task_set_progress(task, state->len
+         ? (int8_t)((state->pos * 100) / state->len) : 100);
+
+   if (state->pos < state->len)
+      return;
+
+   CONTENT_CRC_LOCK();
+   if (state->generation == p_content->rom_crc_generation)
+      p_content->rom_crc = state->crc;
+   CONTENT_CRC_UNLOCK();
+
+   RARCH_LOG("[CONTENT LOAD]: CRC32: 0x%x .\n", (unsigned)state->crc);
+
+task_finished:
+   task_set_finished(task, true);
+}
+
+/* Hands the first content file over to a task computing
+ * its CRC32. A buffer is taken over, as it would otherwise
+ * be freed now that the core is loaded. */
+static void task_push_content_crc(
+      content_information_ctx_t *content_ctx,
+      content_state_t *p_content,
+      struct retro_game_info *info)
+{
+   retro_task_t *task         = NULL;
+   content_crc_state_t *state = (content_crc_state_t*)
+      calloc(1, sizeof(*state));
+
+   if (!state)
+      return;
+
+   if (content_ctx->crc_source == CONTENT_CRC_BUFFER)
+   {
+      if (!info->data)
+         goto error;
+
+      state->buf  = (uint8_t*)info->data;
+      state->len  = (int64_t)info->size;
+#ifdef HAVE_MMAP
+      if (     content_ctx->maps
+            && content_ctx->maps[0].base
+            && content_ctx->maps[0].data == info->data)
+      {
+         state->map = content_ctx->maps[0];
+         memset(&content_ctx->maps[0], 0, sizeof(content_ctx->maps[0]));
+      }
+#endif
+      info->data  = NULL;
+   }
+   else
+   {
+      int64_t size;
+
+      if (!(state->file = filestream_open(info->path,
+                  RETRO_VFS_FILE_ACCESS_READ,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         goto error;
+
+      size       = filestream_get_size(state->file);
+      state->len = size < CONTENT_CRC_FILE_MAX ? size : CONTENT_CRC_FILE_MAX;
+      state->buf = (uint8_t*)malloc(CONTENT_CRC_CHUNK_SIZE);
+
+      if (size < 0 || !state->buf)
+         goto error;
+   }
+
+   if (!(task = task_init()))
+      goto error;
+
+   CONTENT_CRC_LOCK();
+   state->generation          = p_content->rom_crc_generation;
+   p_content->rom_crc_pending = true;
+   CONTENT_CRC_UNLOCK();
+
+   task->handler   = task_content_crc_handler;
+   task->cleanup   = task_content_crc_free;
+   task->state     = state;
+   task->mute      = true;
+
+   task_queue_push(task);
+   return;
+
+error:
+   if (state->file)
+   {
+      filestream_close(state->file);
+      free(state->buf);
+   }
+   free(state);
+}
+
 /**
  * content_load_init_wrap:
  * @args                 : Input arguments.
@@ -670,7 +962,6 @@ static bool content_load(content_ctx_info_t *info,
  **/
 static bool load_content_into_memory(
       content_information_ctx_t *content_ctx,
-      content_state_t *p_content,
       unsigned i, const char *path, void **buf,
       int64_t *length)
 {
@@ -679,11 +970,23 @@ static bool load_content_into_memory(
    RARCH_LOG("[CONTENT LOAD]: %s: %s.\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), path);
 
+#ifdef HAVE_MMAP
+   if (     content_ctx->maps
+         && content_file_map(path, &content_ctx->maps[i]))
+   {
+      ret_buf = (uint8_t*)content_ctx->maps[i].data;
+      *length = (int64_t)content_ctx->maps[i].len;
+   }
+   else
+#endif
    if (!content_file_read(path, (void**) &ret_buf, length))
       return false;
 
    if (*length < 0)
+   {
+      content_file_free_buffer(content_ctx, i, ret_buf);
       return false;
+   }
 
    if (i == 0)
    {
@@ -693,14 +996,14 @@ static bool load_content_into_memory(
       if (type == RARCH_CONTENT_NONE)
       {
 #ifdef HAVE_PATCH
-         bool has_patch = false;
+         uint8_t *content_buf = ret_buf;
 
          /* First content file is significant, attempt to do patching,
           * CRC checking, etc. */
 
          /* Attempt to apply a patch. */
          if (!content_ctx->patch_is_blocked)
-            has_patch = patch_content(
+            patch_content(
                   content_ctx->is_ips_pref,
                   content_ctx->is_bps_pref,
                   content_ctx->is_ups_pref,
@@ -710,21 +1013,17 @@ static bool load_content_into_memory(
                   (uint8_t**)&ret_buf,
                   (void*)length);
 
-         if (has_patch)
-         {
-            p_content->rom_crc = encoding_crc32(0, ret_buf, (size_t)*length);
-            RARCH_LOG("[CONTENT LOAD]: CRC32: 0x%x .\n", (unsigned)p_content->rom_crc);
-         }
-         else
+         /* Unless it was patched in place, the patched
+          * content is a new buffer, and the unpatched one
+          * (possibly mapped) is not needed */
+         if (ret_buf != content_buf)
+            content_file_free_buffer(content_ctx, i, content_buf);
 #endif
-         {
-            strlcpy(p_content->pending_rom_crc_path,
-                  path, sizeof(p_content->pending_rom_crc_path));
-            p_content->pending_rom_crc      = true;
-         }
+
+         /* Hashed once the core is loaded, so that patched
+          * content gets the CRC32 of what the core runs */
+         content_ctx->crc_source = CONTENT_CRC_BUFFER;
       }
-      else
-         p_content->rom_crc = 0;
    }
 
    *buf = ret_buf;
@@ -733,6 +1032,173 @@ static bool load_content_into_memory(
 }
 
 #ifdef HAVE_COMPRESSION
+/* Content extracted for cores which need a full path is
+ * kept in <cache>/extracted/<key>/, where the key is made
+ * of the full path of the file and its size and CRC32 in
+ * the archive. The manifest records the size of every
+ * entry and when it was last used, so that the least
+ * recently used ones can be deleted once the cache grows
+ * past its limit. */
+#define CONTENT_EXTRACTION_CACHE_DIR      "extracted"
+#define CONTENT_EXTRACTION_CACHE_MANIFEST "manifest.cfg"
+
+static bool content_extraction_cache_dir(
+      content_information_ctx_t *content_ctx, char *s, size_t len)
+{
+   if (     !content_ctx->extraction_cache_size
+         || string_is_empty(content_ctx->directory_cache)
+         || !path_is_directory(content_ctx->directory_cache))
+      return false;
+
+   fill_pathname_join(s, content_ctx->directory_cache,
+         CONTENT_EXTRACTION_CACHE_DIR, len);
+
+   return path_is_directory(s) || path_mkdir(s);
+}
+
+static void content_extraction_cache_remove(
+      const char *cache_dir, const char *key)
+{
+   size_t i;
+   char entry_dir[PATH_MAX_LENGTH];
+   struct string_list *list = NULL;
+
+   fill_pathname_join(entry_dir, cache_dir, key, sizeof(entry_dir));
+
+   if ((list = dir_list_new(entry_dir, NULL, false, true, false, false)))
+   {
+      for (i = 0; i < list->size; i++)
+         filestream_delete(list->elems[i].data);
+      string_list_free(list);
+   }
+
+   filestream_delete(entry_dir);
+}
+
+static void content_extraction_cache_evict(config_file_t *conf,
+      const char *cache_dir, const char *keep, uint64_t limit)
+{
+   for (;;)
+   {
+      struct config_entry_list *entry  = NULL;
+      struct config_entry_list *oldest = NULL;
+      unsigned long long oldest_time   = 0;
+      uint64_t total                   = 0;
+
+      for (entry = conf->entries; entry; entry = entry->next)
+      {
+         unsigned size                 = 0;
+         unsigned long long last_used  = 0;
+
+         /* Unset entries are only cleared */
+         if (     !entry->key
+               || !entry->value
+               || sscanf(entry->value, "%u %llu", &size, &last_used) != 2)
+            continue;
+
+         total += size;
+
+         if (string_is_equal(entry->key, keep))
+            continue;
+
+         if (!oldest || last_used < oldest_time)
+         {
+            oldest      = entry;
+            oldest_time = last_used;
+         }
+      }
+
+      if (total <= limit || !oldest)
+         break;
+
+      RARCH_LOG("[CONTENT LOAD]: Removing \"%s\" from extraction cache.\n",
+            oldest->key);
+
+      content_extraction_cache_remove(cache_dir, oldest->key);
+      config_unset(conf, oldest->key);
+   }
+}
+
+/* Extracts a file inside an archive into the extraction
+ * cache, unless it is there already, and returns its
+ * path in 's'. Returns false if the file is not to be
+ * cached, so that it gets extracted as temporary
+ * content instead. */
+static bool content_extraction_cache_fetch(
+      content_information_ctx_t *content_ctx,
+      const char *path, char *s, size_t len)
+{
+   char cache_dir[PATH_MAX_LENGTH];
+   char entry_dir[PATH_MAX_LENGTH];
+   char manifest_path[PATH_MAX_LENGTH];
+   char key[32];
+   char value[64];
+   uint32_t crc                     = 0;
+   uint32_t size                    = 0;
+   int64_t new_path_len             = 0;
+   config_file_t *conf              = NULL;
+
+   if (     !path_contains_compressed_file(path)
+         || !content_extraction_cache_dir(content_ctx,
+            cache_dir, sizeof(cache_dir)))
+      return false;
+
+   /* Size and CRC32 come from the archive directory,
+    * nothing is decompressed to look the file up */
+   if (     !file_archive_get_file_info(path, &crc, &size)
+         || size > content_ctx->extraction_cache_size)
+      return false;
+
+   snprintf(key, sizeof(key), "%08x%08x%08x",
+         (unsigned)djb2_calculate(path), (unsigned)size, (unsigned)crc);
+
+   fill_pathname_join(manifest_path, cache_dir,
+         CONTENT_EXTRACTION_CACHE_MANIFEST, sizeof(manifest_path));
+   fill_pathname_join(entry_dir, cache_dir, key, sizeof(entry_dir));
+   fill_pathname_join(s, entry_dir, path_basename(path), len);
+
+   if (     !(conf = config_file_new(manifest_path))
+         && !(conf = config_file_new_alloc()))
+      return false;
+
+   /* Entries are only added once extraction has finished,
+    * so a file without one may be incomplete. A file which
+    * no longer has the size the archive directory gives was
+    * truncated or replaced since. */
+   if (     config_get_entry(conf, key, NULL)
+         && path_get_size(s) == (int32_t)size)
+      RARCH_LOG("[CONTENT LOAD]: Using \"%s\" from extraction cache.\n", s);
+   else
+   {
+      RARCH_LOG("[CONTENT LOAD]: Extracting \"%s\" to extraction cache.\n",
+            path);
+
+      if (path_is_valid(s))
+         filestream_delete(s);
+
+      if (     (!path_is_directory(entry_dir) && !path_mkdir(entry_dir))
+            || !file_archive_compressed_read(path, NULL, s, &new_path_len)
+            || new_path_len < 0)
+      {
+         content_extraction_cache_remove(cache_dir, key);
+         config_file_free(conf);
+         return false;
+      }
+   }
+
+   snprintf(value, sizeof(value), "%u %llu", (unsigned)size,
+         (unsigned long long)time(NULL));
+   config_set_string(conf, key, value);
+
+   content_extraction_cache_evict(conf, cache_dir, key,
+         content_ctx->extraction_cache_size);
+
+   config_file_write(conf, manifest_path, false);
+   config_file_free(conf);
+
+   return true;
+}
+
 static bool load_content_from_compressed_archive(
       content_information_ctx_t *content_ctx,
       struct retro_game_info *info,
@@ -751,6 +1217,17 @@ static bool load_content_from_compressed_archive(
    new_basedir[0]                    = '\0';
    attr.i                            = 0;
 
+   /* Cached files outlive the content, so they are
+    * not added to the temporary content */
+   if (content_extraction_cache_fetch(content_ctx, path,
+            new_path, sizeof(new_path)))
+   {
+      string_list_append(additional_path_allocs, new_path, attr);
+      info[i].path =
+         additional_path_allocs->elems[additional_path_allocs->size - 1].data;
+      return true;
+   }
+
    RARCH_LOG("[CONTENT LOAD]: Compressed file in case of need_fullpath."
          " Now extracting to temporary directory.\n");
 
@@ -829,6 +1306,27 @@ static bool content_file_init_extract(
          if (!string_is_empty(path))
             strlcpy(temp_content, path, sizeof(temp_content));
 
+         /* A file picked inside the archive can be looked up
+          * in the extraction cache, as long as it would have
+          * been extracted */
+         if (contains_compressed && valid_ext)
+         {
+            struct string_list *ext_list = string_split(valid_ext, "|");
+            bool cached                  = ext_list
+               && string_list_find_elem(ext_list, path_get_extension(path))
+               && content_extraction_cache_fetch(content_ctx, path,
+                     new_path, sizeof(new_path));
+
+            if (ext_list)
+               string_list_free(ext_list);
+
+            if (cached)
+            {
+               string_list_set(content, i, new_path);
+               continue;
+            }
+         }
+
          if (!valid_ext || !file_archive_extract_file(
                   temp_content,
                   sizeof(temp_content),
@@ -916,7 +1414,7 @@ static bool content_file_load(
          int64_t len = 0;
 
          if (!load_content_into_memory(
-                  content_ctx, p_content,
+                  content_ctx,
                   i, path, (void**)&info[i].data, &len))
          {
             char msg[1024];
@@ -1026,9 +1524,9 @@ static bool content_file_load(
 
          RARCH_LOG("[CONTENT LOAD]: %s\n", msg_hash_to_str(
                   MSG_CONTENT_LOADING_SKIPPED_IMPLEMENTATION_WILL_DO_IT));
-         strlcpy(p_content->pending_rom_crc_path,
-               path, sizeof(p_content->pending_rom_crc_path));
-         p_content->pending_rom_crc      = true;
+
+         if (i == 0 && !path_empty)
+            content_ctx->crc_source = CONTENT_CRC_FILE;
       }
    }
 
@@ -1065,6 +1563,9 @@ static bool content_file_load(
       rcheevos_hardcore_paused = true;
 #endif
 
+   if (content_ctx->crc_source != CONTENT_CRC_NONE)
+      task_push_content_crc(content_ctx, p_content, &info[0]);
+
    return true;
 }
 
@@ -1213,6 +1714,9 @@ static bool content_file_init(
    if (!ret)
       return false;
 
+   content_ctx->crc_source = CONTENT_CRC_NONE;
+   content_crc_invalidate(p_content);
+
    content_file_init_set_attribs(content, special, content_ctx, error_string, &attr);
 #ifdef HAVE_COMPRESSION
    content_file_init_extract(content, content_ctx, special, error_string, &attr);
@@ -1227,13 +1731,23 @@ static bool content_file_init(
       unsigned i;
       struct string_list *additional_path_allocs = string_list_new();
 
+#ifdef HAVE_MMAP
+      content_ctx->maps = (struct memmap_file_region*)
+         calloc(content->size, sizeof(*content_ctx->maps));
+#endif
+
       ret = content_file_load(info, p_content,
             content, content_ctx, error_string,
             special, additional_path_allocs);
       string_list_free(additional_path_allocs);
 
       for (i = 0; i < content->size; i++)
-         free((void*)info[i].data);
+         content_file_free_buffer(content_ctx, i, (void*)info[i].data);
+
+#ifdef HAVE_MMAP
+      free(content_ctx->maps);
+      content_ctx->maps = NULL;
+#endif
 
       free(info);
    }
@@ -1521,6 +2035,7 @@ bool task_push_start_dummy_core(content_ctx_info_t *content_info)
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -1618,6 +2133,7 @@ bool task_push_load_content_from_playlist_from_menu(
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -1762,6 +2278,7 @@ bool task_push_start_current_core(content_ctx_info_t *content_info)
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -1904,6 +2421,7 @@ bool task_push_load_content_with_new_core_from_menu(
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -2017,6 +2535,7 @@ static bool task_load_content_internal(
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -2030,7 +2549,11 @@ static bool task_load_content_internal(
       content_ctx.set_supports_no_game_enable = set_supports_no_game_enable;
 
       if (!string_is_empty(path_dir_cache))
+      {
          content_ctx.directory_cache          = strdup(path_dir_cache);
+         content_ctx.extraction_cache_size    = (uint64_t)
+            settings->uints.content_extraction_cache_size * 1024 * 1024;
+      }
       if (!string_is_empty(system->valid_extensions))
          content_ctx.valid_extensions         = strdup(system->valid_extensions);
 
@@ -2418,15 +2941,37 @@ void content_unset_does_not_need_content(void)
 
 uint32_t content_get_crc(void)
 {
+   uint32_t crc;
    content_state_t *p_content = content_state_get_ptr();
-   if (p_content->pending_rom_crc)
-   {
-      p_content->pending_rom_crc   = false;
-      p_content->rom_crc           = file_crc32(0,
-            (const char*)p_content->pending_rom_crc_path);
-      RARCH_LOG("[CONTENT LOAD]: CRC32: 0x%x .\n", (unsigned)p_content->rom_crc);
-   }
-   return p_content->rom_crc;
+
+   /* 0 until the background task has computed it */
+   CONTENT_CRC_LOCK();
+   crc = p_content->rom_crc;
+   CONTENT_CRC_UNLOCK();
+
+   return crc;
+}
+
+static bool content_crc_pending(void *data)
+{
+   bool pending;
+   content_state_t *p_content = content_state_get_ptr();
+
+   CONTENT_CRC_LOCK();
+   pending = p_content->rom_crc_pending;
+   CONTENT_CRC_UNLOCK();
+
+   return pending;
+}
+
+uint32_t content_wait_for_crc(void)
+{
+   /* Runs the task queue until the CRC32 task is done,
+    * or nothing else is left to run */
+   if (content_crc_pending(NULL))
+      task_queue_wait(content_crc_pending, NULL);
+
+   return content_get_crc();
 }
 
 char* content_get_subsystem_rom(unsigned index)
@@ -2462,11 +3007,11 @@ void content_deinit(void)
       string_list_free(p_content->temporary_content);
    }
 
+   content_crc_invalidate(p_content);
+
    p_content->temporary_content            = NULL;
-   p_content->rom_crc                      = 0;
    p_content->is_inited                    = false;
    p_content->core_does_not_need_content   = false;
-   p_content->pending_rom_crc              = false;
 }
 
 /* Set environment variables before a subsystem load */
@@ -2516,6 +3061,7 @@ bool content_init(void)
    content_ctx.name_ups                       = NULL;
    content_ctx.valid_extensions               = NULL;
    content_ctx.block_extract                  = false;
+   content_ctx.extraction_cache_size          = 0;
    content_ctx.need_fullpath                  = false;
    content_ctx.set_supports_no_game_enable    = false;
 
@@ -2541,7 +3087,11 @@ bool content_init(void)
       if (!string_is_empty(path_dir_system))
          content_ctx.directory_system         = strdup(path_dir_system);
       if (!string_is_empty(path_dir_cache))
+      {
          content_ctx.directory_cache          = strdup(path_dir_cache);
+         content_ctx.extraction_cache_size    = (uint64_t)
+            settings->uints.content_extraction_cache_size * 1024 * 1024;
+      }
       if (!string_is_empty(system->valid_extensions))
          content_ctx.valid_extensions         = strdup(system->valid_extensions);
 
@@ -19,16 +19,24 @@
 #include <errno.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
 #include <formats/image.h>
+#include <streams/file_stream.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <retro_endianness.h>
 #include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
 #include "../configuration.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
 
 enum image_status_enum
 {
@@ -37,10 +45,82 @@ enum image_status_enum
    IMAGE_STATUS_TRANSFER_PARSE,
    IMAGE_STATUS_PROCESS_TRANSFER,
    IMAGE_STATUS_PROCESS_TRANSFER_PARSE
+#ifdef HAVE_THREADS
+   ,
+   IMAGE_STATUS_DECODE
+#endif
 };
 
+#ifdef HAVE_THREADS
+/* Upper limit of image decode threads */
+#define IMAGE_DECODE_WORKERS_MAX 4
+/* Longest time in us a task waits for its decode per
+ * iteration, so that the task worker does not spin
+ * while the decode threads are busy */
+#define IMAGE_DECODE_POLL_USEC   1000
+
+enum image_decode_job_state
+{
+   IMAGE_DECODE_JOB_IDLE = 0,
+   IMAGE_DECODE_JOB_QUEUED,
+   IMAGE_DECODE_JOB_RUNNING,
+   IMAGE_DECODE_JOB_DONE
+};
+
+typedef struct image_decode_job image_decode_job_t;
+
+struct image_decode_job
+{
+   void (*run)(void *data);
+   void *data;
+   image_decode_job_t *next;
+   /* Protected by image_decode_lock */
+   enum image_decode_job_state state;
+   /* Queue depth last shown in the task title */
+   unsigned title_depth;
+};
+
+/* Image decodes are handed from the image tasks to a
+ * small pool of threads, so that several thumbnails
+ * requested at once decode concurrently instead of one
+ * after another inside the task worker. Tasks poll their
+ * job and finish as before, so uploads to the video
+ * driver still happen in the task callbacks on the
+ * main thread. */
+static slock_t *image_decode_lock                          = NULL;
+static scond_t *image_decode_cond                          = NULL;
+static scond_t *image_decode_done_cond                     = NULL;
+static sthread_t *image_decode_threads[IMAGE_DECODE_WORKERS_MAX];
+static image_decode_job_t *image_decode_front              = NULL;
+static image_decode_job_t *image_decode_back               = NULL;
+static unsigned image_decode_num_threads                   = 0;
+static unsigned image_decode_depth                         = 0;
+static bool image_decode_inited                            = false;
+static bool image_decode_quit                              = false;
+#endif
+
+typedef struct image_derivative_handle
+{
+#ifdef HAVE_THREADS
+   image_decode_job_t job;
+#endif
+   struct texture_image *result;
+   char *path;
+   char *derivative_path;
+   unsigned max_width;
+   unsigned max_height;
+   unsigned upscale_threshold;
+   bool supports_rgba;
+#ifdef HAVE_THREADS
+   bool decoding;
+#endif
+} image_derivative_handle_t;
+
 struct nbio_image_handle
 {
+#ifdef HAVE_THREADS
+   image_decode_job_t job;
+#endif
    void *handle;
    transfer_cb_t  cb;
    struct texture_image ti; /* ptr alignment */
@@ -55,6 +135,252 @@ struct nbio_image_handle
    bool is_finished;
 };
 
+#ifdef HAVE_THREADS
+static void image_decode_worker(void *userdata)
+{
+   slock_lock(image_decode_lock);
+
+   for (;;)
+   {
+      image_decode_job_t *job = NULL;
+
+      while (!image_decode_quit && !image_decode_front)
+         scond_wait(image_decode_cond, image_decode_lock);
+
+      if (image_decode_quit)
+         break;
+
+      job                = image_decode_front;
+      image_decode_front = job->next;
+      if (!image_decode_front)
+         image_decode_back = NULL;
+      job->next          = NULL;
+      job->state         = IMAGE_DECODE_JOB_RUNNING;
+
+      slock_unlock(image_decode_lock);
+      job->run(job->data);
+      slock_lock(image_decode_lock);
+
+      job->state         = IMAGE_DECODE_JOB_DONE;
+      image_decode_depth--;
+      scond_broadcast(image_decode_done_cond);
+   }
+
+   slock_unlock(image_decode_lock);
+}
+
+/* Called on the main thread whenever an image task is
+ * pushed. Starts the decode threads on first use; with
+ * a single core, decodes stay in the tasks themselves. */
+static void image_decode_init(void)
+{
+   unsigned i;
+   unsigned num_threads = cpu_features_get_core_amount();
+
+   if (image_decode_inited)
+      return;
+   image_decode_inited = true;
+
+   /* One core is left to the main thread */
+   num_threads = (num_threads > 1) ? num_threads - 1 : 0;
+   if (num_threads > IMAGE_DECODE_WORKERS_MAX)
+      num_threads = IMAGE_DECODE_WORKERS_MAX;
+
+   if (num_threads == 0)
+      return;
+
+   image_decode_lock      = slock_new();
+   image_decode_cond      = scond_new();
+   image_decode_done_cond = scond_new();
+
+   if (!image_decode_lock || !image_decode_cond || !image_decode_done_cond)
+   {
+      task_image_decode_deinit();
+      return;
+   }
+
+   image_decode_quit = false;
+
+   for (i = 0; i < num_threads; i++)
+   {
+      sthread_t *thread = sthread_create(image_decode_worker, NULL);
+
+      if (!thread)
+         break;
+
+      image_decode_threads[image_decode_num_threads++] = thread;
+   }
+
+   if (image_decode_num_threads == 0)
+   {
+      task_image_decode_deinit();
+      return;
+   }
+
+   RARCH_LOG("[Image]: Decoding on %u thread(s).\n",
+         image_decode_num_threads);
+}
+
+/* Queues 'job'. Returns false if there are no decode
+ * threads, in which case the caller does the work itself */
+static bool image_decode_submit(image_decode_job_t *job,
+      void (*run)(void *data), void *data)
+{
+   if (!image_decode_num_threads)
+      return false;
+
+   job->run         = run;
+   job->data        = data;
+   job->next        = NULL;
+   job->title_depth = 0;
+
+   slock_lock(image_decode_lock);
+   job->state = IMAGE_DECODE_JOB_QUEUED;
+   if (image_decode_back)
+      image_decode_back->next = job;
+   else
+      image_decode_front      = job;
+   image_decode_back          = job;
+   image_decode_depth++;
+   scond_signal(image_decode_cond);
+   slock_unlock(image_decode_lock);
+
+   return true;
+}
+
+/* Returns true once 'job' has run. Until then, the
+ * title of 'task' shows the depth of the decode queue */
+static bool image_decode_poll(image_decode_job_t *job,
+      retro_task_t *task, const char *path)
+{
+   bool done;
+   unsigned depth;
+
+   slock_lock(image_decode_lock);
+   /* A task running on the main thread must not block */
+   if (     job->state != IMAGE_DECODE_JOB_DONE
+         && task_queue_is_threaded())
+      scond_wait_timeout(image_decode_done_cond, image_decode_lock,
+            IMAGE_DECODE_POLL_USEC);
+   done  = (job->state == IMAGE_DECODE_JOB_DONE);
+   depth = image_decode_depth;
+   slock_unlock(image_decode_lock);
+
+   if (!done && depth != job->title_depth)
+   {
+      char task_title[PATH_MAX_LENGTH];
+
+      snprintf(task_title, sizeof(task_title), "%s%u - %s",
+            msg_hash_to_str(MSG_IMAGE_DECODE_QUEUE_DEPTH), depth,
+            path ? path_basename(path) : "");
+
+      job->title_depth = depth;
+      task_free_title(task);
+      task_set_title(task, strdup(task_title));
+   }
+
+   return done;
+}
+
+/* Called before the data of 'job' is freed. A job that
+ * has not started yet is dropped, one that is running
+ * is waited for (this takes at most one decode). */
+static void image_decode_cancel(image_decode_job_t *job)
+{
+   if (!image_decode_lock)
+      return;
+
+   slock_lock(image_decode_lock);
+
+   if (job->state == IMAGE_DECODE_JOB_QUEUED)
+   {
+      image_decode_job_t *prev = NULL;
+      image_decode_job_t *cur  = image_decode_front;
+
+      while (cur && cur != job)
+      {
+         prev = cur;
+         cur  = cur->next;
+      }
+
+      if (cur)
+      {
+         if (prev)
+            prev->next         = job->next;
+         else
+            image_decode_front = job->next;
+         if (image_decode_back == job)
+            image_decode_back  = prev;
+         image_decode_depth--;
+      }
+
+      job->next  = NULL;
+      job->state = IMAGE_DECODE_JOB_IDLE;
+   }
+   else
+   {
+      while (job->state == IMAGE_DECODE_JOB_RUNNING)
+         scond_wait(image_decode_done_cond, image_decode_lock);
+   }
+
+   slock_unlock(image_decode_lock);
+}
+#endif
+
+void task_image_decode_deinit(void)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+
+   if (image_decode_lock)
+   {
+      slock_lock(image_decode_lock);
+      image_decode_quit = true;
+      if (image_decode_cond)
+         scond_broadcast(image_decode_cond);
+      slock_unlock(image_decode_lock);
+   }
+
+   /* Jobs still queued belong to tasks that will
+    * never be run again, so they are just dropped */
+   for (i = 0; i < image_decode_num_threads; i++)
+      sthread_join(image_decode_threads[i]);
+
+   if (image_decode_done_cond)
+      scond_free(image_decode_done_cond);
+   if (image_decode_cond)
+      scond_free(image_decode_cond);
+   if (image_decode_lock)
+      slock_free(image_decode_lock);
+
+   image_decode_done_cond   = NULL;
+   image_decode_cond        = NULL;
+   image_decode_lock        = NULL;
+   image_decode_front       = NULL;
+   image_decode_back        = NULL;
+   image_decode_num_threads = 0;
+   image_decode_depth       = 0;
+   image_decode_inited      = false;
+   image_decode_quit        = false;
+#endif
+}
+
+void task_image_get_decode_status(unsigned *depth, unsigned *workers)
+{
+#ifdef HAVE_THREADS
+   if (image_decode_lock)
+   {
+      slock_lock(image_decode_lock);
+      *depth = image_decode_depth;
+      slock_unlock(image_decode_lock);
+      *workers = image_decode_num_threads;
+      return;
+   }
+#endif
+   *depth   = 0;
+   *workers = 0;
+}
+
 static int cb_image_upload_generic(void *data, size_t len)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
@@ -154,12 +480,37 @@ static int task_image_iterate_process_transfer(struct nbio_image_handle *image)
    return -1;
 }
 
+#ifdef HAVE_THREADS
+/* Runs on a decode thread: parses and decodes the whole
+ * image in one go. The task only looks at the result
+ * once the job is done. */
+static void task_image_decode_run(void *data)
+{
+   unsigned width                  = 0;
+   unsigned height                 = 0;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)data;
+   int retval                      = IMAGE_PROCESS_ERROR;
+
+   while (image_transfer_iterate(image->handle, image->type));
+
+   do
+   {
+      retval = task_image_process(image, &width, &height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   image->processing_final_state = retval;
+}
+#endif
+
 static void task_image_cleanup(nbio_handle_t *nbio)
 {
    struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
 
    if (image)
    {
+#ifdef HAVE_THREADS
+      image_decode_cancel(&image->job);
+#endif
       image_transfer_free(image->handle, image->type);
 
       image->handle                 = NULL;
@@ -272,6 +623,45 @@ static bool upscale_image(
    return true;
 }
 
+/* Upscales 'ti' in place (by an integer factor) if its
+ * width or height is smaller than 'upscale_threshold' */
+static void upscale_image_to_threshold(
+      struct texture_image *ti, unsigned upscale_threshold)
+{
+   if (upscale_threshold > 0)
+   {
+      if (((ti->width > 0) && (ti->height > 0)) &&
+          ((ti->width  < upscale_threshold) ||
+           (ti->height < upscale_threshold)))
+      {
+         unsigned min_size                  = (ti->width < ti->height) ?
+                                                ti->width : ti->height;
+         float scale_factor                 = (float)upscale_threshold /
+                                                (float)min_size;
+         unsigned scale_factor_int          = (unsigned)scale_factor;
+         struct texture_image img_resampled = {
+            NULL,
+            0,
+            0,
+            false
+         };
+
+         if (scale_factor - (float)scale_factor_int > 0.0f)
+            scale_factor_int += 1;
+
+         if (upscale_image(scale_factor_int, ti, &img_resampled))
+         {
+            ti->width  = img_resampled.width;
+            ti->height = img_resampled.height;
+
+            if (ti->pixels)
+               free(ti->pixels);
+            ti->pixels = img_resampled.pixels;
+         }
+      }
+   }
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -298,6 +688,15 @@ bool task_image_load_handler(retro_task_t *task)
                image->status = IMAGE_STATUS_PROCESS_TRANSFER;
             break;
          case IMAGE_STATUS_TRANSFER:
+#ifdef HAVE_THREADS
+            if (     !image->is_blocking && !image->is_finished
+                  && image_decode_submit(&image->job,
+                     task_image_decode_run, image))
+            {
+               image->status = IMAGE_STATUS_DECODE;
+               break;
+            }
+#endif
             if (!image->is_blocking && !image->is_finished)
             {
                retro_time_t start_time = cpu_features_get_time_usec();
@@ -312,6 +711,17 @@ bool task_image_load_handler(retro_task_t *task)
                      < image->frame_duration);
             }
             break;
+#ifdef HAVE_THREADS
+         case IMAGE_STATUS_DECODE:
+            if (image_decode_poll(&image->job, task, nbio->path))
+            {
+               /* Color conversion and upscaling are
+                * left to the final iteration, as usual */
+               image->cb     = &cb_image_upload_generic;
+               image->status = IMAGE_STATUS_PROCESS_TRANSFER_PARSE;
+            }
+            break;
+#endif
          case IMAGE_STATUS_PROCESS_TRANSFER_PARSE:
             if (image->handle && image->cb)
             {
@@ -333,38 +743,7 @@ bool task_image_load_handler(retro_task_t *task)
       if (img)
       {
          /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
-         {
-            if (((image->ti.width > 0) && (image->ti.height > 0)) &&
-                ((image->ti.width  < image->upscale_threshold) ||
-                 (image->ti.height < image->upscale_threshold)))
-            {
-               unsigned min_size                  = (image->ti.width < image->ti.height) ?
-                                                      image->ti.width : image->ti.height;
-               float scale_factor                 = (float)image->upscale_threshold /
-                                                      (float)min_size;
-               unsigned scale_factor_int          = (unsigned)scale_factor;
-               struct texture_image img_resampled = {
-                  NULL,
-                  0,
-                  0,
-                  false
-               };
-
-               if (scale_factor - (float)scale_factor_int > 0.0f)
-                  scale_factor_int += 1;
-
-               if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
-               {
-                  image->ti.width  = img_resampled.width;
-                  image->ti.height = img_resampled.height;
-
-                  if (image->ti.pixels)
-                     free(image->ti.pixels);
-                  image->ti.pixels = img_resampled.pixels;
-               }
-            }
-         }
+         upscale_image_to_threshold(&image->ti, image->upscale_threshold);
 
          img->width         = image->ti.width;
          img->height        = image->ti.height;
@@ -432,6 +811,14 @@ bool task_push_image_load(const char *fullpath,
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
    image->handle                     = NULL;
+#ifdef HAVE_THREADS
+   image->job.run                    = NULL;
+   image->job.data                   = NULL;
+   image->job.next                   = NULL;
+   image->job.state                  = IMAGE_DECODE_JOB_IDLE;
+
+   image_decode_init();
+#endif
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -470,3 +857,342 @@ bool task_push_image_load(const char *fullpath,
 
    return true;
 }
+
+/* Scales 'image_src' down to 'width' x 'height' by
+ * averaging the source pixels covered by each output
+ * pixel. Pixels are treated as four 8-bit channels,
+ * so either channel order works */
+static bool downscale_image(
+      const struct texture_image *image_src,
+      struct texture_image *image_dst,
+      unsigned width, unsigned height)
+{
+   unsigned x_dst, y_dst;
+   unsigned *x_start = NULL;
+
+   if (     !image_src->pixels
+         || (width  < 1) || (width  > image_src->width)
+         || (height < 1) || (height > image_src->height))
+      return false;
+
+   image_dst->width  = width;
+   image_dst->height = height;
+   image_dst->pixels = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+   x_start           = (unsigned*)malloc((width + 1) * sizeof(unsigned));
+
+   if (!image_dst->pixels || !x_start)
+   {
+      if (image_dst->pixels)
+         free(image_dst->pixels);
+      if (x_start)
+         free(x_start);
+      image_dst->pixels = NULL;
+      return false;
+   }
+
+   for (x_dst = 0; x_dst <= width; x_dst++)
+      x_start[x_dst] = (unsigned)(((uint64_t)x_dst * image_src->width) / width);
+
+   for (y_dst = 0; y_dst < height; y_dst++)
+   {
+      unsigned y0   = (unsigned)(((uint64_t)y_dst       * image_src->height) / height);
+      unsigned y1   = (unsigned)(((uint64_t)(y_dst + 1) * image_src->height) / height);
+      uint32_t *out = image_dst->pixels + y_dst * width;
+
+      for (x_dst = 0; x_dst < width; x_dst++)
+      {
+         unsigned x, y;
+         uint32_t sum[4] = {0, 0, 0, 0};
+         unsigned x0     = x_start[x_dst];
+         unsigned x1     = x_start[x_dst + 1];
+         uint32_t count  = (x1 - x0) * (y1 - y0);
+
+         for (y = y0; y < y1; y++)
+         {
+            const uint32_t *in = image_src->pixels + y * image_src->width;
+
+            for (x = x0; x < x1; x++)
+            {
+               uint32_t pixel = in[x];
+               sum[0]        +=  pixel        & 0xFF;
+               sum[1]        += (pixel >>  8) & 0xFF;
+               sum[2]        += (pixel >> 16) & 0xFF;
+               sum[3]        +=  pixel >> 24;
+            }
+         }
+
+         out[x_dst] =  ((sum[0] + (count >> 1)) / count)
+                    | (((sum[1] + (count >> 1)) / count) <<  8)
+                    | (((sum[2] + (count >> 1)) / count) << 16)
+                    | (((sum[3] + (count >> 1)) / count) << 24);
+      }
+   }
+
+   free(x_start);
+   return true;
+}
+
+/* Writes 'ti' (ARGB8888) as an uncompressed 32-bit TGA,
+ * which loads with little more than a memcpy()
+ * > The file is written under a temporary name and
+ *   renamed once complete, so that a partially written
+ *   derivative is never loaded */
+static bool task_image_derivative_save(
+      struct texture_image *ti, const char *path)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   char dir[PATH_MAX_LENGTH];
+   uint8_t header[18];
+   size_t size   = (size_t)ti->width * ti->height * sizeof(uint32_t);
+   RFILE *file   = NULL;
+   bool success  = false;
+#ifdef MSB_FIRST
+   size_t i;
+#endif
+
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return false;
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   memset(header, 0, sizeof(header));
+   header[2]  = 2;                        /* uncompressed true colour */
+   header[12] = (uint8_t)(ti->width);
+   header[13] = (uint8_t)(ti->width  >> 8);
+   header[14] = (uint8_t)(ti->height);
+   header[15] = (uint8_t)(ti->height >> 8);
+   header[16] = 32;                       /* bits per pixel */
+   header[17] = 0x28;                     /* top-left origin, 8 alpha bits */
+
+   if (!(file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   /* TGA pixels are stored as B, G, R, A bytes, which
+    * is the memory layout of ARGB8888 on little endian */
+#ifdef MSB_FIRST
+   for (i = 0; i < (size_t)ti->width * ti->height; i++)
+      ti->pixels[i] = SWAP32(ti->pixels[i]);
+#endif
+
+   success = (filestream_write(file, header, sizeof(header))
+               == sizeof(header))
+          && (filestream_write(file, ti->pixels, size) == (int64_t)size);
+
+#ifdef MSB_FIRST
+   for (i = 0; i < (size_t)ti->width * ti->height; i++)
+      ti->pixels[i] = SWAP32(ti->pixels[i]);
+#endif
+
+   if (filestream_close(file) != 0)
+      success = false;
+
+   if (success)
+   {
+      filestream_delete(path);
+      success = (filestream_rename(tmp_path, path) == 0);
+   }
+
+   if (!success)
+      filestream_delete(tmp_path);
+
+   return success;
+}
+
+/* Decodes, scales and saves the derivative, leaving
+ * the texture in derivative->result. May run on a
+ * decode thread. */
+static void task_image_derivative_run(void *data)
+{
+   image_derivative_handle_t *derivative = (image_derivative_handle_t*)data;
+   struct texture_image *img             = NULL;
+   struct texture_image ti               = { NULL, 0, 0, false };
+   unsigned width, height;
+
+   /* Always decoded as ARGB8888, which is the
+    * pixel layout written to the derivative.
+    * JPEGs are decoded straight to (about) the
+    * target size where possible */
+   if (!image_texture_load_scaled(&ti, derivative->path,
+            derivative->max_width, derivative->max_height))
+      return;
+
+   /* Fit within the target size, keeping the aspect
+    * ratio. Images are never enlarged here */
+   width  = ti.width;
+   height = ti.height;
+
+   if (width > derivative->max_width)
+   {
+      height = (unsigned)(((uint64_t)height * derivative->max_width
+            + (width >> 1)) / width);
+      width  = derivative->max_width;
+   }
+   if (height > derivative->max_height)
+   {
+      width  = (unsigned)(((uint64_t)width * derivative->max_height
+            + (height >> 1)) / height);
+      height = derivative->max_height;
+   }
+   if (width  < 1)
+      width  = 1;
+   if (height < 1)
+      height = 1;
+
+   if ((width != ti.width) || (height != ti.height))
+   {
+      struct texture_image img_resampled = { NULL, 0, 0, false };
+
+      if (downscale_image(&ti, &img_resampled, width, height))
+      {
+         image_texture_free(&ti);
+         ti = img_resampled;
+      }
+   }
+
+   if (!task_image_derivative_save(&ti, derivative->derivative_path))
+      RARCH_WARN("[Image]: Failed to write \"%s\".\n",
+            derivative->derivative_path);
+
+   /* Convert to the layout of a normal image load */
+   if (derivative->supports_rgba)
+   {
+      size_t i;
+      size_t num_pixels = (size_t)ti.width * ti.height;
+
+      for (i = 0; i < num_pixels; i++)
+      {
+         uint32_t pixel = ti.pixels[i];
+         ti.pixels[i]   = (pixel & 0xFF00FF00)
+                        | ((pixel >> 16) & 0xFF)
+                        | ((pixel & 0xFF) << 16);
+      }
+   }
+
+   upscale_image_to_threshold(&ti, derivative->upscale_threshold);
+
+   if ((img = (struct texture_image*)malloc(sizeof(*img))))
+   {
+      *img               = ti;
+      derivative->result = img;
+   }
+   else
+      image_texture_free(&ti);
+}
+
+static void task_image_derivative_handler(retro_task_t *task)
+{
+   image_derivative_handle_t *derivative = NULL;
+
+   if (!task)
+      return;
+
+   derivative = (image_derivative_handle_t*)task->state;
+
+   if (!derivative || task_get_cancelled(task))
+      goto end;
+
+#ifdef HAVE_THREADS
+   if (derivative->decoding)
+   {
+      if (!image_decode_poll(&derivative->job, task,
+               derivative->path))
+         return;
+   }
+   else if (image_decode_submit(&derivative->job,
+            task_image_derivative_run, derivative))
+   {
+      derivative->decoding = true;
+      return;
+   }
+   else
+#endif
+      task_image_derivative_run(derivative);
+
+   task_set_data(task, derivative->result);
+   derivative->result = NULL;
+
+end:
+   task_set_finished(task, true);
+}
+
+static void task_image_derivative_free(retro_task_t *task)
+{
+   image_derivative_handle_t *derivative = task ?
+         (image_derivative_handle_t*)task->state : NULL;
+
+   if (!derivative)
+      return;
+
+#ifdef HAVE_THREADS
+   image_decode_cancel(&derivative->job);
+#endif
+
+   if (derivative->result)
+   {
+      image_texture_free(derivative->result);
+      free(derivative->result);
+   }
+   if (derivative->path)
+      free(derivative->path);
+   if (derivative->derivative_path)
+      free(derivative->derivative_path);
+   free(derivative);
+}
+
+bool task_push_image_derivative(const char *fullpath,
+      const char *derivative_path,
+      unsigned max_width, unsigned max_height,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   retro_task_t                     *t = NULL;
+   image_derivative_handle_t *derivative = NULL;
+
+   if (     string_is_empty(fullpath)
+         || string_is_empty(derivative_path)
+         || (max_width  < 1)
+         || (max_height < 1))
+      return false;
+
+   if (!(derivative = (image_derivative_handle_t*)
+            calloc(1, sizeof(*derivative))))
+      return false;
+
+   derivative->path              = strdup(fullpath);
+   derivative->derivative_path   = strdup(derivative_path);
+   derivative->max_width         = max_width;
+   derivative->max_height        = max_height;
+   derivative->upscale_threshold = upscale_threshold;
+   derivative->supports_rgba     = supports_rgba;
+
+   if (!derivative->path || !derivative->derivative_path ||
+       !(t = task_init()))
+      goto error;
+
+#ifdef HAVE_THREADS
+   image_decode_init();
+#endif
+
+   t->state     = derivative;
+   t->handler   = task_image_derivative_handler;
+   t->cleanup   = task_image_derivative_free;
+   t->callback  = cb;
+   t->user_data = user_data;
+   t->mute      = true;
+
+   task_queue_push(t);
+
+   return true;
+
+error:
+   if (derivative->path)
+      free(derivative->path);
+   if (derivative->derivative_path)
+      free(derivative->derivative_path);
+   free(derivative);
+   return false;
+}
@@ -0,0 +1,164 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2020 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/task_queue.h>
+
+#include "tasks_internal.h"
+
+#include "../msg_hash.h"
+#include "../menu/menu_driver.h"
+#include "../menu/menu_entries.h"
+
+typedef struct menu_explore_init_handle
+{
+   explore_state_t *state;
+   char *directory_playlist;
+   char *directory_database;
+   char *cache_path;
+} menu_explore_init_handle_t;
+
+static void free_menu_explore_init_handle(
+      menu_explore_init_handle_t *menu_explore)
+{
+   if (!menu_explore)
+      return;
+
+   /* Only set if the result never reached the menu */
+   menu_explore_free_state(menu_explore->state);
+
+   if (menu_explore->directory_playlist)
+      free(menu_explore->directory_playlist);
+   if (menu_explore->directory_database)
+      free(menu_explore->directory_database);
+   if (menu_explore->cache_path)
+      free(menu_explore->cache_path);
+
+   free(menu_explore);
+}
+
+static void cb_task_menu_explore_init(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   unsigned menu_type                       = 0;
+   menu_explore_init_handle_t *menu_explore = NULL;
+
+   if (!task)
+      return;
+
+   menu_explore = (menu_explore_init_handle_t*)task->state;
+
+   if (!menu_explore)
+      return;
+
+   menu_explore_set_state(menu_explore->state);
+   menu_explore->state = NULL;
+
+   /* If the explore menu is currently displayed,
+    * replace its placeholder with the real list */
+   menu_entries_get_last_stack(NULL, NULL, &menu_type, NULL, NULL);
+
+   if (menu_type == MENU_EXPLORE_TAB)
+   {
+      bool refresh_nonblocking = false;
+
+      menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh_nonblocking);
+      menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+   }
+}
+
+static void task_menu_explore_init_free(retro_task_t *task)
+{
+   if (!task)
+      return;
+
+   free_menu_explore_init_handle(
+         (menu_explore_init_handle_t*)task->state);
+}
+
+static void task_menu_explore_init_handler(retro_task_t *task)
+{
+   menu_explore_init_handle_t *menu_explore = NULL;
+
+   if (!task)
+      goto task_finished;
+
+   menu_explore = (menu_explore_init_handle_t*)task->state;
+
+   if (!menu_explore || task_get_cancelled(task))
+      goto task_finished;
+
+   /* Loading every playlist and walking the matching
+    * databases is done in one go, since the index cannot
+    * be used before it is complete anyway */
+   menu_explore->state = menu_explore_build_list(
+         menu_explore->directory_playlist,
+         menu_explore->directory_database,
+         menu_explore->cache_path);
+
+task_finished:
+   if (task)
+      task_set_finished(task, true);
+}
+
+bool task_push_menu_explore_init(
+      const char *directory_playlist,
+      const char *directory_database,
+      const char *cache_path)
+{
+   retro_task_t *task                       = NULL;
+   menu_explore_init_handle_t *menu_explore = NULL;
+
+   menu_explore = (menu_explore_init_handle_t*)
+      calloc(1, sizeof(menu_explore_init_handle_t));
+
+   if (!menu_explore)
+      return false;
+
+   menu_explore->directory_playlist = strdup(
+         directory_playlist ? directory_playlist : "");
+   menu_explore->directory_database = strdup(
+         directory_database ? directory_database : "");
+   menu_explore->cache_path         = strdup(cache_path ? cache_path : "");
+
+   if (  !menu_explore->directory_playlist ||
+         !menu_explore->directory_database ||
+         !menu_explore->cache_path)
+      goto error;
+
+   task = task_init();
+
+   if (!task)
+      goto error;
+
+   task->handler  = task_menu_explore_init_handler;
+   task->state    = menu_explore;
+   task->title    = NULL;
+   task->progress = 0;
+   task->callback = cb_task_menu_explore_init;
+   task->cleanup  = task_menu_explore_init_free;
+   task->mute     = true;
+
+   task_queue_push(task);
+
+   return true;
+
+error:
+   free_menu_explore_init_handle(menu_explore);
+   return false;
+}
@@ -20,9 +20,11 @@
 /* TODO/FIXME - turn this into actual task */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <boolean.h>
+#include <retro_miscellaneous.h>
 
 #include <compat/msvc.h>
 #include <file/file_path.h>
@@ -63,18 +65,14 @@ struct bps_data
    const uint8_t *modify_data;
    const uint8_t *source_data;
    uint8_t *target_data;
+   /* End of the actions, the checksums follow */
    size_t modify_length;
    size_t source_length;
    size_t target_length;
    size_t modify_offset;
-   size_t source_offset;
-   size_t target_offset;
    size_t source_relative_offset;
    size_t target_relative_offset;
    size_t output_offset;
-   uint32_t modify_checksum;
-   uint32_t source_checksum;
-   uint32_t target_checksum;
 };
 
 struct ups_data
@@ -82,62 +80,83 @@ struct ups_data
    const uint8_t *patch_data;
    const uint8_t *source_data;
    uint8_t *target_data;
-   unsigned patch_length;
-   unsigned source_length;
-   unsigned target_length;
-   unsigned patch_offset;
-   unsigned source_offset;
-   unsigned target_offset;
-   unsigned patch_checksum;
-   unsigned source_checksum;
-   unsigned target_checksum;
+   /* End of the hunks, the checksums follow */
+   size_t patch_length;
+   size_t source_length;
+   size_t target_length;
+   size_t patch_offset;
+   size_t source_offset;
+   size_t target_offset;
 };
 
+/* The source may be patched in place, in which case the
+ * target is set to the source */
 typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
-      const uint8_t*, uint64_t, uint8_t**, uint64_t*);
+      uint8_t*, uint64_t, uint8_t**, uint64_t*);
 
-static uint8_t bps_read(struct bps_data *bps)
+static uint32_t patch_read_le32(const uint8_t *data)
 {
-   uint8_t data         = bps->modify_data[bps->modify_offset++];
-   bps->modify_checksum = ~(encoding_crc32(
-         ~bps->modify_checksum, &data, 1));
-   return data;
+   return   (uint32_t)data[0]
+         | ((uint32_t)data[1] <<  8)
+         | ((uint32_t)data[2] << 16)
+         | ((uint32_t)data[3] << 24);
 }
 
-static uint64_t bps_decode(struct bps_data *bps)
+/* Decodes a BPS/UPS variable length number.
+ * Returns false if it runs past 'end' or overflows. */
+static bool patch_decode(const uint8_t *data, size_t *offset,
+      size_t end, uint64_t *out)
 {
-   uint64_t data = 0, shift = 1;
+   uint64_t value = 0, shift = 1;
 
    for (;;)
    {
-      uint8_t x  = bps_read(bps);
-      data      += (x & 0x7f) * shift;
+      uint8_t x;
+
+      if (*offset >= end || shift > ((uint64_t)1 << 56))
+         return false;
+
+      x      = data[(*offset)++];
+      value += (x & 0x7f) * shift;
       if (x & 0x80)
          break;
-      shift    <<= 7;
-      data      += shift;
+      shift <<= 7;
+      value  += shift;
    }
 
-   return data;
+   *out = value;
+   return true;
 }
 
-static void bps_write(struct bps_data *bps, uint8_t data)
+static void patch_xor_block(uint8_t *dst, const uint8_t *src,
+      const uint8_t *xor_data, size_t len)
 {
-   bps->target_data[bps->output_offset++] = data;
-   bps->target_checksum = ~(encoding_crc32(~bps->target_checksum, &data, 1));
+   size_t i = 0;
+
+   /* A word at a time, unaligned accesses go through
+    * memcpy so that the compiler picks safe loads */
+   for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t))
+   {
+      uint64_t a, b;
+      memcpy(&a, src      + i, sizeof(a));
+      memcpy(&b, xor_data + i, sizeof(b));
+      a ^= b;
+      memcpy(dst + i, &a, sizeof(a));
+   }
+
+   for (; i < len; i++)
+      dst[i] = src[i] ^ xor_data[i];
 }
 
 static enum patch_error bps_apply_patch(
       const uint8_t *modify_data, uint64_t modify_length,
-      const uint8_t *source_data, uint64_t source_length,
+      uint8_t *source_data, uint64_t source_length,
       uint8_t **target_data, uint64_t *target_length)
 {
-   size_t i;
    struct bps_data bps;
-   uint32_t checksum               = 0;
-   size_t modify_source_size       = 0;
-   size_t modify_target_size       = 0;
-   size_t modify_markup_size       = 0;
+   uint64_t modify_source_size     = 0;
+   uint64_t modify_target_size     = 0;
+   uint64_t modify_markup_size     = 0;
    uint32_t modify_source_checksum = 0;
    uint32_t modify_target_checksum = 0;
    uint32_t modify_modify_checksum = 0;
@@ -148,38 +167,34 @@ static enum patch_error bps_apply_patch(
    bps.modify_data            = modify_data;
    bps.source_data            = source_data;
    bps.target_data            = *target_data;
-   bps.modify_length          = modify_length;
-   bps.source_length          = source_length;
-   bps.target_length          = *target_length;
-   bps.modify_offset          = 0;
-   bps.source_offset          = 0;
-   bps.target_offset          = 0;
-   bps.modify_checksum        = ~0;
-   bps.source_checksum        = 0;
-   bps.target_checksum        = ~0;
+   bps.modify_length          = (size_t)modify_length - 12;
+   bps.source_length          = (size_t)source_length;
+   bps.target_length          = (size_t)*target_length;
+   bps.modify_offset          = 4;
    bps.source_relative_offset = 0;
    bps.target_relative_offset = 0;
    bps.output_offset          = 0;
 
-   if (  (bps_read(&bps) != 'B') ||
-         (bps_read(&bps) != 'P') ||
-         (bps_read(&bps) != 'S') ||
-         (bps_read(&bps) != '1'))
+   if (memcmp(modify_data, "BPS1", 4))
       return PATCH_PATCH_INVALID_HEADER;
 
-   modify_source_size  = bps_decode(&bps);
-   modify_target_size  = bps_decode(&bps);
-   modify_markup_size  = bps_decode(&bps);
+   if (     !patch_decode(modify_data, &bps.modify_offset,
+               bps.modify_length, &modify_source_size)
+         || !patch_decode(modify_data, &bps.modify_offset,
+               bps.modify_length, &modify_target_size)
+         || !patch_decode(modify_data, &bps.modify_offset,
+               bps.modify_length, &modify_markup_size)
+         || modify_markup_size > bps.modify_length - bps.modify_offset)
+      return PATCH_PATCH_INVALID;
 
-   for (i = 0; i < modify_markup_size; i++)
-      bps_read(&bps);
+   bps.modify_offset += (size_t)modify_markup_size;
 
    if (modify_source_size > bps.source_length)
       return PATCH_SOURCE_TOO_SMALL;
 
    if (modify_target_size > bps.target_length)
    {
-      uint8_t *prov=(uint8_t*)malloc((size_t)modify_target_size);
+      uint8_t *prov = (uint8_t*)malloc((size_t)modify_target_size);
 
       if (!prov)
          return PATCH_TARGET_ALLOC_FAILED;
@@ -187,77 +202,128 @@ static enum patch_error bps_apply_patch(
       free(*target_data);
       bps.target_data   = prov;
       *target_data      = prov;
-      bps.target_length = modify_target_size;
    }
 
-   while (bps.modify_offset < bps.modify_length - 12)
+   bps.target_length = (size_t)modify_target_size;
+
+   /* Every action copies a run of bytes; runs are bounds
+    * checked once and copied in bulk */
+   while (bps.modify_offset < bps.modify_length)
    {
-      size_t length = bps_decode(&bps);
-      unsigned mode = length & 3;
+      uint64_t data;
+      size_t length;
+      unsigned mode;
+      uint8_t *out;
+
+      if (!patch_decode(modify_data, &bps.modify_offset,
+               bps.modify_length, &data))
+         return PATCH_PATCH_INVALID;
+
+      mode   = data & 3;
+      data   = (data >> 2) + 1;
 
-      length = (length >> 2) + 1;
+      if (data > bps.target_length - bps.output_offset)
+         return PATCH_TARGET_INVALID;
+
+      length = (size_t)data;
+      out    = bps.target_data + bps.output_offset;
 
       switch (mode)
       {
          case SOURCE_READ:
-            while (length--)
-               bps_write(&bps, bps.source_data[bps.output_offset]);
+            if (length > bps.source_length - MIN(bps.output_offset,
+                     bps.source_length))
+               return PATCH_SOURCE_TOO_SMALL;
+            memcpy(out, bps.source_data + bps.output_offset, length);
             break;
 
          case TARGET_READ:
-            while (length--)
-               bps_write(&bps, bps_read(&bps));
+            if (length > bps.modify_length - bps.modify_offset)
+               return PATCH_PATCH_INVALID;
+            memcpy(out, modify_data + bps.modify_offset, length);
+            bps.modify_offset += length;
             break;
 
          case SOURCE_COPY:
          case TARGET_COPY:
          {
-            int    offset = (int)bps_decode(&bps);
-            bool negative = offset & 1;
-
-            offset >>= 1;
-
-            if (negative)
-               offset = -offset;
+            uint64_t offset;
+            size_t *relative = (mode == SOURCE_COPY)
+               ? &bps.source_relative_offset
+               : &bps.target_relative_offset;
+            /* Source copies may read anything in the source,
+             * target copies only what has been written */
+            size_t limit     = (mode == SOURCE_COPY)
+               ? bps.source_length
+               : bps.output_offset;
+
+            if (!patch_decode(modify_data, &bps.modify_offset,
+                     bps.modify_length, &offset))
+               return PATCH_PATCH_INVALID;
+
+            if (offset & 1)
+            {
+               if ((offset >> 1) > *relative)
+                  return PATCH_PATCH_INVALID;
+               *relative -= (size_t)(offset >> 1);
+            }
+            else
+            {
+               if ((offset >> 1) >= limit - MIN(*relative, limit))
+                  return PATCH_PATCH_INVALID;
+               *relative += (size_t)(offset >> 1);
+            }
 
             if (mode == SOURCE_COPY)
             {
-               bps.source_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.source_data[bps.source_offset++]);
+               if (length > bps.source_length - *relative)
+                  return PATCH_SOURCE_TOO_SMALL;
+               memcpy(out, bps.source_data + *relative, length);
             }
             else
             {
-               bps.target_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.target_data[bps.target_offset++]);
-               break;
+               const uint8_t *in = bps.target_data + *relative;
+               size_t distance   = bps.output_offset - *relative;
+
+               if (*relative >= bps.output_offset)
+                  return PATCH_PATCH_INVALID;
+
+               /* Runs overlapping the output repeat the last
+                * 'distance' bytes */
+               if (distance == 1)
+                  memset(out, *in, length);
+               else if (distance >= length)
+                  memcpy(out, in, length);
+               else
+               {
+                  size_t i;
+                  for (i = 0; i < length; i += distance)
+                     memcpy(out + i, in + i, MIN(distance, length - i));
+               }
             }
+
+            *relative += length;
             break;
          }
       }
-   }
 
-   for (i = 0; i < 32; i += 8)
-      modify_source_checksum |= bps_read(&bps) << i;
-   for (i = 0; i < 32; i += 8)
-      modify_target_checksum |= bps_read(&bps) << i;
-
-   checksum = ~bps.modify_checksum;
-   for (i = 0; i < 32; i += 8)
-      modify_modify_checksum |= bps_read(&bps) << i;
+      bps.output_offset += length;
+   }
 
-   bps.source_checksum = encoding_crc32(0,
-         bps.source_data, bps.source_length);
-   bps.target_checksum = ~bps.target_checksum;
+   modify_source_checksum = patch_read_le32(modify_data + bps.modify_length);
+   modify_target_checksum = patch_read_le32(modify_data + bps.modify_length + 4);
+   modify_modify_checksum = patch_read_le32(modify_data + bps.modify_length + 8);
 
-   if (bps.source_checksum != modify_source_checksum)
+   if (encoding_crc32(0, bps.source_data, bps.source_length)
+         != modify_source_checksum)
       return PATCH_SOURCE_CHECKSUM_INVALID;
 
-   if (bps.target_checksum != modify_target_checksum)
+   if (encoding_crc32(0, bps.target_data, bps.output_offset)
+         != modify_target_checksum)
       return PATCH_TARGET_CHECKSUM_INVALID;
 
-   if (checksum != modify_modify_checksum)
+   if (encoding_crc32(0, modify_data, (size_t)modify_length - 4)
+         != modify_modify_checksum)
       return PATCH_PATCH_CHECKSUM_INVALID;
 
    *target_length = modify_target_size;
@@ -265,102 +331,74 @@ static enum patch_error bps_apply_patch(
    return PATCH_SUCCESS;
 }
 
-static uint8_t ups_patch_read(struct ups_data *data)
-{
-   if (data && data->patch_offset < data->patch_length)
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-      data->patch_checksum =
-         ~(encoding_crc32(~data->patch_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
-}
-
-static uint8_t ups_source_read(struct ups_data *data)
+/* Writes 'length' bytes of source, XORed with 'xor_data'
+ * unless it is NULL, to the target. The source reads as
+ * zeroes past its end, and writes past the end of the
+ * target are dropped. */
+static void ups_target_write_block(struct ups_data *data,
+      const uint8_t *xor_data, size_t length)
 {
-   if (data && data->source_offset < data->source_length)
+   size_t source_avail = data->source_length - data->source_offset;
+   size_t target_avail = data->target_offset < data->target_length
+      ? data->target_length - data->target_offset : 0;
+   size_t count        = MIN(length, target_avail);
+   size_t from_source  = MIN(count, source_avail);
+   uint8_t *out        = data->target_data + data->target_offset;
+   const uint8_t *in   = data->source_data + data->source_offset;
+
+   if (xor_data)
    {
-      uint8_t n = data->source_data[data->source_offset++];
-      data->source_checksum =
-         ~(encoding_crc32(~data->source_checksum, &n, 1));
-      return n;
+      patch_xor_block(out, in, xor_data, from_source);
+      memcpy(out + from_source, xor_data + from_source,
+            count - from_source);
    }
-   return 0x00;
-}
-
-static void ups_target_write(struct ups_data *data, uint8_t n)
-{
-
-   if (data && data->target_offset < data->target_length)
+   else
    {
-      data->target_data[data->target_offset] = n;
-      data->target_checksum =
-         ~(encoding_crc32(~data->target_checksum, &n, 1));
+      memcpy(out, in, from_source);
+      memset(out + from_source, 0, count - from_source);
    }
 
-   if (data)
-      data->target_offset++;
-}
-
-static uint64_t ups_decode(struct ups_data *data)
-{
-   uint64_t offset = 0, shift = 1;
-
-   for (;;)
-   {
-      uint8_t x = ups_patch_read(data);
-      offset   += (x & 0x7f) * shift;
-
-      if (x & 0x80)
-         break;
-      shift <<= 7;
-      offset += shift;
-   }
-   return offset;
+   data->source_offset += MIN(length, source_avail);
+   data->target_offset += length;
 }
 
 static enum patch_error ups_apply_patch(
       const uint8_t *patchdata, uint64_t patchlength,
-      const uint8_t *sourcedata, uint64_t sourcelength,
+      uint8_t *sourcedata, uint64_t sourcelength,
       uint8_t **targetdata, uint64_t *targetlength)
 {
-   size_t i;
    struct ups_data data;
-   unsigned source_read_length;
-   unsigned target_read_length;
+   uint64_t source_read_length;
+   uint64_t target_read_length;
    uint32_t patch_result_checksum = 0;
    uint32_t patch_read_checksum   = 0;
    uint32_t source_read_checksum  = 0;
    uint32_t target_read_checksum  = 0;
+   uint32_t source_checksum       = 0;
+   uint32_t target_checksum       = 0;
+
+   if (patchlength < 18)
+      return PATCH_PATCH_INVALID;
 
    data.patch_data      = patchdata;
    data.source_data     = sourcedata;
    data.target_data     = *targetdata;
-   data.patch_length    = (unsigned)patchlength;
-   data.source_length   = (unsigned)sourcelength;
-   data.target_length   = (unsigned)*targetlength;
-   data.patch_offset    = 0;
+   data.patch_length    = (size_t)patchlength - 12;
+   data.source_length   = (size_t)sourcelength;
+   data.target_length   = (size_t)*targetlength;
+   data.patch_offset    = 4;
    data.source_offset   = 0;
    data.target_offset   = 0;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
 
-   if (data.patch_length < 18)
+   if (memcmp(patchdata, "UPS1", 4))
       return PATCH_PATCH_INVALID;
 
-   if (
-         (ups_patch_read(&data) != 'U') ||
-         (ups_patch_read(&data) != 'P') ||
-         (ups_patch_read(&data) != 'S') ||
-         (ups_patch_read(&data) != '1')
-      )
+   if (     !patch_decode(patchdata, &data.patch_offset,
+               data.patch_length, &source_read_length)
+         || !patch_decode(patchdata, &data.patch_offset,
+               data.patch_length, &target_read_length))
       return PATCH_PATCH_INVALID;
 
-   source_read_length = (unsigned)ups_decode(&data);
-   target_read_length = (unsigned)ups_decode(&data);
-
    if (     (data.source_length != source_read_length)
          && (data.source_length != target_read_length))
       return PATCH_SOURCE_INVALID;
@@ -378,56 +416,68 @@ static enum patch_error ups_apply_patch(
       data.target_data = prov;
    }
 
-   data.target_length = (unsigned)*targetlength;
-   
-   while (data.patch_offset < data.patch_length - 12)
+   data.target_length = (size_t)*targetlength;
+
+   /* Each hunk skips over unchanged bytes, then XORs a
+    * run of bytes up to and including a zero */
+   while (data.patch_offset < data.patch_length)
    {
-      unsigned length = (unsigned)ups_decode(&data);
-      while (length--)
-         ups_target_write(&data, ups_source_read(&data));
+      uint64_t length;
+      const uint8_t *xor_data;
+      const uint8_t *xor_end;
 
-      for (;;)
-      {
-         uint8_t patch_xor = ups_patch_read(&data);
-         ups_target_write(&data, patch_xor ^ ups_source_read(&data));
-         if (patch_xor == 0)
-            break;
-      }
-   }
+      if (     !patch_decode(patchdata, &data.patch_offset,
+                  data.patch_length, &length)
+            || length > data.target_length)
+         return PATCH_PATCH_INVALID;
 
-   while (data.source_offset < data.source_length)
-      ups_target_write(&data, ups_source_read(&data));
-   while (data.target_offset < data.target_length)
-      ups_target_write(&data, ups_source_read(&data));
+      ups_target_write_block(&data, NULL, (size_t)length);
+
+      xor_data = patchdata + data.patch_offset;
+      xor_end  = (const uint8_t*)memchr(xor_data, 0,
+            data.patch_length - data.patch_offset);
+
+      if (!xor_end)
+         return PATCH_PATCH_INVALID;
+
+      ups_target_write_block(&data, xor_data, xor_end - xor_data + 1);
+      data.patch_offset += xor_end - xor_data + 1;
+   }
 
-   for (i = 0; i < 4; i++)
-      source_read_checksum |= ups_patch_read(&data) << (i * 8);
-   for (i = 0; i < 4; i++)
-      target_read_checksum |= ups_patch_read(&data) << (i * 8);
+   if (data.source_offset < data.source_length)
+      ups_target_write_block(&data, NULL,
+            data.source_length - data.source_offset);
+   if (data.target_offset < data.target_length)
+      ups_target_write_block(&data, NULL,
+            data.target_length - data.target_offset);
 
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
+   source_read_checksum  = patch_read_le32(patchdata + data.patch_length);
+   target_read_checksum  = patch_read_le32(patchdata + data.patch_length + 4);
+   patch_read_checksum   = patch_read_le32(patchdata + data.patch_length + 8);
 
-   for (i = 0; i < 4; i++)
-      patch_read_checksum |= ups_patch_read(&data) << (i * 8);
+   patch_result_checksum = encoding_crc32(0, patchdata,
+         (size_t)patchlength - 4);
+   source_checksum       = encoding_crc32(0, data.source_data,
+         data.source_length);
+   target_checksum       = encoding_crc32(0, data.target_data,
+         data.target_length);
 
    if (patch_result_checksum != patch_read_checksum)
       return PATCH_PATCH_INVALID;
 
-   if (     data.source_checksum == source_read_checksum
-         && data.source_length   == source_read_length)
+   if (     source_checksum    == source_read_checksum
+         && data.source_length == source_read_length)
    {
-      if (     data.target_checksum == target_read_checksum
-            && data.target_length   == target_read_length)
+      if (     target_checksum    == target_read_checksum
+            && data.target_length == target_read_length)
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
    }
-   else if (data.source_checksum == target_read_checksum
-         && data.source_length   == target_read_length)
+   else if (source_checksum    == target_read_checksum
+         && data.source_length == target_read_length)
    {
-      if (     data.target_checksum == source_read_checksum
-            && data.target_length   == source_read_length)
+      if (     target_checksum    == source_read_checksum
+            && data.target_length == source_read_length)
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
    }
@@ -435,12 +485,12 @@ static enum patch_error ups_apply_patch(
    return PATCH_SOURCE_INVALID;
 }
 
-static enum patch_error ips_alloc_targetdata(
+/* Walks the records of an IPS patch without applying them,
+ * returning the size of the patched content */
+static enum patch_error ips_get_target_length(
       const uint8_t *patchdata, uint64_t patchlen,
-      uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+      uint64_t sourcelength, uint64_t *targetlength)
 {
-   uint8_t *prov_alloc;
    uint32_t offset = 5;
    *targetlength   = sourcelength;
 
@@ -459,26 +509,13 @@ static enum patch_error ips_alloc_targetdata(
       if (address == 0x454f46) /* EOF */
       {
          if (offset == patchlen)
-         {
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
             return PATCH_SUCCESS;
-         }
          else if (offset == patchlen - 3)
          {
             uint32_t size  = patchdata[offset++] << 16;
             size          |= patchdata[offset++] << 8;
             size          |= patchdata[offset++] << 0;
             *targetlength  = size;
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
-
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
             return PATCH_SUCCESS;
          }
       }
@@ -494,11 +531,7 @@ static enum patch_error ips_alloc_targetdata(
          if (offset > patchlen - length)
             break;
 
-         while (length--)
-         {
-            address++;
-            offset++;
-         }
+         offset += length;
       }
       else /* RLE */
       {
@@ -511,14 +544,11 @@ static enum patch_error ips_alloc_targetdata(
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            address++;
-
          offset++;
       }
 
-      if (address > *targetlength)
-         *targetlength = address;
+      if (address + length > *targetlength)
+         *targetlength = address + length;
    }
 
    return PATCH_PATCH_INVALID;
@@ -526,7 +556,7 @@ static enum patch_error ips_alloc_targetdata(
 
 static enum patch_error ips_apply_patch(
       const uint8_t *patchdata, uint64_t patchlen,
-      const uint8_t *sourcedata, uint64_t sourcelength,
+      uint8_t *sourcedata, uint64_t sourcelength,
       uint8_t **targetdata, uint64_t *targetlength)
 {
    uint32_t offset = 5;
@@ -538,21 +568,39 @@ static enum patch_error ips_apply_patch(
          patchdata[3] != 'C' ||
          patchdata[4] != 'H')
       return PATCH_PATCH_INVALID;
-   
-   if ((error_patch = ips_alloc_targetdata(
+
+   /* The whole patch is checked first, applying it
+    * cannot fail half-way through */
+   if ((error_patch = ips_get_target_length(
                patchdata, patchlen, sourcelength,
-               targetdata, targetlength)) != PATCH_SUCCESS)
+               targetlength)) != PATCH_SUCCESS)
       return error_patch;
 
-   memcpy(*targetdata, sourcedata, (size_t)sourcelength);
+   /* Patches which do not grow the content are applied in
+    * place, so that mapped content only has the pages the
+    * patch changes read and copied */
+   if (*targetlength <= sourcelength)
+      *targetdata = sourcedata;
+   else
+   {
+      uint8_t *prov_alloc = (uint8_t*)malloc((size_t)*targetlength);
+
+      if (!prov_alloc)
+         return PATCH_TARGET_ALLOC_FAILED;
+
+      free(*targetdata);
+      *targetdata = prov_alloc;
+      memcpy(prov_alloc, sourcedata, (size_t)sourcelength);
+      memset(prov_alloc + sourcelength, 0,
+            (size_t)(*targetlength - sourcelength));
+   }
 
    for (;;)
    {
       uint32_t address;
       unsigned length;
-
-      if (offset > patchlen - 3)
-         break;
+      uint8_t value = 0;
+      const uint8_t *data;
 
       address  = patchdata[offset++] << 16;
       address |= patchdata[offset++] << 8;
@@ -560,51 +608,37 @@ static enum patch_error ips_apply_patch(
 
       if (address == 0x454f46) /* EOF */
       {
-         if (offset == patchlen)
+         if (offset == patchlen || offset == patchlen - 3)
             return PATCH_SUCCESS;
-
-         if (offset == patchlen - 3)
-         {
-            uint32_t size  = patchdata[offset++] << 16;
-            size          |= patchdata[offset++] << 8;
-            size          |= patchdata[offset++] << 0;
-            return PATCH_SUCCESS;
-         }
       }
 
-      if (offset > patchlen - 2)
-         break;
-
       length  = patchdata[offset++] << 8;
       length |= patchdata[offset++] << 0;
 
       if (length) /* Copy */
       {
-         if (offset > patchlen - length)
-            break;
-
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset++];
+         data    = patchdata + offset;
+         offset += length;
       }
       else /* RLE */
       {
-         if (offset > patchlen - 3)
-            break;
-
          length  = patchdata[offset++] << 8;
          length |= patchdata[offset++] << 0;
+         value   = patchdata[offset++];
+         data    = NULL;
+      }
 
-         if (length == 0) /* Illegal */
-            break;
-
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset];
+      /* Records past a truncated end are dropped */
+      if (address >= *targetlength)
+         continue;
+      if (length > *targetlength - address)
+         length = (unsigned)(*targetlength - address);
 
-         offset++;
-      }
+      if (data)
+         memcpy(*targetdata + address, data, length);
+      else
+         memset(*targetdata + address, value, length);
    }
-
-   return PATCH_PATCH_INVALID;
 }
 
 static bool apply_patch_content(uint8_t **buf,
@@ -623,18 +657,21 @@ static bool apply_patch_content(uint8_t **buf,
    if ((err = func((const uint8_t*)patch_data, patch_size, ret_buf,
          ret_size, &patched_content, &target_size)) == PATCH_SUCCESS)
    {
-      free(ret_buf);
       *buf  = patched_content;
       *size = target_size;
+      return true;
    }
-   else
-      RARCH_ERR("%s %s: %s #%u\n",
-            msg_hash_to_str(MSG_FAILED_TO_PATCH),
-            patch_desc,
-            msg_hash_to_str(MSG_ERROR),
-            (unsigned)err);
 
-   return true;
+   RARCH_ERR("%s %s: %s #%u\n",
+         msg_hash_to_str(MSG_FAILED_TO_PATCH),
+         patch_desc,
+         msg_hash_to_str(MSG_ERROR),
+         (unsigned)err);
+
+   if (patched_content && patched_content != ret_buf)
+      free(patched_content);
+
+   return false;
 }
 
 static bool try_bps_patch(bool allow_bps, const char *name_bps,
@@ -723,6 +760,12 @@ static bool try_ips_patch(bool allow_ips,
  *
  * Apply patch to the content file in-memory.
  *
+ * The patched content is either written to a new buffer,
+ * which replaces @buf, leaving the original buffer for the
+ * caller to free, or, for patches which do not grow the
+ * content, written over @buf in place.
+ *
+ * Returns: true if a patch was applied, otherwise false.
  **/
 bool patch_content(
       bool is_ips_pref,
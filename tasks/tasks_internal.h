@@ -140,7 +140,37 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Loads 'fullpath', scaled down to fit within
+ * 'max_width' x 'max_height', and saves the result
+ * as a TGA file at 'derivative_path' for faster
+ * loading next time. The callback receives the
+ * scaled image, as with task_push_image_load() */
+bool task_push_image_derivative(const char *fullpath,
+      const char *derivative_path,
+      unsigned max_width, unsigned max_height,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *userdata);
+
+/* Image loads and derivatives are decoded on a pool
+ * of threads. Reports the number of decodes queued or
+ * running in 'depth', and the number of threads in
+ * 'workers' (0 if images are decoded in the tasks).
+ * Tasks waiting for their decode also show the depth
+ * in their title. */
+void task_image_get_decode_status(unsigned *depth, unsigned *workers);
+
+/* Stops the decode threads. Must be called after the
+ * task queue has been deinitialised */
+void task_image_decode_deinit(void);
+
 #ifdef HAVE_LIBRETRODB
+#ifdef HAVE_MENU
+bool task_push_menu_explore_init(
+      const char *directory_playlist,
+      const char *directory_database,
+      const char *cache_path);
+#endif
+
 bool task_push_dbscan(
       const char *playlist_directory,
       const char *content_database,
@@ -226,6 +256,12 @@ void set_save_state_in_background(bool state);
 void task_push_cdrom_dump(const char *drive);
 #endif
 
+#ifdef HAVE_CHD
+/* Decompresses the whole CHD and compares it with
+ * the checksum of its raw data in the header */
+bool task_push_chd_verify(const char *path);
+#endif
+
 RETRO_END_DECLS
 
 #endif
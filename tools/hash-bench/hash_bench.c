@@ -0,0 +1,245 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Headless throughput benchmark for CRC32 and SHA1.
+ *
+ * The libretro-common sources are included directly, so
+ * that each implementation can be checked against the
+ * portable one and timed on its own, next to the runtime
+ * dispatched entry points. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <streams/file_stream.h>
+#include <features/features_cpu.h>
+
+#include "../../libretro-common/encodings/encoding_crc32.c"
+#include "../../libretro-common/hash/rhash.c"
+
+enum bench_kind
+{
+   BENCH_CRC32 = 0,
+   BENCH_SHA1
+};
+
+struct bench_impl
+{
+   const char *name;
+   enum bench_kind kind;
+   /* CPU_FEATURE_* flags needed, 0 for none */
+   uint64_t features;
+   crc32_update_t crc32;
+   sha1_blocks_t sha1;
+};
+
+/* A NULL function stands for the dispatched entry point */
+static const struct bench_impl bench_impls[] = {
+   { "crc32 slice-by-16", BENCH_CRC32, 0, crc32_update_generic, NULL },
+#ifdef CRC32_PCLMUL
+   { "crc32 pclmul", BENCH_CRC32, CPU_FEATURE_PCLMUL, crc32_update_pclmul, NULL },
+#endif
+#ifdef CRC32_ARMV8
+   { "crc32 armv8", BENCH_CRC32, CPU_FEATURE_CRC32, crc32_update_armv8, NULL },
+#endif
+   { "encoding_crc32", BENCH_CRC32, 0, NULL, NULL },
+   { "sha1 generic", BENCH_SHA1, 0, NULL, sha1_blocks_generic },
+#ifdef SHA1_NI
+   { "sha1 x86 sha", BENCH_SHA1, CPU_FEATURE_SHA1, NULL, sha1_blocks_ni },
+#endif
+#ifdef SHA1_ARMV8
+   { "sha1 armv8", BENCH_SHA1, CPU_FEATURE_SHA1, NULL, sha1_blocks_armv8 },
+#endif
+   { "sha1_context", BENCH_SHA1, 0, NULL, NULL },
+};
+
+static void bench_usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n iterations] [-s size_in_kb] [file]\n"
+         "\n"
+         "  -n <iterations>  Hash the input this many times (default: 16).\n"
+         "  -s <size>        Size of the random input in KB (default: 65536).\n",
+         argv0);
+}
+
+/* Hashes 'len' bytes, and returns the CRC32 or the first
+ * word of the SHA1 digest in 'result' */
+static void bench_run(const struct bench_impl *impl,
+      const uint8_t *buf, size_t len, uint32_t *result)
+{
+   if (impl->kind == BENCH_CRC32)
+   {
+      if (impl->crc32)
+         *result = impl->crc32(0xffffffff, buf, len) ^ 0xffffffff;
+      else
+         *result = encoding_crc32(0, buf, len);
+   }
+   else if (impl->sha1)
+   {
+      /* Whole blocks only, the tail is the same for everyone */
+      unsigned digest[5] = {
+         0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+      impl->sha1(digest, buf, len >> 6);
+      *result = digest[0];
+   }
+   else
+   {
+      struct sha1_context sha1;
+      sha1_context_init(&sha1);
+      sha1_context_update(&sha1, buf, len & ~(size_t)63);
+      *result = sha1.Message_Digest[0];
+   }
+}
+
+/* Checks an implementation against the portable one of its kind */
+static bool bench_verify(const struct bench_impl *impl,
+      const struct bench_impl *reference, const uint8_t *buf, size_t len)
+{
+   size_t i;
+   uint32_t expected, actual;
+
+   bench_run(reference, buf, len, &expected);
+   bench_run(impl, buf, len, &actual);
+   if (expected != actual)
+      return false;
+
+   /* Short and unaligned inputs take the scalar head and tail paths */
+   for (i = 0; i < 1024 && i + 16 <= len; i++)
+   {
+      bench_run(reference, buf + (i & 15), i, &expected);
+      bench_run(impl, buf + (i & 15), i, &actual);
+      if (expected != actual)
+         return false;
+   }
+
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   size_t j;
+   uint8_t *buf        = NULL;
+   int64_t len         = 65536 * 1024;
+   unsigned iterations = 16;
+   const char *path    = NULL;
+   uint64_t features   = cpu_features_get_extended();
+   int ret             = EXIT_FAILURE;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         len = (int64_t)strtoul(argv[++i], NULL, 0) * 1024;
+      else if (argv[i][0] != '-' && !path)
+         path = argv[i];
+      else
+      {
+         bench_usage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (!iterations || len <= 0)
+   {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   if (path)
+   {
+      void *data = NULL;
+
+      if (!filestream_read_file(path, &data, &len) || len <= 0)
+      {
+         fprintf(stderr, "Could not read \"%s\".\n", path);
+         free(data);
+         return EXIT_FAILURE;
+      }
+
+      buf = (uint8_t*)data;
+   }
+   else
+   {
+      uint32_t seed = 0x12345678;
+
+      buf = (uint8_t*)malloc((size_t)len);
+      if (!buf)
+         return EXIT_FAILURE;
+
+      for (j = 0; j < (size_t)len; j++)
+      {
+         seed   = seed * 1103515245 + 12345;
+         buf[j] = (uint8_t)(seed >> 16);
+      }
+   }
+
+   printf("%.2f MB, %u iteration(s), cpu features 0x%llx\n\n",
+         len / 1048576.0, iterations, (unsigned long long)features);
+   printf("%-20s %12s %10s\n", "implementation", "us/iter", "MB/s");
+
+   for (j = 0; j < sizeof(bench_impls) / sizeof(bench_impls[0]); j++)
+   {
+      unsigned iter;
+      uint32_t result;
+      double seconds;
+      retro_time_t time                    = 0;
+      const struct bench_impl *impl        = &bench_impls[j];
+      const struct bench_impl *reference   = &bench_impls[0];
+
+      if (impl->kind == BENCH_SHA1)
+      {
+         size_t k;
+         for (k = 0; bench_impls[k].kind != BENCH_SHA1; k++);
+         reference = &bench_impls[k];
+      }
+
+      if ((impl->features & features) != impl->features)
+      {
+         printf("%-20s %12s %10s\n", impl->name, "-", "unsupported");
+         continue;
+      }
+
+      if (!bench_verify(impl, reference, buf, (size_t)len))
+      {
+         printf("%-20s MISMATCH against %s\n", impl->name, reference->name);
+         goto end;
+      }
+
+      for (iter = 0; iter < iterations; iter++)
+      {
+         retro_time_t start = cpu_features_get_time_usec();
+         bench_run(impl, buf, (size_t)len, &result);
+         time += cpu_features_get_time_usec() - start;
+      }
+
+      seconds = time / 1000000.0;
+      printf("%-20s %12lld %10.2f\n", impl->name,
+            (long long)(time / iterations),
+            seconds > 0.0
+            ? (len / 1048576.0) * iterations / seconds
+            : 0.0);
+   }
+
+   ret = EXIT_SUCCESS;
+
+end:
+   free(buf);
+   return ret;
+}
@@ -0,0 +1,243 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Headless benchmark for content softpatching.
+ *
+ * Applies BPS, UPS and IPS patches to a content file through
+ * patch_content(), exactly as content loading does, and
+ * reports the time per patch and the throughput in megabytes
+ * of patched content per second. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <compat/msvc.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+
+#include "../../msg_hash.h"
+#include "../../verbosity.h"
+#include "../../tasks/tasks_internal.h"
+
+static bool bench_verbose = false;
+
+const char *msg_hash_to_str(enum msg_hash_enums msg)
+{
+   switch (msg)
+   {
+      case MSG_FAILED_TO_PATCH:
+         return "Failed to patch";
+      case MSG_ERROR:
+         return "Error";
+      case MSG_SEVERAL_PATCHES_ARE_EXPLICITLY_DEFINED:
+         return "Several patches are explicitly defined, ignoring all...";
+      case MSG_DID_NOT_FIND_A_VALID_CONTENT_PATCH:
+         return "Did not find a valid content patch.";
+      default:
+         break;
+   }
+   return "";
+}
+
+static void bench_log(const char *tag, const char *fmt, va_list ap)
+{
+   if (!bench_verbose)
+      return;
+   fputs(tag, stderr);
+   vfprintf(stderr, fmt, ap);
+}
+
+void RARCH_LOG(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   bench_log("", fmt, ap);
+   va_end(ap);
+}
+
+void RARCH_WARN(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   bench_log("[WARN] ", fmt, ap);
+   va_end(ap);
+}
+
+/* Errors are always shown, a patch failing should never be silent. */
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   fputs("[ERROR] ", stderr);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static void bench_usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n iterations] [-v] <content> <patch.bps|patch.ups|patch.ips>...\n"
+         "\n"
+         "  -n <iterations>  Apply every patch this many times (default: 10).\n"
+         "  -v               Show the log of every patch.\n",
+         argv0);
+}
+
+/* Applies a patch to a fresh copy of the content, so that
+ * patches applied in place start from the original data.
+ * The copy is not part of the timing. */
+static bool bench_patch(const char *patch_path,
+      const void *content, int64_t content_len,
+      retro_time_t *time, uint32_t *crc, ssize_t *patched_len,
+      bool *in_place)
+{
+   retro_time_t start;
+   bool ret        = false;
+   const char *ext = path_get_extension(patch_path);
+   bool is_ips     = string_is_equal_noncase(ext, "ips");
+   bool is_bps     = string_is_equal_noncase(ext, "bps");
+   bool is_ups     = string_is_equal_noncase(ext, "ups");
+   ssize_t size    = (ssize_t)content_len;
+   uint8_t *copy   = (uint8_t*)malloc((size_t)content_len);
+   uint8_t *buf    = copy;
+
+   if (!copy)
+      return false;
+
+   if (!is_ips && !is_bps && !is_ups)
+   {
+      fprintf(stderr, "\"%s\" is not a BPS, UPS or IPS patch.\n",
+            patch_path);
+      free(copy);
+      return false;
+   }
+
+   memcpy(copy, content, (size_t)content_len);
+
+   start = cpu_features_get_time_usec();
+   ret   = patch_content(is_ips, is_bps, is_ups,
+         is_ips ? patch_path : NULL,
+         is_bps ? patch_path : NULL,
+         is_ups ? patch_path : NULL,
+         &buf, &size);
+   *time = cpu_features_get_time_usec() - start;
+
+   if (ret)
+   {
+      *crc         = encoding_crc32(0, buf, (size_t)size);
+      *patched_len = size;
+      *in_place    = (buf == copy);
+   }
+
+   if (buf != copy)
+      free(buf);
+   free(copy);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned iter;
+   const char *content_path = NULL;
+   void *content            = NULL;
+   int64_t content_len      = 0;
+   unsigned iterations      = 10;
+   unsigned failures        = 0;
+   int first_patch          = 0;
+   int ret                  = EXIT_FAILURE;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-v"))
+         bench_verbose = true;
+      else if (argv[i][0] != '-')
+      {
+         content_path = argv[i];
+         first_patch  = i + 1;
+         break;
+      }
+      else
+      {
+         bench_usage(argv[0]);
+         goto end;
+      }
+   }
+
+   if (!content_path || first_patch >= argc || !iterations)
+   {
+      bench_usage(argv[0]);
+      goto end;
+   }
+
+   if (!filestream_read_file(content_path, &content, &content_len))
+   {
+      fprintf(stderr, "Could not read \"%s\".\n", content_path);
+      goto end;
+   }
+
+   printf("%s: %.2f MB, %u iteration(s)\n\n", content_path,
+         content_len / 1048576.0, iterations);
+   printf("%-32s %10s %8s %12s %10s\n",
+         "patch", "CRC32", "in place", "us/patch", "MB/s");
+
+   for (i = first_patch; i < argc; i++)
+   {
+      retro_time_t total = 0;
+      uint32_t crc       = 0;
+      ssize_t len        = 0;
+      bool in_place      = false;
+
+      for (iter = 0; iter < iterations; iter++)
+      {
+         retro_time_t time = 0;
+
+         if (!bench_patch(argv[i], content, content_len,
+                  &time, &crc, &len, &in_place))
+            break;
+
+         total += time;
+      }
+
+      if (iter < iterations)
+      {
+         printf("%-32s %10s\n", path_basename(argv[i]), "FAILED");
+         failures++;
+         continue;
+      }
+
+      printf("%-32s   %08x %8s %12lld %10.2f\n",
+            path_basename(argv[i]), (unsigned)crc,
+            in_place ? "yes" : "no",
+            (long long)(total / iterations),
+            total > 0
+            ? ((double)len * iterations) / 1048576.0 / (total / 1000000.0)
+            : 0.0);
+   }
+
+   ret = failures ? EXIT_FAILURE : EXIT_SUCCESS;
+
+end:
+   if (content)
+      free(content);
+   return ret;
+}
@@ -0,0 +1,321 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Headless benchmark for the rpng decoder.
+ *
+ * Decodes a corpus of PNG files (typically a thumbnail
+ * directory) from memory, once through the incremental
+ * rpng_process_image() loop used by the image tasks and
+ * once through rpng_decode_image(), checks that both
+ * produce the same pixels and reports megapixels per
+ * second for each. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <formats/image.h>
+#include <formats/rpng.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+#include <streams/file_stream.h>
+#include <features/features_cpu.h>
+
+enum bench_mode
+{
+   BENCH_MODE_INCREMENTAL = 0,
+   BENCH_MODE_SINGLE_SHOT,
+   BENCH_MODE_LAST
+};
+
+static const char *bench_mode_names[BENCH_MODE_LAST] = {
+   "incremental",
+   "single-shot",
+};
+
+struct bench_file
+{
+   char *path;
+   void *buf;
+   int64_t len;
+};
+
+static bool bench_verbose = false;
+
+static void bench_usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n iterations] [-v] <file.png | directory>...\n"
+         "\n"
+         "  -n <iterations>  Decode the corpus this many times (default: 1).\n"
+         "  -v               Report every file.\n",
+         argv0);
+}
+
+/* Returns the decoded pixels, or NULL if the file is not a PNG
+ * rpng can decode. Chunk parsing is included in the timing,
+ * as it is part of every load. */
+static uint32_t *bench_decode(const struct bench_file *file,
+      enum bench_mode mode, unsigned *width, unsigned *height)
+{
+   int ret;
+   uint32_t *data = NULL;
+   rpng_t *rpng   = rpng_alloc();
+
+   if (!rpng)
+      return NULL;
+
+   if (     !rpng_set_buf_ptr(rpng, file->buf, (size_t)file->len)
+         || !rpng_start(rpng))
+      goto error;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto error;
+
+   if (mode == BENCH_MODE_SINGLE_SHOT)
+      ret = rpng_decode_image(rpng, (void**)&data, width, height);
+   else
+   {
+      do
+      {
+         ret = rpng_process_image(rpng, (void**)&data,
+               (size_t)file->len, width, height);
+      } while (ret == IMAGE_PROCESS_NEXT);
+   }
+
+   if (ret == IMAGE_PROCESS_ERROR || ret == IMAGE_PROCESS_ERROR_END)
+      goto error;
+
+   rpng_free(rpng);
+   return data;
+
+error:
+   if (data)
+      free(data);
+   rpng_free(rpng);
+   return NULL;
+}
+
+static bool bench_add_path(const char *path,
+      struct bench_file **files, size_t *count, size_t *capacity)
+{
+   struct bench_file *file;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   if (!filestream_read_file(path, &buf, &len))
+   {
+      fprintf(stderr, "Could not read \"%s\".\n", path);
+      return false;
+   }
+
+   if (*count == *capacity)
+   {
+      size_t new_capacity         = *capacity ? *capacity * 2 : 64;
+      struct bench_file *new_data = (struct bench_file*)realloc(*files,
+            new_capacity * sizeof(**files));
+
+      if (!new_data)
+      {
+         free(buf);
+         return false;
+      }
+
+      *files    = new_data;
+      *capacity = new_capacity;
+   }
+
+   file       = &(*files)[(*count)++];
+   file->path = strdup(path);
+   file->buf  = buf;
+   file->len  = len;
+   return true;
+}
+
+static bool bench_add_arg(const char *arg,
+      struct bench_file **files, size_t *count, size_t *capacity)
+{
+   size_t i;
+   struct string_list *list = NULL;
+
+   if (!path_is_directory(arg))
+      return bench_add_path(arg, files, count, capacity);
+
+   list = dir_list_new(arg, "png", false, false, false, true);
+   if (!list)
+   {
+      fprintf(stderr, "Could not list \"%s\".\n", arg);
+      return false;
+   }
+
+   dir_list_sort(list, true);
+
+   for (i = 0; i < list->size; i++)
+   {
+      if (!bench_add_path(list->elems[i].data, files, count, capacity))
+      {
+         string_list_free(list);
+         return false;
+      }
+   }
+
+   string_list_free(list);
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   size_t f;
+   unsigned iter, mode;
+   retro_time_t time[BENCH_MODE_LAST];
+   struct bench_file *files = NULL;
+   size_t count             = 0;
+   size_t capacity          = 0;
+   size_t decoded           = 0;
+   size_t mismatches        = 0;
+   uint64_t pixels          = 0;
+   unsigned iterations      = 1;
+   int ret                  = EXIT_FAILURE;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-v"))
+         bench_verbose = true;
+      else if (argv[i][0] != '-')
+      {
+         if (!bench_add_arg(argv[i], &files, &count, &capacity))
+            goto end;
+      }
+      else
+      {
+         bench_usage(argv[0]);
+         goto end;
+      }
+   }
+
+   if (!count || !iterations)
+   {
+      bench_usage(argv[0]);
+      goto end;
+   }
+
+   memset(time, 0, sizeof(time));
+
+   /* Check the two paths against each other once, outside
+    * the timed loops. Files rpng cannot decode are dropped. */
+   for (f = 0; f < count; f++)
+   {
+      unsigned width[BENCH_MODE_LAST]  = {0};
+      unsigned height[BENCH_MODE_LAST] = {0};
+      uint32_t *data[BENCH_MODE_LAST];
+      bool keep                        = false;
+
+      for (mode = 0; mode < BENCH_MODE_LAST; mode++)
+         data[mode] = bench_decode(&files[f], (enum bench_mode)mode,
+               &width[mode], &height[mode]);
+
+      if (!data[BENCH_MODE_INCREMENTAL] || !data[BENCH_MODE_SINGLE_SHOT])
+      {
+         if (bench_verbose)
+            printf("%s: not decoded, skipped\n", files[f].path);
+      }
+      else if (   width[0]  != width[1]
+               || height[0] != height[1]
+               || memcmp(data[0], data[1],
+                  (size_t)width[0] * height[0] * sizeof(uint32_t)))
+      {
+         printf("%s: MISMATCH between decode paths\n", files[f].path);
+         mismatches++;
+      }
+      else
+      {
+         if (bench_verbose)
+            printf("%s: %ux%u\n", files[f].path, width[0], height[0]);
+         pixels += (uint64_t)width[0] * height[0];
+         keep    = true;
+      }
+
+      for (mode = 0; mode < BENCH_MODE_LAST; mode++)
+         if (data[mode])
+            free(data[mode]);
+
+      if (keep)
+         files[decoded++] = files[f];
+      else
+      {
+         free(files[f].path);
+         free(files[f].buf);
+      }
+   }
+
+   count = decoded;
+
+   if (!decoded)
+   {
+      fprintf(stderr, "No decodable PNG files.\n");
+      goto end;
+   }
+
+   for (iter = 0; iter < iterations; iter++)
+   {
+      for (mode = 0; mode < BENCH_MODE_LAST; mode++)
+      {
+         retro_time_t start = cpu_features_get_time_usec();
+
+         for (f = 0; f < decoded; f++)
+         {
+            unsigned width  = 0;
+            unsigned height = 0;
+            uint32_t *data  = bench_decode(&files[f],
+                  (enum bench_mode)mode, &width, &height);
+
+            free(data);
+         }
+
+         time[mode] += cpu_features_get_time_usec() - start;
+      }
+   }
+
+   printf("%u file(s), %.2f MP, %u iteration(s)\n\n",
+         (unsigned)decoded, pixels / 1000000.0, iterations);
+   printf("%-12s %12s %10s\n", "mode", "us/iter", "MP/s");
+   for (mode = 0; mode < BENCH_MODE_LAST; mode++)
+   {
+      double seconds = time[mode] / 1000000.0;
+
+      printf("%-12s %12lld %10.2f\n", bench_mode_names[mode],
+            (long long)(time[mode] / iterations),
+            seconds > 0.0
+            ? (pixels * iterations) / 1000000.0 / seconds
+            : 0.0);
+   }
+
+   ret = mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+
+end:
+   for (f = 0; f < count; f++)
+   {
+      free(files[f].path);
+      free(files[f].buf);
+   }
+   free(files);
+   return ret;
+}
@@ -0,0 +1,535 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Headless benchmark for the slang shader pipeline.
+ *
+ * Runs every stage a video driver goes through when loading a .slangp
+ * preset (preset parsing, #include expansion, SPIR-V compilation,
+ * reflection and SPIRV-Cross output) without creating a graphics
+ * context, and reports how long each stage took. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <exception>
+
+#include <spirv_glsl.hpp>
+#include <spirv_hlsl.hpp>
+#include <spirv_msl.hpp>
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <lists/string_list.h>
+#include <features/features_cpu.h>
+
+#include "../../configuration.h"
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+#include "../../frontend/frontend_driver.h"
+#include "../../gfx/video_shader_parse.h"
+#include "../../gfx/drivers_shader/glslang_util.h"
+#include "../../gfx/drivers_shader/glslang_util_cxx.h"
+#include "../../gfx/drivers_shader/slang_reflection.h"
+#include "../../gfx/drivers_shader/slang_reflection.hpp"
+
+using namespace std;
+using namespace spirv_cross;
+
+enum bench_stage
+{
+   BENCH_STAGE_PRESET = 0,
+   BENCH_STAGE_PARAMETERS,
+   BENCH_STAGE_PREPROCESS,
+   BENCH_STAGE_COMPILE,
+   BENCH_STAGE_REFLECT,
+   BENCH_STAGE_CROSS_GLSL,
+   BENCH_STAGE_CROSS_HLSL,
+   BENCH_STAGE_CROSS_MSL,
+   BENCH_STAGE_LAST
+};
+
+static const char *bench_stage_names[BENCH_STAGE_LAST] = {
+   "preset",
+   "parameters",
+   "preprocess",
+   "compile",
+   "reflect",
+   "cross-glsl",
+   "cross-hlsl",
+   "cross-msl",
+};
+
+static bool bench_verbose = false;
+
+/* Frontend symbols referenced by video_shader_parse.c and the
+ * shader backends. The benchmark has no frontend, so these are
+ * reduced to what a headless run needs. */
+static settings_t bench_settings;
+
+settings_t *config_get_ptr(void)
+{
+   return &bench_settings;
+}
+
+void frontend_driver_watch_path_for_changes(struct string_list *list,
+      int flags, path_change_data_t **change_data) { }
+
+bool frontend_driver_check_for_path_changes(
+      path_change_data_t *change_data)
+{
+   return false;
+}
+
+bool video_context_driver_get_flags(gfx_ctx_flags_t *flags)
+{
+   return false;
+}
+
+static void bench_log(const char *tag, const char *fmt, va_list ap)
+{
+   if (!bench_verbose)
+      return;
+   fputs(tag, stderr);
+   vfprintf(stderr, fmt, ap);
+}
+
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
+{
+   bench_log(tag ? tag : "", fmt, ap);
+}
+
+void RARCH_LOG(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   bench_log("", fmt, ap);
+   va_end(ap);
+}
+
+void RARCH_WARN(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   bench_log("[WARN] ", fmt, ap);
+   va_end(ap);
+}
+
+/* Errors are always shown, a failing stage should never be silent. */
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   fputs("[ERROR] ", stderr);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+struct bench_pass
+{
+   glslang_output output;
+   retro_time_t   time[BENCH_STAGE_LAST];
+};
+
+struct bench_state
+{
+   struct video_shader           *shader;
+   vector<bench_pass>            passes;
+   retro_time_t                  time[BENCH_STAGE_LAST];
+   unordered_map<string, slang_texture_semantic_map> texture_map;
+   unordered_map<string, slang_texture_semantic_map> texture_uniform_map;
+};
+
+static void bench_usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n iterations] [-v] <preset.slangp>\n"
+         "\n"
+         "  -n <iterations>  Run the whole pipeline this many times (default: 1).\n"
+         "  -v               Show log output from the shader backend.\n",
+         argv0);
+}
+
+static bool bench_load_preset(const char *path, struct bench_state *state)
+{
+   retro_time_t start;
+   config_file_t *conf = NULL;
+   bool ret            = false;
+
+   start = cpu_features_get_time_usec();
+   conf  = video_shader_read_preset(path);
+   if (!conf)
+   {
+      RARCH_ERR("Failed to open preset \"%s\".\n", path);
+      return false;
+   }
+
+   if (!video_shader_read_conf_preset(conf, state->shader))
+   {
+      RARCH_ERR("Failed to parse preset \"%s\".\n", path);
+      goto end;
+   }
+   state->time[BENCH_STAGE_PRESET] += cpu_features_get_time_usec() - start;
+
+   start = cpu_features_get_time_usec();
+   if (!video_shader_resolve_parameters(conf, state->shader))
+   {
+      RARCH_ERR("Failed to resolve parameters of \"%s\".\n", path);
+      goto end;
+   }
+   state->time[BENCH_STAGE_PARAMETERS] += cpu_features_get_time_usec() - start;
+
+   ret = true;
+
+end:
+   config_file_free(conf);
+   return ret;
+}
+
+/* Mirrors the semantic maps the filter chains build from pass
+ * aliases and LUT names before reflecting each pass. */
+static bool bench_build_semantic_maps(struct bench_state *state)
+{
+   unsigned i;
+   struct video_shader *shader = state->shader;
+
+   state->texture_map.clear();
+   state->texture_uniform_map.clear();
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      const char *alias = shader->pass[i].alias;
+
+      if (!*alias)
+         continue;
+
+      if (!slang_set_unique_map(state->texture_map, string(alias),
+               slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_PASS_OUTPUT, i }))
+         return false;
+      if (!slang_set_unique_map(state->texture_uniform_map,
+               string(alias) + "Size", slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_PASS_OUTPUT, i }))
+         return false;
+      if (!slang_set_unique_map(state->texture_map,
+               string(alias) + "Feedback", slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_PASS_FEEDBACK, i }))
+         return false;
+      if (!slang_set_unique_map(state->texture_uniform_map,
+               string(alias) + "FeedbackSize", slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_PASS_FEEDBACK, i }))
+         return false;
+   }
+
+   for (i = 0; i < shader->luts; i++)
+   {
+      if (!slang_set_unique_map(state->texture_map,
+               string(shader->lut[i].id), slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_USER, i }))
+         return false;
+      if (!slang_set_unique_map(state->texture_uniform_map,
+               string(shader->lut[i].id) + "Size", slang_texture_semantic_map{
+               SLANG_TEXTURE_SEMANTIC_USER, i }))
+         return false;
+   }
+
+   return true;
+}
+
+static bool bench_preprocess_pass(const char *path, bench_pass *pass)
+{
+   glslang_meta meta;
+   retro_time_t start        = cpu_features_get_time_usec();
+   struct string_list *lines = string_list_new();
+   bool ret                  = false;
+
+   if (!lines)
+      return false;
+
+   if (glslang_read_shader_file(path, lines, true))
+      ret = glslang_parse_meta(lines, &meta);
+
+   string_list_free(lines);
+   pass->time[BENCH_STAGE_PREPROCESS] += cpu_features_get_time_usec() - start;
+   return ret;
+}
+
+static bool bench_reflect_pass(struct bench_state *state, unsigned index)
+{
+   unsigned i;
+   slang_reflection reflection;
+   unordered_map<string, slang_semantic_map> semantic_map;
+   bench_pass &pass   = state->passes[index];
+   retro_time_t start = cpu_features_get_time_usec();
+   bool ret           = false;
+
+   for (i = 0; i < pass.output.meta.parameters.size(); i++)
+   {
+      if (!slang_set_unique_map(semantic_map,
+               pass.output.meta.parameters[i].id,
+               slang_semantic_map{ SLANG_SEMANTIC_FLOAT_PARAMETER, i }))
+         return false;
+   }
+
+   reflection.pass_number                  = index;
+   reflection.texture_semantic_map         = &state->texture_map;
+   reflection.texture_semantic_uniform_map = &state->texture_uniform_map;
+   reflection.semantic_map                 = &semantic_map;
+
+   ret = slang_reflect_spirv(pass.output.vertex,
+         pass.output.fragment, &reflection);
+
+   pass.time[BENCH_STAGE_REFLECT] += cpu_features_get_time_usec() - start;
+   return ret;
+}
+
+/* Uses the same binding assignment as slang_process() so the
+ * generated code matches what the D3D, GL and Metal drivers get. */
+static void bench_cross_bindings(Compiler *compiler)
+{
+   ShaderResources resources = compiler->get_shader_resources();
+
+   if (!resources.uniform_buffers.empty())
+      compiler->set_decoration(resources.uniform_buffers[0].id,
+            spv::DecorationBinding, 0);
+   if (!resources.push_constant_buffers.empty())
+      compiler->set_decoration(resources.push_constant_buffers[0].id,
+            spv::DecorationBinding, 1);
+}
+
+static bool bench_cross_stage(const vector<uint32_t> &spirv,
+      enum bench_stage stage)
+{
+   try
+   {
+      switch (stage)
+      {
+         case BENCH_STAGE_CROSS_GLSL:
+            {
+               CompilerGLSL compiler(spirv);
+               CompilerGLSL::Options options;
+               options.version = 330;
+               compiler.set_common_options(options);
+               bench_cross_bindings(&compiler);
+               compiler.compile();
+            }
+            break;
+         case BENCH_STAGE_CROSS_HLSL:
+            {
+               CompilerHLSL compiler(spirv);
+               CompilerHLSL::Options options;
+               options.shader_model = 50;
+               compiler.set_hlsl_options(options);
+               bench_cross_bindings(&compiler);
+               compiler.compile();
+            }
+            break;
+         case BENCH_STAGE_CROSS_MSL:
+            {
+               CompilerMSL compiler(spirv);
+               CompilerMSL::Options options;
+               options.msl_version = 20000;
+               compiler.set_msl_options(options);
+               bench_cross_bindings(&compiler);
+               compiler.compile();
+            }
+            break;
+         default:
+            return false;
+      }
+   }
+   catch (const std::exception &e)
+   {
+      RARCH_ERR("SPIRV-Cross (%s) threw exception: %s.\n",
+            bench_stage_names[stage], e.what());
+      return false;
+   }
+
+   return true;
+}
+
+static bool bench_cross_pass(bench_pass *pass)
+{
+   unsigned stage;
+
+   for (stage = BENCH_STAGE_CROSS_GLSL; stage <= BENCH_STAGE_CROSS_MSL; stage++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+
+      if (!bench_cross_stage(pass->output.vertex, (enum bench_stage)stage))
+         return false;
+      if (!bench_cross_stage(pass->output.fragment, (enum bench_stage)stage))
+         return false;
+
+      pass->time[stage] += cpu_features_get_time_usec() - start;
+   }
+
+   return true;
+}
+
+static bool bench_run(const char *path, struct bench_state *state)
+{
+   unsigned i;
+   struct video_shader *shader = state->shader;
+
+   if (!bench_load_preset(path, state))
+      return false;
+
+   if (state->passes.size() != shader->passes)
+      state->passes.resize(shader->passes);
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      retro_time_t start;
+      bench_pass &pass      = state->passes[i];
+      const char *pass_path = shader->pass[i].source.path;
+
+      if (!bench_preprocess_pass(pass_path, &pass))
+      {
+         RARCH_ERR("Failed to preprocess pass #%u \"%s\".\n", i, pass_path);
+         return false;
+      }
+
+      start       = cpu_features_get_time_usec();
+      pass.output = glslang_output{};
+      if (!glslang_compile_shader(pass_path, &pass.output))
+      {
+         RARCH_ERR("Failed to compile pass #%u \"%s\".\n", i, pass_path);
+         return false;
+      }
+      pass.time[BENCH_STAGE_COMPILE] += cpu_features_get_time_usec() - start;
+
+      /* #pragma name provides the alias when the preset has none. */
+      if (!*shader->pass[i].alias && !pass.output.meta.name.empty())
+         strlcpy(shader->pass[i].alias, pass.output.meta.name.c_str(),
+               sizeof(shader->pass[i].alias));
+   }
+
+   /* Reflection needs the aliases of every pass, so it can
+    * only start once the whole preset has been compiled. */
+   if (!bench_build_semantic_maps(state))
+   {
+      RARCH_ERR("Duplicate pass alias or LUT name in \"%s\".\n", path);
+      return false;
+   }
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      const char *pass_path = shader->pass[i].source.path;
+
+      if (!bench_reflect_pass(state, i))
+      {
+         RARCH_ERR("Failed to reflect pass #%u \"%s\".\n", i, pass_path);
+         return false;
+      }
+
+      if (!bench_cross_pass(&state->passes[i]))
+      {
+         RARCH_ERR("Failed to cross-compile pass #%u \"%s\".\n", i, pass_path);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static void bench_report(const struct bench_state *state, unsigned iterations)
+{
+   unsigned i, stage;
+   retro_time_t total                    = 0;
+   retro_time_t totals[BENCH_STAGE_LAST] = {0};
+
+   for (stage = 0; stage < BENCH_STAGE_LAST; stage++)
+   {
+      totals[stage] = state->time[stage];
+      for (i = 0; i < state->passes.size(); i++)
+         totals[stage] += state->passes[i].time[stage];
+      total += totals[stage];
+   }
+
+   printf("%-12s", "pass");
+   for (stage = 0; stage < BENCH_STAGE_LAST; stage++)
+      printf(" %11s", bench_stage_names[stage]);
+   printf("\n");
+
+   /* All times are averages per iteration, in microseconds. */
+   for (i = 0; i < state->passes.size(); i++)
+   {
+      printf("%-12u", i);
+      for (stage = 0; stage < BENCH_STAGE_LAST; stage++)
+         printf(" %11lld", (long long)(state->passes[i].time[stage] / iterations));
+      printf("\n");
+   }
+
+   printf("%-12s", "total");
+   for (stage = 0; stage < BENCH_STAGE_LAST; stage++)
+      printf(" %11lld", (long long)(totals[stage] / iterations));
+   printf("\n\n%u passes, %u iteration(s), %lld us per iteration\n",
+         (unsigned)state->passes.size(), iterations,
+         (long long)(total / iterations));
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned iter;
+   struct bench_state state;
+   const char *path    = NULL;
+   unsigned iterations = 1;
+   int ret             = EXIT_FAILURE;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-v"))
+         bench_verbose = true;
+      else if (argv[i][0] != '-' && !path)
+         path = argv[i];
+      else
+      {
+         bench_usage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (!path || !iterations)
+   {
+      bench_usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   memset(state.time, 0, sizeof(state.time));
+   state.shader = (struct video_shader*)calloc(1, sizeof(*state.shader));
+   if (!state.shader)
+      return EXIT_FAILURE;
+
+   for (iter = 0; iter < iterations; iter++)
+   {
+      if (!bench_run(path, &state))
+         goto end;
+   }
+
+   bench_report(&state, iterations);
+   ret = EXIT_SUCCESS;
+
+end:
+   free(state.shader);
+   return ret;
+}